@@ -0,0 +1,205 @@
+// Benchmark: passo único x pré-passo de profundidade
+//
+// Desenha pilhas de quads sobrepostos (complexidade de profundidade 1, 2, 4, 8 e 16) com phong e com
+// textura, de trás para a frente (pior caso: todos os pixels são sombreados em todas as camadas) e de
+// frente para trás (melhor caso: o teste de profundidade já descarta as camadas ocultas), e informa
+// quando o pré-passo compensa
+//
+// Uso: depth_prepass_bench [repetições]
+//
+// O pré-passo rasteriza a profundidade de todas as camadas (rasterize_depth) e então sombreia cada
+// pixel uma única vez; o custo extra é uma rasterização sem atributos por camada
+
+#include <models/light.hpp>
+#include <models/texture.hpp>
+#include <rendering/pipeline.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+// Lado da área desenhada (pixels)
+constexpr int VIEWPORT_SIZE = 512;
+
+// Número de camadas das pilhas
+const int LAYERS[] = {1, 2, 4, 8, 16};
+
+/**
+ * @brief Textura xadrez com mipmaps (o benchmark não depende dos assets)
+ *
+ * @param size Lado da textura (potência de 2)
+ * @return models::Texture Textura no layout linha a linha
+ */
+static models::Texture checker_texture(int size)
+{
+  models::Texture tex;
+  tex.width = size;
+  tex.height = size;
+
+  models::TextureLevel base;
+  base.width = size;
+  base.height = size;
+  base.width_log2 = static_cast<int>(std::log2(size));
+  base.u_mask = size - 1;
+  base.v_mask = size - 1;
+
+  tex.texels.resize(static_cast<std::size_t>(size) * size);
+  for (int y = 0; y < size; y++)
+    for (int x = 0; x < size; x++)
+      tex.texels[y * size + x] = ((x / 8) + (y / 8)) % 2 == 0 ? models::WHITE : models::Color{64, 64, 64, 255};
+
+  tex.levels.push_back(base);
+  tex.buildMipmaps();
+
+  return tex;
+}
+
+/**
+ * @brief Camada da pilha: quad levemente rotacionado que cobre a maior parte da viewport
+ *
+ * @param layer Índice da camada (0 é a mais próxima)
+ * @return pipeline::ClipPolygon<V> Quad com normais (phong) ou UVs (textura) nos atributos
+ */
+template <typename V>
+static pipeline::ClipPolygon<V> layer_quad(int layer)
+{
+  const float corners[4][2] = {{-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f}};
+
+  float radians = layer * 0.1f;
+  float c = std::cos(radians), s = std::sin(radians);
+  float half = VIEWPORT_SIZE * 0.45f;
+
+  pipeline::ClipPolygon<V> polygon;
+  for (int i = 0; i < 4; i++)
+  {
+    float x = corners[i][0] * half, y = corners[i][1] * half;
+
+    V vertex;
+    vertex.position = {VIEWPORT_SIZE * 0.5f + x * c - y * s, VIEWPORT_SIZE * 0.5f + x * s + y * c, 0.0f};
+    vertex.w = 1.0f + layer;
+
+    if constexpr (V::COUNT == 3)
+      vertex.attributes = {corners[i][0] * 0.3f, corners[i][1] * 0.3f, 1.0f};
+    else
+      vertex.attributes = {corners[i][0] * 0.5f + 0.5f, corners[i][1] * 0.5f + 0.5f};
+
+    polygon.push(vertex);
+  }
+
+  return polygon;
+}
+
+int main(int argc, char **argv)
+{
+  int repetitions = argc > 1 ? std::atoi(argv[1]) : 10;
+
+  std::vector<std::vector<float>> z_buffer(VIEWPORT_SIZE + 1, std::vector<float>(VIEWPORT_SIZE + 1, 0.0f));
+  std::vector<std::vector<models::Color>> color_buffer(VIEWPORT_SIZE + 1, std::vector<models::Color>(VIEWPORT_SIZE + 1));
+
+  const Vec2f scissor_min = {0.0f, 0.0f};
+  const Vec2f scissor_max = {static_cast<float>(VIEWPORT_SIZE), static_cast<float>(VIEWPORT_SIZE)};
+
+  models::GlobalLight global_light;
+  std::vector<models::Omni> omni_lights(1);
+  omni_lights[0].position = {VIEWPORT_SIZE * 0.5f, VIEWPORT_SIZE * 0.5f, 400.0f};
+  omni_lights[0].intensity = models::ColorToChannels(models::WHITE);
+
+  models::Material material;
+  material.ambient = {0.5f, 0.0f, 0.0f};
+  material.diffuse = {0.7f, 0.5f, 0.0f};
+  material.specular = {0.9f, 0.5f, 0.0f};
+  material.shininess = 32.0f;
+
+  const Vec3f eye = {VIEWPORT_SIZE * 0.5f, VIEWPORT_SIZE * 0.5f, 800.0f};
+  const Vec3f centroid = {VIEWPORT_SIZE * 0.5f, VIEWPORT_SIZE * 0.5f, 0.0f};
+  const Vec3f normal = {0.0f, 0.0f, 1.0f};
+
+  models::Texture tex = checker_texture(256);
+
+  // Desenha a pilha (camadas na ordem dada) e devolve o menor tempo entre as repetições
+  auto measure = [&](auto &&draw, auto &&depth, const std::vector<int> &order, bool prepass, pipeline::RasterStats &stats)
+  {
+    double best = std::numeric_limits<double>::max();
+    for (int r = 0; r < repetitions; r++)
+    {
+      for (auto &column : z_buffer)
+        std::fill(column.begin(), column.end(), 0.0f);
+
+      stats.reset();
+      auto start = std::chrono::steady_clock::now();
+
+      if (prepass)
+        for (int layer : order)
+          depth(layer, stats);
+      for (int layer : order)
+        draw(layer, stats);
+
+      auto end = std::chrono::steady_clock::now();
+      best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+  };
+
+  auto phong = [&](int layer, pipeline::RasterStats &stats)
+  {
+    pipeline::fill_polygon_phong(layer_quad<pipeline::PhongVertex>(layer), scissor_min, scissor_max, centroid, global_light, omni_lights, eye, material,
+                                 pipeline::ShadingRate::RATE_1X1, z_buffer, color_buffer, stats);
+  };
+  auto phong_depth = [&](int layer, pipeline::RasterStats &stats)
+  { pipeline::rasterize_depth(layer_quad<pipeline::PhongVertex>(layer), scissor_min, scissor_max, z_buffer, stats); };
+
+  auto texture = [&](int layer, pipeline::RasterStats &stats)
+  {
+    pipeline::fill_polygon_texture(layer_quad<pipeline::TextureVertex>(layer), scissor_min, scissor_max, tex, pipeline::MipSelection::PER_POLYGON,
+                                   global_light, omni_lights, eye, centroid, normal, material, z_buffer, color_buffer, stats);
+  };
+  auto texture_depth = [&](int layer, pipeline::RasterStats &stats)
+  { pipeline::rasterize_depth(layer_quad<pipeline::TextureVertex>(layer), scissor_min, scissor_max, z_buffer, stats); };
+
+  std::printf("%-8s %-14s %7s %12s %12s %10s %11s  %s\n", "modo", "ordem", "camadas", "passo único", "pré-passo", "sombreados", "(pré-passo)", "vencedor");
+
+  int prepass_wins = 0, cases = 0;
+
+  for (int mode = 0; mode < 2; mode++)
+  {
+    for (int back_to_front = 1; back_to_front >= 0; back_to_front--)
+    {
+      for (int layers : LAYERS)
+      {
+        std::vector<int> order(layers);
+        for (int i = 0; i < layers; i++)
+          order[i] = back_to_front ? layers - 1 - i : i;
+
+        pipeline::RasterStats single_stats, prepass_stats;
+        double single_ms, prepass_ms;
+
+        if (mode == 0)
+        {
+          single_ms = measure(phong, phong_depth, order, false, single_stats);
+          prepass_ms = measure(phong, phong_depth, order, true, prepass_stats);
+        }
+        else
+        {
+          single_ms = measure(texture, texture_depth, order, false, single_stats);
+          prepass_ms = measure(texture, texture_depth, order, true, prepass_stats);
+        }
+
+        bool wins = prepass_ms < single_ms;
+        prepass_wins += wins;
+        cases++;
+
+        std::printf("%-8s %-14s %7d %9.3f ms %9.3f ms %10d %11d  %s (%.2fx)\n", mode == 0 ? "phong" : "textura",
+                    back_to_front ? "trás->frente" : "frente->trás", layers, single_ms, prepass_ms, single_stats.shaded, prepass_stats.shaded,
+                    wins ? "pré-passo" : "passo único", single_ms / prepass_ms);
+      }
+    }
+  }
+
+  std::printf("\nO pré-passo venceu em %d de %d casos\n", prepass_wins, cases);
+
+  return 0;
+}
@@ -0,0 +1,176 @@
+// Benchmark: layout linha a linha x layout em blocos (Morton) das texturas
+//
+// Desenha quads rotacionados e inclinados (a textura é percorrida em u e em v ao mesmo tempo)
+// com cada textura de assets/*.bmp em cada layout e mede o menor tempo por quad
+//
+// Uso: texture_layout_bench [pasta dos assets] [repetições]
+//
+// Cada textura é medida no tamanho original e ampliada 16x (nearest), pois as texturas
+// originais (64x64) cabem inteiras na cache L1 e escondem o efeito do layout
+
+#include <models/texture.hpp>
+#include <rendering/pipeline.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Lado da área desenhada (pixels)
+constexpr int VIEWPORT_SIZE = 512;
+
+// Ângulos de rotação dos quads (graus)
+const float ANGLES[] = {0.0f, 30.0f, 45.0f, 60.0f, 90.0f};
+
+// Layouts comparados
+const models::TextureLayout LAYOUTS[] = {models::TextureLayout::ROW_MAJOR, models::TextureLayout::TILED_4X4, models::TextureLayout::TILED_8X8};
+const char *LAYOUT_NAMES[] = {"row-major", "tiled 4x4", "tiled 8x8"};
+
+/**
+ * @brief Cria uma textura a partir do BMP, ampliada scale vezes
+ *
+ * @param image Imagem carregada
+ * @param scale Fator de ampliação (vizinho mais próximo)
+ * @return models::Texture Textura com mipmaps (layout linha a linha)
+ */
+static models::Texture make_texture(const BMPImage &image, int scale)
+{
+  models::Texture tex;
+  tex.width = image.width * scale;
+  tex.height = image.height * scale;
+
+  models::TextureLevel base;
+  base.width = tex.width;
+  base.height = tex.height;
+  base.width_log2 = static_cast<int>(std::log2(tex.width));
+  base.u_mask = tex.width - 1;
+  base.v_mask = tex.height - 1;
+
+  tex.texels.resize(static_cast<std::size_t>(tex.width) * tex.height);
+  for (int y = 0; y < tex.height; y++)
+    for (int x = 0; x < tex.width; x++)
+      tex.texels[y * tex.width + x] = image.data[(y / scale) * image.width + x / scale];
+
+  tex.levels.push_back(base);
+  tex.buildMipmaps();
+
+  return tex;
+}
+
+/**
+ * @brief Quad rotacionado em torno do centro da viewport e inclinado (o lado de cima fica mais longe)
+ *
+ * @param angle Rotação no plano da tela (graus)
+ * @return pipeline::ClipPolygon<pipeline::TextureVertex> Quad com UVs de 0 a 1
+ */
+static pipeline::ClipPolygon<pipeline::TextureVertex> rotated_quad(float angle)
+{
+  const float corners[4][2] = {{-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f}};
+  const float uvs[4][2] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+
+  float radians = angle * 3.14159265f / 180.0f;
+  float c = std::cos(radians), s = std::sin(radians);
+  float half = VIEWPORT_SIZE * 0.35f;
+
+  pipeline::ClipPolygon<pipeline::TextureVertex> polygon;
+  for (int i = 0; i < 4; i++)
+  {
+    float x = corners[i][0] * half, y = corners[i][1] * half;
+
+    pipeline::TextureVertex vertex;
+    vertex.position = {VIEWPORT_SIZE * 0.5f + x * c - y * s, VIEWPORT_SIZE * 0.5f + x * s + y * c, 0.0f};
+    vertex.w = corners[i][1] < 0.0f ? 2.0f : 1.0f;
+    vertex.attributes = {uvs[i][0], uvs[i][1]};
+    polygon.push(vertex);
+  }
+
+  return polygon;
+}
+
+int main(int argc, char **argv)
+{
+  std::string assets = argc > 1 ? argv[1] : "../assets";
+  int repetitions = argc > 2 ? std::atoi(argv[2]) : 50;
+
+  std::vector<std::filesystem::path> files;
+  for (const auto &entry : std::filesystem::directory_iterator(assets))
+    if (entry.path().extension() == ".bmp")
+      files.push_back(entry.path());
+  std::sort(files.begin(), files.end());
+
+  if (files.empty())
+  {
+    std::fprintf(stderr, "Nenhum BMP encontrado em %s\n", assets.c_str());
+    return 1;
+  }
+
+  std::vector<std::vector<float>> z_buffer(VIEWPORT_SIZE + 1, std::vector<float>(VIEWPORT_SIZE + 1, 0.0f));
+  std::vector<std::vector<models::Color>> color_buffer(VIEWPORT_SIZE + 1, std::vector<models::Color>(VIEWPORT_SIZE + 1));
+
+  const Vec2f scissor_min = {0.0f, 0.0f};
+  const Vec2f scissor_max = {static_cast<float>(VIEWPORT_SIZE), static_cast<float>(VIEWPORT_SIZE)};
+
+  models::GlobalLight global_light;
+  std::vector<models::Omni> omni_lights;
+  models::Material material = {};
+
+  double totals[2][3] = {};
+
+  std::printf("%-16s %6s %6s %12s %12s %12s\n", "asset", "size", "angle", LAYOUT_NAMES[0], LAYOUT_NAMES[1], LAYOUT_NAMES[2]);
+
+  for (const auto &file : files)
+  {
+    BMPImage image = bmp::load(file.string());
+
+    for (int s = 0; s < 2; s++)
+    {
+      int scale = s == 0 ? 1 : 16;
+      models::Texture tex = make_texture(image, scale);
+
+      for (float angle : ANGLES)
+      {
+        pipeline::ClipPolygon<pipeline::TextureVertex> quad = rotated_quad(angle);
+        double ms[3];
+
+        for (int l = 0; l < 3; l++)
+        {
+          tex.setLayout(LAYOUTS[l]);
+
+          // O menor tempo entre as repetições é o menos afetado por ruído do sistema
+          ms[l] = std::numeric_limits<double>::max();
+          for (int r = 0; r < repetitions; r++)
+          {
+            // O z-buffer é limpo para que todos os pixels sejam sombreados em todas as repetições
+            for (auto &column : z_buffer)
+              std::fill(column.begin(), column.end(), 0.0f);
+
+            // Nível 0 sempre: é nele que o layout faz diferença
+            pipeline::RasterStats raster_stats;
+            auto start = std::chrono::steady_clock::now();
+            pipeline::fill_polygon_texture(quad, scissor_min, scissor_max, tex, pipeline::MipSelection::NONE, global_light, omni_lights,
+                                           Vec3f(0.0f, 0.0f, 0.0f), Vec3f(0.0f, 0.0f, 0.0f), Vec3f(0.0f, 0.0f, 1.0f), material, z_buffer, color_buffer, raster_stats);
+            auto end = std::chrono::steady_clock::now();
+
+            ms[l] = std::min(ms[l], std::chrono::duration<double, std::milli>(end - start).count());
+          }
+          totals[s][l] += ms[l];
+        }
+
+        std::printf("%-16s %6d %6.0f %9.3f ms %9.3f ms %9.3f ms\n", file.filename().string().c_str(), tex.width, angle, ms[0], ms[1], ms[2]);
+      }
+    }
+  }
+
+  for (int s = 0; s < 2; s++)
+  {
+    std::printf("\nTotal (%s):\n", s == 0 ? "tamanho original" : "ampliadas 16x");
+    for (int l = 0; l < 3; l++)
+      std::printf("  %-10s %9.3f ms (%.2fx)\n", LAYOUT_NAMES[l], totals[s][l], totals[s][0] / totals[s][l]);
+  }
+
+  return 0;
+}
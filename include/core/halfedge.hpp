@@ -29,6 +29,10 @@ public:
   // Identificador univoco
   std::string id;
 
+  // Índice da meia aresta no vetor da malha
+  // Também identifica o canto (vértice de origem dentro da face), usado para acessar os atributos por canto
+  int index;
+
   // Constructors and destructors
   HalfEdge();
   ~HalfEdge();
@@ -82,12 +86,18 @@ public:
   // Posição do vértice convertido para o sistema de coordenadas de tela
   Vec3f vertex_screen;
 
+  // Fator homogêneo (w) da projeção do vértice, usado no recorte do plano near
+  float screen_w;
+
   // flag que indica se o vértice já foi recortado
   bool clipped;
 
   // Meia aresta que incide sob o vértice
   HalfEdge *incident_edge;
 
+  // Índice do vértice no vetor da malha (também indexa as posições do fluxo comprimido)
+  int index;
+
   // Identificador univoco
   std::string id;
 
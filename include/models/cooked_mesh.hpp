@@ -0,0 +1,148 @@
+#pragma once
+
+#include <core/types.hpp>
+#include <models/colision.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace models
+{
+  // Malha cozida (.mesh): gerada offline pelo mesh_cook e usada em tempo de execução direto do arquivo mapeado
+  // Sem ponteiros: as ligações da half-edge são índices, e cada vetor começa em um offset alinhado em 64 bytes
+  constexpr std::uint32_t COOKED_MESH_VERSION = 1;
+
+  enum CookedMeshFlags : std::uint32_t
+  {
+    COOKED_CORNER_UVS = 1u << 0,    // Possui UV por canto
+    COOKED_CORNER_NORMALS = 1u << 1 // Possui normal por canto
+  };
+
+  struct CookedMeshHeader
+  {
+    char magic[4]; // "MESH"
+    std::uint32_t version;
+    std::uint32_t flags;
+    std::uint32_t vertex_count;
+    std::uint32_t face_count;
+    std::uint32_t halfedge_count; // Cantos das faces seguidos das meias arestas de borda
+    std::uint32_t corner_count;   // Meias arestas que pertencem a faces (índices 0..corner_count-1)
+    std::uint32_t reserved;
+    float bounds_min[3];
+    float bounds_max[3];
+    std::uint64_t positions;        // Vec3f por vértice
+    std::uint64_t vertex_normals;   // Vec3f por vértice (média das normais das faces)
+    std::uint64_t vertex_halfedges; // int32 por vértice (meia aresta que parte do vértice)
+    std::uint64_t halfedges;        // CookedHalfEdge por meia aresta
+    std::uint64_t faces;            // CookedFace por face
+    std::uint64_t corner_uvs;       // Vec2f por canto (0 = ausente)
+    std::uint64_t corner_normals;   // Vec3f por canto (0 = ausente)
+  };
+
+  // Ligações de uma meia aresta (face = -1 nas meias arestas de borda)
+  struct CookedHalfEdge
+  {
+    std::int32_t next;
+    std::int32_t prev;
+    std::int32_t twin;
+    std::int32_t origin;
+    std::int32_t face;
+  };
+
+  // Os cantos de uma face são as meias arestas halfedge .. halfedge + corner_count - 1
+  struct CookedFace
+  {
+    std::int32_t halfedge;
+    std::int32_t corner_count;
+    Vec3f normal;
+    Vec3f centroid;
+  };
+
+  static_assert(sizeof(CookedMeshHeader) == 112, "O cabeçalho da malha cozida deve ter 112 bytes");
+  static_assert(sizeof(CookedHalfEdge) == 20 && sizeof(CookedFace) == 32 && sizeof(Vec3f) == 12 && sizeof(Vec2f) == 8,
+                "Os registros da malha cozida não podem ter preenchimento");
+
+  // Malha de entrada do cozimento (ex.: lida de um OBJ), com os cantos de todas as faces em um único vetor
+  struct MeshSource
+  {
+    std::vector<Vec3f> positions;
+    std::vector<int> corners;     // Índices em positions, face após face, no sentido anti-horário
+    std::vector<int> face_starts; // Face f usa corners[face_starts[f] .. face_starts[f + 1]) (começa com 0)
+    std::vector<Vec2f> uvs;       // Opcional: uma UV por canto
+    std::vector<Vec3f> normals;   // Opcional: uma normal por canto
+
+    int faceCount() const { return face_starts.empty() ? 0 : static_cast<int>(face_starts.size()) - 1; }
+  };
+
+  struct CookOptions
+  {
+    bool weld = true;          // Une vértices com a mesma posição (desligado mantém os índices da entrada)
+    float weld_epsilon = 0.0f; // Distância para unir vértices (0 = apenas posições idênticas)
+    bool cache_order = true;   // Reordena as faces para o cache de vértices (Forsyth) depois da ordem de Morton
+  };
+
+  // Resumo do cozimento (mostrado pelo mesh_cook)
+  struct CookStats
+  {
+    int source_vertices = 0;
+    int welded_vertices = 0;
+    int faces = 0;
+    int dropped_faces = 0; // Faces degeneradas depois da união dos vértices
+    int boundary_edges = 0;
+    float acmr_morton = 0.0f; // ACMR na ordem de Morton
+    float acmr = 0.0f;        // ACMR da ordem gravada
+  };
+
+  // Gera a malha cozida em memória (retorna false se uma aresta dirigida se repete ou se uma borda não fecha)
+  // Vértices tocados por mais de uma borda (ex.: dois triângulos ligados só por um vértice) são aceitos
+  bool cookMesh(const MeshSource &source, std::vector<std::uint8_t> &blob, const CookOptions &options = {}, CookStats *stats = nullptr);
+
+  // Gera o arquivo .mesh
+  bool cookMesh(const MeshSource &source, const std::string &filename, const CookOptions &options = {}, CookStats *stats = nullptr);
+
+  /**
+   * @brief Malha cozida aberta para leitura
+   *
+   * @note Os vetores são usados direto do arquivo lido pelo io::AssetIO (ou da entrada do pacote mapeado, sem
+   *       cópia): abrir a malha custa a leitura e a validação dos offsets do cabeçalho
+   * @note O arquivo guarda índices, não ponteiros. A Mesh da cena (Mesh::Mesh(const CookedMesh &)) ainda é uma
+   *       passada por todos os elementos que cria os ponteiros da half-edge e o vetor de vértices de cada face
+   * @note Os índices não são validados na abertura, quem percorre a malha confere cada índice (com um índice
+   *       inválido loadMesh devolve nullptr)
+   */
+  class CookedMesh
+  {
+  public:
+    // Lê o arquivo pelo io::AssetIO (ou a entrada de um pacote montado) e espera a leitura
+    bool open(const std::string &filename);
+
+    // Usa um arquivo já lido (ex.: resultado do io::AssetIO)
+    bool open(std::vector<std::uint8_t> &&bytes, const std::string &name);
+
+    int vertexCount() const { return static_cast<int>(header->vertex_count); }
+    int faceCount() const { return static_cast<int>(header->face_count); }
+    int halfEdgeCount() const { return static_cast<int>(header->halfedge_count); }
+    int cornerCount() const { return static_cast<int>(header->corner_count); }
+
+    const Vec3f *positions() const { return at<Vec3f>(header->positions); }
+    const Vec3f *vertexNormals() const { return at<Vec3f>(header->vertex_normals); }
+    const std::int32_t *vertexHalfEdges() const { return at<std::int32_t>(header->vertex_halfedges); }
+    const CookedHalfEdge *halfEdges() const { return at<CookedHalfEdge>(header->halfedges); }
+    const CookedFace *faces() const { return at<CookedFace>(header->faces); }
+    const Vec2f *cornerUVs() const { return header->corner_uvs ? at<Vec2f>(header->corner_uvs) : nullptr; }
+    const Vec3f *cornerNormals() const { return header->corner_normals ? at<Vec3f>(header->corner_normals) : nullptr; }
+    AABB bounds() const;
+
+  private:
+    std::vector<std::uint8_t> owned;
+    const std::uint8_t *data = nullptr;
+    const CookedMeshHeader *header = nullptr;
+
+    bool validate(const std::uint8_t *bytes, std::size_t size, const std::string &name);
+
+    template <typename T>
+    const T *at(std::uint64_t offset) const { return reinterpret_cast<const T *>(data + offset); }
+  };
+}
@@ -4,13 +4,30 @@
 #include <models/colision.hpp>
 #include <models/common.hpp>
 
-#include <models/texture.hpp>
+#include <models/texture_manager.hpp>
+#include <models/vertex_cache.hpp>
+#include <models/vertex_compression.hpp>
 
 #include <vector>
 #include <iostream>
 #include <string>
 #include <map>
 
+namespace models
+{
+  class CookedMesh;
+}
+
+// Resultado da reordenação para o cache de vértices
+// ACMR: vértices transformados por triângulo com um cache FIFO de cache_size entradas (mínimo ~0.5, pior 3)
+struct MeshLayoutStats
+{
+  float acmr_before = 0.0f;
+  float acmr_after = 0.0f;
+  int cache_size = 0;
+  int triangles = 0;
+};
+
 class Mesh
 {
 public:
@@ -35,18 +52,39 @@ public:
   // Material do objeto
   models::Material material;
 
-  // Textura associada a malha
-  models::Texture texture;
+  // Textura associada a malha (compartilhada com as outras malhas que usam o mesmo arquivo)
+  models::TextureHandle texture;
+
+  // Atributos por canto (meia aresta)
+  // Os vértices continuam compartilhados entre as faces, mas os atributos que mudam de uma face
+  // para outra (UV, normal, cor) ficam em vetores contínuos indexados por HalfEdge::index.
+  // Um vetor vazio indica que a malha não possui aquele atributo por canto (ou que ele está só no fluxo comprimido).
+  std::vector<Vec2f> corner_uvs;
+  std::vector<Vec3f> corner_normals;
+  std::vector<models::Color> corner_colors;
 
   // Bounding box do modelo
   AABB bounds;
 
+  // Armazenamento contínuo dos elementos de malhas carregadas de arquivos cozidos ou reordenadas
+  // (os vetores de ponteiros acima apontam para estes elementos, vazios nas malhas criadas com createMesh)
+  std::vector<Vertex> vertex_storage;
+  std::vector<Face> face_storage;
+  std::vector<HalfEdge> halfedge_storage;
+
+  // Resultado da última reordenação (optimizeLayout)
+  MeshLayoutStats layout;
+
+  // Fluxo de vértices comprimido (vazio até compressVertices, desfeito por decompressVertices quando a malha muda)
+  models::CompressedVertices compressed;
+
   // Id
   std::string id;
 
   // Construtor e Destrutor
   Mesh();
   Mesh(std::vector<Vertex *> vertexes, std::vector<std::vector<int>> faces, std::string id);
+  Mesh(const models::CookedMesh &cooked, std::string id);
   ~Mesh();
 
   // Obtém o centroid do objeto
@@ -70,4 +108,26 @@ public:
 
   // Determina o vetor unitário médio da face
   void determineVertexNormals();
-};
\ No newline at end of file
+
+  // Reordena faces (Forsyth) e vértices (primeiro uso) para o cache de vértices (malhas de createMesh)
+  MeshLayoutStats optimizeLayout(int cache_size = models::VERTEX_CACHE_SIZE);
+
+  // Quantiza posições, normais e UVs no fluxo comprimido (as normais e UVs por canto em float são liberadas)
+  void compressVertices(models::NormalPrecision precision);
+  // Devolve as normais e UVs por canto para os vetores em float e descarta o fluxo comprimido
+  void decompressVertices();
+
+  // Atributos por canto
+  // Cada vetor interno corresponde a uma face (na mesma ordem usada na criação da malha)
+  // e contém um valor para cada vértice da face
+  void setCornerUVs(const std::vector<std::vector<Vec2f>> &face_uvs);
+  void setCornerNormals(const std::vector<std::vector<Vec3f>> &face_normals);
+  void setCornerColors(const std::vector<std::vector<models::Color>> &face_colors);
+
+  // Associa uma textura (ou célula de atlas) à malha, remapeando as UVs por canto para a região
+  void setTexture(const models::TextureRegion &region);
+};
+
+// Carrega uma malha cozida (.mesh, gerada pelo mesh_cook) ou um OBJ
+// Retorna nullptr se o arquivo for inválido, inclusive com índices fora dos vetores
+Mesh *loadMesh(const std::string &filename);
\ No newline at end of file
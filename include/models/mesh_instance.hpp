@@ -0,0 +1,61 @@
+#pragma once
+
+#include <core/types.hpp>
+#include <math/math.hpp>
+#include <models/colision.hpp>
+#include <models/common.hpp>
+#include <models/mesh.hpp>
+
+#include <string>
+
+// A malha (vértices, faces, meias arestas, textura) é o recurso compartilhado.
+// Várias instâncias podem apontar para o mesmo MeshAsset, assim a memória cresce
+// com o número de malhas únicas e não com o número de objetos na cena.
+typedef Mesh MeshAsset;
+
+class MeshInstance
+{
+public:
+  // Malha compartilhada (a instância não é dona dela)
+  MeshAsset *asset;
+
+  // Matriz de modelo (SRO -> SRU)
+  // Segue a mesma convenção das matrizes do pipeline (Matrix::fromList)
+  Matrix model;
+
+  // Inversa da matriz de modelo (SRU -> SRO)
+  // Usada para levar o observador ao SRO (ocultação de faces) e para transformar normais
+  Matrix inverse_model;
+
+  // Material que sobrescreve o material da malha (se has_material_override for verdadeiro)
+  models::Material material;
+  bool has_material_override;
+
+  // Bounding box da instância no SRU (cacheada, atualizada junto com a matriz de modelo)
+  AABB world_bounds;
+
+  // Flag para indicar se a instância está entre o plano near e far
+  bool is_visible;
+
+  // Id
+  std::string id;
+
+  // Construtor e Destrutor
+  MeshInstance(MeshAsset *asset, const Matrix &model = Matrix(), std::string id = "");
+  ~MeshInstance();
+
+  // Atualiza a matriz de modelo e a bounding box no SRU
+  void setModel(const Matrix &model);
+
+  // Sobrescreve o material da malha apenas para esta instância
+  void setMaterial(const models::Material &material);
+
+  // Material efetivo da instância
+  const models::Material &getMaterial() const;
+
+  // Centroide da instância no SRU (centro da bounding box)
+  Vec3f getCentroid() const;
+
+  // Transforma a bounding box da malha para o SRU
+  void computeWorldBounds();
+};
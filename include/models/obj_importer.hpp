@@ -0,0 +1,34 @@
+#pragma once
+
+#include <models/cooked_mesh.hpp>
+
+#include <cstddef>
+#include <string>
+
+namespace models
+{
+  // Resumo da importação (mostrado pelo mesh_cook)
+  struct ObjStats
+  {
+    std::size_t bytes = 0;
+    int chunks = 0;
+    int positions = 0;
+    int uvs = 0;
+    int normals = 0;
+    int faces = 0;
+    int corners = 0;
+  };
+
+  /**
+   * @brief Importa um arquivo Wavefront OBJ
+   *
+   * @note O arquivo é mapeado em memória (ou lido do pacote montado) e dividido em blocos terminados em fim de
+   *       linha, interpretados em paralelo sem cópias para std::string e sem iostreams
+   * @note Suporta v, vt, vn e f (v, v/vt, v//vn, v/vt/vn, índices negativos). Os demais comandos são ignorados
+   * @note As UVs e normais por canto só são preenchidas se todos os cantos tiverem o atributo
+   */
+  bool importObj(const std::string &filename, MeshSource &source, ObjStats *stats = nullptr);
+
+  // Importa um OBJ já em memória (ex.: resultado do io::AssetIO)
+  bool importObj(const char *data, std::size_t size, const std::string &name, MeshSource &source, ObjStats *stats = nullptr);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <models/color.hpp>
+
+#include <vector>
+
+namespace models
+{
+  struct Texture;
+
+  // Número de cores da paleta (índices de 8 bits)
+  constexpr int PALETTE_SIZE = 256;
+
+  // Índice reservado para pixels vazios (não é uma cor da paleta)
+  constexpr Uint8 PALETTE_EMPTY = 255;
+
+  // Níveis de luz do colormap: o nível COLORMAP_LEVELS / 2 é a cor original, acima dele a cor é clareada (até 2x)
+  constexpr int COLORMAP_LEVELS = 64;
+
+  // Paleta de 256 cores (até 255 cores em colors[0 .. count), a última posição é PALETTE_EMPTY)
+  struct Palette
+  {
+    Color colors[PALETTE_SIZE];
+
+    // Número de cores válidas (as posições entre count e PALETTE_EMPTY não são usadas)
+    int count = 0;
+
+    // Índice da cor mais próxima (distância euclidiana em RGB, só entre as cores válidas)
+    Uint8 nearest(const Color &color) const;
+  };
+
+  // Tabela de iluminação [nível de luz][índice da cor] -> índice da cor iluminada
+  struct Colormap
+  {
+    Uint8 table[COLORMAP_LEVELS][PALETTE_SIZE];
+
+    // Nível do colormap para uma intensidade de luz (1.0 = cor original)
+    static int level(float intensity);
+  };
+
+  // Gera uma paleta por median cut a partir do nível 0 das texturas
+  Palette buildPalette(const std::vector<const Texture *> &textures);
+
+  // Pré-calcula o colormap de uma paleta
+  Colormap buildColormap(const Palette &palette);
+}
@@ -2,28 +2,157 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <cstddef>
 
 #include <algorithm>
 #include <models/color.hpp>
+#include <models/palette.hpp>
+#include <models/texture_compression.hpp>
 #include <utils/bmp_reader.hpp> // usa seu módulo BMPReader
 #include <stdexcept>
+#include <limits>
 
 namespace models
 {
+  // Número de bits fracionários das coordenadas de textura em ponto fixo (16.16)
+  constexpr int TEXTURE_FRACTION_BITS = 16;
+
+  // Ordem dos texels de cada nível na memória
+  enum class TextureLayout
+  {
+    ROW_MAJOR, // Linha a linha
+    TILED_4X4, // Blocos 4x4 em ordem de Morton (blocos linha a linha)
+    TILED_8X8  // Blocos 8x8 em ordem de Morton (blocos linha a linha)
+  };
+
+  // Um nível da pirâmide de mipmaps
+  // As dimensões são sempre potências de dois, então o endereçamento com repetição é feito com máscaras
+  struct TextureLevel
+  {
+    int width = 0;
+    int height = 0;
+    int width_log2 = 0;
+    int u_mask = 0;         // width - 1
+    int v_mask = 0;         // height - 1
+    std::size_t offset = 0; // Posição do primeiro texel do nível em Texture::texels
+
+    // Layout em blocos: log2 do lado do bloco e posição das tabelas do nível em Texture::swizzle
+    int tile_log2 = 0;
+    std::size_t swizzle_offset = 0;
+
+    // Textura comprimida: posição do primeiro bloco do nível em Texture::blocks e blocos por linha
+    std::size_t block_offset = 0;
+    int blocks_per_row = 0;
+  };
+
   struct Texture
   {
+    // Dimensões do nível 0 (potências de dois)
     int width = 0;
     int height = 0;
-    std::vector<std::vector<models::Color>> pixels; // pixels[y][x]
 
-    Color sample(float u, float v) const
+    // Todos os texels de todos os níveis em um único vetor contíguo
+    // ROW_MAJOR: texels[offset + y * width + x], nos layouts em blocos: texels[offset + swizzle[x] + swizzle[width + y]]
+    std::vector<Color> texels;
+
+    // Índices na paleta de cada texel (mesmas posições de texels), vazio até a textura ser quantizada
+    std::vector<Uint8> indices;
+
+    // Blocos BC1 de todos os níveis (texels fica vazio enquanto a textura está comprimida)
+    std::vector<BC1Block> blocks;
+    TextureCompression compression = TextureCompression::NONE;
+
+    // Ordem dos texels em cada nível
+    TextureLayout layout = TextureLayout::ROW_MAJOR;
+
+    // Tabelas do layout em blocos, por nível: deslocamento de cada coluna (width entradas) e de cada linha (height entradas)
+    // O endereço de Morton separa os bits de x e de y, então o endereço é a soma das duas entradas
+    std::vector<int> swizzle;
+
+    // Pirâmide de mipmaps: levels[0] é a resolução original e cada nível tem metade do tamanho do anterior (até 1x1)
+    std::vector<TextureLevel> levels;
+
+    // Primeiro texel de um nível
+    const Color *data(const TextureLevel &level) const { return texels.data() + level.offset; }
+
+    /**
+     * @brief Busca um texel com coordenadas em ponto fixo
+     *
+     * @param u Coordenada U em texels do nível 0, em ponto fixo 16.16
+     * @param v Coordenada V em texels do nível 0, em ponto fixo 16.16
+     *
+     * @note O deslocamento converte para texels do nível (cada nível tem metade da resolução) e a máscara
+     *       faz a repetição (valores negativos também funcionam, pois o deslocamento é aritmético)
+     */
+    Color fetch(int u, int v, int level) const
+    {
+      const TextureLevel &l = levels[level];
+      int shift = TEXTURE_FRACTION_BITS + level;
+      if (compression != TextureCompression::NONE)
+        return fetchCompressed(l, (u >> shift) & l.u_mask, (v >> shift) & l.v_mask);
+      return texels[l.offset + address(l, (u >> shift) & l.u_mask, (v >> shift) & l.v_mask)];
+    }
+
+    // Posição do texel (x, y) dentro do nível, de acordo com o layout
+    int address(const TextureLevel &level, int x, int y) const
+    {
+      if (layout == TextureLayout::ROW_MAJOR)
+        return (y << level.width_log2) | x;
+
+      const int *table = swizzle.data() + level.swizzle_offset;
+      return table[x] + table[level.width + y];
+    }
+
+    // Reordena os texels de todos os níveis para o layout pedido
+    void setLayout(TextureLayout new_layout);
+
+    Color sample(float u, float v, int level = 0) const
+    {
+      const float scale = static_cast<float>(1 << TEXTURE_FRACTION_BITS);
+      return fetch(static_cast<int>(u * width * scale), static_cast<int>(v * height * scale), std::clamp(level, 0, levelCount() - 1));
+    }
+
+    int levelCount() const { return static_cast<int>(levels.size()); }
+
+    // Escolhe o nível a partir de quantos texels (do nível 0) cabem em um pixel
+    int selectLevel(float texels_per_pixel) const;
+
+    // Menor razão texels/pixel pedida ao selectLevel desde a última leitura (usada pelo streaming)
+    // 0 = o nível 0 foi amostrado sem seleção de mipmap, infinito = a textura não foi desenhada
+    mutable float sampled_texels_per_pixel = std::numeric_limits<float>::infinity();
+
+    // Descarta os count níveis mais finos (o nível count passa a ser o nível 0)
+    void dropFinestLevels(int count);
+
+    // Gera os níveis 1..n a partir do nível 0
+    void buildMipmaps(bool gamma_correct = true);
+
+    // Refaz os níveis 1..n só sobre uma área do nível 0 (os níveis já precisam existir)
+    void updateMipmaps(int x, int y, int area_width, int area_height, bool gamma_correct = true);
+
+    // Converte todos os níveis para índices da paleta (caminho de 8 bits)
+    void quantize(const Palette &palette);
+
+    // Comprime todos os níveis em blocos BC1 e libera os texels (NONE descomprime)
+    void compress(TextureCompression quality);
+
+    // Volta para texels RGBA
+    void decompress();
+
+    // Texel (x, y) de um nível comprimido (descomprime o bloco inteiro, o filler usa DecodedBlockCache)
+    Color fetchCompressed(const TextureLevel &level, int x, int y) const;
+
+    // Memória ocupada pelos texels, índices, blocos e tabelas do layout
+    std::size_t memoryBytes() const
     {
-      int x = std::clamp(int(u * (width - 1)), 0, width - 1);
-      int y = std::clamp(int(v * (height - 1)), 0, height - 1);
-      return pixels[y][x];
+      return texels.size() * sizeof(Color) + indices.size() + blocks.size() * sizeof(BC1Block) + swizzle.size() * sizeof(int);
     }
   };
 
-  // Carrega uma textura BMP via bmp_reader e preenche o Texture
+  // Carrega uma textura BMP via bmp_reader e preenche o Texture (com os mipmaps)
+  // Arquivos .bc1 (gerados pelo bc1_compress) são carregados já comprimidos
   bool loadTexture(const std::string &filename, Texture &tex);
+
+  // Decodifica um arquivo já lido para a memória (a extensão de name escolhe o formato)
+  bool loadTexture(const std::string &name, const std::uint8_t *data, std::size_t size, Texture &tex);
 }
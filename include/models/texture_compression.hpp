@@ -0,0 +1,101 @@
+#pragma once
+
+#include <models/color.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace models
+{
+  struct Texture;
+
+  // Formato das texturas na memória (escolhido em tempo de execução)
+  enum class TextureCompression
+  {
+    NONE,     // RGBA, 4 bytes por texel (leitura direta)
+    BC1_FAST, // Blocos BC1 com os extremos da caixa de cores (compressão rápida)
+    BC1_HIGH  // Blocos BC1 com o eixo principal das cores e ajuste por mínimos quadrados (melhor qualidade)
+  };
+
+  // Bloco BC1 (DXT1): 4x4 texels em 8 bytes (1/8 do RGBA)
+  // Duas cores RGB565 e 2 bits por texel escolhendo uma das 4 cores interpoladas
+  // color0 > color1: 4 cores opacas, color0 <= color1: 3 cores e o índice 3 é transparente
+  struct BC1Block
+  {
+    std::uint16_t color0;
+    std::uint16_t color1;
+    std::uint32_t selectors; // Texel (x, y) nos bits 2 * (y * 4 + x)
+  };
+
+  static_assert(sizeof(BC1Block) == 8, "O bloco BC1 deve ter 8 bytes");
+
+  // Comprime 4x4 texels (linha a linha)
+  BC1Block encodeBC1Block(const Color texels[16], TextureCompression quality);
+
+  // Descomprime um bloco em 4x4 texels (linha a linha)
+  void decodeBC1Block(const BC1Block &block, Color texels[16]);
+
+  /**
+   * @brief Cache de blocos descomprimidos
+   *
+   * @note Mapeamento direto: a posição é escolhida pelos bits baixos da coluna e da linha do bloco, então
+   *       uma scanline que cruza até 16 blocos encontra os mesmos blocos nas 3 scanlines seguintes
+   * @note Cada thread de rasterização deve ter o seu cache (não há sincronização)
+   */
+  struct DecodedBlockCache
+  {
+    static constexpr int ENTRIES = 64;
+
+    const BC1Block *tags[ENTRIES] = {};
+    Color texels[ENTRIES][16];
+
+    // Esquece os blocos guardados (obrigatório quando os blocos de uma textura podem ter sido realocados)
+    void clear()
+    {
+      for (auto &tag : tags)
+        tag = nullptr;
+    }
+
+    // Texel (x, y) de um nível com blocks_per_row blocos por linha
+    const Color &fetch(const BC1Block *blocks, int blocks_per_row, int x, int y)
+    {
+      int block_x = x >> 2, block_y = y >> 2;
+      const BC1Block *block = blocks + block_y * blocks_per_row + block_x;
+      int slot = (block_x & 15) | ((block_y & 3) << 4);
+
+      if (tags[slot] != block)
+      {
+        decodeBC1Block(*block, texels[slot]);
+        tags[slot] = block;
+      }
+
+      return texels[slot][((y & 3) << 2) | (x & 3)];
+    }
+  };
+
+  // Arquivo de textura comprimida (.bc1), gerado offline a partir de um BMP
+  // Cabeçalho seguido dos blocos de todos os níveis, na ordem de Texture::blocks
+  bool saveCompressedTexture(const std::string &filename, const Texture &texture);
+  bool loadCompressedTexture(const std::string &filename, Texture &texture);
+  bool loadCompressedTexture(const std::string &name, const std::uint8_t *data, std::size_t size, Texture &texture);
+
+  // Posição de cada nível de um arquivo .bc1 (calculada a partir do cabeçalho)
+  struct CompressedFileLayout
+  {
+    int width = 0, height = 0;
+    TextureCompression quality = TextureCompression::NONE;
+    std::vector<std::size_t> level_offsets; // Byte do primeiro bloco de cada nível, seguido do tamanho do arquivo
+
+    int levelCount() const { return static_cast<int>(level_offsets.size()) - 1; }
+  };
+
+  // Bytes do cabeçalho do .bc1 (basta ler esse trecho para obter o layout)
+  std::size_t compressedHeaderSize();
+  bool readCompressedLayout(const std::string &name, const std::uint8_t *data, std::size_t size, CompressedFileLayout &layout);
+
+  // Carrega os níveis [first_level, fim) a partir do trecho do arquivo que começa em layout.level_offsets[first_level]
+  bool loadCompressedLevels(const std::string &name, const CompressedFileLayout &layout, int first_level, const std::uint8_t *data, std::size_t size,
+                            Texture &texture);
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <models/texture.hpp>
+#include <models/texture_streamer.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace models
+{
+  // Handle com contagem de referências: a textura é liberada quando o último handle deixa de existir
+  typedef std::shared_ptr<Texture> TextureHandle;
+
+  // Textura entregue pelo gerenciador: a textura inteira ou uma célula de um atlas
+  struct TextureRegion
+  {
+    TextureHandle texture;
+
+    // UV na textura = UV original * scale + offset
+    float u_offset = 0.0f;
+    float v_offset = 0.0f;
+    float u_scale = 1.0f;
+    float v_scale = 1.0f;
+
+    // Verdadeiro se a região é uma célula de um atlas (a UV original é limitada a 0..1, sem repetição)
+    bool atlas = false;
+
+    // Converte uma UV da malha para a UV da região
+    void remap(float &u, float &v) const
+    {
+      if (atlas)
+      {
+        u = std::clamp(u, 0.0f, 1.0f);
+        v = std::clamp(v, 0.0f, 1.0f);
+      }
+
+      u = u * u_scale + u_offset;
+      v = v * v_scale + v_offset;
+    }
+  };
+
+  /**
+   * @brief Gerenciador de texturas
+   *
+   * @note Cada arquivo é decodificado uma única vez: pedidos pelo mesmo caminho (ou por um arquivo com o mesmo
+   *       conteúdo) recebem a mesma textura, então a memória não cresce com o número de malhas
+   * @note O hash do conteúdo só escolhe o candidato: os texels (ou blocos) são comparados antes de compartilhar
+   * @note O gerenciador guarda apenas referências fracas, as texturas pertencem às malhas que as usam
+   * @note Com use_atlas, texturas pequenas são copiadas para um atlas compartilhado (uma célula por textura)
+   */
+  class TextureManager
+  {
+  public:
+    // Empacotamento em atlas (deve ser configurado antes dos carregamentos)
+    bool use_atlas = false;
+    int atlas_size = 1024;    // Lado do atlas (potência de dois)
+    int atlas_cell_size = 64; // Lado de cada célula: texturas com os dois lados menores ou iguais vão para o atlas
+
+    // Carregamento em segundo plano (deve ser configurado antes dos carregamentos, desligado por padrão)
+    // As texturas são entregues na hora e os níveis chegam depois, veja TextureStreamer
+    // Sem o conteúdo na hora do carregamento, essas texturas só são compartilhadas pelo caminho e não vão para o atlas
+    bool streaming = false;
+    TextureStreamer streamer;
+
+    // Carrega (ou reaproveita) a textura de um arquivo BMP
+    // Em caso de erro a região volta sem textura
+    TextureRegion load(const std::string &filename);
+
+    // Atualiza as texturas carregadas em segundo plano (uma vez por quadro, antes da rasterização)
+    void update();
+
+    // Número de texturas distintas vivas (cada atlas conta como uma)
+    int liveTextures() const;
+
+    // Número de texels vivos (todos os níveis)
+    std::size_t liveTexels() const;
+
+    // Memória das texturas vivas em bytes (texels, índices da paleta e blocos comprimidos)
+    std::size_t liveBytes() const;
+
+    // Número de arquivos decodificados e de pedidos atendidos sem decodificar
+    int decoded = 0;
+    int reused = 0;
+
+  private:
+    struct Entry
+    {
+      std::weak_ptr<Texture> texture;
+      TextureRegion region; // Região sem o handle (apenas a transformação da UV)
+
+      // Origem do conteúdo, usada para confirmar um hash igual: arquivo, formato no carregamento
+      // e posição/tamanho no nível 0 da textura (a célula, no caso de um atlas)
+      std::string source;
+      TextureCompression compression = TextureCompression::NONE;
+      int x = 0, y = 0, width = 0, height = 0;
+    };
+
+    struct Atlas
+    {
+      std::weak_ptr<Texture> texture;
+      int used_cells = 0;
+    };
+
+    std::unordered_map<std::string, Entry> by_path;
+    std::unordered_map<std::uint64_t, Entry> by_hash;
+    std::vector<Atlas> atlases;
+
+    TextureRegion acquire(const Entry &entry, TextureHandle texture);
+    bool sameContent(const Texture &texture, const Texture &shared, const Entry &entry) const;
+    TextureRegion addToAtlas(const Texture &texture);
+  };
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <models/texture.hpp>
+#include <utils/asset_io.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace models
+{
+  /**
+   * @brief Carregamento de texturas em segundo plano com orçamento de memória
+   *
+   * @note Uma textura registrada começa como um texel cinza, depois recebe os níveis grossos (até initial_size)
+   *       e os níveis mais finos só são carregados quando a tela pede essa resolução
+   * @note Os arquivos são lidos pelo io::AssetIO (níveis grossos com prioridade alta, refinamentos com prioridade
+   *       normal) e decodificados nas threads de jobs. A troca do conteúdo da textura é feita na thread principal
+   *       (update), entre quadros, então o rasterizador nunca vê uma textura pela metade
+   * @note Nos arquivos .bc1 (níveis pré-cozidos pelo bc1_compress) o cabeçalho é lido primeiro e cada pedido lê
+   *       só o trecho do nível pedido até o fim do arquivo (o nível e os mais grossos). Um BMP guarda apenas o
+   *       nível 0, então ele é lido e decodificado inteiro a cada pedido
+   * @note Enquanto o nível pedido não chega, o filler amostra o nível mais fino residente (o mais grosso disponível)
+   * @note Acima do orçamento, os níveis mais finos das texturas usadas há mais tempo são descartados (LRU)
+   */
+  class TextureStreamer
+  {
+  public:
+    TextureStreamer() = default;
+    ~TextureStreamer();
+
+    TextureStreamer(const TextureStreamer &) = delete;
+    TextureStreamer &operator=(const TextureStreamer &) = delete;
+
+    std::size_t budget = 64u << 20; // Memória máxima das texturas residentes (bytes)
+    int initial_size = 16;          // Lado máximo do primeiro carregamento de cada textura
+    int release_delay = 120;        // Quadros em que um nível fica sem uso antes de ser descartado
+
+    // Registra um arquivo e devolve a textura na hora (os níveis chegam depois)
+    std::shared_ptr<Texture> add(const std::string &filename);
+
+    // Aplica os carregamentos concluídos, pede os níveis que faltam e libera os que sobram (uma vez por quadro)
+    void update();
+
+    // Memória das texturas residentes, carregamentos na fila ou em andamento e texturas registradas vivas
+    std::size_t residentBytes() const;
+    int pending();
+    int liveTextures() const;
+
+    // Número de carregamentos aplicados e de níveis descartados
+    int loaded = 0;
+    int released = 0;
+
+    // Número de texturas que receberam o primeiro carregamento (só ele traz cores novas para a paleta)
+    int arrived = 0;
+
+  private:
+    struct Stream
+    {
+      std::weak_ptr<Texture> texture;
+      std::string filename;
+      bool resident = false;  // Verdadeiro depois do primeiro carregamento (antes disso a textura é o texel cinza)
+      int first_level = 0;    // Nível da pirâmide completa que está em levels[0]
+      int level_count = 0;    // Número de níveis da pirâmide completa
+      int requested = -1;     // Nível pedido (-1 = nenhum)
+      io::RequestId read = 0; // Leitura em andamento (0 = nenhuma), cancelada se a textura morrer antes
+      int last_used = 0;      // Último quadro em que a textura foi desenhada
+      int excess_since = -1;  // Primeiro quadro em que o nível 0 deixou de ser necessário
+
+      bool compressed = false;     // Arquivo .bc1 (leitura por níveis)
+      CompressedFileLayout layout; // Posição dos níveis no .bc1 (vazio até o cabeçalho chegar)
+    };
+
+    struct Completion
+    {
+      std::size_t stream;
+      bool ok;
+      int first_level;
+      int level_count;
+      Texture texture;
+      bool header = false;         // Leitura do cabeçalho de um .bc1 (sem níveis)
+      CompressedFileLayout layout; // Layout lido no cabeçalho
+    };
+
+    std::vector<Stream> streams;
+    int frame = 0;
+
+    // Estado compartilhado com os callbacks de leitura (continua válido se uma leitura terminar depois do streamer)
+    struct State
+    {
+      std::mutex mutex;
+      std::vector<Completion> completions;
+      int in_flight = 0;
+    };
+
+    std::shared_ptr<State> state = std::make_shared<State>();
+
+    void request(std::size_t stream, int first_level);
+    static int coarseLevel(int width, int height, int level_count, int initial_size);
+    static void decode(io::ReadResult &result, int first_level, int initial_size, Completion &completion);
+  };
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <vector>
+
+namespace models
+{
+  // Entradas do cache de vértices simulado pela reordenação (cozimento e Mesh::optimizeLayout)
+  constexpr int VERTEX_CACHE_SIZE = 32;
+
+  // Faces descritas por índices: a face f usa corners[starts[f] .. starts[f + 1])
+
+  // ACMR: vértices transformados por triângulo com um cache FIFO de cache_size entradas (mínimo ~0.5, pior 3)
+  float vertexCacheACMR(const std::vector<int> &corners, const std::vector<int> &starts, int vertex_count, int cache_size);
+
+  // Ordem das faces pelo algoritmo de Forsyth (cache LRU de cache_size entradas)
+  std::vector<int> vertexCacheOrder(const std::vector<int> &corners, const std::vector<int> &starts, int vertex_count, int cache_size);
+}
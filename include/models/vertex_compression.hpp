@@ -0,0 +1,115 @@
+#pragma once
+
+#include <core/types.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Mesh;
+
+namespace models
+{
+  // Precisão das normais codificadas no octaedro (escolhida em tempo de execução)
+  enum class NormalPrecision
+  {
+    OCT8, // 2x8 bits por normal (erro máximo ~1 grau)
+    OCT16 // 2x16 bits por normal (erro desprezível)
+  };
+
+  // Posição quantizada em 16 bits por eixo dentro da AABB da malha (6 bytes)
+  struct QuantizedPosition
+  {
+    std::uint16_t x, y, z;
+  };
+
+  // UV quantizada em 16 bits por eixo dentro do intervalo de UVs da malha (4 bytes)
+  struct QuantizedUV
+  {
+    std::uint16_t u, v;
+  };
+
+  static_assert(sizeof(QuantizedPosition) == 6, "A posição quantizada deve ter 6 bytes");
+  static_assert(sizeof(QuantizedUV) == 4, "A UV quantizada deve ter 4 bytes");
+
+  /**
+   * @brief Codifica um vetor unitário no octaedro
+   *
+   * @param normal Vetor unitário
+   * @param bits Bits por componente (8 ou 16)
+   * @return std::uint32_t Componentes x (bits baixos) e y (bits altos)
+   *
+   * @note A normal é projetada no octaedro |x| + |y| + |z| = 1 e o hemisfério inferior é dobrado
+   *       sobre os cantos do quadrado, assim as duas componentes cobrem a esfera inteira
+   */
+  std::uint32_t encodeOctahedral(const Vec3f &normal, int bits);
+
+  // Decodifica um vetor codificado por encodeOctahedral (resultado unitário)
+  Vec3f decodeOctahedral(std::uint32_t packed, int bits);
+
+  /**
+   * @brief Fluxo de vértices comprimido de uma malha
+   *
+   * @note Posições por vértice (na ordem de Mesh::vertexes), normais e UVs por canto (indexadas por HalfEdge::index)
+   * @note A dequantização das posições é uma matriz (escala + translação) combinada com a matriz do pipeline:
+   *       transformPositions converte os inteiros e aplica a matriz combinada, quatro vértices por vez com SSE2
+   * @note Malhas sem normais por canto têm as normais médias dos vértices gravadas por canto na construção,
+   *       assim os modos gouraud e phong não recalculam as normais a cada quadro
+   * @note O ganho é no que a projeção e o sombreamento leem por quadro, não na memória da malha: as posições em
+   *       float continuam nos vértices da half-edge (o recorte, a colisão e as normais das faces leem de lá), então
+   *       as posições quantizadas somam 6 bytes por vértice. Só as normais e UVs por canto em float são liberadas
+   *       (Mesh::compressVertices), e a memória da malha só cai quando elas pesam mais que as posições
+   */
+  class CompressedVertices
+  {
+  public:
+    // Comprime os vértices da malha (as normais médias dos vértices já devem estar calculadas)
+    void build(const Mesh &mesh, NormalPrecision precision);
+    void clear();
+
+    bool empty() const { return positions.empty(); }
+    bool hasUVs() const { return !uvs.empty(); }
+    // As normais vieram de Mesh::corner_normals (e não das normais médias dos vértices)
+    bool hasCornerNormals() const { return corner_normals_source; }
+    NormalPrecision precision() const { return normal_precision; }
+
+    // Matriz que leva as posições quantizadas (0..65535) para o SRO
+    Matrix dequantization() const;
+
+    // Dequantiza e transforma todas as posições (matrix já combinada com dequantization()), out tem positions.size()
+    void transformPositions(const Matrix &matrix, Vec4f *out) const;
+
+    // Posição de um vértice no SRO (Vertex::index)
+    Vec3f position(int vertex) const;
+
+    // Atributos de um canto (HalfEdge::index)
+    Vec3f normal(int corner) const;
+    Vec2f uv(int corner) const;
+
+    // Bytes do fluxo comprimido
+    std::size_t bytes() const;
+    // Bytes dos mesmos atributos em float (posição xyz por vértice, normal e UV por canto ou por vértice)
+    std::size_t floatBytes() const { return float_bytes; }
+    // Bytes dos vetores em float que o fluxo substituiu na malha (normais e UVs por canto)
+    std::size_t releasedBytes() const { return released_bytes; }
+    // Variação da memória da malha (fluxo inteiro menos o que ele liberou, positivo = a malha cresceu)
+    std::ptrdiff_t residentDelta() const { return static_cast<std::ptrdiff_t>(bytes()) - static_cast<std::ptrdiff_t>(released_bytes); }
+
+    // Posições quantizadas (na ordem de Mesh::vertexes)
+    std::vector<QuantizedPosition> positions;
+
+  private:
+    std::vector<std::uint16_t> normals8;
+    std::vector<std::uint32_t> normals16;
+    std::vector<QuantizedUV> uvs;
+
+    NormalPrecision normal_precision = NormalPrecision::OCT16;
+    Vec3f position_min;
+    Vec3f position_step;
+    Vec2f uv_min;
+    Vec2f uv_step;
+    bool corner_normals_source = false;
+    std::size_t float_bytes = 0;
+    std::size_t released_bytes = 0;
+  };
+}
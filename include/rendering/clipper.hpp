@@ -0,0 +1,417 @@
+#pragma once
+
+#include <core/types.hpp>
+#include <math/math.hpp>
+
+#include <array>
+#include <cassert>
+
+namespace pipeline
+{
+  // Recorte
+
+#define INSIDE 0b000000
+#define LEFT 0b000001
+#define RIGHT 0b000010
+#define BOTTOM 0b000100
+#define TOP 0b001000
+#define NEAR 0b010000
+#define FAR 0b100000
+
+  /**
+   * @brief Vértice usado no recorte: posição de tela + N atributos interpolados linearmente
+   *
+   * @note Os atributos dependem do sombreamento (cor no Gouraud, normal no Phong, UV na textura)
+   */
+  template <int N>
+  struct ClipVertex
+  {
+    static constexpr int COUNT = N;
+
+    // Coordenadas de tela (SRT) e profundidade
+    Vec3f position;
+
+    // Fator homogêneo da projeção (usado no recorte do plano near e na correção de perspectiva)
+    float w = 1.0f;
+
+    // Atributos interpolados
+    std::array<float, N> attributes;
+  };
+
+  // Flat: apenas a posição
+  typedef ClipVertex<0> FlatVertex;
+  // Gouraud: cor do vértice (r, g, b)
+  typedef ClipVertex<3> GouraudVertex;
+  // Phong: normal do vértice (x, y, z)
+  typedef ClipVertex<3> PhongVertex;
+  // Textura: coordenada (u, v)
+  typedef ClipVertex<2> TextureVertex;
+
+  // Cada plano de recorte adiciona no máximo um vértice a um polígono convexo, então um triângulo
+  // recortado pelos 6 planos do volume de visualização tem no máximo 3 + 6 vértices
+  constexpr int MAX_CLIP_VERTEXES = 3 + 6;
+
+  /**
+   * @brief Polígono de capacidade fixa (fica na pilha, sem alocação dinâmica)
+   */
+  template <typename V>
+  struct ClipPolygon
+  {
+    V vertexes[MAX_CLIP_VERTEXES];
+    int count = 0;
+
+    void push(const V &vertex)
+    {
+      assert(count < MAX_CLIP_VERTEXES && "ClipPolygon: capacidade excedida (a entrada deve ser um triângulo)");
+      vertexes[count++] = vertex;
+    }
+    int size() const { return count; }
+    const V &operator[](int i) const { return vertexes[i]; }
+  };
+
+  /**
+   * @brief Janelas usadas no recorte de um triângulo
+   *
+   * @note A guard band é uma janela maior que a viewport (2 a 4 vezes). Triângulos dentro dela não
+   *       passam pelo recorte geométrico, o rasterizador apenas descarta (scissor) os pixels fora da viewport
+   * @note O tamanho da guard band é limitado para que as coordenadas de tela continuem pequenas
+   *       (as scanlines e os passos incrementais não estouram, mesmo em inteiros)
+   */
+  struct ClipWindow
+  {
+    // Viewport (scissor do rasterizador)
+    Vec2f min_viewport;
+    Vec2f max_viewport;
+
+    // Guard band
+    Vec2f min_guard_band;
+    Vec2f max_guard_band;
+
+    // Distância do plano near (no SRC a câmera olha para -z, então um ponto é visível se z <= -near)
+    float near;
+  };
+
+  /**
+   * @brief Contadores do recorte de triângulos (reiniciados a cada quadro)
+   */
+  struct ClipStats
+  {
+    // Triângulos que chegaram ao recorte
+    int triangles = 0;
+    // Triângulos totalmente dentro da viewport
+    int inside_viewport = 0;
+    // Triângulos que cruzam a viewport, mas estão dentro da guard band (apenas scissor)
+    int inside_guard_band = 0;
+    // Triângulos recortados contra a viewport (cruzam a guard band)
+    int clipped = 0;
+    // Triângulos recortados pelo plano near
+    int near_clipped = 0;
+    // Triângulos descartados (fora da viewport ou atrás do plano near)
+    int rejected = 0;
+
+    void reset() { *this = ClipStats(); }
+
+    // Soma os contadores de outra gravação (listas de comandos gravadas em paralelo)
+    ClipStats &operator+=(const ClipStats &other)
+    {
+      triangles += other.triangles;
+      inside_viewport += other.inside_viewport;
+      inside_guard_band += other.inside_guard_band;
+      clipped += other.clipped;
+      near_clipped += other.near_clipped;
+      rejected += other.rejected;
+      return *this;
+    }
+
+    // Fração dos triângulos que não passaram pelo recorte geométrico
+    float fast_path_ratio() const { return triangles == 0 ? 1.0f : static_cast<float>(inside_viewport + inside_guard_band) / triangles; }
+  };
+
+  bool is_inside(Vec3f p, Vec2f min, Vec2f max, unsigned int edge);
+  unsigned int outcode(const Vec3f &p, const Vec2f &min, const Vec2f &max);
+
+  /**
+   * @brief Calcula o ponto de interseção de uma aresta com uma borda da janela de recorte.
+   *
+   * @param p1 Vértice inicial da aresta
+   * @param p2 Vértice final da aresta
+   * @param min Canto inferior esquerdo da janela de recorte
+   * @param max Canto superior direito da janela de recorte
+   * @param edge Borda da janela de recorte
+   * @return V Vértice na borda, com todos os atributos interpolados
+   */
+  template <typename V>
+  V compute_intersection(const V &p1, const V &p2, const Vec2f &min, const Vec2f &max, unsigned int edge)
+  {
+    float u = 0.0f;
+    V intersection;
+
+    if (edge == LEFT || edge == RIGHT)
+    {
+      float x = edge == LEFT ? min.x : max.x;
+      u = (x - p1.position.x) / (p2.position.x - p1.position.x);
+      intersection.position.x = x;
+      intersection.position.y = Lerp(p1.position.y, p2.position.y, u);
+    }
+    else
+    {
+      float y = edge == BOTTOM ? min.y : max.y;
+      u = (y - p1.position.y) / (p2.position.y - p1.position.y);
+      intersection.position.x = Lerp(p1.position.x, p2.position.x, u);
+      intersection.position.y = y;
+    }
+
+    // u é linear no espaço de tela, então a profundidade e os atributos são interpolados
+    // com correção de perspectiva (1/w e atributo/w são lineares na tela)
+    float inv_w1 = 1.0f / p1.w;
+    float inv_w2 = 1.0f / p2.w;
+    float inv_w = Lerp(inv_w1, inv_w2, u);
+
+    intersection.w = 1.0f / inv_w;
+    intersection.position.z = Lerp(p1.position.z * inv_w1, p2.position.z * inv_w2, u) * intersection.w;
+
+    for (int i = 0; i < V::COUNT; i++)
+      intersection.attributes[i] = Lerp(p1.attributes[i] * inv_w1, p2.attributes[i] * inv_w2, u) * intersection.w;
+
+    return intersection;
+  }
+
+  /**
+   * @brief Recorta um polígono 2D contra a janela de recorte
+   *
+   * @param polygon Polígono com os vértices percorridos no sentido anti-horário (é substituído pelo polígono recortado)
+   * @param min Limite inferior esquerdo da janela de recorte
+   * @param max Limite superior direito da janela de recorte
+   * @return true Se sobrou um polígono (3 ou mais vértices)
+   * @return false Se o polígono foi totalmente recortado
+   *
+   * @note O algoritmo de Sutherland-Hodgman é utilizado
+   * @note Antes do recorte é feito o teste dos outcodes: se todos os vértices estão dentro, o polígono é aceito
+   *       sem nenhuma passada; se todos estão fora de uma mesma borda, ele é rejeitado. Só as bordas que
+   *       algum vértice cruza são processadas
+   * @note Os vértices intermediários ficam em buffers de capacidade fixa na pilha (nenhuma alocação dinâmica)
+   */
+  template <typename V>
+  bool clip_2D_polygon(ClipPolygon<V> &polygon, const Vec2f &min, const Vec2f &max)
+  {
+    unsigned int codes_or = INSIDE;
+    unsigned int codes_and = LEFT | RIGHT | BOTTOM | TOP;
+
+    for (int i = 0; i < polygon.count; i++)
+    {
+      unsigned int code = outcode(polygon.vertexes[i].position, min, max);
+      codes_or |= code;
+      codes_and &= code;
+    }
+
+    // Aceitação trivial
+    if (codes_or == INSIDE)
+      return polygon.count >= 3;
+
+    // Rejeição trivial
+    if (codes_and != INSIDE)
+    {
+      polygon.count = 0;
+      return false;
+    }
+
+    // Ordem de recorte
+    const unsigned int edges[] = {LEFT, RIGHT, BOTTOM, TOP};
+
+    ClipPolygon<V> buffer;
+    ClipPolygon<V> *input = &polygon;
+    ClipPolygon<V> *output = &buffer;
+
+    // A cada iteração, uma nova lista de vertices é gerada (alternando entre os dois buffers)
+    for (auto edge : edges)
+    {
+      if ((codes_or & edge) == 0)
+        continue;
+
+      output->count = 0;
+
+      for (int i = 0; i < input->count; i++)
+      {
+        const V &p1 = input->vertexes[i];
+        const V &p2 = input->vertexes[(i + 1) % input->count];
+
+        // Testa se os pontos estão dentro da janela de recorte
+        bool p1_inside = is_inside(p1.position, min, max, edge);
+        bool p2_inside = is_inside(p2.position, min, max, edge);
+
+        // Ambos os pontos estão dentro da janela, então adiciona o ponto final
+        if (p1_inside && p2_inside)
+          output->push(p2);
+        // Somente o primeiro ponto está fora da janela, então adiciona o ponto de interseção e o ponto final
+        // (a interseção é sempre calculada a partir do ponto de dentro, assim arestas compartilhadas geram o mesmo ponto)
+        else if (!p1_inside && p2_inside)
+        {
+          output->push(compute_intersection(p2, p1, min, max, edge));
+          output->push(p2);
+        }
+        // Somente o segundo ponto está fora da janela, então adiciona o ponto de interseção
+        else if (p1_inside && !p2_inside)
+          output->push(compute_intersection(p1, p2, min, max, edge));
+        // Nenhum dos pontos está dentro da janela, então não adiciona nenhum ponto
+      }
+
+      std::swap(input, output);
+
+      if (input->count == 0)
+        break;
+    }
+
+    if (input != &polygon)
+      polygon = *input;
+
+    return polygon.count >= 3;
+  }
+
+  /**
+   * @brief Recorta um polígono contra o plano near
+   *
+   * @param polygon Polígono em coordenadas de tela, com o fator homogêneo w de cada vértice
+   * @param near Distância do plano near
+   * @return true Se sobrou um polígono (3 ou mais vértices)
+   * @return false Se o polígono está todo atrás do plano near
+   *
+   * @note O recorte precisa ser feito antes da divisão perspectiva, pois pontos atrás da câmera são
+   *       projetados invertidos. As coordenadas homogêneas são recuperadas multiplicando x e y por w,
+   *       a interseção é calculada no SRC (z é a profundidade da câmera) e o resultado é dividido novamente
+   */
+  template <typename V>
+  bool clip_near_plane(ClipPolygon<V> &polygon, float near)
+  {
+    float near_z = -near;
+
+    ClipPolygon<V> output;
+
+    for (int i = 0; i < polygon.count; i++)
+    {
+      V p1 = polygon.vertexes[i];
+      V p2 = polygon.vertexes[(i + 1) % polygon.count];
+
+      bool p1_inside = p1.position.z <= near_z;
+      bool p2_inside = p2.position.z <= near_z;
+
+      if (p1_inside && p2_inside)
+      {
+        output.push(p2);
+        continue;
+      }
+
+      if (!p1_inside && !p2_inside)
+        continue;
+
+      // Interseção no espaço homogêneo, sempre a partir do ponto de dentro
+      const V &in = p1_inside ? p1 : p2;
+      const V &out = p1_inside ? p2 : p1;
+      float u = (near_z - in.position.z) / (out.position.z - in.position.z);
+
+      V intersection;
+      intersection.w = Lerp(in.w, out.w, u);
+      intersection.position.x = Lerp(in.position.x * in.w, out.position.x * out.w, u) / intersection.w;
+      intersection.position.y = Lerp(in.position.y * in.w, out.position.y * out.w, u) / intersection.w;
+      intersection.position.z = near_z;
+
+      for (int k = 0; k < V::COUNT; k++)
+        intersection.attributes[k] = Lerp(in.attributes[k], out.attributes[k], u);
+
+      output.push(intersection);
+
+      if (p2_inside)
+        output.push(p2);
+    }
+
+    polygon = output;
+
+    return polygon.count >= 3;
+  }
+
+  /**
+   * @brief Prepara um triângulo para a rasterização (recorte com guard band)
+   *
+   * @param polygon Triângulo em coordenadas de tela (é substituído pelo polígono recortado, se preciso)
+   * @param window Viewport, guard band e plano near
+   * @param stats Contadores do recorte
+   * @return true Se o polígono deve ser rasterizado (sempre com scissor na viewport)
+   * @return false Se o polígono foi descartado
+   *
+   * @note Apenas triângulos que cruzam a guard band ou o plano near passam pelo recorte geométrico
+   */
+  template <typename V>
+  bool clip_triangle(ClipPolygon<V> &polygon, const ClipWindow &window, ClipStats &stats)
+  {
+    stats.triangles++;
+
+    // Plano near
+    int behind_near = 0;
+    for (int i = 0; i < polygon.count; i++)
+    {
+      if (polygon.vertexes[i].position.z > -window.near)
+        behind_near++;
+    }
+
+    if (behind_near == polygon.count)
+    {
+      stats.rejected++;
+      return false;
+    }
+
+    if (behind_near > 0)
+    {
+      stats.near_clipped++;
+
+      if (!clip_near_plane(polygon, window.near) || !clip_2D_polygon(polygon, window.min_viewport, window.max_viewport))
+      {
+        stats.rejected++;
+        return false;
+      }
+
+      return true;
+    }
+
+    unsigned int viewport_or = INSIDE;
+    unsigned int viewport_and = LEFT | RIGHT | BOTTOM | TOP;
+    unsigned int guard_band_or = INSIDE;
+
+    for (int i = 0; i < polygon.count; i++)
+    {
+      unsigned int code = outcode(polygon.vertexes[i].position, window.min_viewport, window.max_viewport);
+      viewport_or |= code;
+      viewport_and &= code;
+      guard_band_or |= outcode(polygon.vertexes[i].position, window.min_guard_band, window.max_guard_band);
+    }
+
+    // Fora da viewport
+    if (viewport_and != INSIDE)
+    {
+      stats.rejected++;
+      return false;
+    }
+
+    // Dentro da viewport
+    if (viewport_or == INSIDE)
+    {
+      stats.inside_viewport++;
+      return true;
+    }
+
+    // Cruza a viewport, mas está dentro da guard band: o scissor do rasterizador resolve
+    if (guard_band_or == INSIDE)
+    {
+      stats.inside_guard_band++;
+      return true;
+    }
+
+    stats.clipped++;
+
+    if (!clip_2D_polygon(polygon, window.min_viewport, window.max_viewport))
+    {
+      stats.rejected++;
+      return false;
+    }
+
+    return true;
+  }
+}
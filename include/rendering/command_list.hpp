@@ -0,0 +1,189 @@
+#pragma once
+
+#include <core/types.hpp>
+#include <models/color.hpp>
+#include <models/common.hpp>
+#include <models/texture.hpp>
+#include <rendering/clipper.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pipeline
+{
+  // Rotina de preenchimento de um comando (também é o campo mais significativo da chave)
+  enum class CommandKind : std::uint8_t
+  {
+    FLAT,            // fill_polygon_flat
+    GOURAUD,         // fill_polygon_gourand (gouraud e cores por canto)
+    PHONG,           // fill_polygon_phong
+    TEXTURE,         // fill_polygon_texture
+    TEXTURE_INDEXED, // fill_polygon_texture_indexed
+    LINES,           // DrawLineBuffer (cor)
+    LINES_INDEXED,   // DrawLineBuffer (índice da paleta)
+    VISIBILITY       // fill_polygon_visibility (id do triângulo no visibility buffer)
+  };
+
+  // Ordem de execução dos comandos
+  enum class CommandOrder
+  {
+    SUBMISSION,   // Ordem de gravação (objetos e faces na ordem da cena)
+    STATE,        // Rotina, textura, material e profundidade (frente para trás)
+    FRONT_TO_BACK // Profundidade antes do estado (maximiza o descarte pelo teste de profundidade)
+  };
+
+  /**
+   * @brief Comando de desenho: chave de ordenação + índice dos dados do comando
+   *
+   * @note Chave no modo STATE (bits): rotina [63..60], textura [59..44], material [43..28], profundidade [27..0]
+   * @note Chave no modo SUBMISSION: objeto [63..32], sequência dentro do objeto [31..0]
+   * @note Chave no modo FRONT_TO_BACK: profundidade [63..36], rotina [35..32], textura [31..16], material [15..0]
+   */
+  struct RenderCommand
+  {
+    std::uint64_t key;
+    std::uint32_t payload;
+  };
+
+  // Dados de um comando (tudo o que a rotina de preenchimento precisa além dos buffers e das luzes)
+  struct DrawPayload
+  {
+    CommandKind kind;
+    // Vértices no fluxo da rotina (polígono recortado ou linha)
+    std::uint32_t first_vertex;
+    std::uint32_t vertex_count;
+
+    const models::Material *material = nullptr;
+    const models::Texture *texture = nullptr;
+    const models::Uint8 *colormap_row = nullptr;
+
+    // Centroide e normal no SRU (flat e textura: da face; phong: centroide do objeto)
+    Vec3f centroid;
+    Vec3f normal;
+
+    // Cor das linhas
+    models::Color color;
+    models::Uint8 color_index = 0;
+
+    // Id (objeto, triângulo) gravado no visibility buffer
+    std::uint32_t visibility_id = 0;
+  };
+
+  /**
+   * @brief Lista de comandos de desenho de um quadro
+   *
+   * @note A gravação leva os polígonos já recortados (com os atributos de cada vértice) para fluxos contínuos,
+   *       então a execução não depende mais das coordenadas de tela guardadas na malha
+   * @note Cada thread grava na própria lista e as listas são juntadas com append antes da ordenação
+   */
+  class CommandList
+  {
+  public:
+    CommandOrder order = CommandOrder::STATE;
+
+    std::vector<RenderCommand> commands;
+    std::vector<DrawPayload> payloads;
+
+    // Fluxos de vértices (indexados por DrawPayload::first_vertex)
+    std::vector<FlatVertex> flat_vertexes; // Flat e visibility buffer
+    std::vector<ClipVertex<3>> color_vertexes; // Gouraud (cor) e Phong (normal)
+    std::vector<TextureVertex> texture_vertexes;
+    std::vector<Vec3f> line_vertexes;
+
+    // Contadores do recorte dos polígonos gravados nesta lista
+    ClipStats clip_stats;
+
+    // Esvazia a lista (mantém a memória reservada para o próximo quadro)
+    void clear();
+
+    // Início dos comandos de um objeto (índice na cena e ids do material e da textura no quadro)
+    void begin(int object, int material, int texture);
+
+    // Grava um polígono recortado
+    template <int N>
+    void draw(const ClipPolygon<ClipVertex<N>> &polygon, const DrawPayload &payload);
+
+    // Grava uma linha poligonal (x, y, 1/w)
+    void lines(const std::vector<Vec3f> &vertexes, const DrawPayload &payload);
+
+    // Recupera o polígono de um comando
+    template <int N>
+    void polygon(const DrawPayload &payload, ClipPolygon<ClipVertex<N>> &polygon) const;
+
+    // Junta os comandos de outra lista
+    void append(const CommandList &other);
+
+    // Ordena os comandos pela chave (radix sort)
+    void sort();
+
+    std::size_t size() const { return commands.size(); }
+
+  private:
+    template <int N>
+    std::vector<ClipVertex<N>> &stream();
+    template <int N>
+    const std::vector<ClipVertex<N>> &stream() const;
+
+    // Cria o comando do último payload gravado
+    void push(CommandKind kind, float depth);
+
+    std::uint32_t object = 0;
+    std::uint32_t sequence = 0;
+    std::uint32_t material = 0;
+    std::uint32_t texture = 0;
+
+    std::vector<RenderCommand> scratch;
+  };
+
+  template <>
+  inline std::vector<ClipVertex<0>> &CommandList::stream<0>() { return flat_vertexes; }
+  template <>
+  inline std::vector<ClipVertex<2>> &CommandList::stream<2>() { return texture_vertexes; }
+  template <>
+  inline std::vector<ClipVertex<3>> &CommandList::stream<3>() { return color_vertexes; }
+  template <>
+  inline const std::vector<ClipVertex<0>> &CommandList::stream<0>() const { return flat_vertexes; }
+  template <>
+  inline const std::vector<ClipVertex<2>> &CommandList::stream<2>() const { return texture_vertexes; }
+  template <>
+  inline const std::vector<ClipVertex<3>> &CommandList::stream<3>() const { return color_vertexes; }
+
+  /**
+   * @brief Grava um polígono recortado
+   *
+   * @param polygon Polígono (já recortado)
+   * @param payload Dados do comando (first_vertex e vertex_count são preenchidos aqui)
+   *
+   * @note A profundidade da chave é a do vértice mais próximo do observador
+   */
+  template <int N>
+  void CommandList::draw(const ClipPolygon<ClipVertex<N>> &polygon, const DrawPayload &payload)
+  {
+    std::vector<ClipVertex<N>> &vertexes = stream<N>();
+
+    DrawPayload &stored = payloads.emplace_back(payload);
+    stored.first_vertex = static_cast<std::uint32_t>(vertexes.size());
+    stored.vertex_count = static_cast<std::uint32_t>(polygon.size());
+
+    float depth = -polygon[0].position.z;
+    for (int i = 0; i < polygon.size(); i++)
+    {
+      vertexes.push_back(polygon[i]);
+      depth = std::min(depth, -polygon[i].position.z);
+    }
+
+    push(payload.kind, depth);
+  }
+
+  template <int N>
+  void CommandList::polygon(const DrawPayload &payload, ClipPolygon<ClipVertex<N>> &polygon) const
+  {
+    const std::vector<ClipVertex<N>> &vertexes = stream<N>();
+
+    polygon.count = 0;
+    for (std::uint32_t i = 0; i < payload.vertex_count; i++)
+      polygon.push(vertexes[payload.first_vertex + i]);
+  }
+}
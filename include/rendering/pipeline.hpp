@@ -8,57 +8,88 @@
 #include <models/light.hpp>
 #include <models/texture.hpp>
 #include <core/halfedge.hpp>
+#include <rendering/clipper.hpp>
+#include <rendering/rasterizer.hpp>
 #include <algorithm>
+#include <cstdint>
 
 #include <iostream>
 
 namespace pipeline
 {
+  Matrix model_to_sru(const Vec3f &position, const Vec3f &rotation = Vec3f(), const Vec3f &scale = Vec3f(1.0f, 1.0f, 1.0f));
   Matrix sru_to_src(const Vec3f &vrp, const Vec3f focal_point);
   Matrix projection(const Vec3f &vrp, const Vec3f p, const float dist_proj_plane);
   Matrix src_to_srt(const Vec2f min_window, const Vec2f min_viewport, const Vec2f max_window, const Vec2f max_viewport, bool reflected);
 
-  // Recorte
-
-#define INSIDE 0b000000
-#define LEFT 0b000001
-#define RIGHT 0b000010
-#define BOTTOM 0b000100
-#define TOP 0b001000
-#define NEAR 0b010000
-#define FAR 0b100000
-
-  bool is_inside(Vec3f p, Vec2f min, Vec2f max, unsigned int edge);
-  // usada no flat
-  Vec3f compute_intersection(Vec3f p1, Vec3f p2, Vec2f min, Vec2f max, unsigned int edge);
-  // usada no gouraud
-  std::pair<Vec3f, models::Color> compute_intersection(std::pair<Vec3f, models::Color> p1, std::pair<Vec3f, models::Color> p2, Vec2f min, Vec2f max, unsigned int edge);
-  // usada no phong
-  std::pair<Vec3f, Vec3f> compute_intersection(std::pair<Vec3f, Vec3f> p1, std::pair<Vec3f, Vec3f> p2, Vec2f min, Vec2f max, unsigned int edge);
-
-  // mesma coisa ocorre aqui, uma das funções de clip é usada no flat, outra no gouraud e phong
-  std::vector<Vec3f> clip_2D_polygon(const std::vector<Vec3f> &polygon, const Vec2f &min, const Vec2f &max);
-  std::vector<std::pair<Vec3f, models::Color>> clip_2D_polygon(const std::vector<std::pair<Vec3f, models::Color>> &polygon, const Vec2f &min, const Vec2f &max);
-  std::vector<std::pair<Vec3f, Vec3f>> clip_2D_polygon(const std::vector<std::pair<Vec3f, Vec3f>> &polygon, const Vec2f &min, const Vec2f &max);
-
   // Desenhos pixel-a-pixel
   void setPixel(const Vec3f pixel, const models::Color &color, std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<models::Color>> &color_buffer);
   void DrawBuffer(ImDrawList *draw_list, const std::vector<std::vector<float>> &z_buffer, const std::vector<std::vector<models::Color>> &color_buffer, Vec2f min_window_size);
   void DrawVertexBuffer(const Vec3f point, const models::Color &color, std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<models::Color>> &color_buffer, const int size = 3);
   void DrawLineBuffer(const std::vector<Vec3f> &vertexes, const models::Color &color, std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<models::Color>> &color_buffer);
+  void DrawLineBuffer(const std::vector<Vec3f> &vertexes, models::Uint8 index, std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<models::Uint8>> &index_buffer);
+  void ExpandIndexBuffer(const std::vector<std::vector<models::Uint8>> &index_buffer, const models::Palette &palette, const Vec2f &min_viewport, const Vec2f &max_viewport, std::vector<std::vector<models::Color>> &color_buffer);
+
+  // Mipmaps
+
+  // Momento em que o nível de mipmap é escolhido
+  enum class MipSelection
+  {
+    NONE,        // Sempre o nível 0
+    PER_POLYGON, // Um nível por polígono
+    PER_SPAN     // Um nível por scanline
+  };
+
+  // Planos de 1/w, u/w e v/w de um polígono na tela (índices 0, 1 e 2)
+  struct TextureGradients
+  {
+    float x, y;
+    float origin[3];
+    float dx[3];
+    float dy[3];
+    bool valid;
+  };
+
+  TextureGradients texture_gradients(const ClipPolygon<TextureVertex> &polygon);
+  int texture_level(const TextureGradients &gradients, const models::Texture &tex, float x, float y);
+
+  // Sombreamento com taxa variável (phong)
+
+  // Granularidade da iluminação no modo phong (o teste de profundidade continua sendo feito em cada pixel,
+  // e blocos que cruzam uma aresta do polígono são iluminados por pixel)
+  enum class ShadingRate
+  {
+    RATE_1X1, // Iluminação em cada pixel
+    RATE_2X2, // Uma avaliação por bloco 2x2, interpolada entre os blocos vizinhos
+    RATE_4X4, // Uma avaliação por bloco 4x4
+    ADAPTIVE  // Um bloco por polígono, escolhido pela variação da normal na tela
+  };
+
+  // Maior variação da normal (unitária) entre dois cantos de um bloco aceita pelo modo ADAPTIVE
+  constexpr float SHADING_RATE_MAX_NORMAL_DELTA = 0.05f;
 
   // Rasterização
   void z_buffer(const Vec3f pixel, const models::Color &color, std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<models::Color>> &color_buffer);
-  void fill_polygon_flat(const std::vector<Vec3f> &vertexes, const models::GlobalLight &global_light, const std::vector<models::Omni> &omni_lights, const Vec3f &eye, const Vec3f &face_centroid, const Vec3f &face_normal, const models::Material &object_material, std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<models::Color>> &color_buffer);
-  void fill_polygon_gourand(const std::vector<std::pair<Vec3f, models::Color>> &vertexes, std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<models::Color>> &color_buffer);
-  void fill_polygon_phong(const std::vector<std::pair<Vec3f, Vec3f>> &vertexes, const Vec3f &centroid, const models::GlobalLight &global_light, const std::vector<models::Omni> &omni_lights, const Vec3f &eye, const models::Material &object_material, std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<models::Color>> &color_buffer);
-  void fill_polygon_texture(const std::vector<Vertex *> &vertexes, const models::Texture &tex,
+  void fill_polygon_flat(const ClipPolygon<FlatVertex> &polygon, const Vec2f &scissor_min, const Vec2f &scissor_max, const models::GlobalLight &global_light, const std::vector<models::Omni> &omni_lights, const Vec3f &eye, const Vec3f &face_centroid, const Vec3f &face_normal, const models::Material &object_material, std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<models::Color>> &color_buffer, RasterStats &raster_stats);
+  void fill_polygon_gourand(const ClipPolygon<GouraudVertex> &polygon, const Vec2f &scissor_min, const Vec2f &scissor_max, std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<models::Color>> &color_buffer, RasterStats &raster_stats);
+  void fill_polygon_phong(const ClipPolygon<PhongVertex> &polygon, const Vec2f &scissor_min, const Vec2f &scissor_max, const Vec3f &centroid, const models::GlobalLight &global_light, const std::vector<models::Omni> &omni_lights, const Vec3f &eye, const models::Material &object_material, ShadingRate shading_rate, std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<models::Color>> &color_buffer, RasterStats &raster_stats);
+  void fill_polygon_texture(const ClipPolygon<TextureVertex> &polygon, const Vec2f &scissor_min, const Vec2f &scissor_max, const models::Texture &tex,
+                            MipSelection mip_selection,
                             const models::GlobalLight &global_light,
                             const std::vector<models::Omni> &omni_lights,
                             const Vec3f &eye, const Vec3f &face_centroid, const Vec3f &face_normal,
                             const models::Material &object_material,
                             std::vector<std::vector<float>> &z_buffer,
-                            std::vector<std::vector<models::Color>> &color_buffer);
+                            std::vector<std::vector<models::Color>> &color_buffer,
+                            RasterStats &raster_stats);
+  void fill_polygon_texture_indexed(const ClipPolygon<TextureVertex> &polygon, const Vec2f &scissor_min, const Vec2f &scissor_max, const models::Texture &tex,
+                                    MipSelection mip_selection,
+                                    const models::Uint8 *colormap_row,
+                                    std::vector<std::vector<float>> &z_buffer,
+                                    std::vector<std::vector<models::Uint8>> &index_buffer,
+                                    RasterStats &raster_stats);
+  void fill_polygon_visibility(const ClipPolygon<FlatVertex> &polygon, const Vec2f &scissor_min, const Vec2f &scissor_max, std::uint32_t id,
+                               std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<std::uint32_t>> &id_buffer, RasterStats &raster_stats);
 
   // Outras funções
   std::vector<Vec3f> BresenhamLine(Vec3f start, Vec3f end);
@@ -0,0 +1,392 @@
+#pragma once
+
+#include <core/types.hpp>
+#include <math/math.hpp>
+#include <models/color.hpp>
+#include <rendering/clipper.hpp>
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace pipeline
+{
+  // Número de pixels entre duas divisões exatas da correção de perspectiva (como no d_scan do Quake)
+  // Entre as divisões os atributos avançam de forma afim
+  constexpr int SPAN_SUBDIVISION = 16;
+
+  // Bits fracionários dos atributos entregues em ponto fixo (16.16)
+  constexpr int RASTER_FIXED_BITS = 16;
+
+  /**
+   * @brief Contadores da rasterização (reiniciados a cada quadro)
+   */
+  struct RasterStats
+  {
+    // Pixels cobertos pelos polígonos (chegaram ao teste de profundidade)
+    int tested = 0;
+    // Pixels que passaram no teste de profundidade e foram sombreados
+    int shaded = 0;
+    // Pixels com alguma geometria no fim do quadro (contados no z-buffer depois da execução)
+    int visible = 0;
+    // Pixels rasterizados pelo pré-passo de profundidade (rasterize_depth)
+    int depth_tested = 0;
+    // Pixels sombreados pela resolução do visibility buffer (resolve_visibility)
+    int resolved = 0;
+    // Avaliações da iluminação de phong (uma por pixel ou uma por canto de bloco no sombreamento com taxa reduzida)
+    int lit = 0;
+
+    void reset() { *this = RasterStats(); }
+
+    // Fração dos pixels descartados pelo teste de profundidade antes do sombreamento
+    float rejected_ratio() const { return tested == 0 ? 0.0f : static_cast<float>(tested - shaded) / tested; }
+    // Sombreamentos por pixel visível (1.0 = nenhum pixel foi sombreado mais de uma vez)
+    float overdraw() const { return visible == 0 ? 0.0f : static_cast<float>(shaded) / visible; }
+  };
+
+  /**
+   * @brief Vértice preparado para a rasterização
+   *
+   * @note 1/w e atributo/w são lineares no espaço de tela, então são eles que são interpolados
+   *       nas arestas e nas scanlines
+   */
+  template <int N>
+  struct RasterVertex
+  {
+    float x;
+    float y;
+
+    // 1/w (também é a profundidade usada no z-buffer)
+    float inv_w;
+
+    // Atributos divididos por w
+    std::array<float, N> attributes;
+  };
+
+  /**
+   * @brief Prepara os vértices de um polígono para a rasterização (1/w e atributo/w)
+   *
+   * @param polygon Polígono em coordenadas de tela
+   * @param vertexes Vértices preparados (MAX_CLIP_VERTEXES posições)
+   * @param top Menor y do polígono
+   * @param bottom Maior y do polígono
+   *
+   * @note Com N = 0 só a posição e 1/w são preparados (pré-passo de profundidade)
+   */
+  template <int N, typename V>
+  void prepare_raster_vertexes(const ClipPolygon<V> &polygon, RasterVertex<N> *vertexes, float &top, float &bottom)
+  {
+    top = std::numeric_limits<float>::max();
+    bottom = -std::numeric_limits<float>::max();
+
+    for (int i = 0; i < polygon.count; i++)
+    {
+      const V &vertex = polygon[i];
+      RasterVertex<N> &raster = vertexes[i];
+
+      raster.x = vertex.position.x;
+      raster.y = vertex.position.y;
+      raster.inv_w = 1.0f / vertex.w;
+
+      for (int k = 0; k < N; k++)
+        raster.attributes[k] = vertex.attributes[k] * raster.inv_w;
+
+      top = std::min(top, raster.y);
+      bottom = std::max(bottom, raster.y);
+    }
+  }
+
+  /**
+   * @brief Encontra as extremidades de uma scanline do polígono
+   *
+   * @param vertexes Vértices preparados
+   * @param count Número de vértices
+   * @param sample_y Centro da scanline
+   * @param span Extremidades (esquerda e direita) com 1/w e atributo/w interpolados
+   * @return true Se a scanline cruza o polígono
+   *
+   * @note Compartilhada pelo núcleo completo e pelo de profundidade, assim os dois calculam o mesmo 1/w
+   *       em cada pixel, bit a bit (o passo de sombreamento depois do pré-passo depende disso)
+   */
+  template <int N>
+  bool scanline_span(const RasterVertex<N> *vertexes, int count, float sample_y, RasterVertex<N> (&span)[2])
+  {
+    // Como o polígono é convexo, exatamente duas arestas cruzam a scanline
+    int found = 0;
+
+    for (int i = 0; i < count && found < 2; i++)
+    {
+      const RasterVertex<N> &p1 = vertexes[i];
+      const RasterVertex<N> &p2 = vertexes[(i + 1) % count];
+
+      // A aresta é sempre avaliada de cima para baixo, assim uma aresta compartilhada por dois polígonos
+      // (percorrida em sentidos opostos) gera exatamente os mesmos valores e não deixa buracos
+      const RasterVertex<N> &a = p1.y < p2.y ? p1 : p2;
+      const RasterVertex<N> &b = p1.y < p2.y ? p2 : p1;
+
+      if (!(a.y <= sample_y && sample_y < b.y))
+        continue;
+
+      float t = (sample_y - a.y) / (b.y - a.y);
+
+      span[found].x = Lerp(a.x, b.x, t);
+      span[found].inv_w = Lerp(a.inv_w, b.inv_w, t);
+      for (int k = 0; k < N; k++)
+        span[found].attributes[k] = Lerp(a.attributes[k], b.attributes[k], t);
+
+      found++;
+    }
+
+    if (found < 2)
+      return false;
+
+    if (span[0].x > span[1].x)
+      std::swap(span[0], span[1]);
+
+    return true;
+  }
+
+  /**
+   * @brief Rasteriza um polígono convexo com interpolação de atributos com correção de perspectiva
+   *
+   * @param polygon Polígono em coordenadas de tela (já recortado ou dentro da guard band)
+   * @param scissor_min Canto inferior esquerdo da viewport (pixels fora dela são descartados)
+   * @param scissor_max Canto superior direito da viewport
+   * @param z_buffer Buffer de profundidade (1/w, o maior valor está mais perto)
+   * @param color_buffer Buffer de cores (models::Color, ou índices da paleta no caminho de 8 bits)
+   * @param stats Contadores de pixels testados e sombreados
+   * @param shade Função que calcula a cor do pixel: shade(const Vec3f &pixel, const float *attributes),
+   *              pixel = {x, y, 1/w}. Se shade receber const int *, os atributos são entregues em ponto fixo
+   *              (RASTER_FIXED_BITS) e avançam com somas inteiras dentro de cada segmento
+   *
+   * @note Os pixels são amostrados nas coordenadas inteiras, com a regra do topo-esquerda
+   *       (x de ceil(x_esquerda) até ceil(x_direita) - 1), assim arestas compartilhadas não são desenhadas duas vezes
+   * @note Cada scanline é dividida em segmentos de SPAN_SUBDIVISION pixels: os atributos são calculados
+   *       exatamente (uma divisão) no fim de cada segmento e interpolados de forma afim dentro dele
+   * @note O teste de profundidade é feito antes do sombreamento, pixels ocultos não são sombreados
+   *       (desenhar de frente para trás, CommandOrder::FRONT_TO_BACK, maximiza esse descarte)
+   * @note Depois do pré-passo (rasterize_depth) o z-buffer já tem o 1/w mais próximo de cada pixel, então o teste
+   *       só aceita o fragmento de profundidade igual à gravada e cada pixel é sombreado uma única vez
+   * @note Nenhuma alocação dinâmica é feita
+   */
+  template <typename V, typename Pixel, typename Shader>
+  void rasterize_polygon(const ClipPolygon<V> &polygon, const Vec2f &scissor_min, const Vec2f &scissor_max,
+                         std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<Pixel>> &color_buffer,
+                         RasterStats &stats, Shader shade)
+  {
+    constexpr int N = V::COUNT;
+    constexpr bool FIXED_POINT = std::is_invocable_v<Shader, const Vec3f &, const int *>;
+
+    if (polygon.count < 3)
+      return;
+
+    // Preparação dos vértices (1/w e atributo/w)
+    RasterVertex<N> vertexes[MAX_CLIP_VERTEXES];
+    float top, bottom;
+    prepare_raster_vertexes(polygon, vertexes, top, bottom);
+
+    // Contadores locais (o buffer de cores pode ser de bytes, que podem apontar para qualquer objeto,
+    // então incrementar stats dentro do laço obrigaria o compilador a relê-lo a cada pixel)
+    int tested = 0;
+    int shaded = 0;
+
+    // Scissor em Y
+    int y_begin = std::max(static_cast<int>(ceilf(top)), static_cast<int>(scissor_min.y));
+    int y_end = std::min(static_cast<int>(ceilf(bottom)) - 1, static_cast<int>(scissor_max.y));
+
+    for (int y = y_begin; y <= y_end; y++)
+    {
+      float sample_y = static_cast<float>(y);
+
+      RasterVertex<N> span[2];
+      if (!scanline_span(vertexes, polygon.count, sample_y, span))
+        continue;
+
+      const RasterVertex<N> &left = span[0];
+      const RasterVertex<N> &right = span[1];
+
+      float dx = right.x - left.x;
+      if (dx <= 0.0f)
+        continue;
+
+      // Scissor em X
+      int x_begin = std::max(static_cast<int>(ceilf(left.x)), static_cast<int>(scissor_min.x));
+      int x_end = std::min(static_cast<int>(ceilf(right.x)) - 1, static_cast<int>(scissor_max.x));
+
+      if (x_end < x_begin)
+        continue;
+
+      tested += x_end - x_begin + 1;
+
+      // Gradientes em X (lineares no espaço de tela)
+      float d_inv_w = (right.inv_w - left.inv_w) / dx;
+      std::array<float, N> d_attributes_w;
+      for (int k = 0; k < N; k++)
+        d_attributes_w[k] = (right.attributes[k] - left.attributes[k]) / dx;
+
+      // Valores no primeiro pixel
+      float skip = static_cast<float>(x_begin) - left.x;
+      float inv_w = left.inv_w + skip * d_inv_w;
+
+      std::array<float, N> attributes_w;
+      std::array<float, N> attributes;
+      std::array<float, N> step;
+
+      if constexpr (N > 0)
+      {
+        float w = 1.0f / inv_w;
+        for (int k = 0; k < N; k++)
+        {
+          attributes_w[k] = left.attributes[k] + skip * d_attributes_w[k];
+          attributes[k] = attributes_w[k] * w;
+        }
+      }
+
+      int x = x_begin;
+      while (x <= x_end)
+      {
+        int run = std::min(SPAN_SUBDIVISION, x_end - x + 1);
+        float end_inv_w = inv_w + d_inv_w * run;
+
+        // Divisão exata no fim do segmento, os passos dentro dele são afins
+        if constexpr (N > 0)
+        {
+          float end_w = 1.0f / end_inv_w;
+          for (int k = 0; k < N; k++)
+          {
+            attributes_w[k] += d_attributes_w[k] * run;
+            step[k] = (attributes_w[k] * end_w - attributes[k]) / run;
+          }
+        }
+
+        if constexpr (FIXED_POINT)
+        {
+          // Conversão para ponto fixo uma vez por segmento, dentro dele os passos são inteiros
+          const float scale = static_cast<float>(1 << RASTER_FIXED_BITS);
+          std::array<int, N> fixed;
+          std::array<int, N> fixed_step;
+          for (int k = 0; k < N; k++)
+          {
+            fixed[k] = static_cast<int>(attributes[k] * scale);
+            fixed_step[k] = static_cast<int>(step[k] * scale);
+            attributes[k] += step[k] * run;
+          }
+
+          for (int i = 0; i < run; i++, x++)
+          {
+            float &depth = z_buffer[x][y];
+
+            if (inv_w >= depth)
+            {
+              color_buffer[x][y] = shade(Vec3f{static_cast<float>(x), sample_y, inv_w}, fixed.data());
+              depth = inv_w;
+              shaded++;
+            }
+
+            inv_w += d_inv_w;
+            for (int k = 0; k < N; k++)
+              fixed[k] += fixed_step[k];
+          }
+        }
+        else
+        {
+          for (int i = 0; i < run; i++, x++)
+          {
+            float &depth = z_buffer[x][y];
+
+            if (inv_w >= depth)
+            {
+              color_buffer[x][y] = shade(Vec3f{static_cast<float>(x), sample_y, inv_w}, attributes.data());
+              depth = inv_w;
+              shaded++;
+            }
+
+            inv_w += d_inv_w;
+            for (int k = 0; k < N; k++)
+              attributes[k] += step[k];
+          }
+        }
+
+        inv_w = end_inv_w;
+      }
+    }
+
+    stats.tested += tested;
+    stats.shaded += shaded;
+  }
+
+  /**
+   * @brief Rasteriza apenas a profundidade de um polígono (pré-passo de profundidade)
+   *
+   * @param polygon Polígono em coordenadas de tela (qualquer vértice de recorte, os atributos são ignorados)
+   * @param scissor_min Canto inferior esquerdo da viewport
+   * @param scissor_max Canto superior direito da viewport
+   * @param z_buffer Buffer de profundidade (1/w, o maior valor está mais perto)
+   * @param stats Contadores (pixels rasterizados pelo pré-passo)
+   *
+   * @note Percorre os pixels exatamente como rasterize_polygon (mesmas arestas, mesmos segmentos e as mesmas
+   *       somas de 1/w), sem atributos, sem divisões por pixel e sem buffer de cores
+   */
+  template <typename V>
+  void rasterize_depth(const ClipPolygon<V> &polygon, const Vec2f &scissor_min, const Vec2f &scissor_max,
+                       std::vector<std::vector<float>> &z_buffer, RasterStats &stats)
+  {
+    if (polygon.count < 3)
+      return;
+
+    RasterVertex<0> vertexes[MAX_CLIP_VERTEXES];
+    float top, bottom;
+    prepare_raster_vertexes(polygon, vertexes, top, bottom);
+
+    int written = 0;
+
+    int y_begin = std::max(static_cast<int>(ceilf(top)), static_cast<int>(scissor_min.y));
+    int y_end = std::min(static_cast<int>(ceilf(bottom)) - 1, static_cast<int>(scissor_max.y));
+
+    for (int y = y_begin; y <= y_end; y++)
+    {
+      RasterVertex<0> span[2];
+      if (!scanline_span(vertexes, polygon.count, static_cast<float>(y), span))
+        continue;
+
+      const RasterVertex<0> &left = span[0];
+      const RasterVertex<0> &right = span[1];
+
+      float dx = right.x - left.x;
+      if (dx <= 0.0f)
+        continue;
+
+      int x_begin = std::max(static_cast<int>(ceilf(left.x)), static_cast<int>(scissor_min.x));
+      int x_end = std::min(static_cast<int>(ceilf(right.x)) - 1, static_cast<int>(scissor_max.x));
+
+      if (x_end < x_begin)
+        continue;
+
+      written += x_end - x_begin + 1;
+
+      float d_inv_w = (right.inv_w - left.inv_w) / dx;
+      float inv_w = left.inv_w + (static_cast<float>(x_begin) - left.x) * d_inv_w;
+
+      // Os segmentos só existem para reproduzir o 1/w de rasterize_polygon (que é reiniciado no fim de cada um)
+      int x = x_begin;
+      while (x <= x_end)
+      {
+        int run = std::min(SPAN_SUBDIVISION, x_end - x + 1);
+        float end_inv_w = inv_w + d_inv_w * run;
+
+        for (int i = 0; i < run; i++, x++)
+        {
+          float &depth = z_buffer[x][y];
+          depth = std::max(depth, inv_w);
+          inv_w += d_inv_w;
+        }
+
+        inv_w = end_inv_w;
+      }
+    }
+
+    stats.depth_tested += written;
+  }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <core/types.hpp>
+#include <models/color.hpp>
+#include <models/common.hpp>
+#include <models/light.hpp>
+#include <rendering/rasterizer.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace pipeline
+{
+  // Bits do triângulo no id do visibility buffer (os 12 bits restantes são o objeto)
+  constexpr int VISIBILITY_TRIANGLE_BITS = 20;
+  constexpr std::uint32_t VISIBILITY_TRIANGLE_MASK = (1u << VISIBILITY_TRIANGLE_BITS) - 1u;
+  // Objetos endereçáveis pelo id (o último valor é reservado para VISIBILITY_EMPTY)
+  constexpr std::uint32_t VISIBILITY_MAX_OBJECTS = (1u << (32 - VISIBILITY_TRIANGLE_BITS)) - 1u;
+  // Pixel sem geometria
+  constexpr std::uint32_t VISIBILITY_EMPTY = 0xFFFFFFFFu;
+
+  // Lado dos blocos da resolução (cada thread resolve um bloco por vez)
+  constexpr int VISIBILITY_TILE_SIZE = 32;
+
+  // Id de 32 bits de um triângulo: objeto [31..20], triângulo da malha [19..0]
+  constexpr std::uint32_t visibility_id(int object, int triangle)
+  {
+    return (static_cast<std::uint32_t>(object) << VISIBILITY_TRIANGLE_BITS) | static_cast<std::uint32_t>(triangle);
+  }
+  constexpr int visibility_object(std::uint32_t id) { return static_cast<int>(id >> VISIBILITY_TRIANGLE_BITS); }
+  constexpr int visibility_triangle(std::uint32_t id) { return static_cast<int>(id & VISIBILITY_TRIANGLE_MASK); }
+
+  /**
+   * @brief Triângulo gravado para a resolução do visibility buffer
+   *
+   * @note Os cantos ficam em coordenadas homogêneas de tela (x * w, y * w, w), assim as baricêntricas com
+   *       correção de perspectiva são recuperadas mesmo quando um dos cantos está atrás do plano near
+   */
+  struct VisibilityTriangle
+  {
+    Vec3f position[3];
+    // Normais dos cantos no SRU
+    Vec3f normal[3];
+  };
+
+  /**
+   * @brief Objeto desenhado no visibility buffer
+   */
+  struct VisibilityObject
+  {
+    // Triângulos na ordem do leque das faces da malha (o índice é o triângulo do id)
+    std::vector<VisibilityTriangle> triangles;
+
+    const models::Material *material = nullptr;
+    // Centroide do objeto no SRU
+    Vec3f centroid;
+  };
+
+  // Inversa da matriz dos cantos homogêneos de um triângulo (calculada uma vez por triângulo)
+  struct VisibilityPlanes
+  {
+    Vec3f rows[3];
+    bool valid;
+  };
+
+  VisibilityPlanes visibility_planes(const VisibilityTriangle &triangle);
+  // Baricêntricas (com correção de perspectiva) e 1/w de um pixel dentro de um triângulo gravado
+  bool visibility_barycentrics(const VisibilityPlanes &planes, float x, float y, Vec3f &weights, float &inv_w);
+
+  // Sombreia cada pixel do visibility buffer uma única vez (em paralelo, por blocos)
+  void resolve_visibility(const std::vector<std::vector<std::uint32_t>> &id_buffer, const std::vector<VisibilityObject> &objects,
+                          const Vec2f &scissor_min, const Vec2f &scissor_max,
+                          const models::GlobalLight &global_light, const std::vector<models::Omni> &omni_lights, const Vec3f &eye,
+                          std::vector<std::vector<models::Color>> &color_buffer, RasterStats &stats);
+}
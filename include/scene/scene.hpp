@@ -6,10 +6,14 @@
 #include <models/light.hpp>
 // Objetos
 #include <models/mesh.hpp>
+#include <models/mesh_instance.hpp>
+#include <scene/scene_graph.hpp>
 // Jogador
 #include <entities/player.hpp>
 // Pipeline de visualização
 #include <rendering/pipeline.hpp>
+#include <rendering/command_list.hpp>
+#include <rendering/visibility.hpp>
 #include <math/math.hpp>
 
 class Scene
@@ -22,11 +26,21 @@ public:
     GOURAUD,
     PHONG,
     TEXTURED,
-    NO_ILLUMINATION
+    NO_ILLUMINATION,
+    VISIBILITY // Visibility buffer: a rasterização grava só profundidade e id, cada pixel é sombreado (phong) uma vez depois
   };
 
-  // Vetor que contém todos os objetos da cena
-  std::vector<Mesh *> objects;
+  // Vetor que contém todos os objetos (instâncias) da cena
+  std::vector<MeshInstance *> objects;
+
+  // Malhas únicas da cena (compartilhadas pelas instâncias)
+  std::vector<MeshAsset *> assets;
+
+  // Texturas da cena (cada arquivo é carregado uma única vez)
+  models::TextureManager textures;
+
+  // Hierarquia de transformações (as instâncias ligadas a nós recebem a matriz global do nó)
+  SceneGraph graph;
 
   // Informações do jogador
   Player *player;
@@ -43,12 +57,50 @@ public:
   // Coordenadas máximas da janela de visualização
   Vec2f max_window;
 
+  // Matriz SRU -> SRT (SRC_TO_SRT * Projeção * SRU_TO_SRC)
+  // Calculada uma única vez por quadro e combinada com a matriz de modelo de cada instância
+  Matrix view_projection;
+
+  // Tamanho da guard band em relação à viewport (entre 2 e 4 vezes)
+  float guard_band_scale = 2.0f;
+
+  // Viewport, guard band e plano near do quadro
+  pipeline::ClipWindow clip_window;
+
+  // Contadores do recorte de triângulos do último quadro
+  pipeline::ClipStats clip_stats;
+  // Contadores de pixels testados, sombreados e visíveis do último quadro
+  pipeline::RasterStats raster_stats;
+
+  // Lista de comandos do quadro (gravada por instância, ordenada pela chave e então executada)
+  pipeline::CommandList commands;
+  // Listas de cada thread da gravação (reaproveitadas entre os quadros)
+  std::vector<pipeline::CommandList> recording_lists;
+  // Ordem de execução dos comandos
+  pipeline::CommandOrder command_order = pipeline::CommandOrder::STATE;
+  // Grava instâncias de malhas diferentes em threads diferentes
+  bool parallel_recording = true;
+  // Resolve a profundidade de todos os polígonos antes de sombrear (cada pixel é sombreado uma vez)
+  bool depth_prepass = false;
+
   // Buffer de profundidade
   std::vector<std::vector<float>> z_buffer;
 
   // Buffer de cor
   std::vector<std::vector<models::Color>> color_buffer;
 
+  // Buffer de 8 bits (índices da paleta), usado no modo texturizado com a paleta ativa
+  std::vector<std::vector<models::Uint8>> index_buffer;
+
+  // Visibility buffer: id (objeto, triângulo) de cada pixel e os triângulos gravados de cada objeto no quadro
+  std::vector<std::vector<std::uint32_t>> id_buffer;
+  std::vector<pipeline::VisibilityObject> visibility_objects;
+
+  // Paleta da cena e tabela de iluminação (refeitas quando uma malha nova entra na cena)
+  models::Palette palette;
+  models::Colormap colormap;
+  bool palette_dirty = true;
+
   // Lampadas omni na cena
   std::vector<models::Omni> omni_lights;
 
@@ -61,6 +113,15 @@ public:
   // Configurações de renderização
   IlluminationMode illumination_mode; // Define o tipo de shading
   bool wireframe = true;              // True = desenha apenas wireframe, False = faces preenchidas
+  pipeline::MipSelection mip_selection = pipeline::MipSelection::PER_SPAN; // Escolha do nível de mipmap no modo texturizado
+  pipeline::ShadingRate shading_rate = pipeline::ShadingRate::RATE_1X1;    // Granularidade da iluminação no modo phong
+  models::TextureLayout texture_layout = models::TextureLayout::ROW_MAJOR; // Ordem dos texels das texturas na memória
+  bool palettized = false;                                                 // Modo texturizado em 8 bits (paleta + colormap, estilo Quake)
+  // Formato das texturas na memória (BC1 ocupa 1/8 do RGBA)
+  models::TextureCompression texture_compression = models::TextureCompression::NONE;
+  // Vértices lidos do fluxo comprimido da malha (posições e UVs em 16 bits, normais octaédricas)
+  bool compressed_vertices = false;
+  models::NormalPrecision normal_precision = models::NormalPrecision::OCT16;
 
   // Construtor e destrutor
   Scene();
@@ -69,9 +130,21 @@ public:
   // Inicialização de buffers (executado no inicio da geração de quadros)
   void initialize_buffers();
 
+  // Verdadeiro se o quadro é rasterizado no buffer de 8 bits
+  bool indexed() const;
+
+  // Objeto (índice em objects) e triângulo da malha visíveis em um pixel (apenas no modo VISIBILITY)
+  bool pick(int x, int y, int &object, int &triangle) const;
+
+  // Gera a paleta e o colormap e quantiza as texturas das malhas
+  void build_palette();
+
   // Funções para gerencia da cena
   void add_objects(Mesh *object);
-  void remove_object(Mesh *object);
+  MeshInstance *add_instance(MeshAsset *asset, const Matrix &model = Matrix(), std::string id = "");
+  void remove_object(MeshInstance *object);
+  SceneGraph::NodeHandle add_node(SceneGraph::NodeHandle parent, const Matrix &local, MeshAsset *asset = nullptr, std::string id = "");
+  void remove_node(SceneGraph::NodeHandle node);
 
   // Pipeline de visualização
 
@@ -80,17 +153,43 @@ public:
   // devido a ele não ter o volume de visualização normalizado
   void clipping();
 
+  // Atualiza a matriz SRU -> SRT cacheada (view_projection)
+  void update_view_projection();
+
+  // Atualiza a viewport, a guard band e o plano near usados no recorte (clip_window)
+  void update_clip_window();
+
+  // Leva os vértices da malha da instância para o SRT e determina a visibilidade das faces
+  void project_instance(MeshInstance *object);
+
   // Determina qual função de pipeline aplicar e se vai ou não desenhar o wireframe
   void apply_pipeline();
 
-  // aplica o pipeline com o sombreamento flat
-  void apply_pipeline_flat();
-  // aplica o pipeline com o sombreamento gouraud
-  void apply_pipeline_gouraud();
-  // aplica o pipeline com o sombreamento phong
-  void apply_pipeline_phong();
-  // aplica o pipeline com as texturas
-  void apply_pipeline_texture();
+  // Prepara as texturas das instâncias visíveis (os recursos compartilhados mudam antes da gravação)
+  void prepare_instance(MeshInstance *object);
+
+  // Projeta a instância e grava os comandos do modo de iluminação atual
+  void record_instance(MeshInstance *object, int index, pipeline::CommandList &list);
+
+  // grava os comandos do sombreamento flat
+  void record_flat(MeshInstance *object, pipeline::CommandList &list);
+  // grava os comandos do sombreamento gouraud
+  void record_gouraud(MeshInstance *object, pipeline::CommandList &list);
+  // grava os comandos do sombreamento phong
+  void record_phong(MeshInstance *object, pipeline::CommandList &list);
+  // grava os comandos com as texturas
+  void record_texture(MeshInstance *object, pipeline::CommandList &list);
+  // grava os comandos sem iluminação (cores por canto)
+  void record_colors(MeshInstance *object, pipeline::CommandList &list);
+  // grava as arestas das faces visíveis
+  void record_wireframe(MeshInstance *object, pipeline::CommandList &list);
+  // grava os triângulos no visibility buffer (index é o objeto do id)
+  void record_visibility(MeshInstance *object, int index, pipeline::CommandList &list);
+
+  // Executa os comandos do quadro (já ordenados)
+  void execute_commands();
+  // Executa apenas as linhas (no modo VISIBILITY elas são desenhadas depois da resolução)
+  void execute_lines();
 
   // Colisão
   bool checkPlayerCollision(const Vec3f &newPos);
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <core/types.hpp>
+#include <math/math.hpp>
+#include <models/mesh_instance.hpp>
+
+#include <vector>
+#include <string>
+
+/**
+ * @brief Nó do grafo de cena
+ *
+ * @note Os nós ficam em um vetor contínuo na ordem de uma busca em profundidade (pré-ordem),
+ *       assim o pai sempre aparece antes dos filhos e uma subárvore ocupa um intervalo contínuo
+ */
+struct SceneNode
+{
+  // Transformação local (SRO -> sistema do pai)
+  Matrix local;
+
+  // Transformação global (SRO -> SRU)
+  Matrix world;
+
+  // Índice do pai no vetor de nós (-1 para os nós raiz)
+  int parent;
+
+  // Número de nós da subárvore, incluindo o próprio nó
+  int subtree_size;
+
+  // A transformação local mudou e a subárvore precisa ser recalculada
+  bool dirty;
+
+  // Algum descendente está sujo (permite pular subárvores limpas)
+  bool child_dirty;
+
+  // Instância associada ao nó (opcional, não pertence ao nó)
+  MeshInstance *instance;
+
+  // Id
+  std::string id;
+};
+
+class SceneGraph
+{
+public:
+  // Identificador estável de um nó (os índices mudam quando nós são inseridos ou removidos)
+  typedef int NodeHandle;
+
+  static constexpr NodeHandle NO_PARENT = -1;
+  static constexpr NodeHandle INVALID_NODE = -2; // Retornado por add_node quando o pai não existe mais
+
+  // true se o handle aponta para um nó que ainda está no grafo
+  bool valid(NodeHandle node) const { return node >= 0 && node < static_cast<NodeHandle>(handle_to_index.size()) && handle_to_index[node] >= 0; }
+
+  // Nós em pré-ordem
+  std::vector<SceneNode> nodes;
+
+  // Número de nós recalculados na última atualização
+  int updated_nodes = 0;
+
+  // Funções para gerencia do grafo
+  NodeHandle add_node(NodeHandle parent, const Matrix &local, MeshInstance *instance = nullptr, std::string id = "");
+  void remove_node(NodeHandle node, std::vector<MeshInstance *> *instances = nullptr);
+  void detach_instance(const MeshInstance *instance);
+
+  void set_local(NodeHandle node, const Matrix &local);
+  const Matrix &get_local(NodeHandle node) const;
+  const Matrix &get_world(NodeHandle node) const;
+  SceneNode &get_node(NodeHandle node);
+
+  // Recalcula as matrizes globais das subárvores sujas
+  void update();
+
+private:
+  // handle -> índice no vetor de nós (-1 se o nó foi removido)
+  std::vector<int> handle_to_index;
+
+  // índice no vetor de nós -> handle
+  std::vector<NodeHandle> index_to_handle;
+
+  void mark_ancestors(int index);
+};
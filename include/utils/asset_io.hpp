@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace io
+{
+  // Ordem de atendimento dos pedidos na fila (pedidos da mesma prioridade saem na ordem de chegada)
+  enum class Priority
+  {
+    HIGH,   // Conteúdo que falta na tela (ex.: primeiro nível de uma textura)
+    NORMAL, // Refinamentos (níveis mais finos, LOD)
+    LOW     // Pré-carregamento
+  };
+
+  // Thread que executa o callback de um pedido concluído
+  enum class Delivery
+  {
+    WORKER,     // Threads do sistema de jobs (decodificação fora da thread principal)
+    MAIN_THREAD // Thread principal, dentro de AssetIO::pump
+  };
+
+  using RequestId = std::uint64_t;
+
+  // Resultado de uma leitura: o trecho pedido do arquivo (ou o arquivo inteiro) em [data, data + size)
+  // Como pak::File: data aponta para storage ou, nas entradas sem compressão de um pacote montado, direto para o
+  // pacote mapeado (válido enquanto o programa rodar, os pacotes não são desmontados)
+  struct ReadResult
+  {
+    RequestId id = 0;
+    std::string path;
+    const std::uint8_t *data = nullptr;
+    std::size_t size = 0;
+    std::vector<std::uint8_t> storage;
+    bool ok = false;
+    std::string error; // Mensagem quando ok = false
+  };
+
+  // O callback pode mover o conteúdo de storage (data continua apontando para os mesmos bytes)
+  using Callback = std::function<void(ReadResult &)>;
+
+  /**
+   * @brief Leitura assíncrona de arquivos de assets
+   *
+   * @note No Linux as leituras são feitas com io_uring: uma thread mantém até QUEUE_DEPTH leituras em andamento
+   *       no kernel e é acordada tanto pelas conclusões quanto por pedidos novos (eventfd na mesma fila)
+   * @note Sem io_uring (outros sistemas, kernel antigo ou syscall bloqueada), as threads do sistema de jobs fazem
+   *       as leituras com pread. O mesmo acontece se o io_uring_enter passar a falhar seguidamente
+   * @note Arquivos de pacotes montados (pak::mount) não passam pelo disco: as threads de jobs entregam uma vista
+   *       da entrada no pacote mapeado (sem cópia) ou descomprimem a entrada
+   * @note Pedidos de prioridade maior passam na frente dos que ainda não começaram
+   * @note Um pedido cancelado nunca chama o callback. Se a leitura já estiver no kernel, ela termina e o
+   *       resultado é descartado
+   */
+  class AssetIO
+  {
+  public:
+    static constexpr unsigned QUEUE_DEPTH = 32;
+
+    // use_io_uring = false força o backend com pread
+    explicit AssetIO(bool use_io_uring = true);
+    ~AssetIO();
+
+    AssetIO(const AssetIO &) = delete;
+    AssetIO &operator=(const AssetIO &) = delete;
+
+    // Pede a leitura do arquivo inteiro (retorna na hora, o callback é chamado na thread escolhida por delivery)
+    RequestId read(const std::string &path, Callback callback, Priority priority = Priority::NORMAL, Delivery delivery = Delivery::WORKER);
+
+    // Pede a leitura de size bytes a partir de offset (size = 0 lê até o fim do arquivo)
+    // Um trecho que passa do fim do arquivo é um erro
+    RequestId read(const std::string &path, std::size_t offset, std::size_t size, Callback callback, Priority priority = Priority::NORMAL,
+                   Delivery delivery = Delivery::WORKER);
+
+    // Lê o arquivo inteiro e espera o resultado (carregamentos síncronos, ex.: malhas na inicialização)
+    // Não deve ser chamado dentro de um callback: a thread de jobs ficaria esperando por ela mesma
+    ReadResult readBlocking(const std::string &path, Priority priority = Priority::HIGH);
+
+    // Cancela um pedido. Retorna true se o callback não vai ser chamado (false se já foi ou está sendo chamado)
+    bool cancel(RequestId id);
+
+    // Executa os callbacks com entrega na thread principal (uma vez por quadro). Retorna quantos foram executados
+    int pump();
+
+    // Pedidos na fila, em leitura ou aguardando o callback
+    int pending();
+
+    bool usingIoUring() const { return ring_active; }
+
+  private:
+    struct Request
+    {
+      RequestId id;
+      std::string path;
+      Callback callback;
+      Delivery delivery;
+      std::size_t offset; // Trecho do arquivo (size = 0 = até o fim)
+      std::size_t size;
+    };
+
+    struct Completion
+    {
+      Callback callback;
+      ReadResult result;
+    };
+
+    struct InFlight;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Request> queues[3];             // Um por prioridade
+    std::deque<Request> archived;              // Arquivos de pacotes montados (lidos pelas threads de jobs)
+    std::deque<Completion> worker_completions; // Callbacks para as threads de jobs
+    std::deque<Completion> main_completions;   // Callbacks para pump()
+    std::unordered_set<RequestId> active;      // Pedidos cujo callback ainda vai ser chamado
+    RequestId next_id = 1;
+    bool stopping = false;
+
+    std::vector<std::thread> workers;
+
+    // Backend io_uring (ring_fd < 0 = desativado)
+    // ring_active fica falso quando o anel é abandonado depois de falhas seguidas (as leituras passam para pread)
+    static constexpr int RING_MAX_FAILURES = 8;
+    std::atomic<bool> ring_active{false};
+    int ring_fd = -1;
+    int event_fd = -1;
+    std::thread ring_thread;
+    struct Ring;
+    std::unique_ptr<Ring> ring;
+
+    bool open_ring();
+    void close_ring();
+    bool next_request(Request &request);
+    void complete(Request &request, ReadResult &result);
+    void work();
+    void run_ring();
+    void abandon_ring(unsigned &in_flight);
+    void notify_ring();
+  };
+
+  // Instância usada pelos carregadores do motor
+  AssetIO &shared();
+}
@@ -1,4 +1,6 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <stdexcept>
@@ -15,6 +17,52 @@ struct BMPImage
 
 namespace bmp
 {
+  // Arquivo mapeado em memória (somente leitura)
+  // O conteúdo é lido direto das páginas do arquivo, sem cópia para um buffer intermediário
+  class MappedFile
+  {
+  public:
+    explicit MappedFile(const std::string &filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const std::uint8_t *data() const { return bytes; }
+    std::size_t size() const { return length; }
+
+  private:
+    const std::uint8_t *bytes = nullptr;
+    std::size_t length = 0;
+#ifdef _WIN32
+    void *file_handle = nullptr;
+    void *mapping_handle = nullptr;
+#endif
+  };
+
+  // Informações do cabeçalho de um BMP sem compressão
+  struct Header
+  {
+    int width = 0;
+    int height = 0;
+    int bits_per_pixel = 0;
+    bool alpha = false;                    // 32 bits com máscara de alpha (nos outros casos o alpha é 255)
+    bool top_down = false;                 // Linhas gravadas de cima para baixo (altura negativa no arquivo)
+    std::size_t pixel_offset = 0;          // Início das linhas no arquivo
+    std::size_t stride = 0;                // Bytes por linha (múltiplo de 4)
+    const std::uint8_t *palette = nullptr; // Paleta BGRA (apenas 8 bits por pixel)
+    int palette_size = 0;
+  };
+
+  // Lê e valida o cabeçalho (lança std::runtime_error em formatos não suportados)
+  Header parse(const std::uint8_t *data, std::size_t size);
+  inline Header parse(const MappedFile &file) { return parse(file.data(), file.size()); }
+
+  // Decodifica os pixels para RGBA, linha 0 = topo da imagem
+  // pitch = número de Colors entre o início de duas linhas de destino
+  void decode(const std::uint8_t *data, std::size_t size, const Header &header, models::Color *destination, std::size_t pitch);
+  inline void decode(const MappedFile &file, const Header &header, models::Color *destination, std::size_t pitch) { decode(file.data(), file.size(), header, destination, pitch); }
+
   BMPImage load(const std::string &filename);
   SDL_Texture *createTextureFromBMP(SDL_Renderer *renderer, const BMPImage &img);
 }
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <utils/bmp_reader.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pak
+{
+  // Formato do pacote (.pak): cabeçalho, dados das entradas (alinhados em 64 bytes), diretório e nomes
+  // Sem ponteiros: todas as posições são offsets a partir do início do arquivo
+  constexpr std::uint32_t VERSION = 1;
+  constexpr std::size_t ALIGNMENT = 64;
+  constexpr std::size_t CHUNK_SIZE = 64 * 1024; // Bloco descomprimido de uma entrada LZ4
+
+  struct Header
+  {
+    char magic[4]; // "PAK1"
+    std::uint32_t version;
+    std::uint32_t entry_count;
+    std::uint32_t reserved;
+    std::uint64_t directory_offset;
+    std::uint64_t names_offset;
+  };
+
+  enum class Compression : std::uint32_t
+  {
+    NONE, // Conteúdo gravado como está (lido sem cópia)
+    LZ4   // Blocos LZ4 independentes de CHUNK_SIZE bytes, precedidos da tabela com o tamanho de cada bloco
+  };
+
+  // Entrada do diretório (64 bytes), ordenada por (hash, nome)
+  struct Entry
+  {
+    std::uint64_t hash;          // FNV-1a do nome
+    std::uint64_t offset;        // Início dos dados (múltiplo de ALIGNMENT)
+    std::uint64_t size;          // Bytes gravados
+    std::uint64_t original_size; // Bytes depois da descompressão
+    std::uint32_t name_offset;   // Posição do nome na tabela de nomes
+    std::uint32_t name_length;
+    Compression compression;
+    std::uint32_t chunk_count;
+    std::uint8_t reserved[16];
+  };
+
+  static_assert(sizeof(Header) == 32, "O cabeçalho do pacote deve ter 32 bytes");
+  static_assert(sizeof(Entry) == 64, "A entrada do diretório deve ter 64 bytes");
+
+  // Conteúdo de uma entrada: aponta para o arquivo mapeado ou para storage (entradas comprimidas)
+  struct File
+  {
+    const std::uint8_t *data = nullptr;
+    std::size_t size = 0;
+    std::vector<std::uint8_t> storage;
+  };
+
+  /**
+   * @brief Pacote de assets mapeado em memória
+   *
+   * @note Abrir o pacote é um mmap e a validação do cabeçalho: o diretório é usado direto do arquivo
+   * @note A busca é uma busca binária pelo hash do nome (os nomes só são comparados entre hashes iguais)
+   */
+  class Archive
+  {
+  public:
+    // Lança std::runtime_error se o arquivo não for um pacote válido
+    explicit Archive(const std::string &filename);
+
+    Archive(const Archive &) = delete;
+    Archive &operator=(const Archive &) = delete;
+
+    // Entrada com o nome (relativo ao pacote, separado por '/'), ou nullptr
+    const Entry *find(std::string_view name) const;
+
+    // Lê uma entrada (sem cópia quando não é comprimida). Entradas grandes são descomprimidas em paralelo
+    bool read(const Entry &entry, File &file) const;
+
+    std::string_view name(const Entry &entry) const;
+    const Entry *begin() const { return entries; }
+    const Entry *end() const { return entries + count; }
+    std::size_t size() const { return count; }
+
+  private:
+    bmp::MappedFile mapped;
+    const Entry *entries = nullptr;
+    const char *names = nullptr;
+    std::size_t names_size = 0;
+    std::size_t count = 0;
+  };
+
+  // Hash dos nomes no diretório
+  std::uint64_t hash(std::string_view name);
+
+  // Gera um pacote com os arquivos root/names[i] (compress = LZ4 nas entradas que diminuem)
+  bool build(const std::string &filename, const std::string &root, const std::vector<std::string> &names, bool compress);
+
+  // Pacotes montados: substituem os arquivos soltos do diretório onde estão ("../assets/assets.pak" responde
+  // por "../assets/*"). Montados na inicialização, antes de qualquer carregamento (a busca não tem trava)
+  bool mount(const std::string &filename);
+  bool contains(const std::string &path);
+  bool open(const std::string &path, File &file);
+}
@@ -1,6 +1,8 @@
 #include <core/game.hpp>
 
+#include <utils/asset_io.hpp>
 #include <utils/bmp_reader.hpp>
+#include <utils/pak.hpp>
 
 #include "../models/cube.cpp"
 #include "../models/ground.cpp"
@@ -66,6 +68,9 @@ bool Game::initialize()
 
   isRunning = true;
 
+  // Pacote de assets (opcional): os caminhos "../assets/*" passam a ser lidos dele
+  pak::mount("../assets/assets.pak");
+
   // Inicializa a cena
   scene = std::make_unique<Scene>();
 
@@ -82,7 +87,9 @@ bool Game::initialize()
   player.position = {0.f, 0.f, 20.0f};
   player.target = {0.0f, 0.0f, -1.0f};
 
-  scene->add_objects(cube(Vec3f(), "../assets/redbrick.bmp"));
+  // A malha do cubo é criada uma única vez e posicionada através de instâncias
+  MeshAsset *crate = cube(scene->textures, "../assets/redbrick.bmp");
+  scene->add_node(SceneGraph::NO_PARENT, pipeline::model_to_sru(Vec3f(0.0f, 0.0f, 0.0f)), crate, "crate_0");
   // scene->add_objects(ground(3.0f, -3.0f));
 
   scene->wireframe = true;
@@ -263,7 +270,7 @@ void Game::render()
 
     // Seleção de iluminação
     ImGui::Text("Iluminação:");
-    const char *illum_modes[] = {"FLAT", "GOURAUD", "PHONG", "TEXTURED", "NO ILLUMINATION"};
+    const char *illum_modes[] = {"FLAT", "GOURAUD", "PHONG", "TEXTURED", "NO ILLUMINATION", "VISIBILITY BUFFER"};
     static int current_mode = static_cast<int>(scene->illumination_mode);
     if (ImGui::Combo("Mode", &current_mode, illum_modes, IM_ARRAYSIZE(illum_modes)))
     {
@@ -272,6 +279,136 @@ void Game::render()
 
     ImGui::Checkbox("Wireframe", &scene->wireframe);
 
+    // Seleção do nível de mipmap (modo texturizado)
+    const char *mip_modes[] = {"NONE", "PER POLYGON", "PER SPAN"};
+    int current_mip = static_cast<int>(scene->mip_selection);
+    if (ImGui::Combo("Mipmap", &current_mip, mip_modes, IM_ARRAYSIZE(mip_modes)))
+    {
+      scene->mip_selection = static_cast<pipeline::MipSelection>(current_mip);
+    }
+
+    // Granularidade da iluminação (modo phong)
+    const char *shading_rates[] = {"1X1", "2X2", "4X4", "ADAPTIVE"};
+    int current_rate = static_cast<int>(scene->shading_rate);
+    if (ImGui::Combo("Taxa phong", &current_rate, shading_rates, IM_ARRAYSIZE(shading_rates)))
+    {
+      scene->shading_rate = static_cast<pipeline::ShadingRate>(current_rate);
+    }
+
+    // Layout das texturas na memória
+    const char *texture_layouts[] = {"ROW MAJOR", "TILED 4X4", "TILED 8X8"};
+    int current_layout = static_cast<int>(scene->texture_layout);
+    if (ImGui::Combo("Texel layout", &current_layout, texture_layouts, IM_ARRAYSIZE(texture_layouts)))
+    {
+      scene->texture_layout = static_cast<models::TextureLayout>(current_layout);
+    }
+
+    // Formato das texturas: RGBA (leitura direta) ou BC1 (1/8 da memória, compressão rápida ou de qualidade)
+    const char *texture_compressions[] = {"RGBA", "BC1 FAST", "BC1 HIGH"};
+    int current_compression = static_cast<int>(scene->texture_compression);
+    if (ImGui::Combo("Compressão", &current_compression, texture_compressions, IM_ARRAYSIZE(texture_compressions)))
+    {
+      scene->texture_compression = static_cast<models::TextureCompression>(current_compression);
+    }
+    ImGui::Text("Texturas: %d (%zu KB)", scene->textures.liveTextures(), scene->textures.liveBytes() / 1024);
+
+    // Cache de vértices: ACMR médio das malhas (ponderado pelos triângulos) antes e depois da reordenação
+    float acmr_before = 0.0f, acmr_after = 0.0f;
+    int layout_triangles = 0;
+    for (MeshAsset *asset : scene->assets)
+    {
+      acmr_before += asset->layout.acmr_before * asset->layout.triangles;
+      acmr_after += asset->layout.acmr_after * asset->layout.triangles;
+      layout_triangles += asset->layout.triangles;
+    }
+    if (layout_triangles > 0)
+      ImGui::Text("ACMR: %.2f -> %.2f", acmr_before / layout_triangles, acmr_after / layout_triangles);
+
+    // Fluxo de vértices comprimido: posições e UVs em 16 bits, normais octaédricas de 2x8 ou 2x16 bits
+    ImGui::Checkbox("Vértices comprimidos", &scene->compressed_vertices);
+    const char *normal_precisions[] = {"OCT 2X8", "OCT 2X16"};
+    int current_precision = static_cast<int>(scene->normal_precision);
+    if (ImGui::Combo("Normais", &current_precision, normal_precisions, IM_ARRAYSIZE(normal_precisions)))
+    {
+      scene->normal_precision = static_cast<models::NormalPrecision>(current_precision);
+    }
+    if (scene->compressed_vertices)
+    {
+      // Lido por quadro: o fluxo contra os mesmos atributos em float (sem os campos de tela e as ligações dos vértices)
+      // Memória: as posições em float continuam nos vértices, então a malha só perde as normais e UVs liberadas
+      std::size_t compressed_bytes = 0, float_bytes = 0;
+      std::ptrdiff_t resident_delta = 0;
+      for (MeshAsset *asset : scene->assets)
+      {
+        compressed_bytes += asset->compressed.bytes();
+        float_bytes += asset->compressed.floatBytes();
+        resident_delta += asset->compressed.residentDelta();
+      }
+      ImGui::Text("Lido por quadro: %zu B (float: %zu B, %.2fx)", compressed_bytes, float_bytes,
+                  compressed_bytes == 0 ? 0.0f : static_cast<float>(float_bytes) / compressed_bytes);
+      ImGui::Text("Memória das malhas: %+td B", resident_delta);
+    }
+
+    // Streaming das texturas: orçamento de memória e carregamentos pendentes
+    if (scene->textures.streaming)
+    {
+      models::TextureStreamer &streamer = scene->textures.streamer;
+      int budget_kb = static_cast<int>(streamer.budget / 1024);
+      if (ImGui::SliderInt("Orçamento (KB)", &budget_kb, 16, 64 * 1024, "%d", ImGuiSliderFlags_Logarithmic))
+      {
+        streamer.budget = static_cast<std::size_t>(budget_kb) * 1024;
+      }
+      ImGui::Text("Streaming: %zu KB, %d pendentes (%s)", streamer.residentBytes() / 1024, streamer.pending(),
+                  io::shared().usingIoUring() ? "io_uring" : "pread");
+    }
+
+    // Modo texturizado em 8 bits (paleta de 256 cores + colormap)
+    ImGui::Checkbox("8-bit (paleta)", &scene->palettized);
+
+    // Contadores do recorte (guard band)
+    ImGui::Separator();
+    ImGui::Text("Recorte:");
+    ImGui::SliderFloat("Guard band", &scene->guard_band_scale, 2.0f, 4.0f, "%.1fx");
+    const pipeline::ClipStats &stats = scene->clip_stats;
+    ImGui::Text("Triângulos: %d", stats.triangles);
+    ImGui::Text("Sem recorte: %.1f%%", stats.fast_path_ratio() * 100.0f);
+    ImGui::Text("Recortados: %d (near: %d)", stats.clipped, stats.near_clipped);
+    ImGui::Text("Descartados: %d", stats.rejected);
+
+    // Contadores da rasterização: pixels descartados pelo teste de profundidade e sombreamentos por pixel visível
+    const pipeline::RasterStats &raster = scene->raster_stats;
+    ImGui::Text("Pixels testados: %d, sombreados: %d", raster.tested, raster.shaded);
+    if (scene->depth_prepass)
+      ImGui::Text("Pré-passo: %d pixels", raster.depth_tested);
+    ImGui::Text("Descartados pela profundidade: %.1f%%", raster.rejected_ratio() * 100.0f);
+    ImGui::Text("Overdraw: %.2fx", raster.overdraw());
+    if (scene->illumination_mode == Scene::IlluminationMode::PHONG)
+      ImGui::Text("Iluminação (phong): %d avaliações", raster.lit);
+
+    // Visibility buffer: pixels sombreados na resolução e picking exato pelo id gravado no pixel do cursor
+    if (scene->illumination_mode == Scene::IlluminationMode::VISIBILITY)
+    {
+      ImGui::Text("Resolvidos: %d pixels", raster.resolved);
+      ImVec2 mouse = ImGui::GetIO().MousePos;
+      int picked_object, picked_triangle;
+      if (scene->pick(static_cast<int>(mouse.x), static_cast<int>(mouse.y), picked_object, picked_triangle))
+        ImGui::Text("Cursor: %s, triângulo %d", scene->objects[picked_object]->id.c_str(), picked_triangle);
+      else
+        ImGui::Text("Cursor: -");
+    }
+
+    // Lista de comandos: ordem de execução e gravação em paralelo
+    ImGui::Separator();
+    ImGui::Text("Comandos: %zu", scene->commands.size());
+    const char *command_orders[] = {"SUBMISSION", "STATE", "FRONT_TO_BACK"};
+    int current_order = static_cast<int>(scene->command_order);
+    if (ImGui::Combo("Ordem", &current_order, command_orders, IM_ARRAYSIZE(command_orders)))
+    {
+      scene->command_order = static_cast<pipeline::CommandOrder>(current_order);
+    }
+    ImGui::Checkbox("Gravação paralela", &scene->parallel_recording);
+    ImGui::Checkbox("Pré-passo de profundidade", &scene->depth_prepass);
+
     // ============================
     // Controles Arcball sem mouse (checkbox + valor fixo)
     // ============================
@@ -320,6 +457,9 @@ void Game::render()
 
 void Game::update()
 {
+  // Callbacks de leitura de assets entregues na thread principal
+  io::shared().pump();
+
   if (scene)
     scene->apply_pipeline();
 }
@@ -10,8 +10,11 @@ HalfEdge::HalfEdge()
   this->twin = nullptr;
   this->origin = nullptr;
   this->incident_face = nullptr;
+  this->index = -1;
 }
 
+HalfEdge::~HalfEdge() = default;
+
 /**
  * @brief Construtor da classe Face
  *
@@ -29,6 +32,8 @@ Face::Face()
   this->id = "";
 }
 
+Face::~Face() = default;
+
 /**
  * @brief Verifica se a face é visível
  *
@@ -118,8 +123,10 @@ Vertex::Vertex()
 {
   this->vertex = Vec4f();
   this->vertex_screen = Vec3f();
+  this->screen_w = 1.0f;
   this->clipped = false;
   this->incident_edge = nullptr;
+  this->index = -1;
   this->u = 0.0f;
   this->v = 0.0f;
   this->has_uv = false;
@@ -145,8 +152,10 @@ Vertex::Vertex(float x, float y, float z, float w, HalfEdge *half_edge, std::str
   vertex = {x, y, z, w};
   // 1.17549e-38 is the smallest positive float value
   vertex_screen = {1.17549e-38f, 1.17549e-38f, 1.17549e-38f};
+  screen_w = 1.0f;
   this->id = id;
   incident_edge = half_edge;
+  index = -1;
   normal = Vec3f();
   this->clipped = false;
   this->u = u_coord;
@@ -0,0 +1,586 @@
+#include <models/cooked_mesh.hpp>
+#include <models/vertex_cache.hpp>
+#include <math/math.hpp>
+#include <utils/asset_io.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace models
+{
+  static const char COOKED_MESH_MAGIC[4] = {'M', 'E', 'S', 'H'};
+  static constexpr std::size_t COOKED_ALIGNMENT = 64;
+
+  // Espalha os 10 bits baixos de value a cada 3 bits (código de Morton)
+  static std::uint32_t spread_bits(std::uint32_t value)
+  {
+    value &= 0x3ff;
+    value = (value | (value << 16)) & 0x030000ff;
+    value = (value | (value << 8)) & 0x0300f00f;
+    value = (value | (value << 4)) & 0x030c30c3;
+    value = (value | (value << 2)) & 0x09249249;
+    return value;
+  }
+
+  /**
+   * @brief Cozinha uma malha
+   *
+   * @param source Malha de entrada
+   * @param blob Recebe a malha cozida (mesmo conteúdo do arquivo .mesh)
+   * @param options Parâmetros do cozimento
+   * @param stats Recebe o resumo (opcional)
+   * @return true Se a malha foi gerada
+   *
+   * @note Etapas: une os vértices, descarta as faces degeneradas, calcula normais e centroides, ordena as faces
+   *       pela curva de Morton dos centroides (faces vizinhas no espaço ficam vizinhas na memória), refina a ordem
+   *       para o cache de vértices (Forsyth, mantida só se o ACMR melhorar), renumera os vértices na ordem do
+   *       primeiro uso e monta a half-edge (gêmeas procuradas entre as meias arestas que partem de cada vértice e
+   *       laços de borda com face = -1)
+   * @note A reordenação para o cache é a única etapa cara: ela fica no cozimento para que a carga não precise
+   *       refazê-la (Mesh::optimizeLayout só é usado nas malhas montadas em tempo de execução)
+   * @note Os cantos de cada face são meias arestas consecutivas, então os atributos por canto são lidos em sequência
+   * @note Todas as etapas são lineares e trabalham em vetores contínuos (nenhuma alocação por face)
+   * @note Um vértice pode ter várias meias arestas de borda partindo dele: cada uma é ligada a uma borda que
+   *       chega ao vértice, então todo laço fecha. A malha só é recusada quando a mesma aresta dirigida aparece
+   *       duas vezes (faces invertidas ou aresta com mais de duas faces) ou quando uma borda fica sem continuação
+   */
+  bool cookMesh(const MeshSource &source, std::vector<std::uint8_t> &blob, const CookOptions &options, CookStats *stats)
+  {
+    CookStats summary;
+    summary.source_vertices = static_cast<int>(source.positions.size());
+
+    int source_faces = source.faceCount();
+    if (source_faces > 0 && (source.face_starts.front() != 0 || source.face_starts.back() != static_cast<int>(source.corners.size())))
+    {
+      std::cerr << "Faces não cobrem os cantos da malha\n";
+      return false;
+    }
+
+    // União dos vértices (posições iguais, ou na mesma célula de weld_epsilon)
+    std::vector<int> weld(source.positions.size());
+    std::vector<Vec3f> welded;
+    if (!options.weld)
+    {
+      for (std::size_t i = 0; i < weld.size(); i++)
+        weld[i] = static_cast<int>(i);
+    }
+    else
+    {
+      struct KeyHash
+      {
+        std::size_t operator()(const std::array<std::int64_t, 3> &key) const
+        {
+          return static_cast<std::size_t>(key[0] * 73856093 ^ key[1] * 19349663 ^ key[2] * 83492791);
+        }
+      };
+
+      std::unordered_map<std::array<std::int64_t, 3>, int, KeyHash> cells;
+      cells.reserve(source.positions.size());
+
+      for (std::size_t i = 0; i < source.positions.size(); i++)
+      {
+        const Vec3f &p = source.positions[i];
+        std::array<std::int64_t, 3> key;
+        if (options.weld_epsilon > 0.0f)
+          key = {std::llround(p.x / options.weld_epsilon), std::llround(p.y / options.weld_epsilon), std::llround(p.z / options.weld_epsilon)};
+        else
+        {
+          // Bits do float (+0 e -0 são a mesma posição)
+          float coordinates[3] = {p.x + 0.0f, p.y + 0.0f, p.z + 0.0f};
+          for (int k = 0; k < 3; k++)
+          {
+            std::uint32_t bits;
+            std::memcpy(&bits, &coordinates[k], sizeof(bits));
+            key[k] = bits;
+          }
+        }
+
+        auto inserted = cells.emplace(key, static_cast<int>(welded.size()));
+        if (inserted.second)
+          welded.push_back(p);
+        weld[i] = inserted.first->second;
+      }
+    }
+
+    const std::vector<Vec3f> &points = options.weld ? welded : source.positions;
+
+    bool has_uvs = !source.uvs.empty() && source.uvs.size() == source.corners.size();
+    bool has_normals = !source.normals.empty() && source.normals.size() == source.corners.size();
+
+    // Faces depois da união (cantos repetidos em sequência são removidos)
+    std::vector<int> corners;
+    std::vector<int> starts = {0};
+    std::vector<Vec2f> uvs;
+    std::vector<Vec3f> normals;
+    std::vector<Vec3f> face_normals;
+    std::vector<Vec3f> centroids;
+    corners.reserve(source.corners.size());
+    starts.reserve(source_faces + 1);
+    face_normals.reserve(source_faces);
+    centroids.reserve(source_faces);
+    if (has_uvs)
+      uvs.reserve(source.corners.size());
+    if (has_normals)
+      normals.reserve(source.corners.size());
+
+    for (int f = 0; f < source_faces; f++)
+    {
+      std::size_t first = corners.size();
+
+      for (int k = source.face_starts[f]; k < source.face_starts[f + 1]; k++)
+      {
+        int index = source.corners[k];
+        if (index < 0 || static_cast<std::size_t>(index) >= weld.size())
+        {
+          std::cerr << "Índice de vértice inválido na face " << f << "\n";
+          return false;
+        }
+
+        int vertex = weld[index];
+        if (corners.size() > first && corners.back() == vertex)
+          continue;
+
+        corners.push_back(vertex);
+        if (has_uvs)
+          uvs.push_back(source.uvs[k]);
+        if (has_normals)
+          normals.push_back(source.normals[k]);
+      }
+
+      std::size_t count = corners.size() - first;
+      while (count > 1 && corners.back() == corners[first])
+      {
+        corners.pop_back();
+        count--;
+      }
+
+      if (count < 3)
+      {
+        corners.resize(first);
+        summary.dropped_faces++;
+      }
+
+      if (has_uvs)
+        uvs.resize(corners.size());
+      if (has_normals)
+        normals.resize(corners.size());
+      if (count < 3)
+        continue;
+
+      // Mesma normal de Face::determine_face_normal: (next - origin) x (prev - origin) a partir do canto 0
+      const Vec3f &p1 = points[corners.back()];
+      const Vec3f &p2 = points[corners[first]];
+      const Vec3f &p3 = points[corners[first + 1]];
+      Vec3f a = {p1.x - p2.x, p1.y - p2.y, p1.z - p2.z};
+      Vec3f b = {p3.x - p2.x, p3.y - p2.y, p3.z - p2.z};
+      face_normals.push_back(Vector3Normalize(Vector3CrossProduct(b, a)));
+
+      Vec3f centroid = {0.0f, 0.0f, 0.0f};
+      for (std::size_t k = first; k < corners.size(); k++)
+      {
+        centroid.x += points[corners[k]].x;
+        centroid.y += points[corners[k]].y;
+        centroid.z += points[corners[k]].z;
+      }
+      float inverse = 1.0f / static_cast<float>(count);
+      centroids.push_back({centroid.x * inverse, centroid.y * inverse, centroid.z * inverse});
+      starts.push_back(static_cast<int>(corners.size()));
+    }
+
+    int face_count = static_cast<int>(centroids.size());
+    if (face_count == 0)
+    {
+      std::cerr << "Malha sem faces\n";
+      return false;
+    }
+
+    // Ordem de Morton dos centroides dentro da caixa da malha (chave nos 32 bits altos, face nos baixos)
+    Vec3f low = centroids[0], high = centroids[0];
+    for (const Vec3f &centroid : centroids)
+    {
+      low = {std::min(low.x, centroid.x), std::min(low.y, centroid.y), std::min(low.z, centroid.z)};
+      high = {std::max(high.x, centroid.x), std::max(high.y, centroid.y), std::max(high.z, centroid.z)};
+    }
+
+    auto cell = [](float value, float min, float max)
+    {
+      float extent = max - min;
+      return extent > 0.0f ? static_cast<std::uint32_t>(std::clamp((value - min) / extent, 0.0f, 1.0f) * 1023.0f) : 0u;
+    };
+
+    std::vector<std::uint64_t> order(face_count);
+    for (int f = 0; f < face_count; f++)
+    {
+      const Vec3f &centroid = centroids[f];
+      std::uint32_t morton = spread_bits(cell(centroid.x, low.x, high.x)) | (spread_bits(cell(centroid.y, low.y, high.y)) << 1) |
+                             (spread_bits(cell(centroid.z, low.z, high.z)) << 2);
+      order[f] = (static_cast<std::uint64_t>(morton) << 32) | static_cast<std::uint32_t>(f);
+    }
+
+    std::sort(order.begin(), order.end());
+
+    std::vector<int> face_order(face_count);
+    for (int f = 0; f < face_count; f++)
+      face_order[f] = static_cast<int>(order[f] & 0xffffffffu);
+
+    // Ordem para o cache de vértices, partindo da ordem de Morton (faces sem vizinhas restantes seguem a curva)
+    {
+      std::vector<int> morton_corners, morton_starts = {0};
+      morton_corners.reserve(corners.size());
+      for (int face : face_order)
+      {
+        morton_corners.insert(morton_corners.end(), corners.begin() + starts[face], corners.begin() + starts[face + 1]);
+        morton_starts.push_back(static_cast<int>(morton_corners.size()));
+      }
+
+      int point_count = static_cast<int>(points.size());
+      summary.acmr_morton = summary.acmr = vertexCacheACMR(morton_corners, morton_starts, point_count, VERTEX_CACHE_SIZE);
+
+      if (options.cache_order)
+      {
+        std::vector<int> cache_order = vertexCacheOrder(morton_corners, morton_starts, point_count, VERTEX_CACHE_SIZE);
+
+        std::vector<int> ordered_corners, ordered_starts = {0};
+        ordered_corners.reserve(morton_corners.size());
+        for (int f : cache_order)
+        {
+          ordered_corners.insert(ordered_corners.end(), morton_corners.begin() + morton_starts[f], morton_corners.begin() + morton_starts[f + 1]);
+          ordered_starts.push_back(static_cast<int>(ordered_corners.size()));
+        }
+
+        float acmr = vertexCacheACMR(ordered_corners, ordered_starts, point_count, VERTEX_CACHE_SIZE);
+        if (acmr < summary.acmr)
+        {
+          summary.acmr = acmr;
+          std::vector<int> reordered(face_count);
+          for (int f = 0; f < face_count; f++)
+            reordered[f] = face_order[cache_order[f]];
+          face_order.swap(reordered);
+        }
+      }
+    }
+
+    // Meias arestas das faces na nova ordem (cantos consecutivos), com os vértices renumerados no primeiro uso
+    int corner_count = static_cast<int>(corners.size());
+    std::vector<int> renumber(points.size(), -1);
+    std::vector<Vec3f> positions;
+    std::vector<CookedHalfEdge> halfedges;
+    std::vector<CookedFace> cooked_faces(face_count);
+    std::vector<Vec2f> corner_uvs;
+    std::vector<Vec3f> corner_normals;
+    halfedges.reserve(corner_count + corner_count / 8);
+    if (has_uvs)
+      corner_uvs.reserve(corner_count);
+    if (has_normals)
+      corner_normals.reserve(corner_count);
+
+    for (int f = 0; f < face_count; f++)
+    {
+      int face = face_order[f];
+      int first = static_cast<int>(halfedges.size());
+      int count = starts[face + 1] - starts[face];
+
+      cooked_faces[f].halfedge = first;
+      cooked_faces[f].corner_count = count;
+      cooked_faces[f].normal = face_normals[face];
+      cooked_faces[f].centroid = centroids[face];
+
+      for (int k = 0; k < count; k++)
+      {
+        int &vertex = renumber[corners[starts[face] + k]];
+        if (vertex < 0)
+        {
+          vertex = static_cast<int>(positions.size());
+          positions.push_back(points[corners[starts[face] + k]]);
+        }
+
+        CookedHalfEdge he;
+        he.next = first + (k + 1) % count;
+        he.prev = first + (k + count - 1) % count;
+        he.twin = -1;
+        he.origin = vertex;
+        he.face = f;
+        halfedges.push_back(he);
+      }
+
+      if (has_uvs)
+        corner_uvs.insert(corner_uvs.end(), uvs.begin() + starts[face], uvs.begin() + starts[face + 1]);
+      if (has_normals)
+        corner_normals.insert(corner_normals.end(), normals.begin() + starts[face], normals.begin() + starts[face + 1]);
+    }
+
+    int vertex_count = static_cast<int>(positions.size());
+
+    // Meias arestas que partem de cada vértice (ordenação por contagem)
+    std::vector<int> outgoing_start(vertex_count + 1, 0);
+    std::vector<int> outgoing(corner_count);
+    for (int i = 0; i < corner_count; i++)
+      outgoing_start[halfedges[i].origin + 1]++;
+    for (int v = 0; v < vertex_count; v++)
+      outgoing_start[v + 1] += outgoing_start[v];
+    {
+      std::vector<int> cursor(outgoing_start.begin(), outgoing_start.end() - 1);
+      for (int i = 0; i < corner_count; i++)
+        outgoing[cursor[halfedges[i].origin]++] = i;
+    }
+
+    auto destination = [&halfedges](int he)
+    { return halfedges[halfedges[he].next].origin; };
+
+    // Gêmeas: a aresta a -> b encontra b -> a entre as meias arestas que partem de b
+    for (int i = 0; i < corner_count; i++)
+    {
+      int a = halfedges[i].origin;
+      int b = destination(i);
+
+      for (int k = outgoing_start[a]; k < outgoing_start[a + 1]; k++)
+      {
+        if (outgoing[k] != i && destination(outgoing[k]) == b)
+        {
+          std::cerr << "Aresta usada duas vezes no mesmo sentido (malha não manifold ou com faces invertidas)\n";
+          return false;
+        }
+      }
+
+      for (int k = outgoing_start[b]; k < outgoing_start[b + 1]; k++)
+      {
+        if (destination(outgoing[k]) == a)
+        {
+          halfedges[i].twin = outgoing[k];
+          break;
+        }
+      }
+    }
+
+    // Bordas: cada canto sem gêmea ganha uma meia aresta no sentido oposto, ligadas em laços
+    // (as bordas que partem de um vértice formam uma lista, para aceitar vértices tocados por mais de uma borda)
+    std::vector<int> boundary_from(vertex_count, -1);
+    std::vector<int> boundary_link;
+    for (int i = 0; i < corner_count; i++)
+    {
+      if (halfedges[i].twin >= 0)
+        continue;
+
+      int origin = destination(i);
+
+      CookedHalfEdge border;
+      border.next = border.prev = -1;
+      border.twin = i;
+      border.origin = origin;
+      border.face = -1;
+
+      halfedges[i].twin = static_cast<int>(halfedges.size());
+      boundary_link.push_back(boundary_from[origin]);
+      boundary_from[origin] = static_cast<int>(halfedges.size());
+      halfedges.push_back(border);
+    }
+
+    for (std::size_t i = corner_count; i < halfedges.size(); i++)
+    {
+      int end = halfedges[halfedges[i].twin].origin;
+      int next = boundary_from[end];
+      if (next < 0)
+      {
+        std::cerr << "Borda aberta sem continuação (malha não manifold)\n";
+        return false;
+      }
+
+      boundary_from[end] = boundary_link[next - corner_count];
+      halfedges[i].next = next;
+      halfedges[next].prev = static_cast<int>(i);
+    }
+
+    for (std::size_t i = corner_count; i < halfedges.size(); i++)
+    {
+      if (halfedges[i].prev < 0)
+      {
+        std::cerr << "Borda aberta sem continuação (malha não manifold)\n";
+        return false;
+      }
+    }
+
+    summary.boundary_edges = static_cast<int>(halfedges.size()) - corner_count;
+
+    // Meia aresta de cada vértice e normais médias (como Mesh::determineVertexNormals)
+    std::vector<std::int32_t> vertex_halfedges(vertex_count);
+    std::vector<Vec3f> vertex_normals(vertex_count);
+    for (int v = 0; v < vertex_count; v++)
+      vertex_halfedges[v] = outgoing[outgoing_start[v]];
+
+    for (int i = 0; i < corner_count; i++)
+    {
+      const CookedHalfEdge &he = halfedges[i];
+      const Vec3f &normal = cooked_faces[he.face].normal;
+      vertex_normals[he.origin] = {vertex_normals[he.origin].x + normal.x, vertex_normals[he.origin].y + normal.y, vertex_normals[he.origin].z + normal.z};
+    }
+
+    for (Vec3f &normal : vertex_normals)
+      normal = Vector3Normalize(normal);
+
+    Vec3f bounds_min = positions[0], bounds_max = positions[0];
+    for (const Vec3f &p : positions)
+    {
+      bounds_min = {std::min(bounds_min.x, p.x), std::min(bounds_min.y, p.y), std::min(bounds_min.z, p.z)};
+      bounds_max = {std::max(bounds_max.x, p.x), std::max(bounds_max.y, p.y), std::max(bounds_max.z, p.z)};
+    }
+
+    // Cabeçalho e vetores alinhados
+    CookedMeshHeader header = {};
+    std::memcpy(header.magic, COOKED_MESH_MAGIC, sizeof(header.magic));
+    header.version = COOKED_MESH_VERSION;
+    header.flags = (has_uvs ? COOKED_CORNER_UVS : 0u) | (has_normals ? COOKED_CORNER_NORMALS : 0u);
+    header.vertex_count = static_cast<std::uint32_t>(vertex_count);
+    header.face_count = static_cast<std::uint32_t>(face_count);
+    header.halfedge_count = static_cast<std::uint32_t>(halfedges.size());
+    header.corner_count = static_cast<std::uint32_t>(corner_count);
+    header.bounds_min[0] = bounds_min.x;
+    header.bounds_min[1] = bounds_min.y;
+    header.bounds_min[2] = bounds_min.z;
+    header.bounds_max[0] = bounds_max.x;
+    header.bounds_max[1] = bounds_max.y;
+    header.bounds_max[2] = bounds_max.z;
+
+    blob.assign(sizeof(header), 0);
+    auto append = [&blob](const void *bytes, std::size_t size) -> std::uint64_t
+    {
+      blob.resize((blob.size() + COOKED_ALIGNMENT - 1) / COOKED_ALIGNMENT * COOKED_ALIGNMENT);
+      std::uint64_t offset = blob.size();
+      blob.insert(blob.end(), static_cast<const std::uint8_t *>(bytes), static_cast<const std::uint8_t *>(bytes) + size);
+      return offset;
+    };
+
+    header.positions = append(positions.data(), positions.size() * sizeof(Vec3f));
+    header.vertex_normals = append(vertex_normals.data(), vertex_normals.size() * sizeof(Vec3f));
+    header.vertex_halfedges = append(vertex_halfedges.data(), vertex_halfedges.size() * sizeof(std::int32_t));
+    header.halfedges = append(halfedges.data(), halfedges.size() * sizeof(CookedHalfEdge));
+    header.faces = append(cooked_faces.data(), cooked_faces.size() * sizeof(CookedFace));
+    if (has_uvs)
+      header.corner_uvs = append(corner_uvs.data(), corner_uvs.size() * sizeof(Vec2f));
+    if (has_normals)
+      header.corner_normals = append(corner_normals.data(), corner_normals.size() * sizeof(Vec3f));
+    std::memcpy(blob.data(), &header, sizeof(header));
+
+    summary.welded_vertices = vertex_count;
+    summary.faces = face_count;
+    if (stats)
+      *stats = summary;
+
+    return true;
+  }
+
+  /**
+   * @brief Cozinha uma malha e grava o arquivo .mesh
+   *
+   * @param source Malha de entrada
+   * @param filename Arquivo .mesh de saída
+   * @param options Parâmetros do cozimento
+   * @param stats Recebe o resumo (opcional)
+   * @return true Se o arquivo foi gravado
+   */
+  bool cookMesh(const MeshSource &source, const std::string &filename, const CookOptions &options, CookStats *stats)
+  {
+    std::vector<std::uint8_t> blob;
+    if (!cookMesh(source, blob, options, stats))
+      return false;
+
+    std::FILE *file = std::fopen(filename.c_str(), "wb");
+    if (!file)
+      return false;
+
+    bool written = std::fwrite(blob.data(), blob.size(), 1, file) == 1;
+    return std::fclose(file) == 0 && written;
+  }
+
+  /**
+   * @brief Abre uma malha cozida
+   *
+   * @param filename Caminho do arquivo .mesh
+   * @return true Se o arquivo é uma malha cozida válida
+   *
+   * @note A leitura passa pela fila do io::AssetIO (io_uring, pread ou pacote montado) com prioridade alta
+   */
+  bool CookedMesh::open(const std::string &filename)
+  {
+    io::ReadResult result = io::shared().readBlocking(filename);
+    if (!result.ok)
+    {
+      header = nullptr;
+      owned.clear();
+      std::cerr << "Erro ao carregar malha '" << filename << "': " << result.error << "\n";
+      return false;
+    }
+
+    // Entrada sem compressão de um pacote montado: os vetores são usados direto do pacote mapeado
+    if (result.storage.empty())
+    {
+      header = nullptr;
+      owned.clear();
+      return validate(result.data, result.size, filename);
+    }
+
+    return open(std::move(result.storage), filename);
+  }
+
+  bool CookedMesh::open(std::vector<std::uint8_t> &&bytes, const std::string &name)
+  {
+    header = nullptr;
+    owned = std::move(bytes);
+    return validate(owned.data(), owned.size(), name);
+  }
+
+  // Confere o cabeçalho e se os vetores cabem no arquivo (custo constante)
+  bool CookedMesh::validate(const std::uint8_t *bytes, std::size_t size, const std::string &name)
+  {
+    auto fail = [&name](const char *reason)
+    {
+      std::cerr << "Erro ao carregar malha '" << name << "': " << reason << "\n";
+      return false;
+    };
+
+    if (size < sizeof(CookedMeshHeader))
+      return fail("Arquivo truncado");
+
+    const auto *candidate = reinterpret_cast<const CookedMeshHeader *>(bytes);
+    if (std::memcmp(candidate->magic, COOKED_MESH_MAGIC, sizeof(candidate->magic)) != 0 || candidate->version != COOKED_MESH_VERSION)
+      return fail("Formato não suportado");
+
+    if (candidate->corner_count > candidate->halfedge_count || candidate->face_count == 0 || candidate->vertex_count == 0)
+      return fail("Cabeçalho inválido");
+
+    auto fits = [size](std::uint64_t offset, std::uint64_t count, std::size_t element)
+    {
+      return offset % alignof(std::int32_t) == 0 && offset <= size && count <= (size - offset) / element;
+    };
+
+    bool has_uvs = candidate->flags & COOKED_CORNER_UVS;
+    bool has_normals = candidate->flags & COOKED_CORNER_NORMALS;
+
+    if (!fits(candidate->positions, candidate->vertex_count, sizeof(Vec3f)) ||
+        !fits(candidate->vertex_normals, candidate->vertex_count, sizeof(Vec3f)) ||
+        !fits(candidate->vertex_halfedges, candidate->vertex_count, sizeof(std::int32_t)) ||
+        !fits(candidate->halfedges, candidate->halfedge_count, sizeof(CookedHalfEdge)) ||
+        !fits(candidate->faces, candidate->face_count, sizeof(CookedFace)) ||
+        has_uvs != (candidate->corner_uvs != 0) || has_normals != (candidate->corner_normals != 0) ||
+        (has_uvs && !fits(candidate->corner_uvs, candidate->corner_count, sizeof(Vec2f))) ||
+        (has_normals && !fits(candidate->corner_normals, candidate->corner_count, sizeof(Vec3f))))
+      return fail("Tamanho não confere com o cabeçalho");
+
+    data = bytes;
+    header = candidate;
+    return true;
+  }
+
+  AABB CookedMesh::bounds() const
+  {
+    AABB box;
+    box.min = {header->bounds_min[0], header->bounds_min[1], header->bounds_min[2]};
+    box.max = {header->bounds_max[0], header->bounds_max[1], header->bounds_max[2]};
+    return box;
+  }
+}
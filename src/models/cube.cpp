@@ -1,26 +1,32 @@
 #include <models/mesh.hpp>
-#include <models/texture.hpp>
+#include <models/texture_manager.hpp>
 
 #include <utils/bmp_reader.hpp>
 
+#include <cmath>
+
 /**
  * @brief Retorna a malha de um cubo
  *
  * @note O cubo tem tamanho unitário(-1 à 1) e está centrado na origem
+ * @note A malha é um recurso compartilhado: para posicionar vários cubos, crie
+ *       instâncias (MeshInstance) com matrizes de modelo diferentes em vez de novas malhas
  *
+ * @param textures Gerenciador de texturas da cena
+ * @param filename Caminho da textura BMP
  * @return Mesh* Ponteiro para a malha do cubo
  */
-Mesh *cube(Vec3f shift, std::string filename)
+Mesh *cube(models::TextureManager &textures, std::string filename)
 {
-  // Vértices do cubo com UVs
-  Vertex *v0 = new Vertex(-1.0f + shift.x, -1.0f + shift.y, -1.0f + shift.z, 1.0f, nullptr, "v0", 0.0f, 0.0f);
-  Vertex *v1 = new Vertex(1.0f + shift.x, -1.0f + shift.y, -1.0f + shift.z, 1.0f, nullptr, "v1", 1.0f, 0.0f);
-  Vertex *v2 = new Vertex(1.0f + shift.x, -1.0f + shift.y, 1.0f + shift.z, 1.0f, nullptr, "v2", 1.0f, 1.0f);
-  Vertex *v3 = new Vertex(-1.0f + shift.x, -1.0f + shift.y, 1.0f + shift.z, 1.0f, nullptr, "v3", 0.0f, 1.0f);
-  Vertex *v4 = new Vertex(-1.0f + shift.x, 1.0f + shift.y, -1.0f + shift.z, 1.0f, nullptr, "v4", 0.0f, 0.0f);
-  Vertex *v5 = new Vertex(1.0f + shift.x, 1.0f + shift.y, -1.0f + shift.z, 1.0f, nullptr, "v5", 1.0f, 0.0f);
-  Vertex *v6 = new Vertex(1.0f + shift.x, 1.0f + shift.y, 1.0f + shift.z, 1.0f, nullptr, "v6", 1.0f, 1.0f);
-  Vertex *v7 = new Vertex(-1.0f + shift.x, 1.0f + shift.y, 1.0f + shift.z, 1.0f, nullptr, "v7", 0.0f, 1.0f);
+  // Vértices do cubo (as UVs são definidas por canto, veja abaixo)
+  Vertex *v0 = new Vertex(-1.0f, -1.0f, -1.0f, 1.0f, nullptr, "v0");
+  Vertex *v1 = new Vertex(1.0f, -1.0f, -1.0f, 1.0f, nullptr, "v1");
+  Vertex *v2 = new Vertex(1.0f, -1.0f, 1.0f, 1.0f, nullptr, "v2");
+  Vertex *v3 = new Vertex(-1.0f, -1.0f, 1.0f, 1.0f, nullptr, "v3");
+  Vertex *v4 = new Vertex(-1.0f, 1.0f, -1.0f, 1.0f, nullptr, "v4");
+  Vertex *v5 = new Vertex(1.0f, 1.0f, -1.0f, 1.0f, nullptr, "v5");
+  Vertex *v6 = new Vertex(1.0f, 1.0f, 1.0f, 1.0f, nullptr, "v6");
+  Vertex *v7 = new Vertex(-1.0f, 1.0f, 1.0f, 1.0f, nullptr, "v7");
 
   std::vector<std::vector<int>> edges = {
       // Back Face
@@ -44,19 +50,49 @@ Mesh *cube(Vec3f shift, std::string filename)
 
   Mesh *cube = new Mesh({v0, v1, v2, v3, v4, v5, v6, v7}, edges, "cube");
 
-  // Carrega a textura BMP
-  models::Texture tex;
-  if (!models::loadTexture(filename, tex))
-  {
-  }
-  else
+  // UVs por canto: cada face recebe a textura inteira
+  // Os vértices são compartilhados entre faces, então a UV depende da face (canto) e não do vértice
+  // A projeção é feita no eixo dominante da normal da face (box mapping)
+  std::vector<std::vector<Vec2f>> face_uvs;
+  for (auto face : cube->faces)
   {
-    cube->texture = tex;
+    face->determine_face_normal();
+    Vec3f n = face->normal;
+
+    std::vector<Vec2f> uvs;
+    for (auto v : face->vertexes)
+    {
+      Vec3f p = v->vertex.to_vec3();
+      float s, t;
+
+      if (fabsf(n.x) >= fabsf(n.y) && fabsf(n.x) >= fabsf(n.z))
+      {
+        s = n.x > 0 ? -p.z : p.z;
+        t = p.y;
+      }
+      else if (fabsf(n.y) >= fabsf(n.z))
+      {
+        s = p.x;
+        t = n.y > 0 ? -p.z : p.z;
+      }
+      else
+      {
+        s = n.z > 0 ? p.x : -p.x;
+        t = p.y;
+      }
+
+      // -1..1 -> 0..1 (a linha 0 da textura é o topo da imagem)
+      uvs.push_back({(s + 1.0f) / 2.0f, (1.0f - t) / 2.0f});
+    }
+
+    face_uvs.push_back(uvs);
   }
 
-  // Marca que todos os vértices têm UVs
-  for (auto v : cube->vertexes)
-    v->has_uv = true;
+  cube->setCornerUVs(face_uvs);
+
+  // Textura BMP (compartilhada entre os cubos com o mesmo arquivo)
+  // Deve ser associada depois das UVs: numa célula de atlas as UVs são remapeadas
+  cube->setTexture(textures.load(filename));
 
   return cube;
 }
\ No newline at end of file
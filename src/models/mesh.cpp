@@ -1,4 +1,11 @@
 #include <models/mesh.hpp>
+#include <models/cooked_mesh.hpp>
+#include <models/obj_importer.hpp>
+#include <models/vertex_cache.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
 
 Mesh::Mesh()
 {
@@ -33,6 +40,155 @@ Mesh::Mesh(std::vector<Vertex *> vertexes, std::vector<std::vector<int>> faces,
   this->material.shininess = 32.0f;
 }
 
+/**
+ * @brief Construtor a partir de uma malha cozida
+ *
+ * @param cooked Malha cozida aberta
+ * @param id Identificador da malha
+ *
+ * @note A topologia já vem pronta (gêmeas, laços de borda, normais e bounding box), então a construção é uma
+ *       passada linear que liga os elementos por índice, sem o mapa de arestas e sem buscas do createMesh
+ * @note A passada ainda converte cada índice em ponteiro e aloca o vetor de vértices de cada face; os vértices,
+ *       faces e meias arestas ficam em três vetores contínuos (uma alocação para cada tipo)
+ * @note Com um índice fora dos vetores a malha fica vazia (sem faces), e loadMesh devolve nullptr
+ */
+Mesh::Mesh(const models::CookedMesh &cooked, std::string id) : Mesh()
+{
+  this->id = id;
+
+  int vertex_count = cooked.vertexCount();
+  int face_count = cooked.faceCount();
+  int halfedge_count = cooked.halfEdgeCount();
+  int corner_count = cooked.cornerCount();
+
+  auto valid = [](std::int32_t index, int count)
+  { return index >= 0 && index < count; };
+
+  vertex_storage.resize(vertex_count);
+  face_storage.resize(face_count);
+  halfedge_storage.resize(halfedge_count);
+  vertexes.resize(vertex_count);
+  faces.resize(face_count);
+  halfedges.resize(halfedge_count);
+
+  const Vec3f *positions = cooked.positions();
+  const Vec3f *normals = cooked.vertexNormals();
+  const std::int32_t *vertex_halfedges = cooked.vertexHalfEdges();
+  bool ok = true;
+
+  for (int i = 0; i < vertex_count && ok; i++)
+  {
+    Vertex &vertex = vertex_storage[i];
+    vertex.vertex = {positions[i].x, positions[i].y, positions[i].z, 1.0f};
+    vertex.normal = normals[i];
+    ok = valid(vertex_halfedges[i], halfedge_count);
+    vertex.incident_edge = ok ? &halfedge_storage[vertex_halfedges[i]] : nullptr;
+    vertex.index = i;
+    vertexes[i] = &vertex;
+  }
+
+  const models::CookedHalfEdge *links = cooked.halfEdges();
+  for (int i = 0; i < halfedge_count && ok; i++)
+  {
+    const models::CookedHalfEdge &link = links[i];
+    ok = valid(link.next, halfedge_count) && valid(link.prev, halfedge_count) && valid(link.twin, halfedge_count) &&
+         valid(link.origin, vertex_count) && (i < corner_count ? valid(link.face, face_count) : link.face == -1);
+    if (!ok)
+      break;
+
+    HalfEdge &he = halfedge_storage[i];
+    he.next = &halfedge_storage[link.next];
+    he.prev = &halfedge_storage[link.prev];
+    he.twin = &halfedge_storage[link.twin];
+    he.origin = &vertex_storage[link.origin];
+    he.incident_face = link.face >= 0 ? &face_storage[link.face] : nullptr;
+    he.index = i;
+    halfedges[i] = &he;
+  }
+
+  const models::CookedFace *cooked_faces = cooked.faces();
+  for (int i = 0; i < face_count && ok; i++)
+  {
+    const models::CookedFace &cooked_face = cooked_faces[i];
+    ok = cooked_face.corner_count >= 3 && valid(cooked_face.halfedge, corner_count) && cooked_face.corner_count <= corner_count - cooked_face.halfedge;
+    if (!ok)
+      break;
+
+    Face &face = face_storage[i];
+    face.he = &halfedge_storage[cooked_face.halfedge];
+    face.normal = cooked_face.normal;
+    face.centroid = cooked_face.centroid;
+    face.vertexes.resize(cooked_face.corner_count);
+    for (int k = 0; k < cooked_face.corner_count; k++)
+      face.vertexes[k] = halfedge_storage[cooked_face.halfedge + k].origin;
+    faces[i] = &face;
+  }
+
+  if (!ok)
+  {
+    vertexes.clear();
+    faces.clear();
+    halfedges.clear();
+    return;
+  }
+
+  // Atributos por canto: os cantos são as primeiras meias arestas, as de borda recebem valores nulos
+  if (const Vec2f *uvs = cooked.cornerUVs())
+  {
+    corner_uvs.assign(uvs, uvs + corner_count);
+    corner_uvs.resize(halfedge_count);
+  }
+
+  if (const Vec3f *corner = cooked.cornerNormals())
+  {
+    corner_normals.assign(corner, corner + corner_count);
+    corner_normals.resize(halfedge_count);
+  }
+
+  num_faces = face_count;
+  bounds = cooked.bounds();
+}
+
+/**
+ * @brief Carrega uma malha cozida ou um arquivo OBJ
+ *
+ * @param filename Caminho do arquivo .mesh ou .obj
+ * @return Mesh* Malha criada, ou nullptr se o arquivo for inválido (inclusive com índices fora dos vetores)
+ *
+ * @note O OBJ é importado em paralelo e cozido em memória, sem unir vértices (os índices do arquivo definem a
+ *       topologia), e a malha é montada pelo mesmo caminho linear das malhas cozidas
+ */
+Mesh *loadMesh(const std::string &filename)
+{
+  models::CookedMesh cooked;
+  bool obj = filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".obj") == 0;
+
+  if (obj)
+  {
+    models::MeshSource source;
+    std::vector<std::uint8_t> blob;
+    models::CookOptions options;
+    options.weld = false;
+    // OBJ lido em tempo de execução: só a ordem de Morton (a reordenação para o cache fica para o mesh_cook)
+    options.cache_order = false;
+
+    if (!models::importObj(filename, source) || !models::cookMesh(source, blob, options) || !cooked.open(std::move(blob), filename))
+      return nullptr;
+  }
+  else if (!cooked.open(filename))
+    return nullptr;
+
+  // Índices inválidos deixam a malha vazia
+  Mesh *mesh = new Mesh(cooked, filename);
+  if (mesh->faces.empty())
+  {
+    delete mesh;
+    return nullptr;
+  }
+
+  return mesh;
+}
+
 /**
  * @brief Destrutor padrão da classe Mesh
  */
@@ -141,6 +297,9 @@ void Mesh::createMesh(const std::vector<Vertex *> _vertexes, std::vector<std::ve
     return;
   }
 
+  for (std::size_t i = 0; i < vertexes.size(); i++)
+    vertexes[i]->index = static_cast<int>(i);
+
   std::vector<Vertex *> vertices = vertexes;
 
   // Cria as faces da malha
@@ -204,6 +363,7 @@ HalfEdge *Mesh::addEdge(Vertex *vertex1, Vertex *vertex2)
 {
   HalfEdge *he = new HalfEdge();
   he->id = "e" + std::to_string(halfedges.size());
+  he->index = static_cast<int>(halfedges.size());
 
   std::string id = "e" + vertex1->id + "-" + vertex2->id;
   halfedges_map.insert(std::pair<std::string, HalfEdge *>(id, he));
@@ -339,12 +499,18 @@ void Mesh::determineVertexNormals()
 
     while (true)
     {
-      Vec3f face_normal = he->incident_face->normal;
+      // Meias arestas de borda (malhas cozidas abertas) não têm face
+      if (he->incident_face)
+      {
+        Vec3f face_normal = he->incident_face->normal;
 
-      normal.x += face_normal.x;
-      normal.y += face_normal.y;
-      normal.z += face_normal.z;
+        normal.x += face_normal.x;
+        normal.y += face_normal.y;
+        normal.z += face_normal.z;
+      }
 
+      if (!he->twin)
+        break;
       he = he->twin->next;
 
       if (he == start_he)
@@ -359,4 +525,365 @@ void Mesh::determineVertexNormals()
 
     v->normal = normal;
   }
+}
+
+/**
+ * @brief Gera o fluxo de vértices comprimido (Mesh::compressed)
+ *
+ * @param precision Precisão das normais octaédricas
+ *
+ * @note As normais médias são calculadas uma vez aqui (no SRO, como as faces) e ficam gravadas por canto no fluxo
+ * @note Depois da compressão o fluxo é a única cópia das normais e UVs por canto: os vetores em float são liberados.
+ *       Uma troca de precisão parte dos valores decodificados (de OCT8 para OCT16 o erro do OCT8 permanece)
+ */
+void Mesh::compressVertices(models::NormalPrecision precision)
+{
+  decompressVertices();
+
+  if (corner_normals.empty())
+  {
+    // As normais das faces só são atualizadas no teste de visibilidade, que ainda pode não ter rodado
+    for (auto face : faces)
+      face->determine_face_normal();
+    determineVertexNormals();
+  }
+
+  compressed.build(*this, precision);
+
+  std::vector<Vec3f>().swap(corner_normals);
+  std::vector<Vec2f>().swap(corner_uvs);
+}
+
+/**
+ * @brief Devolve as normais e UVs por canto do fluxo comprimido para os vetores em float e descarta o fluxo
+ *
+ * @note Chamado quando a compressão é desligada e antes de qualquer alteração nos atributos por canto.
+ *       As normais médias gravadas no fluxo (malhas sem normais por canto) não viram normais por canto
+ */
+void Mesh::decompressVertices()
+{
+  if (compressed.empty())
+    return;
+
+  int corners = static_cast<int>(halfedges.size());
+
+  if (compressed.hasCornerNormals())
+  {
+    corner_normals.resize(corners);
+    for (int i = 0; i < corners; i++)
+      corner_normals[i] = compressed.normal(i);
+  }
+
+  if (compressed.hasUVs())
+  {
+    corner_uvs.resize(corners);
+    for (int i = 0; i < corners; i++)
+      corner_uvs[i] = compressed.uv(i);
+  }
+
+  compressed.clear();
+}
+
+/**
+ * @brief Preenche um vetor de atributos por canto a partir de valores por face
+ *
+ * @param faces Faces da malha
+ * @param halfedge_count Número de meias arestas da malha
+ * @param per_face Valores de cada face, na ordem dos vértices da face
+ * @param stream Vetor de atributos indexado por HalfEdge::index
+ *
+ * @note O canto k da face é a meia aresta que parte do k-ésimo vértice da face (face->he é o canto 0)
+ */
+template <typename T>
+static void fillCornerStream(const std::vector<Face *> &faces, size_t halfedge_count, const std::vector<std::vector<T>> &per_face, std::vector<T> &stream)
+{
+  stream.assign(halfedge_count, T());
+
+  for (size_t i = 0; i < faces.size() && i < per_face.size(); i++)
+  {
+    HalfEdge *he = faces[i]->he;
+    for (size_t k = 0; k < per_face[i].size(); k++)
+    {
+      stream[he->index] = per_face[i][k];
+      he = he->next;
+    }
+  }
+}
+
+/**
+ * @brief Define as coordenadas UV por canto
+ *
+ * @param face_uvs Coordenadas UV de cada face (um par por vértice da face)
+ *
+ * @note Resolve o caso de vértices compartilhados por faces com UVs diferentes (ex.: arestas do cubo)
+ *       sem duplicar os vértices
+ */
+void Mesh::setCornerUVs(const std::vector<std::vector<Vec2f>> &face_uvs)
+{
+  decompressVertices();
+  fillCornerStream(faces, halfedges.size(), face_uvs, corner_uvs);
+}
+
+/**
+ * @brief Define as normais por canto
+ *
+ * @param face_normals Normais de cada face (uma por vértice da face)
+ *
+ * @note Quando presentes, substituem a normal média do vértice no Gouraud e no Phong (arestas vivas)
+ */
+void Mesh::setCornerNormals(const std::vector<std::vector<Vec3f>> &face_normals)
+{
+  decompressVertices();
+  fillCornerStream(faces, halfedges.size(), face_normals, corner_normals);
+}
+
+/**
+ * @brief Define as cores por canto
+ *
+ * @param face_colors Cores de cada face (uma por vértice da face)
+ */
+void Mesh::setCornerColors(const std::vector<std::vector<models::Color>> &face_colors)
+{
+  fillCornerStream(faces, halfedges.size(), face_colors, corner_colors);
+}
+
+/**
+ * @brief Associa uma textura à malha
+ *
+ * @param region Região entregue pelo TextureManager
+ *
+ * @note Quando a região é uma célula de atlas, as UVs por canto são levadas para a célula. Malhas sem UVs
+ *       por canto recebem a UV do vértice (ou o mapeamento planar padrão) em cada canto antes do remapeamento
+ */
+void Mesh::setTexture(const models::TextureRegion &region)
+{
+  texture = region.texture;
+
+  if (!region.atlas)
+    return;
+
+  decompressVertices();
+
+  if (corner_uvs.empty())
+  {
+    corner_uvs.assign(halfedges.size(), Vec2f());
+    for (auto he : halfedges)
+    {
+      Vertex *v = he->origin;
+      if (v->has_uv)
+        corner_uvs[he->index] = {v->u, v->v};
+      else
+        corner_uvs[he->index] = {(v->vertex.x + 1.0f) / 2.0f, (v->vertex.y + 1.0f) / 2.0f};
+    }
+  }
+
+  for (auto &uv : corner_uvs)
+    region.remap(uv.x, uv.y);
+}
+
+/**
+ * @brief Reordena faces e vértices para o cache de vértices
+ *
+ * @param cache_size Entradas do cache simulado
+ * @return MeshLayoutStats ACMR (vértices transformados por triângulo) antes e depois
+ *
+ * @note As faces são ordenadas pelo algoritmo de Forsyth (se o ACMR melhorar) e os vértices renumerados na ordem
+ *       do primeiro uso. Vértices, faces e meias arestas são copiados para os vetores contínuos na nova ordem (as
+ *       meias arestas de cada face ficam em sequência) e todas as ligações da half-edge são refeitas para as cópias
+ * @note Os atributos por canto são permutados junto com as meias arestas. Os elementos antigos criados com
+ *       createMesh são liberados: a malha passa a ser dona de todos os elementos
+ * @note Deve ser chamado antes de qualquer código guardar ponteiros para os elementos (ex.: na carga)
+ * @note Usado nas malhas montadas em tempo de execução (createMesh): as malhas cozidas já saem do mesh_cook
+ *       na ordem do cache, e os mapas de ponteiros daqui custam mais que a própria carga em malhas grandes
+ */
+MeshLayoutStats Mesh::optimizeLayout(int cache_size)
+{
+  MeshLayoutStats stats;
+  stats.cache_size = cache_size;
+
+  int vertex_count = static_cast<int>(vertexes.size());
+  int face_count = static_cast<int>(faces.size());
+  int halfedge_count = static_cast<int>(halfedges.size());
+  if (vertex_count == 0 || face_count == 0)
+    return stats;
+
+  // Os atributos por canto são permutados em float
+  decompressVertices();
+
+  std::unordered_map<const Vertex *, int> vertex_index;
+  std::unordered_map<const Face *, int> face_index;
+  std::unordered_map<const HalfEdge *, int> halfedge_index;
+  vertex_index.reserve(vertex_count);
+  face_index.reserve(face_count);
+  halfedge_index.reserve(halfedge_count);
+  for (int i = 0; i < vertex_count; i++)
+    vertex_index[vertexes[i]] = i;
+  for (int i = 0; i < face_count; i++)
+    face_index[faces[i]] = i;
+  for (int i = 0; i < halfedge_count; i++)
+    halfedge_index[halfedges[i]] = i;
+
+  // Cantos de cada face na ordem do laço da half-edge
+  std::vector<int> corners, starts = {0};
+  std::vector<int> corner_halfedges;
+  for (Face *face : faces)
+  {
+    HalfEdge *he = face->he;
+    do
+    {
+      corners.push_back(vertex_index.at(he->origin));
+      corner_halfedges.push_back(halfedge_index.at(he));
+      he = he->next;
+    } while (he != face->he);
+    starts.push_back(static_cast<int>(corners.size()));
+  }
+
+  stats.triangles = static_cast<int>(corners.size()) - 2 * face_count;
+  stats.acmr_before = models::vertexCacheACMR(corners, starts, vertex_count, cache_size);
+
+  // A ordem atual é mantida se já for melhor
+  std::vector<int> order = models::vertexCacheOrder(corners, starts, vertex_count, cache_size);
+  {
+    std::vector<int> ordered_corners, ordered_starts = {0};
+    ordered_corners.reserve(corners.size());
+    for (int f : order)
+    {
+      ordered_corners.insert(ordered_corners.end(), corners.begin() + starts[f], corners.begin() + starts[f + 1]);
+      ordered_starts.push_back(static_cast<int>(ordered_corners.size()));
+    }
+
+    stats.acmr_after = models::vertexCacheACMR(ordered_corners, ordered_starts, vertex_count, cache_size);
+    if (stats.acmr_after >= stats.acmr_before)
+    {
+      stats.acmr_after = stats.acmr_before;
+      for (int f = 0; f < face_count; f++)
+        order[f] = f;
+    }
+  }
+
+  // Novos índices: vértices no primeiro uso, meias arestas das faces em sequência e depois as sem face
+  std::vector<int> new_vertex(vertex_count, -1), new_halfedge(halfedge_count, -1);
+  std::vector<int> old_vertex, old_halfedge;
+  old_vertex.reserve(vertex_count);
+  old_halfedge.reserve(halfedge_count);
+
+  for (int f : order)
+  {
+    for (int k = starts[f]; k < starts[f + 1]; k++)
+    {
+      if (new_vertex[corners[k]] < 0)
+      {
+        new_vertex[corners[k]] = static_cast<int>(old_vertex.size());
+        old_vertex.push_back(corners[k]);
+      }
+      new_halfedge[corner_halfedges[k]] = static_cast<int>(old_halfedge.size());
+      old_halfedge.push_back(corner_halfedges[k]);
+    }
+  }
+
+  for (int v = 0; v < vertex_count; v++)
+  {
+    if (new_vertex[v] < 0)
+    {
+      new_vertex[v] = static_cast<int>(old_vertex.size());
+      old_vertex.push_back(v);
+    }
+  }
+
+  for (int i = 0; i < halfedge_count; i++)
+  {
+    if (new_halfedge[i] < 0)
+    {
+      new_halfedge[i] = static_cast<int>(old_halfedge.size());
+      old_halfedge.push_back(i);
+    }
+  }
+
+  // Cópias na nova ordem, com as ligações apontando para as cópias
+  std::vector<Vertex> new_vertex_storage(vertex_count);
+  std::vector<Face> new_face_storage(face_count);
+  std::vector<HalfEdge> new_halfedge_storage(halfedge_count);
+
+  auto vertex_at = [&](const Vertex *vertex) -> Vertex *
+  { return vertex ? &new_vertex_storage[new_vertex[vertex_index.at(vertex)]] : nullptr; };
+  auto halfedge_at = [&](const HalfEdge *he) -> HalfEdge *
+  { return he ? &new_halfedge_storage[new_halfedge[halfedge_index.at(he)]] : nullptr; };
+
+  std::vector<int> new_face(face_count);
+  for (int i = 0; i < face_count; i++)
+    new_face[order[i]] = i;
+  auto face_at = [&](const Face *face) -> Face *
+  { return face ? &new_face_storage[new_face[face_index.at(face)]] : nullptr; };
+
+  for (int i = 0; i < vertex_count; i++)
+  {
+    Vertex &vertex = new_vertex_storage[i];
+    vertex = *vertexes[old_vertex[i]];
+    vertex.incident_edge = halfedge_at(vertex.incident_edge);
+    vertex.index = i;
+  }
+
+  for (int i = 0; i < face_count; i++)
+  {
+    Face &face = new_face_storage[i];
+    face = *faces[order[i]];
+    face.he = halfedge_at(face.he);
+    for (Vertex *&vertex : face.vertexes)
+      vertex = vertex_at(vertex);
+    face.clipped_vertexes.clear();
+  }
+
+  for (int i = 0; i < halfedge_count; i++)
+  {
+    HalfEdge &he = new_halfedge_storage[i];
+    he = *halfedges[old_halfedge[i]];
+    he.next = halfedge_at(he.next);
+    he.prev = halfedge_at(he.prev);
+    he.twin = halfedge_at(he.twin);
+    he.origin = vertex_at(he.origin);
+    he.incident_face = face_at(he.incident_face);
+    he.index = i;
+  }
+
+  // Atributos por canto seguem as meias arestas
+  auto permute = [&](auto &stream)
+  {
+    if (stream.size() != static_cast<std::size_t>(halfedge_count))
+      return;
+
+    auto permuted = stream;
+    for (int i = 0; i < halfedge_count; i++)
+      permuted[i] = stream[halfedges[old_halfedge[i]]->index];
+    stream.swap(permuted);
+  };
+
+  permute(corner_uvs);
+  permute(corner_normals);
+  permute(corner_colors);
+
+  // Elementos antigos: os de createMesh foram alocados um a um
+  if (vertex_storage.empty())
+  {
+    for (Vertex *vertex : vertexes)
+      delete vertex;
+    for (Face *face : faces)
+      delete face;
+    for (HalfEdge *he : halfedges)
+      delete he;
+  }
+
+  halfedges_map.clear();
+  vertex_storage.swap(new_vertex_storage);
+  face_storage.swap(new_face_storage);
+  halfedge_storage.swap(new_halfedge_storage);
+
+  for (int i = 0; i < vertex_count; i++)
+    vertexes[i] = &vertex_storage[i];
+  for (int i = 0; i < face_count; i++)
+    faces[i] = &face_storage[i];
+  for (int i = 0; i < halfedge_count; i++)
+    halfedges[i] = &halfedge_storage[i];
+
+  layout = stats;
+  return stats;
 }
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include <models/mesh_instance.hpp>
+
+/**
+ * @brief Construtor da classe MeshInstance
+ *
+ * @param asset Malha compartilhada
+ * @param model Matriz de modelo (SRO -> SRU)
+ * @param id Identificador da instância
+ */
+MeshInstance::MeshInstance(MeshAsset *asset, const Matrix &model, std::string id)
+{
+  this->asset = asset;
+  this->has_material_override = false;
+  this->is_visible = true;
+  this->id = id.empty() ? asset->id : id;
+  this->setModel(model);
+}
+
+/**
+ * @brief Destrutor da classe MeshInstance
+ *
+ * @note A malha não é liberada aqui, pois ela é compartilhada entre instâncias
+ */
+MeshInstance::~MeshInstance() = default;
+
+/**
+ * @brief Atualiza a matriz de modelo da instância
+ *
+ * @param model Nova matriz de modelo
+ *
+ * @note A inversa e a bounding box no SRU são recalculadas
+ */
+void MeshInstance::setModel(const Matrix &model)
+{
+  this->model = model;
+  this->inverse_model = MatrixInvert(model);
+  computeWorldBounds();
+}
+
+/**
+ * @brief Sobrescreve o material da malha para esta instância
+ *
+ * @param material Material da instância
+ */
+void MeshInstance::setMaterial(const models::Material &material)
+{
+  this->material = material;
+  this->has_material_override = true;
+}
+
+/**
+ * @brief Obtém o material efetivo da instância
+ *
+ * @return const models::Material& Material da instância, ou o da malha caso não haja sobrescrita
+ */
+const models::Material &MeshInstance::getMaterial() const
+{
+  return has_material_override ? material : asset->material;
+}
+
+/**
+ * @brief Obtém o centroide da instância no SRU
+ *
+ * @return Vec3f Centro da bounding box no SRU
+ */
+Vec3f MeshInstance::getCentroid() const
+{
+  return (world_bounds.min + world_bounds.max) * 0.5f;
+}
+
+/**
+ * @brief Calcula a bounding box da instância no SRU
+ *
+ * @note Os 8 cantos da bounding box da malha são transformados pela matriz de modelo
+ * @note Deve ser chamado sempre que a matriz de modelo mudar (setModel já faz isso)
+ */
+void MeshInstance::computeWorldBounds()
+{
+  const AABB &local = asset->bounds;
+
+  Vec3f minV = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+  Vec3f maxV = {-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max()};
+
+  for (int i = 0; i < 8; i++)
+  {
+    Vec4f corner = {(i & 1) ? local.max.x : local.min.x,
+                    (i & 2) ? local.max.y : local.min.y,
+                    (i & 4) ? local.max.z : local.min.z,
+                    1.0f};
+
+    Vec4f world = MatrixMultiplyVector(model, corner);
+
+    minV.x = std::min(minV.x, world.x);
+    minV.y = std::min(minV.y, world.y);
+    minV.z = std::min(minV.z, world.z);
+
+    maxV.x = std::max(maxV.x, world.x);
+    maxV.y = std::max(maxV.y, world.y);
+    maxV.z = std::max(maxV.z, world.z);
+  }
+
+  world_bounds.min = minV;
+  world_bounds.max = maxV;
+}
@@ -0,0 +1,465 @@
+#include <models/obj_importer.hpp>
+#include <utils/asset_io.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace models
+{
+  static constexpr std::size_t OBJ_MIN_CHUNK = 1024 * 1024; // Tamanho mínimo de um bloco interpretado por uma thread
+
+  static const double POWERS_OF_TEN[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                         1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+  // Índice negativo (relativo ao fim da lista) resolvido depois que o início do bloco na lista é conhecido
+  struct ObjRelative
+  {
+    std::size_t corner;
+    int local;     // Posição na lista do próprio bloco (negativa se aponta para um bloco anterior)
+    int attribute; // 0 = posição, 1 = UV, 2 = normal
+  };
+
+  // Resultado de um bloco do arquivo
+  struct ObjChunk
+  {
+    std::vector<Vec3f> positions;
+    std::vector<Vec2f> uvs;
+    std::vector<Vec3f> normals;
+    std::vector<int> corners;        // Índices (a partir de 0) em positions de todo o arquivo
+    std::vector<int> corner_uvs;     // Índices em uvs (-1 = canto sem UV)
+    std::vector<int> corner_normals; // Índices em normals (-1 = canto sem normal)
+    std::vector<int> face_sizes;
+    std::vector<ObjRelative> relative;
+    bool missing_uvs = false;
+    bool missing_normals = false;
+    const char *error = nullptr; // Linha inválida (nullptr = bloco interpretado)
+  };
+
+  // Executa task(0 .. count - 1) distribuindo os índices entre as threads
+  static void parallel_for(std::size_t count, const std::function<void(std::size_t)> &task)
+  {
+    std::atomic<std::size_t> next{0};
+    auto run = [&]()
+    {
+      for (std::size_t i = next++; i < count; i = next++)
+        task(i);
+    };
+
+    unsigned int hardware = std::thread::hardware_concurrency();
+    std::size_t helpers_count = std::min<std::size_t>(std::clamp(hardware, 1u, 16u) - 1, count > 0 ? count - 1 : 0);
+
+    std::vector<std::thread> helpers;
+    for (std::size_t i = 0; i < helpers_count; i++)
+      helpers.emplace_back(run);
+
+    run();
+    for (std::thread &helper : helpers)
+      helper.join();
+  }
+
+  static bool is_digit(char c)
+  {
+    return c >= '0' && c <= '9';
+  }
+
+  static const char *skip_spaces(const char *p, const char *end)
+  {
+    while (p < end && (*p == ' ' || *p == '\t'))
+      p++;
+    return p;
+  }
+
+  /**
+   * @brief Lê um número real
+   *
+   * @return const char* Posição depois do número, ou nullptr se não houver número
+   *
+   * @note Até 19 dígitos significativos são acumulados em um inteiro e escalados por uma potência de 10 exata
+   *       (resultado correto para os valores usuais de um OBJ, sem passar por strtof e sem exigir terminador nulo)
+   */
+  static const char *parse_float(const char *p, const char *end, float &value)
+  {
+    p = skip_spaces(p, end);
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+      negative = *p++ == '-';
+
+    std::uint64_t mantissa = 0;
+    int digits = 0, exponent = 0;
+    bool any = false;
+
+    for (; p < end && is_digit(*p); p++, any = true)
+    {
+      if (digits < 19)
+      {
+        mantissa = mantissa * 10 + static_cast<std::uint64_t>(*p - '0');
+        digits += mantissa != 0;
+      }
+      else
+        exponent++;
+    }
+
+    if (p < end && *p == '.')
+    {
+      for (p++; p < end && is_digit(*p); p++, any = true)
+      {
+        if (digits < 19)
+        {
+          mantissa = mantissa * 10 + static_cast<std::uint64_t>(*p - '0');
+          digits += mantissa != 0;
+          exponent--;
+        }
+      }
+    }
+
+    if (!any)
+      return nullptr;
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+      const char *q = p + 1;
+      bool negative_exponent = false;
+      if (q < end && (*q == '-' || *q == '+'))
+        negative_exponent = *q++ == '-';
+
+      int power = 0;
+      bool exponent_digits = false;
+      for (; q < end && is_digit(*q); q++, exponent_digits = true)
+        power = std::min(power * 10 + (*q - '0'), 10000);
+
+      if (exponent_digits)
+      {
+        exponent += negative_exponent ? -power : power;
+        p = q;
+      }
+    }
+
+    double result = static_cast<double>(mantissa);
+    for (; exponent > 22; exponent -= 22)
+      result *= POWERS_OF_TEN[22];
+    for (; exponent < -22; exponent += 22)
+      result /= POWERS_OF_TEN[22];
+    result = exponent >= 0 ? result * POWERS_OF_TEN[exponent] : result / POWERS_OF_TEN[-exponent];
+
+    value = static_cast<float>(negative ? -result : result);
+    return p;
+  }
+
+  // Lê um índice inteiro (com sinal). Retorna nullptr se não houver dígitos
+  static const char *parse_index(const char *p, const char *end, std::int64_t &value)
+  {
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+      negative = *p++ == '-';
+
+    if (p >= end || !is_digit(*p))
+      return nullptr;
+
+    std::int64_t result = 0;
+    for (; p < end && is_digit(*p); p++)
+      result = std::min<std::int64_t>(result * 10 + (*p - '0'), INT64_C(1) << 40);
+
+    value = negative ? -result : result;
+    return p;
+  }
+
+  // Converte um índice do OBJ (1..n ou negativo a partir do fim) e registra os relativos para a junção
+  static bool resolve_index(ObjChunk &chunk, std::int64_t index, std::size_t local_count, std::vector<int> &target, int attribute)
+  {
+    if (index == 0 || index > INT32_MAX || index < -INT32_MAX)
+      return false;
+
+    if (index > 0)
+      target.push_back(static_cast<int>(index - 1));
+    else
+    {
+      chunk.relative.push_back({target.size(), static_cast<int>(static_cast<std::int64_t>(local_count) + index), attribute});
+      target.push_back(-1);
+    }
+
+    return true;
+  }
+
+  // Lê uma linha "f". Retorna false se a linha for inválida
+  static bool parse_face(ObjChunk &chunk, const char *p, const char *end)
+  {
+    int size = 0;
+    while (true)
+    {
+      p = skip_spaces(p, end);
+      if (p >= end || *p == '#')
+        break;
+
+      std::int64_t vertex, uv = 0, normal = 0;
+      p = parse_index(p, end, vertex);
+      if (!p || !resolve_index(chunk, vertex, chunk.positions.size(), chunk.corners, 0))
+        return false;
+
+      if (p < end && *p == '/')
+      {
+        p++;
+        if (p < end && *p != '/' && !(p = parse_index(p, end, uv)))
+          return false;
+        if (p < end && *p == '/' && !(p = parse_index(p + 1, end, normal)))
+          return false;
+      }
+
+      if (uv)
+      {
+        if (!resolve_index(chunk, uv, chunk.uvs.size(), chunk.corner_uvs, 1))
+          return false;
+      }
+      else
+      {
+        chunk.corner_uvs.push_back(-1);
+        chunk.missing_uvs = true;
+      }
+
+      if (normal)
+      {
+        if (!resolve_index(chunk, normal, chunk.normals.size(), chunk.corner_normals, 2))
+          return false;
+      }
+      else
+      {
+        chunk.corner_normals.push_back(-1);
+        chunk.missing_normals = true;
+      }
+
+      if (p < end && *p != ' ' && *p != '\t' && *p != '#')
+        return false;
+      size++;
+    }
+
+    if (size > 0)
+      chunk.face_sizes.push_back(size);
+    return true;
+  }
+
+  // Interpreta as linhas de [begin, end) (o bloco começa no início de uma linha)
+  static void parse_chunk(ObjChunk &chunk, const char *begin, const char *end)
+  {
+    for (const char *line = begin; line < end;)
+    {
+      const char *newline = static_cast<const char *>(std::memchr(line, '\n', end - line));
+      const char *line_end = newline ? newline : end;
+      const char *next = newline ? newline + 1 : end;
+      if (line_end > line && line_end[-1] == '\r')
+        line_end--;
+
+      const char *p = skip_spaces(line, line_end);
+      bool ok = true;
+
+      if (line_end - p >= 2 && p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+      {
+        Vec3f position;
+        ok = (p = parse_float(p + 2, line_end, position.x)) && (p = parse_float(p, line_end, position.y)) &&
+             (p = parse_float(p, line_end, position.z));
+        chunk.positions.push_back(position);
+      }
+      else if (line_end - p >= 3 && p[0] == 'v' && p[1] == 't' && (p[2] == ' ' || p[2] == '\t'))
+      {
+        Vec2f uv;
+        ok = (p = parse_float(p + 3, line_end, uv.x)) && (p = parse_float(p, line_end, uv.y));
+        chunk.uvs.push_back(uv);
+      }
+      else if (line_end - p >= 3 && p[0] == 'v' && p[1] == 'n' && (p[2] == ' ' || p[2] == '\t'))
+      {
+        Vec3f normal;
+        ok = (p = parse_float(p + 3, line_end, normal.x)) && (p = parse_float(p, line_end, normal.y)) &&
+             (p = parse_float(p, line_end, normal.z));
+        chunk.normals.push_back(normal);
+      }
+      else if (line_end - p >= 2 && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+        ok = parse_face(chunk, p + 2, line_end);
+
+      if (!ok)
+      {
+        chunk.error = line;
+        return;
+      }
+
+      line = next;
+    }
+  }
+
+  bool importObj(const char *data, std::size_t size, const std::string &name, MeshSource &source, ObjStats *stats)
+  {
+    auto fail = [&name](const std::string &reason)
+    {
+      std::cerr << "Erro ao importar OBJ '" << name << "': " << reason << "\n";
+      return false;
+    };
+
+    // Blocos de tamanho parecido, cortados depois de um fim de linha
+    unsigned int hardware = std::thread::hardware_concurrency();
+    std::size_t chunk_count = std::clamp<std::size_t>(size / OBJ_MIN_CHUNK, 1, std::clamp(hardware, 1u, 16u) * 4);
+
+    std::vector<const char *> bounds(chunk_count + 1);
+    bounds[0] = data;
+    bounds[chunk_count] = data + size;
+    for (std::size_t i = 1; i < chunk_count; i++)
+    {
+      const char *cut = std::max(data + size * i / chunk_count, bounds[i - 1]);
+      const char *newline = static_cast<const char *>(std::memchr(cut, '\n', data + size - cut));
+      bounds[i] = newline ? newline + 1 : data + size;
+    }
+
+    std::vector<ObjChunk> chunks(chunk_count);
+    parallel_for(chunk_count, [&](std::size_t i)
+                 { parse_chunk(chunks[i], bounds[i], bounds[i + 1]); });
+
+    // Início de cada bloco nas listas do arquivo
+    struct Base
+    {
+      std::size_t positions = 0, uvs = 0, normals = 0, corners = 0, faces = 0;
+    };
+
+    std::vector<Base> bases(chunk_count + 1);
+    bool missing_uvs = false, missing_normals = false;
+    for (std::size_t i = 0; i < chunk_count; i++)
+    {
+      const ObjChunk &chunk = chunks[i];
+      if (chunk.error)
+      {
+        std::size_t line = 1 + std::count(data, chunk.error, '\n');
+        return fail("linha " + std::to_string(line) + " inválida");
+      }
+
+      bases[i + 1].positions = bases[i].positions + chunk.positions.size();
+      bases[i + 1].uvs = bases[i].uvs + chunk.uvs.size();
+      bases[i + 1].normals = bases[i].normals + chunk.normals.size();
+      bases[i + 1].corners = bases[i].corners + chunk.corners.size();
+      bases[i + 1].faces = bases[i].faces + chunk.face_sizes.size();
+      missing_uvs = missing_uvs || chunk.missing_uvs;
+      missing_normals = missing_normals || chunk.missing_normals;
+    }
+
+    const Base &total = bases[chunk_count];
+    if (total.faces == 0)
+      return fail("nenhuma face");
+    if (total.positions > INT32_MAX || total.corners > INT32_MAX)
+      return fail("malha grande demais");
+
+    bool has_uvs = !missing_uvs && total.uvs > 0;
+    bool has_normals = !missing_normals && total.normals > 0;
+
+    source.positions.resize(total.positions);
+    source.corners.resize(total.corners);
+    source.face_starts.resize(total.faces + 1);
+    source.face_starts[0] = 0;
+    source.uvs.clear();
+    source.normals.clear();
+
+    std::vector<Vec2f> uvs(has_uvs ? total.uvs : 0);
+    std::vector<Vec3f> normals(has_normals ? total.normals : 0);
+    if (has_uvs)
+      source.uvs.resize(total.corners);
+    if (has_normals)
+      source.normals.resize(total.corners);
+
+    // Junção em duas passadas paralelas: listas de atributos, depois os cantos (que apontam para qualquer bloco)
+    parallel_for(chunk_count, [&](std::size_t i)
+                 {
+                   ObjChunk &chunk = chunks[i];
+                   const Base &base = bases[i];
+
+                   std::copy(chunk.positions.begin(), chunk.positions.end(), source.positions.begin() + base.positions);
+                   if (has_uvs)
+                     std::copy(chunk.uvs.begin(), chunk.uvs.end(), uvs.begin() + base.uvs);
+                   if (has_normals)
+                     std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + base.normals);
+
+                   for (const ObjRelative &relative : chunk.relative)
+                   {
+                     std::vector<int> &target = relative.attribute == 0 ? chunk.corners : relative.attribute == 1 ? chunk.corner_uvs : chunk.corner_normals;
+                     std::size_t start = relative.attribute == 0 ? base.positions : relative.attribute == 1 ? base.uvs : base.normals;
+                     std::int64_t index = static_cast<std::int64_t>(start) + relative.local;
+                     target[relative.corner] = index >= 0 ? static_cast<int>(index) : INT32_MAX;
+                   }
+
+                   std::copy(chunk.corners.begin(), chunk.corners.end(), source.corners.begin() + base.corners);
+
+                   int start = static_cast<int>(base.corners);
+                   for (std::size_t f = 0; f < chunk.face_sizes.size(); f++)
+                   {
+                     start += chunk.face_sizes[f];
+                     source.face_starts[base.faces + f + 1] = start;
+                   }
+
+                   std::vector<Vec3f>().swap(chunk.positions);
+                   std::vector<int>().swap(chunk.corners); });
+
+    std::atomic<bool> valid{true};
+    parallel_for(chunk_count, [&](std::size_t i)
+                 {
+                   ObjChunk &chunk = chunks[i];
+                   std::size_t corner = bases[i].corners;
+
+                   for (std::size_t k = 0; k < chunk.corner_uvs.size() && has_uvs; k++)
+                   {
+                     std::size_t index = static_cast<std::size_t>(chunk.corner_uvs[k]);
+                     if (index >= uvs.size())
+                       valid = false;
+                     else
+                       source.uvs[corner + k] = uvs[index];
+                   }
+
+                   for (std::size_t k = 0; k < chunk.corner_normals.size() && has_normals; k++)
+                   {
+                     std::size_t index = static_cast<std::size_t>(chunk.corner_normals[k]);
+                     if (index >= normals.size())
+                       valid = false;
+                     else
+                       source.normals[corner + k] = normals[index];
+                   }
+
+                   chunk = ObjChunk(); });
+
+    if (!valid)
+      return fail("índice de UV ou normal fora da lista");
+
+    if (stats)
+    {
+      stats->bytes = size;
+      stats->chunks = static_cast<int>(chunk_count);
+      stats->positions = static_cast<int>(total.positions);
+      stats->uvs = static_cast<int>(total.uvs);
+      stats->normals = static_cast<int>(total.normals);
+      stats->faces = static_cast<int>(total.faces);
+      stats->corners = static_cast<int>(total.corners);
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief Importa um arquivo OBJ
+   *
+   * @param filename Caminho do arquivo
+   * @param source Recebe a malha (índices de posição são conferidos no cozimento)
+   * @param stats Recebe o resumo (opcional)
+   * @return true Se o arquivo foi interpretado
+   *
+   * @note O arquivo é lido pelo io::AssetIO (caminhos cobertos por um pacote montado são lidos do pacote)
+   */
+  bool importObj(const std::string &filename, MeshSource &source, ObjStats *stats)
+  {
+    io::ReadResult result = io::shared().readBlocking(filename);
+    if (!result.ok)
+    {
+      std::cerr << "Erro ao importar OBJ '" << filename << "': " << result.error << "\n";
+      return false;
+    }
+
+    return importObj(reinterpret_cast<const char *>(result.data), result.size, filename, source, stats);
+  }
+}
@@ -0,0 +1,190 @@
+#include <models/palette.hpp>
+#include <models/texture.hpp>
+
+#include <algorithm>
+
+namespace models
+{
+  /**
+   * @brief Busca a cor mais próxima da paleta
+   *
+   * @param color Cor RGB (o alpha é ignorado)
+   * @return Uint8 Índice da cor
+   *
+   * @note Busca exaustiva: é usada apenas na quantização das texturas e na criação do colormap
+   * @note As posições sem cor (quando o median cut gera menos caixas) ficam fora da busca
+   */
+  Uint8 Palette::nearest(const Color &color) const
+  {
+    int best = 0;
+    int best_distance = 1 << 30;
+
+    for (int i = 0; i < std::min(count, static_cast<int>(PALETTE_EMPTY)); i++)
+    {
+      int dr = colors[i].r - color.r;
+      int dg = colors[i].g - color.g;
+      int db = colors[i].b - color.b;
+      int distance = dr * dr + dg * dg + db * db;
+
+      if (distance < best_distance)
+      {
+        best_distance = distance;
+        best = i;
+      }
+    }
+
+    return static_cast<Uint8>(best);
+  }
+
+  int Colormap::level(float intensity)
+  {
+    int value = static_cast<int>(intensity * (COLORMAP_LEVELS / 2) + 0.5f);
+    return std::clamp(value, 0, COLORMAP_LEVELS - 1);
+  }
+
+  // Canal c (0 = R, 1 = G, 2 = B) de uma cor
+  static Uint8 channel_value(const Color &color, int c)
+  {
+    return c == 0 ? color.r : (c == 1 ? color.g : color.b);
+  }
+
+  /**
+   * @brief Gera uma paleta por median cut
+   *
+   * @param textures Texturas usadas na cena
+   * @return Palette Paleta com até 254 cores da imagem seguidas do preto (count cores) e PALETTE_EMPTY
+   *
+   * @note A caixa de cores com o maior intervalo em algum canal é dividida na mediana desse canal até
+   *       existirem 254 caixas, cada cor da paleta é a média de uma caixa
+   * @note A paleta sempre contém preto, que é para onde o colormap leva as cores no nível de luz 0
+   */
+  Palette buildPalette(const std::vector<const Texture *> &textures)
+  {
+    Palette palette = {};
+
+    std::vector<Color> samples;
+    for (const Texture *texture : textures)
+    {
+      if (!texture || texture->levels.empty() || texture->texels.empty())
+        continue;
+
+      const TextureLevel &base = texture->levels[0];
+      samples.insert(samples.end(), texture->texels.begin() + base.offset, texture->texels.begin() + base.offset + base.width * base.height);
+    }
+    samples.push_back(BLACK);
+
+    // Caixa = intervalo [begin, end) de samples
+    struct Box
+    {
+      size_t begin, end;
+      int channel, range;
+    };
+
+    auto measure = [&samples](size_t begin, size_t end)
+    {
+      Uint8 low[3] = {255, 255, 255}, high[3] = {0, 0, 0};
+      for (size_t i = begin; i < end; i++)
+      {
+        const Uint8 value[3] = {samples[i].r, samples[i].g, samples[i].b};
+        for (int c = 0; c < 3; c++)
+        {
+          low[c] = std::min(low[c], value[c]);
+          high[c] = std::max(high[c], value[c]);
+        }
+      }
+
+      Box box = {begin, end, 0, high[0] - low[0]};
+      for (int c = 1; c < 3; c++)
+      {
+        if (high[c] - low[c] > box.range)
+        {
+          box.channel = c;
+          box.range = high[c] - low[c];
+        }
+      }
+      return box;
+    };
+
+    std::vector<Box> boxes = {measure(0, samples.size())};
+
+    // Uma posição fica reservada para o preto e outra para PALETTE_EMPTY
+    const int color_count = PALETTE_SIZE - 2;
+
+    while (static_cast<int>(boxes.size()) < color_count)
+    {
+      // Caixa com o maior intervalo (que ainda pode ser dividida)
+      auto widest = std::max_element(boxes.begin(), boxes.end(), [](const Box &a, const Box &b)
+                                     { return a.range < b.range; });
+      if (widest->range == 0 || widest->end - widest->begin < 2)
+        break;
+
+      Box box = *widest;
+      int channel = box.channel;
+      size_t middle = box.begin + (box.end - box.begin) / 2;
+
+      std::nth_element(samples.begin() + box.begin, samples.begin() + middle, samples.begin() + box.end, [channel](const Color &a, const Color &b)
+                       { return channel_value(a, channel) < channel_value(b, channel); });
+
+      *widest = measure(box.begin, middle);
+      boxes.push_back(measure(middle, box.end));
+    }
+
+    for (size_t i = 0; i < boxes.size(); i++)
+    {
+      long r = 0, g = 0, b = 0;
+      for (size_t k = boxes[i].begin; k < boxes[i].end; k++)
+      {
+        r += samples[k].r;
+        g += samples[k].g;
+        b += samples[k].b;
+      }
+
+      long count = static_cast<long>(boxes[i].end - boxes[i].begin);
+      palette.colors[i] = {static_cast<Uint8>(r / count), static_cast<Uint8>(g / count), static_cast<Uint8>(b / count), 255};
+    }
+
+    // Preto exato logo depois das caixas (a caixa que contém o preto pode ter outra média)
+    palette.colors[boxes.size()] = BLACK;
+    palette.count = static_cast<int>(boxes.size()) + 1;
+
+    palette.colors[PALETTE_EMPTY] = TRANSPARENT;
+    return palette;
+  }
+
+  /**
+   * @brief Pré-calcula o colormap
+   *
+   * @param palette Paleta
+   * @return Colormap Para cada nível de luz e cada cor, o índice da cor escalada mais próxima
+   *
+   * @note Com o colormap a iluminação de um texel é uma única leitura: colormap[nível][índice]
+   * @note PALETTE_EMPTY (e as posições sem cor) continua vazio em todos os níveis
+   */
+  Colormap buildColormap(const Palette &palette)
+  {
+    Colormap colormap;
+
+    for (int level = 0; level < COLORMAP_LEVELS; level++)
+    {
+      float scale = static_cast<float>(level) / (COLORMAP_LEVELS / 2);
+
+      for (int i = 0; i < PALETTE_SIZE; i++)
+      {
+        if (i >= palette.count)
+        {
+          colormap.table[level][i] = PALETTE_EMPTY;
+          continue;
+        }
+
+        const Color &color = palette.colors[i];
+        Color lit = {static_cast<Uint8>(std::min(color.r * scale, 255.0f)),
+                     static_cast<Uint8>(std::min(color.g * scale, 255.0f)),
+                     static_cast<Uint8>(std::min(color.b * scale, 255.0f)), 255};
+
+        colormap.table[level][i] = palette.nearest(lit);
+      }
+    }
+
+    return colormap;
+  }
+}
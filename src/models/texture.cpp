@@ -1,32 +1,497 @@
 #include <models/texture.hpp>
+#include <utils/pak.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
 
 namespace models
 {
+  /**
+   * @brief Escolhe o nível de mipmap
+   *
+   * @param texels_per_pixel Quantos texels do nível 0 um pixel da tela cobre (na direção de maior variação)
+   * @return int Nível a ser amostrado (0 quando a textura está ampliada)
+   *
+   * @note Cada nível tem metade da resolução do anterior, então o nível é log2(texels_per_pixel)
+   */
+  int Texture::selectLevel(float texels_per_pixel) const
+  {
+    sampled_texels_per_pixel = std::min(sampled_texels_per_pixel, texels_per_pixel);
+
+    if (texels_per_pixel <= 1.0f || levels.size() <= 1)
+      return 0;
+
+    int level = static_cast<int>(std::log2(texels_per_pixel));
+    return std::min(level, levelCount() - 1);
+  }
+
+  /**
+   * @brief Menor potência de dois maior ou igual a value
+   */
+  static int next_power_of_two(int value)
+  {
+    int result = 1;
+    while (result < value)
+      result <<= 1;
+    return result;
+  }
+
+  /**
+   * @brief log2 de uma potência de dois
+   */
+  static int log2_of_power_of_two(int value)
+  {
+    int result = 0;
+    while ((1 << result) < value)
+      result++;
+    return result;
+  }
+
+  /**
+   * @brief Espalha os bits de value nas posições pares (0 -> 0, 1 -> 1, 2 -> 4, 3 -> 5, ...)
+   *
+   * @param value Valor com no máximo bits bits
+   * @param bits Número de bits de value
+   */
+  static int dilate(int value, int bits)
+  {
+    int result = 0;
+    for (int i = 0; i < bits; i++)
+      result |= ((value >> i) & 1) << (2 * i);
+    return result;
+  }
+
+  /**
+   * @brief Reordena os texels de todos os níveis para outro layout
+   *
+   * @param new_layout Layout desejado
+   *
+   * @note Nos layouts em blocos, cada bloco ocupa 2^(2 * tile_log2) texels consecutivos (ordem de Morton dentro
+   *       do bloco) e os blocos ficam linha a linha. Um passo em v dentro do bloco cai na mesma linha de cache
+   * @note Em níveis menores que o bloco, o bloco é reduzido para o menor lado do nível
+   */
+  void Texture::setLayout(TextureLayout new_layout)
+  {
+    // Os blocos BC1 já são 4x4, o layout só vale para os texels RGBA
+    if (new_layout == layout || compression != TextureCompression::NONE)
+      return;
+
+    // Cópia linha a linha de todos os níveis (texels e índices da paleta)
+    std::vector<Color> row_major(texels.size());
+    std::vector<Uint8> row_major_indices(indices.size());
+    for (const TextureLevel &level : levels)
+    {
+      for (int y = 0; y < level.height; y++)
+      {
+        for (int x = 0; x < level.width; x++)
+        {
+          std::size_t from = level.offset + address(level, x, y);
+          std::size_t to = level.offset + y * level.width + x;
+          row_major[to] = texels[from];
+          if (!indices.empty())
+            row_major_indices[to] = indices[from];
+        }
+      }
+    }
+
+    // Tabelas do novo layout
+    layout = new_layout;
+    swizzle.clear();
+
+    if (layout != TextureLayout::ROW_MAJOR)
+    {
+      int tile_log2 = layout == TextureLayout::TILED_4X4 ? 2 : 3;
+
+      for (TextureLevel &level : levels)
+      {
+        int height_log2 = log2_of_power_of_two(level.height);
+        int bits = std::min({tile_log2, level.width_log2, height_log2});
+        int tile_mask = (1 << bits) - 1;
+
+        level.tile_log2 = bits;
+        level.swizzle_offset = swizzle.size();
+
+        // Bits de x nas posições pares do bloco e índice do bloco na linha
+        for (int x = 0; x < level.width; x++)
+          swizzle.push_back(dilate(x & tile_mask, bits) | ((x >> bits) << (2 * bits)));
+
+        // Bits de y nas posições ímpares do bloco e linha de blocos
+        for (int y = 0; y < level.height; y++)
+          swizzle.push_back((dilate(y & tile_mask, bits) << 1) | ((y >> bits) << (bits + level.width_log2)));
+      }
+    }
+
+    for (const TextureLevel &level : levels)
+    {
+      for (int y = 0; y < level.height; y++)
+      {
+        for (int x = 0; x < level.width; x++)
+        {
+          std::size_t from = level.offset + y * level.width + x;
+          std::size_t to = level.offset + address(level, x, y);
+          texels[to] = row_major[from];
+          if (!indices.empty())
+            indices[to] = row_major_indices[from];
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Média 2x2 usada na redução dos mipmaps
+   *
+   * @note As tabelas de conversão sRGB <-> linear (gamma 2.2) são montadas uma vez por redução
+   */
+  struct MipFilter
+  {
+    float to_linear[256];
+    bool gamma_correct;
+
+    explicit MipFilter(bool gamma) : gamma_correct(gamma)
+    {
+      for (int i = 0; i < 256; i++)
+        to_linear[i] = gamma_correct ? std::pow(i / 255.0f, 2.2f) : i / 255.0f;
+    }
+
+    Uint8 to_channel(float value) const
+    {
+      float encoded = gamma_correct ? std::pow(value, 1.0f / 2.2f) : value;
+      return static_cast<Uint8>(std::clamp(encoded * 255.0f + 0.5f, 0.0f, 255.0f));
+    }
+
+    Color average(const Color *const (&block)[4]) const
+    {
+      float r = 0.0f, g = 0.0f, b = 0.0f, a = 0.0f;
+      for (auto texel : block)
+      {
+        r += to_linear[texel->r];
+        g += to_linear[texel->g];
+        b += to_linear[texel->b];
+        a += texel->a;
+      }
+
+      return {to_channel(r * 0.25f), to_channel(g * 0.25f), to_channel(b * 0.25f), static_cast<Uint8>(a * 0.25f + 0.5f)};
+    }
+  };
+
+  /**
+   * @brief Gera a pirâmide de mipmaps a partir do nível 0
+   *
+   * @param gamma_correct Se verdadeiro, a média é feita no espaço linear (as cores do BMP estão em sRGB)
+   *
+   * @note Cada texel de um nível é a média (box filter) de 2x2 texels do nível anterior
+   * @note Quando uma das dimensões chega a 1, o último texel dessa dimensão é repetido
+   * @note Os níveis são gravados em sequência no mesmo vetor de texels do nível 0
+   */
+  void Texture::buildMipmaps(bool gamma_correct)
+  {
+    if (levels.empty())
+      return;
+
+    // Os mipmaps são gerados a partir dos texels RGBA
+    decompress();
+
+    // A redução é feita linha a linha, o layout é restaurado no final
+    TextureLayout target_layout = layout;
+    setLayout(TextureLayout::ROW_MAJOR);
+
+    // Os índices da paleta deixam de valer (a textura precisa ser quantizada de novo)
+    indices.clear();
+
+    // Descarta os níveis antigos (o nível 0 fica no início do vetor)
+    levels.resize(1);
+    texels.resize(static_cast<std::size_t>(width) * height);
+
+    // Dimensões e posições de todos os níveis, assim o vetor é alocado uma única vez
+    std::size_t total = texels.size();
+    while (levels.back().width > 1 || levels.back().height > 1)
+    {
+      const TextureLevel &source = levels.back();
+
+      TextureLevel level;
+      level.width = std::max(1, source.width / 2);
+      level.height = std::max(1, source.height / 2);
+      level.width_log2 = log2_of_power_of_two(level.width);
+      level.u_mask = level.width - 1;
+      level.v_mask = level.height - 1;
+      level.offset = total;
+
+      total += static_cast<std::size_t>(level.width) * level.height;
+      levels.push_back(level);
+    }
+    texels.resize(total);
+
+    MipFilter filter(gamma_correct);
+
+    for (std::size_t i = 1; i < levels.size(); i++)
+    {
+      const TextureLevel &source = levels[i - 1];
+      const TextureLevel &level = levels[i];
+
+      const Color *source_texels = data(source);
+      Color *level_texels = texels.data() + level.offset;
+
+      for (int y = 0; y < level.height; y++)
+      {
+        int y0 = std::min(2 * y, source.height - 1);
+        int y1 = std::min(2 * y + 1, source.height - 1);
+
+        for (int x = 0; x < level.width; x++)
+        {
+          int x0 = std::min(2 * x, source.width - 1);
+          int x1 = std::min(2 * x + 1, source.width - 1);
+
+          const Color *block[4] = {&source_texels[y0 * source.width + x0], &source_texels[y0 * source.width + x1],
+                                   &source_texels[y1 * source.width + x0], &source_texels[y1 * source.width + x1]};
+
+          level_texels[y * level.width + x] = filter.average(block);
+        }
+      }
+    }
+
+    setLayout(target_layout);
+  }
+
+  /**
+   * @brief Refaz os níveis 1..n apenas sobre uma área do nível 0
+   *
+   * @param x Coluna inicial da área no nível 0
+   * @param y Linha inicial da área no nível 0
+   * @param area_width Largura da área
+   * @param area_height Altura da área
+   * @param gamma_correct Se verdadeiro, a média é feita no espaço linear
+   *
+   * @note Usa o mesmo filtro do buildMipmaps e mantém os níveis existentes. Em cada nível são refeitos os
+   *       texels que cobrem a área, então o resultado é igual ao de um buildMipmaps completo quando a área
+   *       é alinhada ao seu tamanho (potência de dois), como as células de um atlas
+   * @note O endereço respeita o layout atual, não é preciso voltar para linha a linha
+   */
+  void Texture::updateMipmaps(int x, int y, int area_width, int area_height, bool gamma_correct)
+  {
+    if (levels.empty() || area_width <= 0 || area_height <= 0)
+      return;
+
+    decompress();
+
+    // Os índices da paleta deixam de valer (a textura precisa ser quantizada de novo)
+    indices.clear();
+
+    MipFilter filter(gamma_correct);
+
+    int x_end = x + area_width, y_end = y + area_height;
+    for (std::size_t i = 1; i < levels.size(); i++)
+    {
+      const TextureLevel &source = levels[i - 1];
+      const TextureLevel &level = levels[i];
+
+      // Texels do nível que cobrem a área (arredondando para fora)
+      x = x >> 1;
+      y = y >> 1;
+      x_end = std::min(level.width, (x_end + 1) >> 1);
+      y_end = std::min(level.height, (y_end + 1) >> 1);
+
+      for (int ly = y; ly < y_end; ly++)
+      {
+        int y0 = std::min(2 * ly, source.height - 1);
+        int y1 = std::min(2 * ly + 1, source.height - 1);
+
+        for (int lx = x; lx < x_end; lx++)
+        {
+          int x0 = std::min(2 * lx, source.width - 1);
+          int x1 = std::min(2 * lx + 1, source.width - 1);
+
+          const Color *block[4] = {&texels[source.offset + address(source, x0, y0)], &texels[source.offset + address(source, x1, y0)],
+                                   &texels[source.offset + address(source, x0, y1)], &texels[source.offset + address(source, x1, y1)]};
+
+          texels[level.offset + address(level, lx, ly)] = filter.average(block);
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Descarta os níveis mais finos da pirâmide
+   *
+   * @param count Número de níveis descartados (o último nível nunca é descartado)
+   *
+   * @note Os níveis ficam em sequência (do mais fino para o mais grosso) nos texels, índices, tabelas do layout
+   *       e blocos comprimidos, então descartar os primeiros níveis é apagar o início de cada vetor
+   * @note A textura resultante é uma textura menor completa: as UVs continuam valendo, pois são normalizadas
+   */
+  void Texture::dropFinestLevels(int count)
+  {
+    count = std::min(count, levelCount() - 1);
+    if (count <= 0)
+      return;
+
+    const TextureLevel first = levels[count];
+
+    if (!texels.empty())
+      texels.erase(texels.begin(), texels.begin() + first.offset);
+    if (!indices.empty())
+      indices.erase(indices.begin(), indices.begin() + first.offset);
+    if (!swizzle.empty())
+      swizzle.erase(swizzle.begin(), swizzle.begin() + first.swizzle_offset);
+    if (!blocks.empty())
+      blocks.erase(blocks.begin(), blocks.begin() + first.block_offset);
+
+    texels.shrink_to_fit();
+    indices.shrink_to_fit();
+    swizzle.shrink_to_fit();
+    blocks.shrink_to_fit();
+
+    levels.erase(levels.begin(), levels.begin() + count);
+    for (TextureLevel &level : levels)
+    {
+      level.offset -= first.offset;
+      level.swizzle_offset -= first.swizzle_offset;
+      level.block_offset -= first.block_offset;
+    }
+
+    width = levels[0].width;
+    height = levels[0].height;
+  }
+
+  /**
+   * @brief Converte os texels de todos os níveis para índices da paleta
+   *
+   * @param palette Paleta da cena
+   *
+   * @note Cores repetidas são comuns nas texturas, então o resultado da busca é guardado por cor
+   */
+  void Texture::quantize(const Palette &palette)
+  {
+    indices.resize(texels.size());
+
+    std::unordered_map<std::uint32_t, Uint8> cache;
+    for (std::size_t i = 0; i < texels.size(); i++)
+    {
+      const Color &texel = texels[i];
+      std::uint32_t key = (static_cast<std::uint32_t>(texel.r) << 16) | (static_cast<std::uint32_t>(texel.g) << 8) | texel.b;
+
+      auto found = cache.find(key);
+      if (found == cache.end())
+        found = cache.emplace(key, palette.nearest(texel)).first;
+
+      indices[i] = found->second;
+    }
+  }
+
+  /**
+   * @brief Carrega uma textura BMP
+   *
+   * @param filename Caminho do arquivo
+   * @param tex Textura que recebe o nível 0 e os mipmaps
+   * @return true Se a textura foi carregada
+   *
+   * @note O arquivo é mapeado em memória e as linhas são decodificadas direto no vetor de texels da textura,
+   *       que já é reservado com o tamanho da pirâmide inteira (os mipmaps não realocam o vetor)
+   * @note Imagens com dimensões que não são potências de dois são reamostradas (vizinho mais próximo)
+   *       para a próxima potência de dois, assim a repetição continua sendo feita com máscaras
+   * @note Caminhos cobertos por um pacote montado (pak::mount) são lidos do pacote
+   */
   bool loadTexture(const std::string &filename, Texture &tex)
   {
+    // Arquivo de um pacote montado: decodificado direto das páginas do pacote
+    pak::File packed;
+    if (pak::open(filename, packed))
+      return loadTexture(filename, packed.data, packed.size, tex);
+
     try
     {
-      // Usa bmp_reader para carregar BMP em 1D
-      BMPImage bmp = bmp::load(filename);
+      bmp::MappedFile file(filename);
+      return loadTexture(filename, file.data(), file.size(), tex);
+    }
+    catch (const std::exception &e)
+    {
+      std::cerr << "Erro ao carregar textura '" << filename << "': " << e.what() << "\n";
+      return false;
+    }
+  }
+
+  /**
+   * @brief Decodifica uma textura já lida para a memória
+   *
+   * @param name Nome do arquivo (a extensão .bc1 escolhe o formato comprimido)
+   * @param data Conteúdo do arquivo
+   * @param size Tamanho do arquivo
+   * @param tex Textura que recebe o nível 0 e os mipmaps
+   * @return true Se a textura foi decodificada
+   *
+   * @note Usada pelos carregamentos assíncronos (io::AssetIO), que entregam o arquivo inteiro em um buffer
+   */
+  bool loadTexture(const std::string &name, const std::uint8_t *data, std::size_t size, Texture &tex)
+  {
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".bc1") == 0)
+      return loadCompressedTexture(name, data, size, tex);
 
-      tex.width = bmp.width;
-      tex.height = bmp.height;
-      tex.pixels.resize(tex.height, std::vector<Color>(tex.width));
+    try
+    {
+      bmp::Header header = bmp::parse(data, size);
 
-      // Converte do vetor 1D (bmp.data) para 2D (pixels[y][x])
-      for (int y = 0; y < tex.height; ++y)
+      tex.width = next_power_of_two(header.width);
+      tex.height = next_power_of_two(header.height);
+
+      TextureLevel base;
+      base.width = tex.width;
+      base.height = tex.height;
+      base.width_log2 = log2_of_power_of_two(base.width);
+      base.u_mask = base.width - 1;
+      base.v_mask = base.height - 1;
+      base.offset = 0;
+
+      // Tamanho da pirâmide (cada nível tem metade dos lados do anterior, até 1x1)
+      std::size_t total = 0;
+      for (int w = base.width, h = base.height;; w = std::max(1, w / 2), h = std::max(1, h / 2))
       {
-        for (int x = 0; x < tex.width; ++x)
+        total += static_cast<std::size_t>(w) * h;
+        if (w == 1 && h == 1)
+          break;
+      }
+
+      // A textura pode estar sendo recarregada: com blocos BC1 antigos o buildMipmaps (via decompress)
+      // sobrescreveria os texels decodificados, e índices antigos da paleta não valem para os novos texels
+      tex.compression = TextureCompression::NONE;
+      tex.blocks.clear();
+      tex.indices.clear();
+
+      tex.texels.clear();
+      tex.texels.reserve(total);
+      tex.texels.resize(static_cast<std::size_t>(base.width) * base.height);
+
+      if (header.width == base.width && header.height == base.height)
+      {
+        // Caminho direto: arquivo -> nível 0
+        bmp::decode(data, size, header, tex.texels.data(), base.width);
+      }
+      else
+      {
+        std::vector<Color> decoded(static_cast<std::size_t>(header.width) * header.height);
+        bmp::decode(data, size, header, decoded.data(), header.width);
+
+        for (int y = 0; y < base.height; ++y)
         {
-          tex.pixels[y][x] = bmp.data[y * tex.width + x];
+          int source_y = y * header.height / base.height;
+          for (int x = 0; x < base.width; ++x)
+          {
+            int source_x = x * header.width / base.width;
+            tex.texels[y * base.width + x] = decoded[source_y * header.width + source_x];
+          }
         }
       }
 
+      tex.layout = TextureLayout::ROW_MAJOR;
+      tex.swizzle.clear();
+      tex.levels.clear();
+      tex.levels.push_back(base);
+      tex.buildMipmaps();
+
       return true;
     }
     catch (const std::exception &e)
     {
-      std::cerr << "Erro ao carregar textura '" << filename << "': " << e.what() << "\n";
+      std::cerr << "Erro ao carregar textura '" << name << "': " << e.what() << "\n";
       return false;
     }
   }
@@ -0,0 +1,595 @@
+#include <models/texture_compression.hpp>
+#include <models/texture.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace models
+{
+  // Cor com canais em float (0..255) usada pelo compressor
+  struct ColorPoint
+  {
+    float r, g, b;
+  };
+
+  static std::uint16_t to_565(const ColorPoint &color)
+  {
+    int r = std::clamp(static_cast<int>(color.r * 31.0f / 255.0f + 0.5f), 0, 31);
+    int g = std::clamp(static_cast<int>(color.g * 63.0f / 255.0f + 0.5f), 0, 63);
+    int b = std::clamp(static_cast<int>(color.b * 31.0f / 255.0f + 0.5f), 0, 31);
+    return static_cast<std::uint16_t>((r << 11) | (g << 5) | b);
+  }
+
+  static Color from_565(std::uint16_t value)
+  {
+    int r = (value >> 11) & 31;
+    int g = (value >> 5) & 63;
+    int b = value & 31;
+    return {static_cast<Uint8>((r << 3) | (r >> 2)), static_cast<Uint8>((g << 2) | (g >> 4)), static_cast<Uint8>((b << 3) | (b >> 2)), 255};
+  }
+
+  // As 4 cores de um bloco (a mesma tabela é usada na compressão e na descompressão)
+  static void block_palette(std::uint16_t color0, std::uint16_t color1, Color palette[4])
+  {
+    palette[0] = from_565(color0);
+    palette[1] = from_565(color1);
+
+    if (color0 > color1)
+    {
+      palette[2] = {static_cast<Uint8>((2 * palette[0].r + palette[1].r) / 3), static_cast<Uint8>((2 * palette[0].g + palette[1].g) / 3), static_cast<Uint8>((2 * palette[0].b + palette[1].b) / 3), 255};
+      palette[3] = {static_cast<Uint8>((palette[0].r + 2 * palette[1].r) / 3), static_cast<Uint8>((palette[0].g + 2 * palette[1].g) / 3), static_cast<Uint8>((palette[0].b + 2 * palette[1].b) / 3), 255};
+    }
+    else
+    {
+      palette[2] = {static_cast<Uint8>((palette[0].r + palette[1].r) / 2), static_cast<Uint8>((palette[0].g + palette[1].g) / 2), static_cast<Uint8>((palette[0].b + palette[1].b) / 2), 255};
+      palette[3] = TRANSPARENT;
+    }
+  }
+
+  void decodeBC1Block(const BC1Block &block, Color texels[16])
+  {
+    Color palette[4];
+    block_palette(block.color0, block.color1, palette);
+
+    for (int i = 0; i < 16; i++)
+      texels[i] = palette[(block.selectors >> (2 * i)) & 3];
+  }
+
+  static int color_distance(const Color &a, const Color &b)
+  {
+    int dr = a.r - b.r, dg = a.g - b.g, db = a.b - b.b;
+    return dr * dr + dg * dg + db * db;
+  }
+
+  /**
+   * @brief Monta o bloco a partir de dois extremos e escolhe a cor de cada texel
+   *
+   * @param a Primeiro extremo
+   * @param b Segundo extremo
+   * @param texels Texels do bloco
+   * @param transparent Se o bloco tem texels transparentes (modo de 3 cores)
+   * @param error Erro quadrático total do bloco
+   */
+  static BC1Block fit_block(const ColorPoint &a, const ColorPoint &b, const Color texels[16], bool transparent, long &error)
+  {
+    BC1Block block;
+    block.color0 = to_565(a);
+    block.color1 = to_565(b);
+
+    // A ordem dos extremos define o modo do bloco
+    bool swap = transparent ? block.color0 > block.color1 : block.color0 < block.color1;
+    if (swap)
+      std::swap(block.color0, block.color1);
+
+    Color palette[4];
+    block_palette(block.color0, block.color1, palette);
+    int colors = block.color0 > block.color1 ? 4 : 3;
+
+    block.selectors = 0;
+    error = 0;
+    for (int i = 0; i < 16; i++)
+    {
+      int best = 3;
+      if (texels[i].a >= 128)
+      {
+        int best_distance = 1 << 30;
+        for (int c = 0; c < colors; c++)
+        {
+          int distance = color_distance(texels[i], palette[c]);
+          if (distance < best_distance)
+          {
+            best_distance = distance;
+            best = c;
+          }
+        }
+        error += best_distance;
+      }
+      block.selectors |= static_cast<std::uint32_t>(best) << (2 * i);
+    }
+
+    return block;
+  }
+
+  /**
+   * @brief Reajusta os extremos por mínimos quadrados mantendo a escolha de cada texel
+   *
+   * @note Cada texel é aproximado por w * a + (1 - w) * b, com w = 1, 0, 2/3 ou 1/3 (índices 0 a 3)
+   */
+  static bool refit_endpoints(const BC1Block &block, const Color texels[16], ColorPoint &a, ColorPoint &b)
+  {
+    const float weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    ColorPoint ax = {0.0f, 0.0f, 0.0f}, bx = {0.0f, 0.0f, 0.0f};
+
+    for (int i = 0; i < 16; i++)
+    {
+      float w = weights[(block.selectors >> (2 * i)) & 3];
+      float v = 1.0f - w;
+
+      aa += w * w;
+      ab += w * v;
+      bb += v * v;
+      ax = {ax.r + w * texels[i].r, ax.g + w * texels[i].g, ax.b + w * texels[i].b};
+      bx = {bx.r + v * texels[i].r, bx.g + v * texels[i].g, bx.b + v * texels[i].b};
+    }
+
+    float determinant = aa * bb - ab * ab;
+    if (std::fabs(determinant) < 1e-6f)
+      return false;
+
+    float inverse = 1.0f / determinant;
+    auto solve = [&](float x_a, float x_b, float &out_a, float &out_b)
+    {
+      out_a = std::clamp((bb * x_a - ab * x_b) * inverse, 0.0f, 255.0f);
+      out_b = std::clamp((aa * x_b - ab * x_a) * inverse, 0.0f, 255.0f);
+    };
+
+    solve(ax.r, bx.r, a.r, b.r);
+    solve(ax.g, bx.g, a.g, b.g);
+    solve(ax.b, bx.b, a.b, b.b);
+    return true;
+  }
+
+  /**
+   * @brief Comprime 4x4 texels em um bloco BC1
+   *
+   * @param texels Texels do bloco (linha a linha)
+   * @param quality BC1_FAST ou BC1_HIGH
+   * @return BC1Block Bloco comprimido
+   *
+   * @note BC1_FAST usa os cantos da caixa de cores (reduzida em 1/16 para aproximar os extremos das cores reais)
+   * @note BC1_HIGH usa os extremos das cores no eixo principal (maior variância) e reajusta os extremos por
+   *       mínimos quadrados, ficando com o bloco de menor erro
+   * @note Texels com alpha < 128 viram o índice transparente (modo de 3 cores)
+   */
+  BC1Block encodeBC1Block(const Color texels[16], TextureCompression quality)
+  {
+    ColorPoint low = {255.0f, 255.0f, 255.0f}, high = {0.0f, 0.0f, 0.0f};
+    ColorPoint mean = {0.0f, 0.0f, 0.0f};
+    int opaque = 0;
+
+    for (int i = 0; i < 16; i++)
+    {
+      if (texels[i].a < 128)
+        continue;
+
+      low = {std::min(low.r, static_cast<float>(texels[i].r)), std::min(low.g, static_cast<float>(texels[i].g)), std::min(low.b, static_cast<float>(texels[i].b))};
+      high = {std::max(high.r, static_cast<float>(texels[i].r)), std::max(high.g, static_cast<float>(texels[i].g)), std::max(high.b, static_cast<float>(texels[i].b))};
+      mean = {mean.r + texels[i].r, mean.g + texels[i].g, mean.b + texels[i].b};
+      opaque++;
+    }
+
+    // Bloco inteiro transparente
+    if (opaque == 0)
+      return {0, 0, 0xFFFFFFFFu};
+
+    bool transparent = opaque < 16;
+
+    ColorPoint inset = {(high.r - low.r) / 16.0f, (high.g - low.g) / 16.0f, (high.b - low.b) / 16.0f};
+    ColorPoint a = {high.r - inset.r, high.g - inset.g, high.b - inset.b};
+    ColorPoint b = {low.r + inset.r, low.g + inset.g, low.b + inset.b};
+
+    // Diagonal da caixa: um canal que diminui quando o canal de maior intervalo aumenta tem os extremos trocados
+    mean = {mean.r / opaque, mean.g / opaque, mean.b / opaque};
+
+    float ranges[3] = {high.r - low.r, high.g - low.g, high.b - low.b};
+    int main_channel = static_cast<int>(std::max_element(ranges, ranges + 3) - ranges);
+
+    float covariance[3] = {};
+    for (int i = 0; i < 16; i++)
+    {
+      if (texels[i].a < 128)
+        continue;
+
+      float delta[3] = {texels[i].r - mean.r, texels[i].g - mean.g, texels[i].b - mean.b};
+      for (int c = 0; c < 3; c++)
+        covariance[c] += delta[main_channel] * delta[c];
+    }
+
+    if (covariance[0] < 0.0f)
+      std::swap(a.r, b.r);
+    if (covariance[1] < 0.0f)
+      std::swap(a.g, b.g);
+    if (covariance[2] < 0.0f)
+      std::swap(a.b, b.b);
+
+    long best_error;
+    BC1Block best = fit_block(a, b, texels, transparent, best_error);
+
+    if (quality != TextureCompression::BC1_HIGH || best_error == 0)
+      return best;
+
+    // Eixo principal: autovetor da covariância por iteração de potência
+    float matrix[6] = {}; // rr, rg, rb, gg, gb, bb
+    for (int i = 0; i < 16; i++)
+    {
+      if (texels[i].a < 128)
+        continue;
+
+      float r = texels[i].r - mean.r, g = texels[i].g - mean.g, bl = texels[i].b - mean.b;
+      matrix[0] += r * r;
+      matrix[1] += r * g;
+      matrix[2] += r * bl;
+      matrix[3] += g * g;
+      matrix[4] += g * bl;
+      matrix[5] += bl * bl;
+    }
+
+    ColorPoint axis = {a.r - b.r, a.g - b.g, a.b - b.b};
+    for (int iteration = 0; iteration < 8; iteration++)
+    {
+      ColorPoint next = {matrix[0] * axis.r + matrix[1] * axis.g + matrix[2] * axis.b,
+                         matrix[1] * axis.r + matrix[3] * axis.g + matrix[4] * axis.b,
+                         matrix[2] * axis.r + matrix[4] * axis.g + matrix[5] * axis.b};
+
+      float length = std::max({std::fabs(next.r), std::fabs(next.g), std::fabs(next.b)});
+      if (length < 1e-6f)
+        break;
+      axis = {next.r / length, next.g / length, next.b / length};
+    }
+
+    float length_squared = axis.r * axis.r + axis.g * axis.g + axis.b * axis.b;
+    if (length_squared > 1e-6f)
+    {
+      float t_min = 1e30f, t_max = -1e30f;
+      for (int i = 0; i < 16; i++)
+      {
+        if (texels[i].a < 128)
+          continue;
+
+        float t = ((texels[i].r - mean.r) * axis.r + (texels[i].g - mean.g) * axis.g + (texels[i].b - mean.b) * axis.b) / length_squared;
+        t_min = std::min(t_min, t);
+        t_max = std::max(t_max, t);
+      }
+
+      a = {std::clamp(mean.r + t_max * axis.r, 0.0f, 255.0f), std::clamp(mean.g + t_max * axis.g, 0.0f, 255.0f), std::clamp(mean.b + t_max * axis.b, 0.0f, 255.0f)};
+      b = {std::clamp(mean.r + t_min * axis.r, 0.0f, 255.0f), std::clamp(mean.g + t_min * axis.g, 0.0f, 255.0f), std::clamp(mean.b + t_min * axis.b, 0.0f, 255.0f)};
+
+      long error;
+      BC1Block block = fit_block(a, b, texels, transparent, error);
+      if (error < best_error)
+      {
+        best = block;
+        best_error = error;
+      }
+    }
+
+    // O reajuste assume o modo de 4 cores
+    if (transparent)
+      return best;
+
+    for (int iteration = 0; iteration < 2; iteration++)
+    {
+      if (best.color0 <= best.color1 || !refit_endpoints(best, texels, a, b))
+        break;
+
+      long error;
+      BC1Block block = fit_block(a, b, texels, transparent, error);
+      if (error >= best_error)
+        break;
+
+      best = block;
+      best_error = error;
+    }
+
+    return best;
+  }
+
+  // Dimensões de um nível em blocos (níveis menores que 4x4 ocupam um bloco)
+  static int blocks_in(int texels)
+  {
+    return std::max(1, texels / 4);
+  }
+
+  /**
+   * @brief Comprime todos os níveis da textura
+   *
+   * @param quality Formato pedido (NONE descomprime)
+   *
+   * @note Os texels RGBA são liberados, a textura passa a ocupar 1/8 da memória
+   * @note Uma textura já comprimida é descomprimida antes (trocar a qualidade em tempo de execução parte
+   *       dos texels já aproximados, para a melhor qualidade o .bc1 deve ser gerado a partir do BMP)
+   */
+  void Texture::compress(TextureCompression quality)
+  {
+    if (quality == compression)
+      return;
+
+    decompress();
+    if (quality == TextureCompression::NONE || levels.empty())
+      return;
+
+    // Os blocos são montados a partir das linhas
+    setLayout(TextureLayout::ROW_MAJOR);
+
+    blocks.clear();
+    for (TextureLevel &level : levels)
+    {
+      level.block_offset = blocks.size();
+      level.blocks_per_row = blocks_in(level.width);
+
+      const Color *source = data(level);
+      for (int block_y = 0; block_y < blocks_in(level.height); block_y++)
+      {
+        for (int block_x = 0; block_x < level.blocks_per_row; block_x++)
+        {
+          // Em níveis menores que o bloco, o último texel é repetido
+          Color block_texels[16];
+          for (int y = 0; y < 4; y++)
+            for (int x = 0; x < 4; x++)
+              block_texels[y * 4 + x] = source[std::min(block_y * 4 + y, level.height - 1) * level.width + std::min(block_x * 4 + x, level.width - 1)];
+
+          blocks.push_back(encodeBC1Block(block_texels, quality));
+        }
+      }
+    }
+
+    std::vector<Color>().swap(texels);
+    std::vector<Uint8>().swap(indices);
+    compression = quality;
+  }
+
+  /**
+   * @brief Volta os blocos para texels RGBA (linha a linha)
+   */
+  void Texture::decompress()
+  {
+    if (compression == TextureCompression::NONE)
+      return;
+
+    const TextureLevel &last = levels.back();
+    texels.assign(last.offset + static_cast<std::size_t>(last.width) * last.height, TRANSPARENT);
+
+    for (const TextureLevel &level : levels)
+    {
+      Color *destination = texels.data() + level.offset;
+      for (int block_y = 0; block_y < blocks_in(level.height); block_y++)
+      {
+        for (int block_x = 0; block_x < level.blocks_per_row; block_x++)
+        {
+          Color block_texels[16];
+          decodeBC1Block(blocks[level.block_offset + block_y * level.blocks_per_row + block_x], block_texels);
+
+          for (int y = 0; y < 4 && block_y * 4 + y < level.height; y++)
+            for (int x = 0; x < 4 && block_x * 4 + x < level.width; x++)
+              destination[(block_y * 4 + y) * level.width + block_x * 4 + x] = block_texels[y * 4 + x];
+        }
+      }
+    }
+
+    std::vector<BC1Block>().swap(blocks);
+    compression = TextureCompression::NONE;
+  }
+
+  Color Texture::fetchCompressed(const TextureLevel &level, int x, int y) const
+  {
+    Color block_texels[16];
+    decodeBC1Block(blocks[level.block_offset + (y >> 2) * level.blocks_per_row + (x >> 2)], block_texels);
+    return block_texels[((y & 3) << 2) | (x & 3)];
+  }
+
+  // Cabeçalho do arquivo .bc1
+  struct CompressedFileHeader
+  {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t level_count;
+    std::uint32_t quality;
+  };
+
+  static const char COMPRESSED_MAGIC[4] = {'B', 'C', '1', 'T'};
+  static constexpr std::uint32_t COMPRESSED_VERSION = 1;
+
+  /**
+   * @brief Grava uma textura comprimida
+   *
+   * @param filename Caminho do arquivo .bc1
+   * @param texture Textura já comprimida (Texture::compress)
+   * @return true Se o arquivo foi gravado
+   */
+  bool saveCompressedTexture(const std::string &filename, const Texture &texture)
+  {
+    if (texture.compression == TextureCompression::NONE)
+      return false;
+
+    std::FILE *file = std::fopen(filename.c_str(), "wb");
+    if (!file)
+      return false;
+
+    CompressedFileHeader header;
+    std::memcpy(header.magic, COMPRESSED_MAGIC, sizeof(header.magic));
+    header.version = COMPRESSED_VERSION;
+    header.width = static_cast<std::uint32_t>(texture.width);
+    header.height = static_cast<std::uint32_t>(texture.height);
+    header.level_count = static_cast<std::uint32_t>(texture.levels.size());
+    header.quality = static_cast<std::uint32_t>(texture.compression);
+
+    bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   std::fwrite(texture.blocks.data(), sizeof(BC1Block), texture.blocks.size(), file) == texture.blocks.size();
+
+    return std::fclose(file) == 0 && written;
+  }
+
+  /**
+   * @brief Carrega uma textura comprimida gerada offline
+   *
+   * @param filename Caminho do arquivo .bc1
+   * @param texture Textura que recebe os níveis e os blocos
+   * @return true Se a textura foi carregada
+   *
+   * @note Os blocos são copiados do arquivo mapeado, sem descompressão nem geração de mipmaps
+   */
+  bool loadCompressedTexture(const std::string &filename, Texture &texture)
+  {
+    try
+    {
+      bmp::MappedFile file(filename);
+      return loadCompressedTexture(filename, file.data(), file.size(), texture);
+    }
+    catch (const std::exception &e)
+    {
+      std::cerr << "Erro ao carregar textura '" << filename << "': " << e.what() << "\n";
+      return false;
+    }
+  }
+
+  /**
+   * @brief Carrega uma textura comprimida já lida para a memória
+   *
+   * @param name Nome do arquivo (apenas para as mensagens de erro)
+   * @param data Conteúdo do arquivo .bc1
+   * @param size Tamanho do arquivo
+   * @param texture Textura que recebe os níveis e os blocos
+   * @return true Se a textura foi carregada
+   */
+  bool loadCompressedTexture(const std::string &name, const std::uint8_t *data, std::size_t size, Texture &texture)
+  {
+    CompressedFileLayout layout;
+    if (!readCompressedLayout(name, data, size, layout))
+      return false;
+
+    if (size != layout.level_offsets.back())
+    {
+      std::cerr << "Erro ao carregar textura '" << name << "': Tamanho não confere com o cabeçalho\n";
+      return false;
+    }
+
+    return loadCompressedLevels(name, layout, 0, data + layout.level_offsets[0], size - layout.level_offsets[0], texture);
+  }
+
+  std::size_t compressedHeaderSize()
+  {
+    return sizeof(CompressedFileHeader);
+  }
+
+  /**
+   * @brief Lê o cabeçalho de um .bc1 e calcula a posição dos níveis no arquivo
+   *
+   * @param name Nome do arquivo (apenas para as mensagens de erro)
+   * @param data Início do arquivo (pelo menos compressedHeaderSize() bytes)
+   * @param size Bytes disponíveis em data
+   * @param layout Recebe as dimensões, a qualidade e a posição de cada nível
+   * @return true Se o cabeçalho é válido
+   *
+   * @note Os níveis ficam do mais fino para o mais grosso, então os níveis a partir de um nível são um
+   *       trecho contínuo até o fim do arquivo
+   */
+  bool readCompressedLayout(const std::string &name, const std::uint8_t *data, std::size_t size, CompressedFileLayout &layout)
+  {
+    try
+    {
+      CompressedFileHeader header;
+      if (size < sizeof(header))
+        throw std::runtime_error("Arquivo truncado");
+
+      std::memcpy(&header, data, sizeof(header));
+      if (std::memcmp(header.magic, COMPRESSED_MAGIC, sizeof(header.magic)) != 0 || header.version != COMPRESSED_VERSION)
+        throw std::runtime_error("Formato não suportado");
+
+      if (header.width == 0 || header.height == 0 || (header.width & (header.width - 1)) || (header.height & (header.height - 1)) ||
+          header.level_count == 0 || header.level_count > 32 ||
+          header.quality == static_cast<std::uint32_t>(TextureCompression::NONE) || header.quality > static_cast<std::uint32_t>(TextureCompression::BC1_HIGH))
+        throw std::runtime_error("Cabeçalho inválido");
+
+      layout.width = static_cast<int>(header.width);
+      layout.height = static_cast<int>(header.height);
+      layout.quality = static_cast<TextureCompression>(header.quality);
+      layout.level_offsets.clear();
+
+      // Mesma pirâmide de Texture::buildMipmaps
+      std::size_t offset = sizeof(header);
+      for (std::uint32_t i = 0; i < header.level_count; i++)
+      {
+        layout.level_offsets.push_back(offset);
+        offset += static_cast<std::size_t>(blocks_in(std::max(1, layout.width >> i))) * blocks_in(std::max(1, layout.height >> i)) * sizeof(BC1Block);
+      }
+      layout.level_offsets.push_back(offset);
+
+      return true;
+    }
+    catch (const std::exception &e)
+    {
+      std::cerr << "Erro ao carregar textura '" << name << "': " << e.what() << "\n";
+      return false;
+    }
+  }
+
+  /**
+   * @brief Carrega os níveis mais grossos de um .bc1
+   *
+   * @param name Nome do arquivo (apenas para as mensagens de erro)
+   * @param layout Layout do arquivo (readCompressedLayout)
+   * @param first_level Primeiro nível carregado (vira o nível 0 da textura)
+   * @param data Trecho do arquivo de layout.level_offsets[first_level] até o fim
+   * @param size Tamanho do trecho
+   * @param texture Textura que recebe os níveis e os blocos
+   * @return true Se o trecho tem o tamanho esperado
+   *
+   * @note O resultado é igual a carregar o arquivo inteiro e descartar os first_level níveis mais finos
+   */
+  bool loadCompressedLevels(const std::string &name, const CompressedFileLayout &layout, int first_level, const std::uint8_t *data, std::size_t size,
+                            Texture &texture)
+  {
+    if (first_level < 0 || first_level >= layout.levelCount() ||
+        size != layout.level_offsets.back() - layout.level_offsets[first_level])
+    {
+      std::cerr << "Erro ao carregar textura '" << name << "': Tamanho não confere com o cabeçalho\n";
+      return false;
+    }
+
+    texture = Texture();
+    texture.width = std::max(1, layout.width >> first_level);
+    texture.height = std::max(1, layout.height >> first_level);
+
+    // Apenas posições, os texels não são alocados
+    std::size_t texel_count = 0, block_count = 0;
+    for (int i = first_level; i < layout.levelCount(); i++)
+    {
+      TextureLevel level;
+      level.width = std::max(1, layout.width >> i);
+      level.height = std::max(1, layout.height >> i);
+      while ((1 << level.width_log2) < level.width)
+        level.width_log2++;
+      level.u_mask = level.width - 1;
+      level.v_mask = level.height - 1;
+      level.offset = texel_count;
+      level.block_offset = block_count;
+      level.blocks_per_row = blocks_in(level.width);
+
+      texel_count += static_cast<std::size_t>(level.width) * level.height;
+      block_count += static_cast<std::size_t>(level.blocks_per_row) * blocks_in(level.height);
+      texture.levels.push_back(level);
+    }
+
+    texture.blocks.resize(block_count);
+    std::memcpy(texture.blocks.data(), data, block_count * sizeof(BC1Block));
+    texture.compression = layout.quality;
+
+    return true;
+  }
+}
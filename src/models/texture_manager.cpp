@@ -0,0 +1,343 @@
+#include <models/texture_manager.hpp>
+
+#include <cstring>
+
+namespace models
+{
+  /**
+   * @brief Hash FNV-1a dos texels do nível 0 (junto com as dimensões)
+   *
+   * @note Texturas comprimidas usam os bytes dos blocos, então só são iguais a outras texturas comprimidas
+   */
+  static std::uint64_t content_hash(const Texture &texture)
+  {
+    std::uint64_t hash = 14695981039346656037ull;
+
+    auto mix = [&hash](std::uint8_t byte)
+    {
+      hash ^= byte;
+      hash *= 1099511628211ull;
+    };
+
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+      mix(static_cast<std::uint8_t>(texture.width >> shift));
+      mix(static_cast<std::uint8_t>(texture.height >> shift));
+    }
+
+    if (texture.compression != TextureCompression::NONE)
+    {
+      mix(static_cast<std::uint8_t>(texture.compression));
+      const std::uint8_t *bytes = reinterpret_cast<const std::uint8_t *>(texture.blocks.data());
+      for (std::size_t i = 0; i < texture.blocks.size() * sizeof(BC1Block); i++)
+        mix(bytes[i]);
+      return hash;
+    }
+
+    const TextureLevel &base = texture.levels[0];
+    for (int y = 0; y < base.height; y++)
+    {
+      for (int x = 0; x < base.width; x++)
+      {
+        const Color &texel = texture.texels[base.offset + texture.address(base, x, y)];
+        mix(texel.r);
+        mix(texel.g);
+        mix(texel.b);
+        mix(texel.a);
+      }
+    }
+
+    return hash;
+  }
+
+  /**
+   * @brief Completa a região de uma entrada com o handle da textura
+   */
+  TextureRegion TextureManager::acquire(const Entry &entry, TextureHandle texture)
+  {
+    TextureRegion region = entry.region;
+    region.texture = std::move(texture);
+    return region;
+  }
+
+  /**
+   * @brief Confere se uma textura recém-carregada tem o mesmo conteúdo de uma entrada já registrada
+   *
+   * @param texture Textura recém-carregada
+   * @param shared Textura da entrada (a própria textura ou o atlas)
+   * @param entry Entrada com o mesmo hash
+   * @return true Se o nível 0 (ou os blocos BC1) é igual byte a byte
+   *
+   * @note Se a textura compartilhada mudou de formato depois do carregamento (compressão em tempo de execução),
+   *       os texels originais não existem mais e o arquivo da entrada é decodificado de novo para a comparação
+   */
+  bool TextureManager::sameContent(const Texture &texture, const Texture &shared, const Entry &entry) const
+  {
+    if (texture.width != entry.width || texture.height != entry.height || texture.compression != entry.compression)
+      return false;
+
+    const Texture *reference = &shared;
+    int x = entry.x, y = entry.y;
+
+    Texture original;
+    if (shared.compression != entry.compression)
+    {
+      if (!loadTexture(entry.source, original))
+        return false;
+      reference = &original;
+      x = y = 0;
+    }
+
+    // Texturas comprimidas nunca vão para o atlas: os blocos cobrem a textura inteira
+    if (texture.compression != TextureCompression::NONE)
+      return reference->blocks.size() == texture.blocks.size() &&
+             std::memcmp(reference->blocks.data(), texture.blocks.data(), texture.blocks.size() * sizeof(BC1Block)) == 0;
+
+    const TextureLevel &source = texture.levels[0];
+    const TextureLevel &target = reference->levels[0];
+    for (int j = 0; j < source.height; j++)
+    {
+      for (int i = 0; i < source.width; i++)
+      {
+        const Color &a = texture.texels[source.offset + texture.address(source, i, j)];
+        const Color &b = reference->texels[target.offset + reference->address(target, x + i, y + j)];
+        if (a.r != b.r || a.g != b.g || a.b != b.b || a.a != b.a)
+          return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief Carrega a textura de um arquivo BMP
+   *
+   * @param filename Caminho do arquivo
+   * @return TextureRegion Textura (ou célula de atlas) e a transformação da UV
+   *
+   * @note A busca é feita primeiro pelo caminho (sem decodificar) e depois pelo conteúdo (hash e comparação)
+   * @note Um hash igual com conteúdo diferente (colisão) gera uma textura própria, a entrada do hash não muda
+   */
+  TextureRegion TextureManager::load(const std::string &filename)
+  {
+    // Mesmo caminho: nada é lido do disco
+    auto path = by_path.find(filename);
+    if (path != by_path.end())
+    {
+      if (TextureHandle texture = path->second.texture.lock())
+      {
+        reused++;
+        return acquire(path->second, std::move(texture));
+      }
+      by_path.erase(path);
+    }
+
+    // Sem leitura do disco aqui: a textura é registrada no streamer e só é comparada pelo caminho
+    if (streaming)
+    {
+      TextureHandle texture = streamer.add(filename);
+
+      Entry entry;
+      entry.texture = texture;
+      by_path[filename] = entry;
+      return acquire(entry, std::move(texture));
+    }
+
+    Texture texture;
+    if (!loadTexture(filename, texture))
+      return {};
+    decoded++;
+
+    // Mesmo conteúdo em outro caminho
+    std::uint64_t hash = content_hash(texture);
+    auto content = by_hash.find(hash);
+    if (content != by_hash.end())
+    {
+      if (TextureHandle shared = content->second.texture.lock())
+      {
+        if (sameContent(texture, *shared, content->second))
+        {
+          reused++;
+          by_path[filename] = content->second;
+          return acquire(content->second, std::move(shared));
+        }
+      }
+      else
+        by_hash.erase(content);
+    }
+
+    Entry entry;
+    entry.source = filename;
+    entry.compression = texture.compression;
+    entry.width = texture.width;
+    entry.height = texture.height;
+
+    TextureRegion region;
+    if (use_atlas && texture.width <= atlas_cell_size && texture.height <= atlas_cell_size && texture.compression == TextureCompression::NONE)
+    {
+      region = addToAtlas(texture);
+      entry.x = static_cast<int>(region.u_offset * atlas_size);
+      entry.y = static_cast<int>(region.v_offset * atlas_size);
+    }
+    else
+      region.texture = std::make_shared<Texture>(std::move(texture));
+
+    entry.texture = region.texture;
+    entry.region = region;
+    entry.region.texture.reset();
+
+    by_path[filename] = entry;
+    by_hash.emplace(hash, entry);
+
+    return region;
+  }
+
+  /**
+   * @brief Copia uma textura pequena para uma célula livre de um atlas
+   *
+   * @param texture Textura carregada (lados menores ou iguais a atlas_cell_size)
+   * @return TextureRegion Atlas e a transformação da UV para a célula
+   *
+   * @note As células são alinhadas ao seu tamanho e os mipmaps do atlas param no nível em que uma célula vira
+   *       um texel, assim nenhum nível mistura texturas vizinhas e cada inserção refaz só a pirâmide da célula
+   * @note A UV é reduzida em meio texel para que a borda da célula (u = 1) não amostre a célula vizinha
+   * @note As células não são reaproveitadas: o atlas é liberado quando nenhuma malha o usa
+   */
+  TextureRegion TextureManager::addToAtlas(const Texture &texture)
+  {
+    int cells_per_row = atlas_size / atlas_cell_size;
+    int cell_count = cells_per_row * cells_per_row;
+
+    // Atlas vivo com célula livre (ou um novo)
+    TextureHandle atlas_texture;
+    Atlas *atlas = nullptr;
+
+    for (Atlas &candidate : atlases)
+    {
+      if (candidate.used_cells >= cell_count)
+        continue;
+
+      if ((atlas_texture = candidate.texture.lock()))
+      {
+        atlas = &candidate;
+        break;
+      }
+    }
+
+    if (!atlas)
+    {
+      // Atlas sem usuários são descartados
+      atlases.erase(std::remove_if(atlases.begin(), atlases.end(), [](const Atlas &a)
+                                   { return a.texture.expired(); }),
+                    atlases.end());
+
+      atlas_texture = std::make_shared<Texture>();
+      atlas_texture->width = atlas_size;
+      atlas_texture->height = atlas_size;
+      atlas_texture->texels.assign(static_cast<std::size_t>(atlas_size) * atlas_size, TRANSPARENT);
+
+      TextureLevel base;
+      base.width = atlas_size;
+      base.height = atlas_size;
+      base.u_mask = atlas_size - 1;
+      base.v_mask = atlas_size - 1;
+      while ((1 << base.width_log2) < atlas_size)
+        base.width_log2++;
+      atlas_texture->levels.push_back(base);
+
+      // Mipmaps até o nível em que uma célula tem 1x1 texel (montados uma vez, depois só as células mudam)
+      int cell_levels = 1;
+      while ((1 << (cell_levels - 1)) < atlas_cell_size)
+        cell_levels++;
+
+      atlas_texture->buildMipmaps();
+      if (atlas_texture->levelCount() > cell_levels)
+      {
+        atlas_texture->levels.resize(cell_levels);
+        const TextureLevel &last = atlas_texture->levels.back();
+        atlas_texture->texels.resize(last.offset + static_cast<std::size_t>(last.width) * last.height);
+      }
+
+      atlases.push_back({atlas_texture, 0});
+      atlas = &atlases.back();
+    }
+
+    // O atlas pode ter sido comprimido desde a última cópia (os mipmaps são refeitos com os texels RGBA)
+    atlas_texture->decompress();
+
+    int cell = atlas->used_cells++;
+    int cell_x = (cell % cells_per_row) * atlas_cell_size;
+    int cell_y = (cell / cells_per_row) * atlas_cell_size;
+
+    // Cópia do nível 0 (o endereço respeita o layout atual do atlas)
+    const TextureLevel &source = texture.levels[0];
+    const TextureLevel &target = atlas_texture->levels[0];
+    for (int y = 0; y < source.height; y++)
+      for (int x = 0; x < source.width; x++)
+        atlas_texture->texels[target.offset + atlas_texture->address(target, cell_x + x, cell_y + y)] =
+            texture.texels[source.offset + texture.address(source, x, y)];
+
+    // Só os mipmaps da célula são refeitos (as células são alinhadas, nenhum texel de outro nível muda)
+    atlas_texture->updateMipmaps(cell_x, cell_y, atlas_cell_size, atlas_cell_size);
+
+    TextureRegion region;
+    region.texture = atlas_texture;
+    region.atlas = true;
+    region.u_offset = static_cast<float>(cell_x) / atlas_size;
+    region.v_offset = static_cast<float>(cell_y) / atlas_size;
+    region.u_scale = (source.width - 0.5f) / atlas_size;
+    region.v_scale = (source.height - 0.5f) / atlas_size;
+
+    return region;
+  }
+
+  void TextureManager::update()
+  {
+    if (streaming)
+      streamer.update();
+  }
+
+  int TextureManager::liveTextures() const
+  {
+    std::vector<const Texture *> live;
+    for (const auto &[path, entry] : by_path)
+    {
+      TextureHandle texture = entry.texture.lock();
+      if (texture && std::find(live.begin(), live.end(), texture.get()) == live.end())
+        live.push_back(texture.get());
+    }
+    return static_cast<int>(live.size());
+  }
+
+  std::size_t TextureManager::liveTexels() const
+  {
+    std::vector<const Texture *> live;
+    std::size_t texels = 0;
+    for (const auto &[path, entry] : by_path)
+    {
+      TextureHandle texture = entry.texture.lock();
+      if (texture && std::find(live.begin(), live.end(), texture.get()) == live.end())
+      {
+        live.push_back(texture.get());
+        texels += texture->texels.size();
+      }
+    }
+    return texels;
+  }
+
+  std::size_t TextureManager::liveBytes() const
+  {
+    std::vector<const Texture *> live;
+    std::size_t bytes = 0;
+    for (const auto &[path, entry] : by_path)
+    {
+      TextureHandle texture = entry.texture.lock();
+      if (texture && std::find(live.begin(), live.end(), texture.get()) == live.end())
+      {
+        live.push_back(texture.get());
+        bytes += texture->memoryBytes();
+      }
+    }
+    return bytes;
+  }
+}
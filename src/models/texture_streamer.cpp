@@ -0,0 +1,354 @@
+#include <models/texture_streamer.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace models
+{
+  TextureStreamer::~TextureStreamer()
+  {
+    // Leituras que ainda não começaram saem da fila. As que estão em andamento entregam para o estado compartilhado
+    for (Stream &stream : streams)
+    {
+      if (stream.read != 0)
+        io::shared().cancel(stream.read);
+    }
+  }
+
+  /**
+   * @brief Registra uma textura para carregamento em segundo plano
+   *
+   * @param filename Caminho do arquivo (BMP ou .bc1)
+   * @return std::shared_ptr<Texture> Textura 1x1 cinza, substituída pelos níveis carregados em update()
+   *
+   */
+  std::shared_ptr<Texture> TextureStreamer::add(const std::string &filename)
+  {
+    auto texture = std::make_shared<Texture>();
+    texture->width = 1;
+    texture->height = 1;
+    texture->texels.assign(1, Color{128, 128, 128, 255});
+    texture->levels.push_back(TextureLevel{});
+    texture->levels[0].width = 1;
+    texture->levels[0].height = 1;
+
+    Stream stream;
+    stream.texture = texture;
+    stream.filename = filename;
+    stream.last_used = frame;
+    stream.compressed = filename.size() > 4 && filename.compare(filename.size() - 4, 4, ".bc1") == 0;
+    streams.push_back(stream);
+
+    request(streams.size() - 1, -1);
+    return texture;
+  }
+
+  /**
+   * @brief Pede a leitura de uma textura ao io::AssetIO
+   *
+   * @param stream Índice da textura
+   * @param first_level Nível mais fino pedido (-1 = níveis grossos)
+   *
+   * @note Os níveis grossos têm prioridade alta: toda textura aparece antes de qualquer textura ganhar resolução
+   * @note O callback roda nas threads de jobs e só acessa o estado compartilhado (nunca o streamer)
+   * @note Um .bc1 sem layout conhecido pede só o cabeçalho; os níveis são pedidos quando ele chega (update)
+   */
+  void TextureStreamer::request(std::size_t stream, int first_level)
+  {
+    streams[stream].requested = first_level;
+
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->in_flight++;
+    }
+
+    std::shared_ptr<State> shared_state = state;
+    auto deliver = [shared_state](Completion &completion)
+    {
+      std::lock_guard<std::mutex> lock(shared_state->mutex);
+      shared_state->completions.push_back(std::move(completion));
+      shared_state->in_flight--;
+    };
+
+    Stream &target = streams[stream];
+    if (target.compressed && target.layout.level_offsets.empty())
+    {
+      auto callback = [deliver, stream](io::ReadResult &result)
+      {
+        Completion completion;
+        completion.stream = stream;
+        completion.header = true;
+        completion.ok = result.ok && readCompressedLayout(result.path, result.data, result.size, completion.layout);
+        completion.first_level = 0;
+        completion.level_count = completion.layout.levelCount();
+
+        if (!result.ok)
+          std::cerr << result.error << "\n";
+        deliver(completion);
+      };
+
+      target.read = io::shared().read(target.filename, 0, compressedHeaderSize(), callback, io::Priority::HIGH);
+      return;
+    }
+
+    if (target.compressed)
+    {
+      const CompressedFileLayout &layout = target.layout;
+      int level = first_level < 0 ? coarseLevel(layout.width, layout.height, layout.levelCount(), initial_size) : first_level;
+
+      auto callback = [deliver, stream, level, layout](io::ReadResult &result)
+      {
+        Completion completion;
+        completion.stream = stream;
+        completion.ok = result.ok && loadCompressedLevels(result.path, layout, level, result.data, result.size, completion.texture);
+        completion.first_level = level;
+        completion.level_count = layout.levelCount();
+
+        if (!result.ok)
+          std::cerr << result.error << "\n";
+        deliver(completion);
+      };
+
+      target.read = io::shared().read(target.filename, layout.level_offsets[level], 0, callback,
+                                      first_level < 0 ? io::Priority::HIGH : io::Priority::NORMAL);
+      return;
+    }
+
+    int size = initial_size;
+    auto callback = [deliver, stream, first_level, size](io::ReadResult &result)
+    {
+      Completion completion;
+      completion.stream = stream;
+      decode(result, first_level, size, completion);
+      deliver(completion);
+    };
+
+    target.read = io::shared().read(target.filename, callback, first_level < 0 ? io::Priority::HIGH : io::Priority::NORMAL);
+  }
+
+  /**
+   * @brief Nível em que o primeiro carregamento começa
+   *
+   * @param width Largura do nível 0
+   * @param height Altura do nível 0
+   * @param level_count Número de níveis da pirâmide completa
+   * @param initial_size Lado máximo dos níveis grossos
+   * @return int Nível mais fino com os dois lados até initial_size (ou o último nível)
+   */
+  int TextureStreamer::coarseLevel(int width, int height, int level_count, int initial_size)
+  {
+    int level = 0;
+    while (level < level_count - 1 && std::max(width >> level, height >> level) > initial_size)
+      level++;
+    return level;
+  }
+
+  /**
+   * @brief Decodifica um arquivo lido (threads de jobs)
+   *
+   * @param result Conteúdo do arquivo
+   * @param first_level Nível mais fino pedido (-1 = níveis grossos, lado até initial_size)
+   * @param initial_size Lado máximo dos níveis grossos
+   * @param completion Recebe a textura
+   *
+   * @note Caminho dos BMPs: o arquivo é decodificado inteiro (com os mipmaps) e os níveis mais finos que o pedido
+   *       são descartados (os .bc1 são lidos por níveis em request)
+   */
+  void TextureStreamer::decode(io::ReadResult &result, int first_level, int initial_size, Completion &completion)
+  {
+    completion.ok = result.ok && loadTexture(result.path, result.data, result.size, completion.texture);
+    completion.level_count = completion.texture.levelCount();
+    completion.first_level = 0;
+
+    if (!result.ok)
+      std::cerr << result.error << "\n";
+
+    if (!completion.ok)
+      return;
+
+    if (first_level < 0)
+      first_level = coarseLevel(completion.texture.width, completion.texture.height, completion.level_count, initial_size);
+
+    completion.first_level = std::min(first_level, completion.level_count - 1);
+    completion.texture.dropFinestLevels(completion.first_level);
+  }
+
+  /**
+   * @brief Atualiza a residência das texturas (thread principal, antes da rasterização do quadro)
+   *
+   * @note Nível necessário = nível da pirâmide completa que o selectLevel escolheria, a partir da menor razão
+   *       texels/pixel amostrada no quadro anterior (Texture::sampled_texels_per_pixel)
+   * @note Um pedido por textura de cada vez: se o nível necessário mudar, o próximo pedido já usa o valor novo
+   */
+  void TextureStreamer::update()
+  {
+    frame++;
+
+    // Carregamentos concluídos
+    std::vector<Completion> done;
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      done.swap(state->completions);
+    }
+
+    for (Completion &completion : done)
+    {
+      Stream &stream = streams[completion.stream];
+      stream.requested = -1;
+      stream.read = 0;
+
+      std::shared_ptr<Texture> texture = stream.texture.lock();
+      if (!texture || !completion.ok)
+        continue;
+
+      // Cabeçalho de um .bc1: os níveis grossos são pedidos agora que a posição de cada nível é conhecida
+      if (completion.header)
+      {
+        stream.layout = std::move(completion.layout);
+        stream.level_count = completion.level_count;
+        request(completion.stream, -1);
+        continue;
+      }
+
+      // Resultado mais grosso que o residente (o nível foi pedido antes de um carregamento mais fino chegar)
+      if (stream.resident && completion.first_level >= stream.first_level)
+        continue;
+
+      // A textura continua sendo o mesmo objeto, então malhas e handles não mudam
+      float sampled = texture->sampled_texels_per_pixel;
+      *texture = std::move(completion.texture);
+      texture->sampled_texels_per_pixel = sampled;
+
+      if (!stream.resident)
+        arrived++;
+
+      stream.resident = true;
+      stream.first_level = completion.first_level;
+      stream.level_count = completion.level_count;
+      stream.excess_since = -1;
+      loaded++;
+    }
+
+    // Níveis necessários
+    std::size_t total = residentBytes();
+
+    for (std::size_t i = 0; i < streams.size(); i++)
+    {
+      Stream &stream = streams[i];
+      std::shared_ptr<Texture> texture = stream.texture.lock();
+
+      // Textura liberada com uma leitura na fila: a leitura é cancelada
+      if (!texture && stream.read != 0 && io::shared().cancel(stream.read))
+      {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->in_flight--;
+        stream.read = 0;
+      }
+
+      if (!texture || !stream.resident)
+        continue;
+
+      float sampled = texture->sampled_texels_per_pixel;
+      texture->sampled_texels_per_pixel = std::numeric_limits<float>::infinity();
+
+      if (std::isinf(sampled))
+        continue;
+
+      stream.last_used = frame;
+
+      // Cada nível a menos dobra a razão texels/pixel
+      int offset = sampled > 0.0f ? static_cast<int>(std::floor(std::log2(sampled))) : -stream.level_count;
+      int needed = std::clamp(stream.first_level + offset, 0, stream.level_count - 1);
+
+      if (needed < stream.first_level)
+      {
+        stream.excess_since = -1;
+        if (stream.requested >= 0)
+          continue;
+
+        // Cada nível mais fino tem 4x a memória do anterior: pede o mais fino que cabe no orçamento
+        std::size_t bytes = texture->memoryBytes();
+        int level = stream.first_level;
+        while (level > needed && total + bytes * 3 <= budget)
+        {
+          total += bytes * 3;
+          bytes *= 4;
+          level--;
+        }
+
+        if (level < stream.first_level)
+          request(i, level);
+      }
+      else if (needed > stream.first_level)
+      {
+        // O nível 0 sobra: descartado depois de release_delay quadros sem ser necessário
+        if (stream.excess_since < 0)
+          stream.excess_since = frame;
+        else if (frame - stream.excess_since >= release_delay)
+        {
+          std::size_t before = texture->memoryBytes();
+          texture->dropFinestLevels(needed - stream.first_level);
+          total -= before - texture->memoryBytes();
+          stream.first_level = needed;
+          stream.excess_since = -1;
+          released++;
+        }
+      }
+      else
+        stream.excess_since = -1;
+    }
+
+    // Orçamento: descarta o nível mais fino da textura usada há mais tempo
+    while (total > budget)
+    {
+      Stream *oldest = nullptr;
+      std::shared_ptr<Texture> oldest_texture;
+
+      for (Stream &stream : streams)
+      {
+        std::shared_ptr<Texture> texture = stream.texture.lock();
+        if (!texture || !stream.resident || texture->levelCount() <= 1 || std::max(texture->width, texture->height) <= initial_size)
+          continue;
+
+        if (!oldest || stream.last_used < oldest->last_used)
+        {
+          oldest = &stream;
+          oldest_texture = texture;
+        }
+      }
+
+      if (!oldest)
+        break;
+
+      std::size_t before = oldest_texture->memoryBytes();
+      oldest_texture->dropFinestLevels(1);
+      total -= before - oldest_texture->memoryBytes();
+      oldest->first_level++;
+      released++;
+    }
+  }
+
+  std::size_t TextureStreamer::residentBytes() const
+  {
+    std::size_t bytes = 0;
+    for (const Stream &stream : streams)
+    {
+      if (std::shared_ptr<Texture> texture = stream.texture.lock())
+        bytes += texture->memoryBytes();
+    }
+    return bytes;
+  }
+
+  int TextureStreamer::pending()
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return static_cast<int>(state->completions.size()) + state->in_flight;
+  }
+
+  int TextureStreamer::liveTextures() const
+  {
+    return static_cast<int>(std::count_if(streams.begin(), streams.end(), [](const Stream &stream)
+                                          { return !stream.texture.expired(); }));
+  }
+}
@@ -0,0 +1,188 @@
+#include <models/vertex_cache.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace models
+{
+  // Parâmetros da pontuação de Forsyth ("Linear-Speed Vertex Cache Optimisation")
+  static constexpr float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+  static constexpr float FORSYTH_LAST_FACE_SCORE = 0.75f;
+  static constexpr float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+  static constexpr float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+  /**
+   * @brief Vértices transformados por triângulo com um cache FIFO de vértices
+   *
+   * @param corners Vértices de cada canto, face após face
+   * @param starts Início de cada face em corners (faces + 1 posições)
+   * @param vertex_count Número de vértices
+   * @param cache_size Entradas do cache
+   * @return float ACMR (cada face de n cantos conta como n - 2 triângulos)
+   */
+  float vertexCacheACMR(const std::vector<int> &corners, const std::vector<int> &starts, int vertex_count, int cache_size)
+  {
+    // Um vértice está no cache se foi inserido há menos de cache_size inserções
+    std::vector<long> inserted(vertex_count, -1);
+    long insertions = 0, triangles = 0;
+
+    for (std::size_t f = 0; f + 1 < starts.size(); f++)
+    {
+      for (int k = starts[f]; k < starts[f + 1]; k++)
+      {
+        long &time = inserted[corners[k]];
+        if (time < 0 || insertions - time >= cache_size)
+          time = insertions++;
+      }
+      triangles += std::max(starts[f + 1] - starts[f] - 2, 0);
+    }
+
+    return triangles > 0 ? static_cast<float>(insertions) / static_cast<float>(triangles) : 0.0f;
+  }
+
+  /**
+   * @brief Ordem das faces pelo algoritmo de Forsyth
+   *
+   * @param corners Vértices de cada canto, face após face
+   * @param starts Início de cada face em corners (faces + 1 posições)
+   * @param vertex_count Número de vértices
+   * @param cache_size Entradas do cache LRU simulado
+   * @return std::vector<int> Faces na nova ordem
+   *
+   * @note Cada vértice recebe uma pontuação pela posição no cache (vértices recém usados valem mais) e pelo
+   *       número de faces restantes (vértices quase terminados valem mais). A próxima face é a de maior soma
+   *       entre as faces dos vértices do cache, então só as faces vizinhas são reavaliadas a cada passo
+   * @note Versão para polígonos: a face inteira entra no início do cache
+   */
+  std::vector<int> vertexCacheOrder(const std::vector<int> &corners, const std::vector<int> &starts, int vertex_count, int cache_size)
+  {
+    int face_count = static_cast<int>(starts.size()) - 1;
+
+    // Faces de cada vértice (as ainda não emitidas ficam no início do trecho do vértice)
+    std::vector<int> adjacency_start(vertex_count + 1, 0);
+    for (int corner : corners)
+      adjacency_start[corner + 1]++;
+    for (int v = 0; v < vertex_count; v++)
+      adjacency_start[v + 1] += adjacency_start[v];
+
+    std::vector<int> adjacency(corners.size());
+    std::vector<int> remaining(vertex_count, 0);
+    for (int f = 0; f < face_count; f++)
+      for (int k = starts[f]; k < starts[f + 1]; k++)
+        adjacency[adjacency_start[corners[k]] + remaining[corners[k]]++] = f;
+
+    std::vector<int> cache_position(vertex_count, -1);
+    std::vector<float> vertex_score(vertex_count);
+    std::vector<float> face_score(face_count, 0.0f);
+    std::vector<char> emitted(face_count, 0);
+    int last_face_size = 0;
+
+    auto score = [&](int v)
+    {
+      if (remaining[v] == 0)
+        return -1.0f;
+
+      float value = 0.0f;
+      int position = cache_position[v];
+      if (position >= 0)
+      {
+        if (position < last_face_size)
+          value = FORSYTH_LAST_FACE_SCORE;
+        else
+          value = std::pow(1.0f - static_cast<float>(position - last_face_size) / static_cast<float>(cache_size - last_face_size), FORSYTH_CACHE_DECAY_POWER);
+      }
+
+      return value + FORSYTH_VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remaining[v]), -FORSYTH_VALENCE_BOOST_POWER);
+    };
+
+    for (int v = 0; v < vertex_count; v++)
+      vertex_score[v] = score(v);
+    for (int f = 0; f < face_count; f++)
+      for (int k = starts[f]; k < starts[f + 1]; k++)
+        face_score[f] += vertex_score[corners[k]];
+
+    std::vector<int> order;
+    order.reserve(face_count);
+    std::vector<int> cache, next_cache;
+    int best = face_count > 0 ? static_cast<int>(std::max_element(face_score.begin(), face_score.end()) - face_score.begin()) : -1;
+    int cursor = 0;
+
+    while (best >= 0)
+    {
+      order.push_back(best);
+      emitted[best] = 1;
+
+      // Retira a face das listas dos seus vértices
+      for (int k = starts[best]; k < starts[best + 1]; k++)
+      {
+        int v = corners[k];
+        int begin = adjacency_start[v], end = begin + remaining[v];
+        for (int i = begin; i < end; i++)
+        {
+          if (adjacency[i] == best)
+          {
+            std::swap(adjacency[i], adjacency[end - 1]);
+            remaining[v]--;
+            break;
+          }
+        }
+      }
+
+      // Cache LRU: vértices da face no início, seguidos dos anteriores que não estão na face
+      next_cache.assign(corners.begin() + starts[best], corners.begin() + starts[best + 1]);
+      for (int v : cache)
+        if (std::find(next_cache.begin(), next_cache.end(), v) == next_cache.end())
+          next_cache.push_back(v);
+
+      last_face_size = starts[best + 1] - starts[best];
+      for (int v : next_cache)
+        cache_position[v] = -1;
+      for (std::size_t i = 0; i < next_cache.size() && static_cast<int>(i) < cache_size; i++)
+        cache_position[next_cache[i]] = static_cast<int>(i);
+
+      // Reavalia os vértices afetados (os que saíram do cache também mudam) e as faces deles
+      best = -1;
+      float best_score = -1.0f;
+      for (int v : next_cache)
+      {
+        float updated = score(v);
+        float delta = updated - vertex_score[v];
+        vertex_score[v] = updated;
+
+        for (int i = adjacency_start[v]; i < adjacency_start[v] + remaining[v]; i++)
+        {
+          int f = adjacency[i];
+          face_score[f] += delta;
+        }
+      }
+
+      for (std::size_t i = 0; i < next_cache.size() && static_cast<int>(i) < cache_size; i++)
+      {
+        int v = next_cache[i];
+        for (int j = adjacency_start[v]; j < adjacency_start[v] + remaining[v]; j++)
+        {
+          int f = adjacency[j];
+          if (face_score[f] > best_score)
+          {
+            best_score = face_score[f];
+            best = f;
+          }
+        }
+      }
+
+      if (static_cast<int>(next_cache.size()) > cache_size)
+        next_cache.resize(cache_size);
+      cache.swap(next_cache);
+
+      // Nenhuma face vizinha restante: continua pela próxima face não emitida
+      if (best < 0)
+      {
+        while (cursor < face_count && emitted[cursor])
+          cursor++;
+        best = cursor < face_count ? cursor : -1;
+      }
+    }
+
+    return order;
+  }
+}
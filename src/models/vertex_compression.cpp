@@ -0,0 +1,267 @@
+#include <models/vertex_compression.hpp>
+#include <models/mesh.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+// Estágio de dequantização com SSE2 (parte da base do x86-64)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VERTEX_SSE2 1
+#endif
+
+namespace models
+{
+  // Maior valor de uma componente quantizada em 16 bits
+  static constexpr float QUANTIZED_MAX = 65535.0f;
+
+  // Sinal sem zero (o zero conta como positivo, senão as normais nos eixos perdem o hemisfério)
+  static float sign_not_zero(float value)
+  {
+    return value >= 0.0f ? 1.0f : -1.0f;
+  }
+
+  // Quantiza um valor de [min, min + step * 65535] em 16 bits
+  static std::uint16_t quantize(float value, float min, float step)
+  {
+    if (step <= 0.0f)
+      return 0;
+
+    float q = std::round((value - min) / step);
+    return static_cast<std::uint16_t>(std::clamp(q, 0.0f, QUANTIZED_MAX));
+  }
+
+  std::uint32_t encodeOctahedral(const Vec3f &normal, int bits)
+  {
+    float max_value = static_cast<float>((1u << bits) - 1u);
+
+    float length = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+    if (length <= 0.0f)
+      length = 1.0f;
+
+    float x = normal.x / length;
+    float y = normal.y / length;
+
+    // Hemisfério inferior: dobra sobre as diagonais do quadrado
+    if (normal.z < 0.0f)
+    {
+      float folded_x = (1.0f - std::fabs(y)) * sign_not_zero(x);
+      float folded_y = (1.0f - std::fabs(x)) * sign_not_zero(y);
+      x = folded_x;
+      y = folded_y;
+    }
+
+    std::uint32_t qx = static_cast<std::uint32_t>(std::clamp(std::round((x * 0.5f + 0.5f) * max_value), 0.0f, max_value));
+    std::uint32_t qy = static_cast<std::uint32_t>(std::clamp(std::round((y * 0.5f + 0.5f) * max_value), 0.0f, max_value));
+
+    return qx | (qy << bits);
+  }
+
+  Vec3f decodeOctahedral(std::uint32_t packed, int bits)
+  {
+    std::uint32_t mask = (1u << bits) - 1u;
+    float max_value = static_cast<float>(mask);
+
+    float x = static_cast<float>(packed & mask) / max_value * 2.0f - 1.0f;
+    float y = static_cast<float>((packed >> bits) & mask) / max_value * 2.0f - 1.0f;
+    float z = 1.0f - std::fabs(x) - std::fabs(y);
+
+    // Desfaz a dobra do hemisfério inferior
+    float t = std::max(-z, 0.0f);
+    x += x >= 0.0f ? -t : t;
+    y += y >= 0.0f ? -t : t;
+
+    return Vector3Normalize(Vec3f(x, y, z));
+  }
+
+  /**
+   * @brief Comprime os vértices da malha
+   *
+   * @param mesh Malha (as normais médias dos vértices já devem estar calculadas se ela não tiver normais por canto)
+   * @param precision Precisão das normais
+   *
+   * @note As posições são quantizadas dentro da AABB dos vértices (o erro máximo é metade do passo,
+   *       ~0.0008% da maior dimensão da malha) e as UVs dentro do intervalo das UVs por canto
+   */
+  void CompressedVertices::build(const Mesh &mesh, NormalPrecision precision)
+  {
+    clear();
+    normal_precision = precision;
+
+    if (mesh.vertexes.empty())
+      return;
+
+    // AABB dos vértices no SRO
+    Vec3f min = mesh.vertexes[0]->vertex.to_vec3();
+    Vec3f max = min;
+    for (const Vertex *vertex : mesh.vertexes)
+    {
+      min = {std::min(min.x, vertex->vertex.x), std::min(min.y, vertex->vertex.y), std::min(min.z, vertex->vertex.z)};
+      max = {std::max(max.x, vertex->vertex.x), std::max(max.y, vertex->vertex.y), std::max(max.z, vertex->vertex.z)};
+    }
+
+    position_min = min;
+    position_step = (max - min) * (1.0f / QUANTIZED_MAX);
+
+    positions.resize(mesh.vertexes.size());
+    for (std::size_t i = 0; i < mesh.vertexes.size(); i++)
+    {
+      const Vec4f &p = mesh.vertexes[i]->vertex;
+      positions[i] = {quantize(p.x, min.x, position_step.x), quantize(p.y, min.y, position_step.y), quantize(p.z, min.z, position_step.z)};
+    }
+
+    // Normais por canto (normal do canto se existir, senão a normal média do vértice de origem)
+    std::size_t corners = mesh.halfedges.size();
+    bool has_corner_normals = !mesh.corner_normals.empty();
+
+    if (precision == NormalPrecision::OCT8)
+      normals8.resize(corners);
+    else
+      normals16.resize(corners);
+
+    for (const HalfEdge *he : mesh.halfedges)
+    {
+      const Vec3f &normal = has_corner_normals ? mesh.corner_normals[he->index] : he->origin->normal;
+
+      if (precision == NormalPrecision::OCT8)
+        normals8[he->index] = static_cast<std::uint16_t>(encodeOctahedral(normal, 8));
+      else
+        normals16[he->index] = encodeOctahedral(normal, 16);
+    }
+
+    // UVs por canto
+    if (!mesh.corner_uvs.empty())
+    {
+      Vec2f uv_max = mesh.corner_uvs[0];
+      uv_min = uv_max;
+      for (const Vec2f &uv : mesh.corner_uvs)
+      {
+        uv_min = {std::min(uv_min.x, uv.x), std::min(uv_min.y, uv.y)};
+        uv_max = {std::max(uv_max.x, uv.x), std::max(uv_max.y, uv.y)};
+      }
+      uv_step = {(uv_max.x - uv_min.x) / QUANTIZED_MAX, (uv_max.y - uv_min.y) / QUANTIZED_MAX};
+
+      uvs.resize(mesh.corner_uvs.size());
+      for (std::size_t i = 0; i < uvs.size(); i++)
+        uvs[i] = {quantize(mesh.corner_uvs[i].x, uv_min.x, uv_step.x), quantize(mesh.corner_uvs[i].y, uv_min.y, uv_step.y)};
+    }
+
+    corner_normals_source = has_corner_normals;
+
+    // Os mesmos atributos em float: posição xyz por vértice, normal por canto (ou a média por vértice) e UV por canto.
+    // Os campos de tela, ids e ligações dos vértices não entram, o fluxo não os substitui
+    std::size_t normal_count = has_corner_normals ? corners : mesh.vertexes.size();
+    float_bytes = mesh.vertexes.size() * sizeof(Vec3f) + normal_count * sizeof(Vec3f) + mesh.corner_uvs.size() * sizeof(Vec2f);
+    released_bytes = mesh.corner_normals.size() * sizeof(Vec3f) + mesh.corner_uvs.size() * sizeof(Vec2f);
+  }
+
+  void CompressedVertices::clear()
+  {
+    positions.clear();
+    normals8.clear();
+    normals16.clear();
+    uvs.clear();
+    corner_normals_source = false;
+    float_bytes = 0;
+    released_bytes = 0;
+  }
+
+  /**
+   * @brief Matriz de dequantização das posições
+   *
+   * @return Matrix Escala pelo passo de quantização seguida da translação para o mínimo da AABB
+   *
+   * @note Segue a convenção de pipeline::model_to_sru (linhas em Matrix::fromList) e é multiplicada à direita
+   *       da matriz do pipeline: MatrixMultiply(pipeline_matrix, dequantization())
+   */
+  Matrix CompressedVertices::dequantization() const
+  {
+    float m[16] = {position_step.x, 0, 0, position_min.x,
+                   0, position_step.y, 0, position_min.y,
+                   0, 0, position_step.z, position_min.z,
+                   0, 0, 0, 1};
+
+    return Matrix::fromList(m);
+  }
+
+  /**
+   * @brief Estágio de dequantização e transformação das posições
+   *
+   * @param matrix Matriz do pipeline multiplicada por dequantization()
+   * @param out Recebe as posições no espaço de recorte (positions.size() elementos)
+   *
+   * @note Com SSE2 quatro posições (24 bytes) são lidas de uma vez, os inteiros de 16 bits são estendidos e
+   *       convertidos para float em três registradores e cada vértice é a soma das colunas da matriz escaladas
+   *       pelas suas coordenadas. As somas seguem a ordem de MatrixMultiplyVector, então o resultado é o mesmo
+   *       do caminho escalar
+   */
+  void CompressedVertices::transformPositions(const Matrix &matrix, Vec4f *out) const
+  {
+    std::size_t count = positions.size();
+    std::size_t i = 0;
+
+#ifdef VERTEX_SSE2
+    const __m128 column_x = _mm_setr_ps(matrix.m0, matrix.m4, matrix.m8, matrix.m12);
+    const __m128 column_y = _mm_setr_ps(matrix.m1, matrix.m5, matrix.m9, matrix.m13);
+    const __m128 column_z = _mm_setr_ps(matrix.m2, matrix.m6, matrix.m10, matrix.m14);
+    const __m128 column_w = _mm_setr_ps(matrix.m3, matrix.m7, matrix.m11, matrix.m15);
+    const __m128i zero = _mm_setzero_si128();
+
+    auto transform = [&](__m128 x, __m128 y, __m128 z, Vec4f &result)
+    {
+      __m128 sum = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(column_x, x), _mm_mul_ps(column_y, y)), _mm_mul_ps(column_z, z)), column_w);
+      _mm_storeu_ps(&result.x, sum);
+    };
+
+    const auto *bytes = reinterpret_cast<const std::uint8_t *>(positions.data());
+    for (; i + 4 <= count; i += 4)
+    {
+      // x0 y0 z0 x1 y1 z1 x2 y2 | z2 x3 y3 z3
+      __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + i * sizeof(QuantizedPosition)));
+      __m128i high = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(bytes + i * sizeof(QuantizedPosition) + 16));
+
+      __m128 a = _mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero));  // x0 y0 z0 x1
+      __m128 b = _mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero));  // y1 z1 x2 y2
+      __m128 c = _mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)); // z2 x3 y3 z3
+
+      transform(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2)), out[i]);
+      transform(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 1, 1, 1)), out[i + 1]);
+      transform(_mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 2, 2)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 3, 3)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(0, 0, 0, 0)), out[i + 2]);
+      transform(_mm_shuffle_ps(c, c, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(2, 2, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 3, 3)), out[i + 3]);
+    }
+#endif
+
+    for (; i < count; i++)
+      out[i] = MatrixMultiplyVector(matrix, Vec4f(positions[i].x, positions[i].y, positions[i].z, 1.0f));
+  }
+
+  Vec3f CompressedVertices::position(int vertex) const
+  {
+    const QuantizedPosition &q = positions[vertex];
+    return {position_min.x + static_cast<float>(q.x) * position_step.x,
+            position_min.y + static_cast<float>(q.y) * position_step.y,
+            position_min.z + static_cast<float>(q.z) * position_step.z};
+  }
+
+  Vec3f CompressedVertices::normal(int corner) const
+  {
+    if (normal_precision == NormalPrecision::OCT8)
+      return decodeOctahedral(normals8[corner], 8);
+
+    return decodeOctahedral(normals16[corner], 16);
+  }
+
+  Vec2f CompressedVertices::uv(int corner) const
+  {
+    const QuantizedUV &q = uvs[corner];
+    return {uv_min.x + static_cast<float>(q.u) * uv_step.x, uv_min.y + static_cast<float>(q.v) * uv_step.y};
+  }
+
+  std::size_t CompressedVertices::bytes() const
+  {
+    return positions.size() * sizeof(QuantizedPosition) +
+           normals8.size() * sizeof(std::uint16_t) +
+           normals16.size() * sizeof(std::uint32_t) +
+           uvs.size() * sizeof(QuantizedUV);
+  }
+}
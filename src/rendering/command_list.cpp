@@ -0,0 +1,204 @@
+#include <rendering/command_list.hpp>
+
+#include <cstring>
+#include <limits>
+
+namespace pipeline
+{
+  // Campos da chave no modo STATE
+  static constexpr int KEY_KIND_SHIFT = 60;
+  static constexpr int KEY_TEXTURE_SHIFT = 44;
+  static constexpr int KEY_MATERIAL_SHIFT = 28;
+  static constexpr std::uint64_t KEY_FIELD_MASK = 0xFFFF;
+  static constexpr std::uint64_t KEY_DEPTH_MASK = (1ull << 28) - 1;
+
+  // Campos da chave no modo FRONT_TO_BACK
+  static constexpr int DEPTH_FIRST_DEPTH_SHIFT = 36;
+  static constexpr int DEPTH_FIRST_KIND_SHIFT = 32;
+  static constexpr int DEPTH_FIRST_TEXTURE_SHIFT = 16;
+
+  // Dígitos do radix sort (8 passadas de 8 bits)
+  static constexpr int RADIX_BITS = 8;
+  static constexpr int RADIX_PASSES = 64 / RADIX_BITS;
+  static constexpr int RADIX_BUCKETS = 1 << RADIX_BITS;
+
+  /**
+   * @brief Profundidade em 28 bits para a chave
+   *
+   * @note Em floats positivos a ordem dos bits é a ordem dos valores, então basta descartar o sinal
+   *       e os 3 bits menos significativos da mantissa
+   */
+  static std::uint64_t depth_bits(float depth)
+  {
+    if (!(depth > 0.0f))
+      return 0;
+
+    std::uint32_t bits;
+    std::memcpy(&bits, &depth, sizeof(bits));
+    return (bits >> 3) & KEY_DEPTH_MASK;
+  }
+
+  void CommandList::clear()
+  {
+    commands.clear();
+    payloads.clear();
+    flat_vertexes.clear();
+    color_vertexes.clear();
+    texture_vertexes.clear();
+    line_vertexes.clear();
+    clip_stats.reset();
+    object = 0;
+    sequence = 0;
+  }
+
+  void CommandList::begin(int object_index, int material_id, int texture_id)
+  {
+    object = static_cast<std::uint32_t>(object_index);
+    material = static_cast<std::uint32_t>(material_id);
+    texture = static_cast<std::uint32_t>(texture_id);
+    sequence = 0;
+  }
+
+  void CommandList::push(CommandKind kind, float depth)
+  {
+    std::uint64_t key;
+    if (order == CommandOrder::SUBMISSION)
+      key = (static_cast<std::uint64_t>(object) << 32) | sequence;
+    else if (order == CommandOrder::FRONT_TO_BACK)
+      key = (depth_bits(depth) << DEPTH_FIRST_DEPTH_SHIFT) |
+            (static_cast<std::uint64_t>(kind) << DEPTH_FIRST_KIND_SHIFT) |
+            ((texture & KEY_FIELD_MASK) << DEPTH_FIRST_TEXTURE_SHIFT) |
+            (material & KEY_FIELD_MASK);
+    else
+      key = (static_cast<std::uint64_t>(kind) << KEY_KIND_SHIFT) |
+            ((texture & KEY_FIELD_MASK) << KEY_TEXTURE_SHIFT) |
+            ((material & KEY_FIELD_MASK) << KEY_MATERIAL_SHIFT) |
+            depth_bits(depth);
+
+    sequence++;
+    commands.push_back({key, static_cast<std::uint32_t>(payloads.size() - 1)});
+  }
+
+  /**
+   * @brief Grava uma linha poligonal fechada
+   *
+   * @param vertexes Vértices (x, y, 1/w)
+   * @param payload Dados do comando (first_vertex e vertex_count são preenchidos aqui)
+   */
+  void CommandList::lines(const std::vector<Vec3f> &vertexes, const DrawPayload &payload)
+  {
+    DrawPayload &stored = payloads.emplace_back(payload);
+    stored.first_vertex = static_cast<std::uint32_t>(line_vertexes.size());
+    stored.vertex_count = static_cast<std::uint32_t>(vertexes.size());
+
+    float depth = std::numeric_limits<float>::max();
+    for (const Vec3f &vertex : vertexes)
+    {
+      line_vertexes.push_back(vertex);
+      if (vertex.z > 0.0f)
+        depth = std::min(depth, 1.0f / vertex.z);
+    }
+
+    push(payload.kind, depth);
+  }
+
+  /**
+   * @brief Junta os comandos de outra lista no fim desta
+   *
+   * @param other Lista gravada por outra thread
+   *
+   * @note Os índices dos payloads e dos vértices são deslocados, as chaves não mudam
+   */
+  void CommandList::append(const CommandList &other)
+  {
+    std::uint32_t payload_base = static_cast<std::uint32_t>(payloads.size());
+    std::uint32_t flat_base = static_cast<std::uint32_t>(flat_vertexes.size());
+    std::uint32_t color_base = static_cast<std::uint32_t>(color_vertexes.size());
+    std::uint32_t texture_base = static_cast<std::uint32_t>(texture_vertexes.size());
+    std::uint32_t line_base = static_cast<std::uint32_t>(line_vertexes.size());
+
+    commands.reserve(commands.size() + other.commands.size());
+    for (const RenderCommand &command : other.commands)
+      commands.push_back({command.key, command.payload + payload_base});
+
+    payloads.reserve(payloads.size() + other.payloads.size());
+    for (DrawPayload payload : other.payloads)
+    {
+      switch (payload.kind)
+      {
+      case CommandKind::FLAT:
+      case CommandKind::VISIBILITY:
+        payload.first_vertex += flat_base;
+        break;
+      case CommandKind::GOURAUD:
+      case CommandKind::PHONG:
+        payload.first_vertex += color_base;
+        break;
+      case CommandKind::TEXTURE:
+      case CommandKind::TEXTURE_INDEXED:
+        payload.first_vertex += texture_base;
+        break;
+      case CommandKind::LINES:
+      case CommandKind::LINES_INDEXED:
+        payload.first_vertex += line_base;
+        break;
+      }
+      payloads.push_back(payload);
+    }
+
+    flat_vertexes.insert(flat_vertexes.end(), other.flat_vertexes.begin(), other.flat_vertexes.end());
+    color_vertexes.insert(color_vertexes.end(), other.color_vertexes.begin(), other.color_vertexes.end());
+    texture_vertexes.insert(texture_vertexes.end(), other.texture_vertexes.begin(), other.texture_vertexes.end());
+    line_vertexes.insert(line_vertexes.end(), other.line_vertexes.begin(), other.line_vertexes.end());
+
+    clip_stats += other.clip_stats;
+  }
+
+  /**
+   * @brief Ordena os comandos pela chave
+   *
+   * @note Radix sort LSD estável (comandos com a mesma chave ficam na ordem de gravação). Os histogramas
+   *       dos 8 dígitos são montados em uma única leitura e as passadas em que todas as chaves têm o
+   *       mesmo dígito são puladas (ex.: os bits altos do objeto no modo SUBMISSION)
+   */
+  void CommandList::sort()
+  {
+    std::size_t count = commands.size();
+    if (count < 2)
+      return;
+
+    std::size_t histograms[RADIX_PASSES][RADIX_BUCKETS] = {};
+    for (const RenderCommand &command : commands)
+      for (int pass = 0; pass < RADIX_PASSES; pass++)
+        histograms[pass][(command.key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+
+    scratch.resize(count);
+    RenderCommand *source = commands.data();
+    RenderCommand *destination = scratch.data();
+
+    for (int pass = 0; pass < RADIX_PASSES; pass++)
+    {
+      int shift = pass * RADIX_BITS;
+      std::size_t *offsets = histograms[pass];
+
+      if (offsets[(source[0].key >> shift) & (RADIX_BUCKETS - 1)] == count)
+        continue;
+
+      std::size_t offset = 0;
+      for (int digit = 0; digit < RADIX_BUCKETS; digit++)
+      {
+        std::size_t digit_count = offsets[digit];
+        offsets[digit] = offset;
+        offset += digit_count;
+      }
+
+      for (std::size_t i = 0; i < count; i++)
+        destination[offsets[(source[i].key >> shift) & (RADIX_BUCKETS - 1)]++] = source[i];
+
+      std::swap(source, destination);
+    }
+
+    if (source != commands.data())
+      commands.swap(scratch);
+  }
+}
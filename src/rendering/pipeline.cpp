@@ -1,5 +1,59 @@
 #include <rendering/pipeline.hpp>
 
+/**
+ * @brief Obtém a matriz de modelo, que leva do SRO para o SRU.
+ * @note SRO: Sistema de Referência do Objeto
+ * @note SRU: Sistema de Referência do Universo
+ *
+ * A matriz obtida é dada por M = T * Rz * Ry * Rx * S, ou seja, o objeto é escalado,
+ * rotacionado em X, Y e Z (nesta ordem) e por fim transladado.
+ *
+ * @param position Posição do objeto no SRU
+ * @param rotation Ângulos de rotação em X, Y e Z (radianos)
+ * @param scale Fatores de escala em X, Y e Z
+ * @return Matriz de modelo
+ *
+ * @note Segue a mesma convenção de sru_to_src (linhas em Matrix::fromList)
+ */
+Matrix pipeline::model_to_sru(const Vec3f &position, const Vec3f &rotation, const Vec3f &scale)
+{
+  float cx = cosf(rotation.x), sx = sinf(rotation.x);
+  float cy = cosf(rotation.y), sy = sinf(rotation.y);
+  float cz = cosf(rotation.z), sz = sinf(rotation.z);
+
+  float t[16] = {1, 0, 0, position.x,
+                 0, 1, 0, position.y,
+                 0, 0, 1, position.z,
+                 0, 0, 0, 1};
+
+  float rx[16] = {1, 0, 0, 0,
+                  0, cx, -sx, 0,
+                  0, sx, cx, 0,
+                  0, 0, 0, 1};
+
+  float ry[16] = {cy, 0, sy, 0,
+                  0, 1, 0, 0,
+                  -sy, 0, cy, 0,
+                  0, 0, 0, 1};
+
+  float rz[16] = {cz, -sz, 0, 0,
+                  sz, cz, 0, 0,
+                  0, 0, 1, 0,
+                  0, 0, 0, 1};
+
+  float s[16] = {scale.x, 0, 0, 0,
+                 0, scale.y, 0, 0,
+                 0, 0, scale.z, 0,
+                 0, 0, 0, 1};
+
+  Matrix result = MatrixMultiply(Matrix::fromList(t), Matrix::fromList(rz));
+  result = MatrixMultiply(result, Matrix::fromList(ry));
+  result = MatrixMultiply(result, Matrix::fromList(rx));
+  result = MatrixMultiply(result, Matrix::fromList(s));
+
+  return result;
+}
+
 /**
  * @brief Obtém a matriz de transformação de SRU para SRC.
  * @note SRU: Sistema de Referência do Universo
@@ -182,348 +236,28 @@ bool pipeline::is_inside(Vec3f p, Vec2f min, Vec2f max, unsigned int edge)
 }
 
 /**
- * @brief Calcula o ponto de interseção de uma linha com uma janela de recorte.
+ * @brief Calcula o outcode (Cohen-Sutherland) de um ponto em relação à janela de recorte.
  *
- * @param p1 Ponto inicial da linha
- * @param p2 Ponto final da linha
+ * @param p Ponto a ser verificado
  * @param min Canto inferior esquerdo da janela de recorte
  * @param max Canto superior direito da janela de recorte
- * @param edge Borda da janela de recorte
- * @return Vec3f
- *
- * @note Utilizado no recorte de linhas 2D
- */
-Vec3f pipeline::compute_intersection(Vec3f p1, Vec3f p2, Vec2f min, Vec2f max, unsigned int edge)
-{
-  float u = 0.0f;
-  Vec3f intersection;
-
-  if (edge == LEFT)
-  {
-    u = (min.x - p1.x) / (p2.x - p1.x);
-    intersection.x = min.x;
-    intersection.y = Lerp(p1.y, p2.y, u);
-    intersection.z = Lerp(p1.z, p2.z, u);
-  }
-  else if (edge == RIGHT)
-  {
-    u = (max.x - p1.x) / (p2.x - p1.x);
-    intersection.x = max.x;
-    intersection.y = Lerp(p1.y, p2.y, u);
-    intersection.z = Lerp(p1.z, p2.z, u);
-  }
-  else if (edge == BOTTOM)
-  {
-    u = (min.y - p1.y) / (p2.y - p1.y);
-    intersection.x = Lerp(p1.x, p2.x, u);
-    intersection.y = min.y;
-    intersection.z = Lerp(p1.z, p2.z, u);
-  }
-  else if (edge == TOP)
-  {
-    u = (max.y - p1.y) / (p2.y - p1.y);
-    intersection.x = Lerp(p1.x, p2.x, u);
-    intersection.y = max.y;
-    intersection.z = Lerp(p1.z, p2.z, u);
-  }
-
-  return intersection;
-}
-
-/**
- * @brief Calcula o ponto de interseção de uma linha com uma janela de recorte.
- *
- * @param p1 Pontos iniciais da linha (coordenadas e normal/cor)
- * @param p2 Pontos finais da linha (coordenadas e normal/cor)
- * @param min Canto inferior esquerdo da borda de recorte
- * @param max Canto superior direito da borda de recorte
- * @param edge Plano de borda a ser verificada
- * @return std::pair<Vec3f, models::Color> Par de coordenadas e normal/cor
- *
- * @note Utilizado no recorte de polígonos 2D
- */
-std::pair<Vec3f, models::Color> pipeline::compute_intersection(std::pair<Vec3f, models::Color> p1, std::pair<Vec3f, models::Color> p2, Vec2f min, Vec2f max, unsigned int edge)
-{
-  float u = 0.0f;
-  std::pair<Vec3f, models::Color> intersection;
-
-  if (edge == LEFT)
-  {
-    u = (min.x - p1.first.x) / (p2.first.x - p1.first.x);
-    intersection.first.x = min.x;
-    intersection.first.y = Lerp(p1.first.y, p2.first.y, u);
-    intersection.first.z = Lerp(p1.first.z, p2.first.z, u);
-  }
-  else if (edge == RIGHT)
-  {
-    u = (max.x - p1.first.x) / (p2.first.x - p1.first.x);
-    intersection.first.x = max.x;
-    intersection.first.y = Lerp(p1.first.y, p2.first.y, u);
-    intersection.first.z = Lerp(p1.first.z, p2.first.z, u);
-  }
-  else if (edge == BOTTOM)
-  {
-    u = (min.y - p1.first.y) / (p2.first.y - p1.first.y);
-    intersection.first.x = Lerp(p1.first.x, p2.first.x, u);
-    intersection.first.y = min.y;
-    intersection.first.z = Lerp(p1.first.z, p2.first.z, u);
-  }
-  else if (edge == TOP)
-  {
-    u = (max.y - p1.first.y) / (p2.first.y - p1.first.y);
-    intersection.first.x = Lerp(p1.first.x, p2.first.x, u);
-    intersection.first.y = max.y;
-    intersection.first.z = Lerp(p1.first.z, p2.first.z, u);
-  }
-
-  intersection.second = models::InterpolateColors(p1.second, p2.second, u);
-
-  return intersection;
-}
-
-/**
- * @brief Calcula o ponto de interseção de uma linha com uma janela de recorte.
- *
- * @param p1 Pontos iniciais da linha (coordenadas e normal/cor)
- * @param p2 Pontos finais da linha (coordenadas e normal/cor)
- * @param min Canto inferior esquerdo da borda de recorte
- * @param max Canto superior direito da borda de recorte
- * @param edge Plano de borda a ser verificada
- * @return std::pair<Vec3f, Vec3f> Par de coordenadas e normal do vértice
- *
- * @note Utilizado no recorte de polígonos 2D
- */
-std::pair<Vec3f, Vec3f> pipeline::compute_intersection(std::pair<Vec3f, Vec3f> p1, std::pair<Vec3f, Vec3f> p2, Vec2f min, Vec2f max, unsigned int edge)
-{
-  float u = 0.0f;
-  std::pair<Vec3f, Vec3f> intersection;
-
-  if (edge == LEFT)
-  {
-    u = (min.x - p1.first.x) / (p2.first.x - p1.first.x);
-    intersection.first.x = min.x;
-    intersection.first.y = Lerp(p1.first.y, p2.first.y, u);
-    intersection.first.z = Lerp(p1.first.z, p2.first.z, u);
-  }
-  else if (edge == RIGHT)
-  {
-    u = (max.x - p1.first.x) / (p2.first.x - p1.first.x);
-    intersection.first.x = max.x;
-    intersection.first.y = Lerp(p1.first.y, p2.first.y, u);
-    intersection.first.z = Lerp(p1.first.z, p2.first.z, u);
-  }
-  else if (edge == BOTTOM)
-  {
-    u = (min.y - p1.first.y) / (p2.first.y - p1.first.y);
-    intersection.first.x = Lerp(p1.first.x, p2.first.x, u);
-    intersection.first.y = min.y;
-    intersection.first.z = Lerp(p1.first.z, p2.first.z, u);
-  }
-  else if (edge == TOP)
-  {
-    u = (max.y - p1.first.y) / (p2.first.y - p1.first.y);
-    intersection.first.x = Lerp(p1.first.x, p2.first.x, u);
-    intersection.first.y = max.y;
-    intersection.first.z = Lerp(p1.first.z, p2.first.z, u);
-  }
-
-  intersection.second.x = Lerp(p1.second.x, p2.second.x, u);
-  intersection.second.y = Lerp(p1.second.y, p2.second.y, u);
-  intersection.second.z = Lerp(p1.second.z, p2.second.z, u);
-
-  return intersection;
-}
-
-/**
- * @brief Clipa um polígono 2D
- *
- * @param polygon Lista de vértices do polígono percorridos no sentido anti-horário
- * @param min Limite inferior esquerdo da janela de recorte
- * @param max Limite superior direito da janela de recorte
- * @return std::vector<Vec3f> Lista de vértices do polígono clipado
- *
- * @note O algoritmo de Sutherland-Hodgman é utilizado
- */
-std::vector<Vec3f> pipeline::clip_2D_polygon(const std::vector<Vec3f> &polygon, const Vec2f &min, const Vec2f &max)
-{
-  std::vector<Vec3f> result = polygon;
-
-  // Ordem de recorte
-  const std::vector<unsigned int> edges = {LEFT, RIGHT, BOTTOM, TOP};
-
-  // A cada iteração, uma nova lista de vertices é gerada
-  for (auto edge : edges)
-  {
-    if (result.empty())
-      break;
-
-    std::vector<Vec3f> input = result;
-    result.clear();
-
-    for (int i = 0; i < input.size(); i++)
-    {
-      int k = (i + 1) % input.size();
-      Vec3f p1 = input[i];
-      Vec3f p2 = input[k];
-
-      // Testa se os pontos estão dentro da janela de recorte
-      bool p1_inside = is_inside(p1, min, max, edge);
-      bool p2_inside = is_inside(p2, min, max, edge);
-
-      // Aceitação trivial
-      // Ambos os pontos estão dentro da janela, então adiciona o ponto final
-      if (p1_inside && p2_inside)
-        result.push_back(p2);
-
-      // Rejeição trivial
-      // Nenhum dos pontos está dentro da janela, então não adiciona nenhum ponto
-      else if (!p1_inside && !p2_inside)
-        continue;
-      // Não é possível aceitar ou rejeitar trivialmente a linha
-      else
-      {
-        // Calcula o ponto de interseção
-        Vec3f intersection = compute_intersection(p1, p2, min, max, edge);
-
-        // Somente o primeiro ponto está fora da janela, então adiciona o ponto de interseção e o ponto final
-        if (!p1_inside && p2_inside)
-        {
-          result.push_back(intersection);
-          result.push_back(p2);
-        }
-        // Somente o segundo ponto está fora da janela, então adiciona o ponto de interseção
-        else if (p1_inside && !p2_inside)
-          result.push_back(intersection);
-      }
-    }
-  }
-  return result;
-}
-
-/**
- * @brief Clipa um polígono 2D
- *
- * @param polygon Lista de vértices do polígono percorridos no sentido anti-horário (coordenadas e normal/cor)
- * @param min Limite inferior esquerdo da janela de recorte
- * @param max Limite superior direito da janela de recorte
- * @return std::vector<std::pair<Vec3f, models::Color>> Lista de vértices e normal/cor do polígono clipado
- *
- * @note O algoritmo de Sutherland-Hodgman é utilizado
- * @note Refatorar para utilizar a mesma função de clipagem dos polígonos 2D
+ * @return unsigned int Bits das bordas (LEFT, RIGHT, BOTTOM, TOP) que o ponto está fora, INSIDE se estiver dentro
  */
-std::vector<std::pair<Vec3f, models::Color>> pipeline::clip_2D_polygon(const std::vector<std::pair<Vec3f, models::Color>> &polygon, const Vec2f &min, const Vec2f &max)
+unsigned int pipeline::outcode(const Vec3f &p, const Vec2f &min, const Vec2f &max)
 {
-  std::vector<std::pair<Vec3f, models::Color>> result = polygon;
+  unsigned int code = INSIDE;
 
-  const std::vector<unsigned int> edges = {LEFT, RIGHT, BOTTOM, TOP};
+  if (p.x < min.x)
+    code |= LEFT;
+  else if (p.x > max.x)
+    code |= RIGHT;
 
-  // A cada iteração, uma nova lista de vertices é gerada
-  for (auto edge : edges)
-  {
-    if (result.empty())
-      break;
-
-    std::vector<std::pair<Vec3f, models::Color>> input = result;
-    result.clear();
+  if (p.y < min.y)
+    code |= BOTTOM;
+  else if (p.y > max.y)
+    code |= TOP;
 
-    for (int i = 0; i < input.size(); i++)
-    {
-      int k = (i + 1) % input.size();
-      std::pair<Vec3f, models::Color> p1 = input[i];
-      std::pair<Vec3f, models::Color> p2 = input[k];
-
-      // Testa se os pontos estão dentro da janela de recorte
-      bool p1_inside = is_inside(p1.first, min, max, edge);
-      bool p2_inside = is_inside(p2.first, min, max, edge);
-
-      // Ambos os pontos estão dentro da janela, então adiciona o ponto final
-      if (p1_inside && p2_inside)
-        result.push_back(p2);
-      // Nenhum dos pontos está dentro da janela, então não adiciona nenhum ponto
-      else if (!p1_inside && !p2_inside)
-        continue;
-      // Não é possível aceitar ou rejeitar trivialmente a linha
-      else
-      {
-        // Calcula o ponto de interseção
-        std::pair<Vec3f, models::Color> intersection = compute_intersection(p1, p2, min, max, edge);
-
-        // Somente o primeiro ponto está fora da janela, então adiciona o ponto de interseção e o ponto final
-        if (!p1_inside && p2_inside)
-        {
-          result.push_back(intersection);
-          result.push_back(p2);
-        }
-        // Somente o segundo ponto está fora da janela, então adiciona o ponto de interseção
-        else if (p1_inside && !p2_inside)
-          result.push_back(intersection);
-      }
-    }
-  }
-  return result;
-}
-
-/**
- * @brief Clipa um polígono 2D
- *
- * @param polygon Lista de vértices do polígono percorridos no sentido anti-horário (coordenadas e normal/cor)
- * @param min Limite inferior esquerdo da janela de recorte
- * @param max Limite superior direito da janela de recorte
- * @return std::vector<std::pair<Vec3f, Vec3f>> Lista de vértices e normal/cor do polígono clipado
- *
- * @note O algoritmo de Sutherland-Hodgman é utilizado
- * @note Refatorar para utilizar a mesma função de clipagem dos polígonos 2D
- */
-std::vector<std::pair<Vec3f, Vec3f>> pipeline::clip_2D_polygon(const std::vector<std::pair<Vec3f, Vec3f>> &polygon, const Vec2f &min, const Vec2f &max)
-{
-  std::vector<std::pair<Vec3f, Vec3f>> result = polygon;
-
-  const std::vector<unsigned int> edges = {LEFT, RIGHT, BOTTOM, TOP};
-
-  // A cada iteração, uma nova lista de vertices é gerada
-  for (auto edge : edges)
-  {
-    if (result.empty())
-      break;
-
-    std::vector<std::pair<Vec3f, Vec3f>> input = result;
-    result.clear();
-
-    for (int i = 0; i < input.size(); i++)
-    {
-      int k = (i + 1) % input.size();
-      std::pair<Vec3f, Vec3f> p1 = input[i];
-      std::pair<Vec3f, Vec3f> p2 = input[k];
-
-      // Testa se os pontos estão dentro da janela de recorte
-      bool p1_inside = is_inside(p1.first, min, max, edge);
-      bool p2_inside = is_inside(p2.first, min, max, edge);
-
-      // Ambos os pontos estão dentro da janela, então adiciona o ponto final
-      if (p1_inside && p2_inside)
-        result.push_back(p2);
-      // Nenhum dos pontos está dentro da janela, então não adiciona nenhum ponto
-      else if (!p1_inside && !p2_inside)
-        continue;
-      // Não é possível aceitar ou rejeitar trivialmente a linha
-      else
-      {
-        // Calcula o ponto de interseção
-        std::pair<Vec3f, Vec3f> intersection = compute_intersection(p1, p2, min, max, edge);
-
-        // Somente o primeiro ponto está fora da janela, então adiciona o ponto de interseção e o ponto final
-        if (!p1_inside && p2_inside)
-        {
-          result.push_back(intersection);
-          result.push_back(p2);
-        }
-        // Somente o segundo ponto está fora da janela, então adiciona o ponto de interseção
-        else if (p1_inside && !p2_inside)
-          result.push_back(intersection);
-      }
-    }
-  }
-  return result;
+  return code;
 }
 
 /**
@@ -650,6 +384,62 @@ void pipeline::DrawLineBuffer(const std::vector<Vec3f> &vertexes, const models::
   }
 }
 
+/**
+ * @brief Desenha uma linha no buffer de 8 bits
+ *
+ * @param vertexes Vetor de vértices que compõem a linha
+ * @param index Índice da cor da linha na paleta
+ * @param z_buffer Buffer de profundidade
+ * @param index_buffer Buffer de índices da paleta
+ */
+void pipeline::DrawLineBuffer(const std::vector<Vec3f> &vertexes, models::Uint8 index, std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<models::Uint8>> &index_buffer)
+{
+  for (size_t i = 0; i < vertexes.size(); i++)
+  {
+    std::vector<Vec3f> line = pipeline::BresenhamLine(vertexes[i], vertexes[(i + 1) % vertexes.size()]);
+
+    for (const Vec3f &vertex : line)
+    {
+      int x = static_cast<int>(vertex.x);
+      int y = static_cast<int>(vertex.y);
+
+      if (x < 0 || x >= static_cast<int>(z_buffer.size()) || y < 0 || y >= static_cast<int>(z_buffer[0].size()))
+        continue;
+
+      if (z_buffer[x][y] > vertex.z)
+        continue;
+
+      z_buffer[x][y] = vertex.z;
+      index_buffer[x][y] = index;
+    }
+  }
+}
+
+/**
+ * @brief Converte o buffer de 8 bits para cores (apresentação)
+ *
+ * @param index_buffer Buffer de índices da paleta
+ * @param palette Paleta
+ * @param min_viewport Canto inferior esquerdo da viewport
+ * @param max_viewport Canto superior direito da viewport
+ * @param color_buffer Buffer de cores (destino)
+ *
+ * @note É a única passada que lê a paleta: durante a rasterização os pixels têm 1 byte
+ */
+void pipeline::ExpandIndexBuffer(const std::vector<std::vector<models::Uint8>> &index_buffer, const models::Palette &palette, const Vec2f &min_viewport, const Vec2f &max_viewport, std::vector<std::vector<models::Color>> &color_buffer)
+{
+  int min_x = std::max(static_cast<int>(min_viewport.x), 0);
+  int min_y = std::max(static_cast<int>(min_viewport.y), 0);
+  int max_x = std::min(static_cast<int>(max_viewport.x), static_cast<int>(index_buffer.size()) - 1);
+
+  for (int x = min_x; x <= max_x; x++)
+  {
+    int max_y = std::min(static_cast<int>(max_viewport.y), static_cast<int>(index_buffer[x].size()) - 1);
+
+    for (int y = min_y; y <= max_y; y++)
+      color_buffer[x][y] = palette.colors[index_buffer[x][y]];
+  }
+}
 /**
  * @brief Desenha um buffer na janela
  *
@@ -681,10 +471,12 @@ void pipeline::DrawBuffer(ImDrawList *draw_list, const std::vector<std::vector<f
 /**
  * @brief Atualiza o buffer de profundidade
  *
- * @param z Profundidade do pixel
+ * @param pixel Pixel da tela, z é a profundidade (1/w)
  * @param color Cor do pixel
  * @param z_buffer Buffer de profundidade
  * @param color_buffer Buffer de cores
+ *
+ * @note O buffer guarda 1/w, que é linear no espaço de tela: quanto maior, mais perto do observador
  */
 void pipeline::z_buffer(const Vec3f pixel, const models::Color &color, std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<models::Color>> &color_buffer)
 {
@@ -698,7 +490,7 @@ void pipeline::z_buffer(const Vec3f pixel, const models::Color &color, std::vect
     return;
 
   // Se o pixel atual estiver mais distante que o pixel já desenhado, não atualiza os buffers
-  if (z_buffer[x_int][y_int] < pixel.z)
+  if (z_buffer[x_int][y_int] > pixel.z)
     return;
 
   // Caso contrário, atualiza o buffer de profundidade e de cor
@@ -709,8 +501,9 @@ void pipeline::z_buffer(const Vec3f pixel, const models::Color &color, std::vect
 /**
  * @brief Preenche um polígono com sombreamento flat
  *
- * @param vertexes Vertices da face do polígono
- * @param color Cor do polígono
+ * @param polygon Vertices do polígono (já recortado)
+ * @param scissor_min Canto inferior esquerdo da viewport (pixels fora dela são descartados)
+ * @param scissor_max Canto superior direito da viewport
  * @param global_light Luz global
  * @param omni_lights Luzes omni
  * @param eye Posição do observador
@@ -719,358 +512,639 @@ void pipeline::z_buffer(const Vec3f pixel, const models::Color &color, std::vect
  * @param object_material Material do objeto
  * @param z_buffer Buffer de profundidade
  * @param color_buffer Buffer de cores
+ * @param raster_stats Contadores de pixels testados e sombreados
  *
  */
-void pipeline::fill_polygon_flat(const std::vector<Vec3f> &vertexes, const models::GlobalLight &global_light, const std::vector<models::Omni> &omni_lights, const Vec3f &eye, const Vec3f &face_centroid, const Vec3f &face_normal, const models::Material &object_material, std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<models::Color>> &color_buffer)
+void pipeline::fill_polygon_flat(const ClipPolygon<FlatVertex> &polygon, const Vec2f &scissor_min, const Vec2f &scissor_max, const models::GlobalLight &global_light, const std::vector<models::Omni> &omni_lights, const Vec3f &eye, const Vec3f &face_centroid, const Vec3f &face_normal, const models::Material &object_material, std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<models::Color>> &color_buffer, RasterStats &raster_stats)
 {
   // Calculamos a cor do objeto
   // Como no nosso pipeline o objeto é homogêneo, não precisamos nos preocupar com variações
   // de materiais de acordo com cada face (Ex.: Objeto metálico com partes de plástico)
-  models::Color color = models::FlatShading(global_light, omni_lights, face_centroid, face_normal, eye, object_material);
+  // A cor só é calculada no primeiro pixel que passa no teste de profundidade, faces totalmente ocultas não são iluminadas
+  models::Color color;
+  bool lit = false;
+
+  // Só a profundidade (1/w) é interpolada
+  pipeline::rasterize_polygon(polygon, scissor_min, scissor_max, z_buffer, color_buffer, raster_stats,
+                              [&](const Vec3f &, const float *)
+                              {
+                                if (!lit)
+                                {
+                                  color = models::FlatShading(global_light, omni_lights, face_centroid, face_normal, eye, object_material);
+                                  lit = true;
+                                }
+                                return color;
+                              });
+}
 
-  // Determina os limites das scanlines
-  int y_min = std::numeric_limits<int>::max();
-  int y_max = std::numeric_limits<int>::min();
+/**
+ * @brief Preenche um polígono com sombreamento de Gourand
+ *
+ * @param polygon Vertices do polígono (já recortado) com a cor de cada vértice (r, g, b)
+ * @param scissor_min Canto inferior esquerdo da viewport (pixels fora dela são descartados)
+ * @param scissor_max Canto superior direito da viewport
+ * @param z_buffer Buffer de profundidade
+ * @param color_buffer Buffer de cores
+ * @param raster_stats Contadores de pixels testados e sombreados
+ *
+ */
+void pipeline::fill_polygon_gourand(const ClipPolygon<GouraudVertex> &polygon, const Vec2f &scissor_min, const Vec2f &scissor_max, std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<models::Color>> &color_buffer, RasterStats &raster_stats)
+{
+  // A cor de cada vértice é interpolada com correção de perspectiva
+  pipeline::rasterize_polygon(polygon, scissor_min, scissor_max, z_buffer, color_buffer, raster_stats,
+                              [](const Vec3f &, const float *rgb)
+                              { return models::ChannelsToColor({Clamp(rgb[0], 0, 255), Clamp(rgb[1], 0, 255), Clamp(rgb[2], 0, 255)}); });
+}
 
-  for (auto vertex : vertexes)
-  {
-    float y = vertex.y;
-    if (y < y_min)
-      y_min = static_cast<int>(y);
-    if (y > y_max)
-      y_max = static_cast<int>(y);
-  }
+// Planos de 1/w e normal/w de um polígono phong na tela (índice 0 é 1/w, 1 a 3 são a normal)
+struct PhongGradients
+{
+  float x, y;
+  float origin[4];
+  float dx[4];
+  float dy[4];
+  bool valid;
+};
 
-  // Determina o tamanho da area que vamos processar
-  std::vector<std::vector<Vec3f>> scanlines(y_max - y_min);
+/**
+ * @brief Calcula os gradientes de tela de 1/w e normal/w de um polígono phong
+ *
+ * @param polygon Polígono em coordenadas de tela
+ * @return PhongGradients Planos (valor no primeiro vértice e derivadas em X e Y)
+ *
+ * @note Mesmo cálculo de texture_gradients, com a normal no lugar das UVs
+ */
+static PhongGradients phong_gradients(const pipeline::ClipPolygon<pipeline::PhongVertex> &polygon)
+{
+  PhongGradients gradients = {};
 
-  for (int i = 0; i < vertexes.size(); i++)
+  const pipeline::PhongVertex &p0 = polygon[0];
+  const pipeline::PhongVertex &p1 = polygon[1];
+  const pipeline::PhongVertex &p2 = polygon[2];
+
+  float x1 = p1.position.x - p0.position.x;
+  float y1 = p1.position.y - p0.position.y;
+  float x2 = p2.position.x - p0.position.x;
+  float y2 = p2.position.y - p0.position.y;
+
+  float det = x1 * y2 - x2 * y1;
+  if (std::fabs(det) < 1e-6f)
+    return gradients;
+
+  float values[3][4];
+  const pipeline::PhongVertex *vertexes[3] = {&p0, &p1, &p2};
+
+  for (int i = 0; i < 3; i++)
   {
-    // Quando chegar no final da lista, vai conectar com o 1º vértice.
-    int k = (i + 1) % vertexes.size();
-    Vec3f start = vertexes[i];
-    Vec3f end = vertexes[k];
+    float inv_w = 1.0f / vertexes[i]->w;
+    values[i][0] = inv_w;
+    for (int k = 0; k < 3; k++)
+      values[i][k + 1] = vertexes[i]->attributes[k] * inv_w;
+  }
 
-    // Scanlines horizontais não são processadas
-    if (start.y == end.y)
-      continue;
+  for (int k = 0; k < 4; k++)
+  {
+    float f1 = values[1][k] - values[0][k];
+    float f2 = values[2][k] - values[0][k];
 
-    // Ordena as scanlines
-    if (start.y > end.y)
-    {
-      std::swap(start, end);
-    }
+    gradients.origin[k] = values[0][k];
+    gradients.dx[k] = (f1 * y2 - f2 * y1) / det;
+    gradients.dy[k] = (f2 * x1 - f1 * x2) / det;
+  }
 
-    // determina as taxes da interpolação
-    // Interpolamos X e Z em relação a Y
-    // A interpolação é incremental (scanline p/ scanline)
-    float m_inv = (end.x - start.x) / (end.y - start.y);
-    float mz = (end.z - start.z) / (end.y - start.y);
+  gradients.x = p0.position.x;
+  gradients.y = p0.position.y;
+  gradients.valid = true;
 
-    float x = start.x;
-    float z = start.z;
+  return gradients;
+}
 
-    for (int y = static_cast<int>(start.y); y < static_cast<int>(end.y); y++)
-    {
+/**
+ * @brief Normal interpolada (com correção de perspectiva) em um ponto da tela
+ *
+ * @param gradients Gradientes do polígono (phong_gradients)
+ * @param x Coordenada X do ponto
+ * @param y Coordenada Y do ponto
+ * @param normal Normal no ponto (não normalizada)
+ * @param inv_w 1/w no ponto
+ * @return true Se o ponto está à frente do observador
+ */
+static bool phong_normal(const PhongGradients &gradients, float x, float y, Vec3f &normal, float &inv_w)
+{
+  float offset_x = x - gradients.x;
+  float offset_y = y - gradients.y;
+
+  inv_w = gradients.origin[0] + gradients.dx[0] * offset_x + gradients.dy[0] * offset_y;
+  if (inv_w <= 0.0f)
+    return false;
+
+  float w = 1.0f / inv_w;
+  normal = {(gradients.origin[1] + gradients.dx[1] * offset_x + gradients.dy[1] * offset_y) * w,
+            (gradients.origin[2] + gradients.dx[2] * offset_x + gradients.dy[2] * offset_y) * w,
+            (gradients.origin[3] + gradients.dx[3] * offset_x + gradients.dy[3] * offset_y) * w};
+  return true;
+}
 
-      scanlines[y - y_min].push_back({x, static_cast<float>(y), z});
+/**
+ * @brief Lado do bloco de iluminação de um polígono phong
+ *
+ * @param polygon Polígono em coordenadas de tela
+ * @param gradients Gradientes do polígono (phong_gradients)
+ * @param shading_rate Granularidade pedida
+ * @return int 1, 2 ou 4 pixels
+ *
+ * @note No modo ADAPTIVE a variação da normal por pixel é medida no centro do polígono, como em
+ *       texture_level: dn/dx = (d(n/w)/dx - n * d(1/w)/dx) * w. O maior bloco em que a normal varia no
+ *       máximo SHADING_RATE_MAX_NORMAL_DELTA entre dois cantos vizinhos é escolhido (faces planas ficam
+ *       sempre em 4x4, silhuetas e malhas pouco tesseladas voltam para 1x1)
+ */
+static int shading_block(const pipeline::ClipPolygon<pipeline::PhongVertex> &polygon, const PhongGradients &gradients, pipeline::ShadingRate shading_rate)
+{
+  if (!gradients.valid)
+    return 1;
 
-      x += m_inv;
-      z += mz;
-    }
+  switch (shading_rate)
+  {
+  case pipeline::ShadingRate::RATE_1X1:
+    return 1;
+  case pipeline::ShadingRate::RATE_2X2:
+    return 2;
+  case pipeline::ShadingRate::RATE_4X4:
+    return 4;
+  case pipeline::ShadingRate::ADAPTIVE:
+    break;
   }
 
-  for (auto scanline : scanlines)
+  float center_x = 0.0f, center_y = 0.0f;
+  for (int i = 0; i < polygon.size(); i++)
   {
-    // Ordenamos as scanlines para que os valores de X fiquem ordenados
-    std::sort(scanline.begin(), scanline.end(), [](Vec3f a, Vec3f b)
-              { return a.x < b.x; });
-
-    // Cada scanline possui pares de 2 elementos
-    // esse algoritmo pressupõe que as malhas são convexas(fechadas)
-    for (int j = 0; j < scanline.size(); j += 2)
-    {
-      int k = (j + 1) % scanline.size();
-      Vec3f start = scanline[j];
-      Vec3f end = scanline[k];
-
-      // Mesmo cenário da interpolação anterior (em relação a Y)
-      // Porém agora a interpolação é em relação a X
-      // E só interpolamos Z
-      float mz = (end.z - start.z) / (end.x - start.x);
-      float z = start.z + (start.x - ceilf(start.x)) * mz;
-
-      // Esse arredondamento é para evitar descontinuidades
-      // durante a interpolação em Y, alguns pixels podem ficar com valor
-      // quebrado Ex.: 100.80 pixels, aí entra esse arrendondamento
-      // desenhamos um pixel a mais no inicio e um pixel a menos no final
-      // Desse modo a face fica continua.
-      for (float x = ceilf(start.x); x <= floorf(end.x); x++)
-      {
-        // nesse caso só interpolamos em Z, pois já sabemos a scanline em X e Y
-        pipeline::z_buffer(Vec3f{x, start.y, z}, color, z_buffer, color_buffer);
-        z += mz;
-      }
-    }
+    center_x += polygon[i].position.x;
+    center_y += polygon[i].position.y;
   }
+  center_x /= polygon.size();
+  center_y /= polygon.size();
+
+  Vec3f normal;
+  float inv_w;
+  if (!phong_normal(gradients, center_x, center_y, normal, inv_w))
+    return 1;
+
+  float length = std::sqrt(Vector3DotProduct(normal, normal));
+  if (length <= 0.0f)
+    return 1;
+
+  float w = 1.0f / inv_w;
+  Vec3f dn_dx = {(gradients.dx[1] - normal.x * gradients.dx[0]) * w,
+                 (gradients.dx[2] - normal.y * gradients.dx[0]) * w,
+                 (gradients.dx[3] - normal.z * gradients.dx[0]) * w};
+  Vec3f dn_dy = {(gradients.dy[1] - normal.x * gradients.dy[0]) * w,
+                 (gradients.dy[2] - normal.y * gradients.dy[0]) * w,
+                 (gradients.dy[3] - normal.z * gradients.dy[0]) * w};
+
+  // Variação da normal unitária por pixel
+  float delta = std::sqrt(std::max(Vector3DotProduct(dn_dx, dn_dx), Vector3DotProduct(dn_dy, dn_dy))) / length;
+
+  if (delta * 4.0f <= pipeline::SHADING_RATE_MAX_NORMAL_DELTA)
+    return 4;
+  if (delta * 2.0f <= pipeline::SHADING_RATE_MAX_NORMAL_DELTA)
+    return 2;
+  return 1;
 }
 
+// Canto da grade de iluminação (stamp diz a qual polígono ele pertence, a cor só é calculada quando um bloco a usa)
+struct ShadingSample
+{
+  std::uint32_t stamp;
+  bool inside;
+  bool shaded;
+  models::Color color;
+};
+
 /**
- * @brief Preenche um polígono com sombreamento de Gourand
+ * @brief Preenche um polígono com sombreamento de Phong
  *
- * @param vertexes Vertices da face do polígono
+ * @param polygon Vertices do polígono (já recortado) com a normal de cada vértice
+ * @param scissor_min Canto inferior esquerdo da viewport (pixels fora dela são descartados)
+ * @param scissor_max Canto superior direito da viewport
+ * @param global_light Luz ambiente global
+ * @param omni_lights Lista de luzes omnidirecionais
+ * @param eye Posição do observador
+ * @param object_material Material do objeto
+ * @param shading_rate Granularidade da iluminação
  * @param z_buffer Buffer de profundidade
  * @param color_buffer Buffer de cores
+ * @param raster_stats Contadores de pixels testados e sombreados
  *
+ * @note Com blocos 2x2 ou 4x4 a iluminação é avaliada só nos cantos de uma grade alinhada à tela e cada
+ *       pixel mistura bilinearmente os quatro cantos do seu bloco. Os cantos são calculados sob demanda, na
+ *       primeira vez que um pixel visível precisa deles, e a rasterização não interpola a normal (só 1/w)
+ * @note Só blocos com os quatro cantos dentro do polígono (ou sobre a borda) são misturados. Um canto fora
+ *       teria a normal extrapolada do plano deste polígono, diferente da que o vizinho calcula no mesmo ponto,
+ *       e os triângulos de um leque mostrariam costuras nas diagonais. Os pixels de blocos que cruzam uma
+ *       aresta são iluminados um a um com a normal do plano no pixel, que nos dois lados de uma aresta comum
+ *       vem das mesmas normais de vértice
  */
-void pipeline::fill_polygon_gourand(const std::vector<std::pair<Vec3f, models::Color>> &_vertexes, std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<models::Color>> &color_buffer)
+void pipeline::fill_polygon_phong(const ClipPolygon<PhongVertex> &polygon, const Vec2f &scissor_min, const Vec2f &scissor_max, const Vec3f &centroid, const models::GlobalLight &global_light, const std::vector<models::Omni> &omni_lights, const Vec3f &eye, const models::Material &object_material, ShadingRate shading_rate, std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<models::Color>> &color_buffer, RasterStats &raster_stats)
 {
-  // Usando para associar cada vértice com sua cor calculada
-  std::vector<std::pair<Vec3f, models::Color>> vertexes = _vertexes;
+  int evaluations = 0;
+
+  PhongGradients gradients = {};
+  if (shading_rate != ShadingRate::RATE_1X1)
+    gradients = phong_gradients(polygon);
+
+  int block = shading_block(polygon, gradients, shading_rate);
+
+  if (block == 1)
+  {
+    // A normal é interpolada com correção de perspectiva e a iluminação é calculada em cada pixel visível
+    pipeline::rasterize_polygon(polygon, scissor_min, scissor_max, z_buffer, color_buffer, raster_stats,
+                                [&](const Vec3f &pixel, const float *normal)
+                                {
+                                  evaluations++;
+                                  return models::PhongShading(global_light, omni_lights, centroid, pixel, Vec3f{normal[0], normal[1], normal[2]}, eye, object_material);
+                                });
+    raster_stats.lit += evaluations;
+    return;
+  }
 
-  int y_min = std::numeric_limits<int>::max();
-  int y_max = std::numeric_limits<int>::min();
+  int shift = block == 4 ? 2 : 1;
 
-  for (auto vertex : vertexes)
+  // Retângulo do polígono dentro da viewport, com a origem alinhada à grade
+  float min_x = scissor_max.x, min_y = scissor_max.y, max_x = scissor_min.x, max_y = scissor_min.y;
+  ClipPolygon<FlatVertex> outline;
+  for (int i = 0; i < polygon.size(); i++)
   {
-    float y = vertex.first.y;
-    if (y < y_min)
-      y_min = static_cast<int>(y);
-    if (y > y_max)
-      y_max = static_cast<int>(y);
+    min_x = std::min(min_x, polygon[i].position.x);
+    min_y = std::min(min_y, polygon[i].position.y);
+    max_x = std::max(max_x, polygon[i].position.x);
+    max_y = std::max(max_y, polygon[i].position.y);
+
+    FlatVertex vertex;
+    vertex.position = polygon[i].position;
+    vertex.w = polygon[i].w;
+    outline.push(vertex);
   }
+  min_x = std::max(min_x, scissor_min.x);
+  min_y = std::max(min_y, scissor_min.y);
+  max_x = std::min(max_x, scissor_max.x);
+  max_y = std::min(max_y, scissor_max.y);
+  if (max_x < min_x || max_y < min_y)
+    return;
 
-  // Vetor de scanlines
-  // 1º parâmetro do par: vetor de coordenadas SRT (coordenadas de tela)
-  // 2º parâmetro do par: cor do pixel
-  std::vector<std::vector<std::pair<Vec3f, models::Color>>> scanlines(y_max - y_min);
+  int origin_x = static_cast<int>(std::floor(min_x)) >> shift << shift;
+  int origin_y = static_cast<int>(std::floor(min_y)) >> shift << shift;
+  int columns = ((static_cast<int>(std::floor(max_x)) - origin_x) >> shift) + 2;
+  int rows = ((static_cast<int>(std::floor(max_y)) - origin_y) >> shift) + 2;
+
+  // Arestas com a orientação do polígono (valor >= 0 do lado de dentro) e a tolerância de cada uma
+  float area = 0.0f;
+  for (int i = 0; i < polygon.size(); i++)
+  {
+    const Vec3f &a = polygon[i].position;
+    const Vec3f &b = polygon[(i + 1) % polygon.size()].position;
+    area += a.x * b.y - b.x * a.y;
+  }
+  float orientation = area < 0.0f ? -1.0f : 1.0f;
 
-  // Como a lista de vertices é composta pelo inicio e fim da aresta, o incremento é de 2
-  for (int i = 0; i < vertexes.size(); i++)
+  struct Edge
+  {
+    float x, y, dx, dy, tolerance;
+  };
+  Edge edges[MAX_CLIP_VERTEXES];
+  for (int i = 0; i < polygon.size(); i++)
   {
-    int k = (i + 1) % vertexes.size();
+    const Vec3f &a = polygon[i].position;
+    const Vec3f &b = polygon[(i + 1) % polygon.size()].position;
+    edges[i] = {a.x, a.y, (b.x - a.x) * orientation, (b.y - a.y) * orientation, 0.0f};
+    // Um milésimo de pixel, para os cantos sobre a aresta contarem como dentro
+    edges[i].tolerance = -1e-3f * std::sqrt(edges[i].dx * edges[i].dx + edges[i].dy * edges[i].dy);
+  }
 
-    Vec3f start = vertexes[i].first;
-    Vec3f end = vertexes[k].first;
+  // Cantos da grade do polígono atual; só a memória é reaproveitada (o stamp invalida os cantos do polígono anterior)
+  static thread_local std::vector<ShadingSample> samples;
+  static thread_local std::uint32_t stamp = 0;
+
+  if (samples.size() < static_cast<std::size_t>(columns * rows))
+    samples.resize(columns * rows);
+  if (++stamp == 0)
+  {
+    for (ShadingSample &sample : samples)
+      sample.stamp = 0;
+    stamp = 1;
+  }
 
-    models::Color start_color = vertexes[i].second;
-    models::Color end_color = vertexes[k].second;
+  // Normal de reserva para cantos atrás do observador (só acontece fora do polígono, perto do plano near)
+  const Vec3f fallback_normal = {polygon[0].attributes[0], polygon[0].attributes[1], polygon[0].attributes[2]};
 
-    // Se a linha for horizontal, não faz nada
-    if (start.y == end.y)
-      continue;
+  auto sample_at = [&](int column, int row) -> ShadingSample &
+  {
+    ShadingSample &sample = samples[row * columns + column];
+    if (sample.stamp != stamp)
+    {
+      float x = static_cast<float>(origin_x + (column << shift));
+      float y = static_cast<float>(origin_y + (row << shift));
+
+      sample.inside = true;
+      for (int i = 0; i < polygon.size() && sample.inside; i++)
+        sample.inside = edges[i].dx * (y - edges[i].y) - edges[i].dy * (x - edges[i].x) >= edges[i].tolerance;
+      sample.shaded = false;
+      sample.stamp = stamp;
+    }
+    return sample;
+  };
 
-    if (start.y > end.y)
+  auto shade = [&](float x, float y, float inv_w) -> models::Color
+  {
+    Vec3f normal;
+    float sample_inv_w;
+    if (!phong_normal(gradients, x, y, normal, sample_inv_w))
     {
-      std::swap(start, end);
-      std::swap(start_color, end_color);
+      normal = fallback_normal;
+      sample_inv_w = inv_w;
     }
 
-    float dy = end.y - start.y;
+    evaluations++;
+    return models::PhongShading(global_light, omni_lights, centroid, Vec3f{x, y, sample_inv_w}, normal, eye, object_material);
+  };
 
-    float m_inv = (end.x - start.x) / dy;
-    float dz = (end.z - start.z) / dy;
+  auto corner = [&](ShadingSample &sample, int column, int row) -> const models::Color &
+  {
+    if (!sample.shaded)
+    {
+      sample.color = shade(static_cast<float>(origin_x + (column << shift)), static_cast<float>(origin_y + (row << shift)), 1.0f / polygon[0].w);
+      sample.shaded = true;
+    }
+    return sample.color;
+  };
+
+  int fraction_mask = block - 1;
+  int weight_shift = 2 * shift;
+
+  // Só 1/w é interpolado, a profundidade continua sendo testada em cada pixel
+  pipeline::rasterize_polygon(outline, scissor_min, scissor_max, z_buffer, color_buffer, raster_stats,
+                              [&](const Vec3f &pixel, const float *)
+                              {
+                                int local_x = static_cast<int>(pixel.x) - origin_x;
+                                int local_y = static_cast<int>(pixel.y) - origin_y;
+                                int column = std::min(local_x >> shift, columns - 2);
+                                int row = std::min(local_y >> shift, rows - 2);
+                                int fx = local_x & fraction_mask;
+                                int fy = local_y & fraction_mask;
+
+                                ShadingSample &s00 = sample_at(column, row);
+                                ShadingSample &s10 = sample_at(column + 1, row);
+                                ShadingSample &s01 = sample_at(column, row + 1);
+                                ShadingSample &s11 = sample_at(column + 1, row + 1);
+
+                                // Bloco cruzando uma aresta: iluminação por pixel
+                                if (!(s00.inside && s10.inside && s01.inside && s11.inside))
+                                  return shade(pixel.x, pixel.y, pixel.z);
+
+                                const models::Color &c00 = corner(s00, column, row);
+                                const models::Color &c10 = corner(s10, column + 1, row);
+                                const models::Color &c01 = corner(s01, column, row + 1);
+                                const models::Color &c11 = corner(s11, column + 1, row + 1);
+
+                                // Pesos bilineares inteiros (somam block * block)
+                                int w00 = (block - fx) * (block - fy);
+                                int w10 = fx * (block - fy);
+                                int w01 = (block - fx) * fy;
+                                int w11 = fx * fy;
+
+                                return models::Color{
+                                    static_cast<models::Uint8>((c00.r * w00 + c10.r * w10 + c01.r * w01 + c11.r * w11) >> weight_shift),
+                                    static_cast<models::Uint8>((c00.g * w00 + c10.g * w10 + c01.g * w01 + c11.g * w11) >> weight_shift),
+                                    static_cast<models::Uint8>((c00.b * w00 + c10.b * w10 + c01.b * w01 + c11.b * w11) >> weight_shift),
+                                    c00.a};
+                              });
+
+  raster_stats.lit += evaluations;
+}
 
-    float dr = (end_color.r - start_color.r) / dy;
-    float dg = (end_color.g - start_color.g) / dy;
-    float db = (end_color.b - start_color.b) / dy;
+/**
+ * @brief Calcula os gradientes de tela de 1/w, u/w e v/w de um polígono
+ *
+ * @param polygon Polígono em coordenadas de tela
+ * @return TextureGradients Planos de 1/w, u/w e v/w (valor no primeiro vértice e derivadas em X e Y)
+ *
+ * @note Essas grandezas são lineares na tela, então três vértices bastam para determinar os planos
+ */
+pipeline::TextureGradients pipeline::texture_gradients(const ClipPolygon<TextureVertex> &polygon)
+{
+  TextureGradients gradients = {};
 
-    float x = start.x;
-    float z = start.z;
+  const TextureVertex &p0 = polygon[0];
+  const TextureVertex &p1 = polygon[1];
+  const TextureVertex &p2 = polygon[2];
 
-    float r = start_color.r;
-    float g = start_color.g;
-    float b = start_color.b;
+  float x1 = p1.position.x - p0.position.x;
+  float y1 = p1.position.y - p0.position.y;
+  float x2 = p2.position.x - p0.position.x;
+  float y2 = p2.position.y - p0.position.y;
 
-    for (int y = static_cast<int>(start.y); y < static_cast<int>(end.y); y++)
-    {
+  float det = x1 * y2 - x2 * y1;
+  if (std::fabs(det) < 1e-6f)
+    return gradients;
 
-      scanlines[y - y_min].push_back(std::make_pair<Vec3f, models::Color>({x, static_cast<float>(y), z}, {models::ChannelsToColor({r, g, b})}));
-      x += m_inv;
-      z += dz;
+  float values[3][3];
+  const TextureVertex *vertexes[3] = {&p0, &p1, &p2};
 
-      r += dr;
-      g += dg;
-      b += db;
-    }
+  for (int i = 0; i < 3; i++)
+  {
+    float inv_w = 1.0f / vertexes[i]->w;
+    values[i][0] = inv_w;
+    values[i][1] = vertexes[i]->attributes[0] * inv_w;
+    values[i][2] = vertexes[i]->attributes[1] * inv_w;
   }
 
-  for (int i = 0; i < scanlines.size(); i++)
+  for (int k = 0; k < 3; k++)
   {
-    std::sort(scanlines[i].begin(), scanlines[i].end(),
-              [](std::pair<Vec3f, models::Color> a, std::pair<Vec3f, models::Color> b)
-              { return a.first.x < b.first.x; });
+    float f1 = values[1][k] - values[0][k];
+    float f2 = values[2][k] - values[0][k];
 
-    for (int j = 0; j < scanlines[i].size(); j = j + 2)
-    {
+    gradients.origin[k] = values[0][k];
+    gradients.dx[k] = (f1 * y2 - f2 * y1) / det;
+    gradients.dy[k] = (f2 * x1 - f1 * x2) / det;
+  }
 
-      Vec3f start = scanlines[i][j].first;
-      Vec3f end = scanlines[i][j + 1].first;
+  gradients.x = p0.position.x;
+  gradients.y = p0.position.y;
+  gradients.valid = true;
 
-      models::Color start_color = scanlines[i][j].second;
-      models::Color end_color = scanlines[i][j + 1].second;
+  return gradients;
+}
 
-      float dx = end.x - start.x;
+/**
+ * @brief Escolhe o nível de mipmap em um ponto da tela
+ *
+ * @param gradients Gradientes do polígono (texture_gradients)
+ * @param tex Textura
+ * @param x Coordenada X do pixel
+ * @param y Coordenada Y do pixel
+ * @return int Nível de mipmap
+ *
+ * @note Com f = u/w e g = 1/w, du/dx = (df/dx - u * dg/dx) / g (o mesmo vale para v e para Y)
+ * @note O nível usa a maior variação entre as direções X e Y (em texels do nível 0)
+ */
+int pipeline::texture_level(const TextureGradients &gradients, const models::Texture &tex, float x, float y)
+{
+  if (!gradients.valid || tex.levelCount() <= 1)
+    return 0;
 
-      float dz = (end.z - start.z) / dx;
-      float z = start.z + (start.x - ceilf(start.x)) * dz;
+  float offset_x = x - gradients.x;
+  float offset_y = y - gradients.y;
 
-      float dr = (end_color.r - start_color.r) / dx;
-      float dg = (end_color.g - start_color.g) / dx;
-      float db = (end_color.b - start_color.b) / dx;
+  float inv_w = gradients.origin[0] + gradients.dx[0] * offset_x + gradients.dy[0] * offset_y;
+  if (inv_w <= 0.0f)
+    return 0;
 
-      float r = start_color.r + (start.x - ceilf(start.x)) * dr;
-      float g = start_color.g + (start.x - ceilf(start.x)) * dg;
-      float b = start_color.b + (start.x - ceilf(start.x)) * db;
+  float w = 1.0f / inv_w;
+  float u = (gradients.origin[1] + gradients.dx[1] * offset_x + gradients.dy[1] * offset_y) * w;
+  float v = (gradients.origin[2] + gradients.dx[2] * offset_x + gradients.dy[2] * offset_y) * w;
 
-      for (float x = ceilf(start.x); x <= floorf(end.x); x++)
-      {
-        models::Color current_color = models::ChannelsToColor({r, g, b});
+  float du_dx = (gradients.dx[1] - u * gradients.dx[0]) * w * tex.width;
+  float dv_dx = (gradients.dx[2] - v * gradients.dx[0]) * w * tex.height;
+  float du_dy = (gradients.dy[1] - u * gradients.dy[0]) * w * tex.width;
+  float dv_dy = (gradients.dy[2] - v * gradients.dy[0]) * w * tex.height;
 
-        pipeline::z_buffer(Vec3f{x, start.y, z}, current_color, z_buffer, color_buffer);
-        z += dz;
-        r += dr;
-        g += dg;
-        b += db;
-      }
-    }
-  }
+  float rho = std::sqrt(std::max(du_dx * du_dx + dv_dx * dv_dx, du_dy * du_dy + dv_dy * dv_dy));
+
+  return tex.selectLevel(rho);
 }
 
+// O filler de textura recebe do rasterizador as UVs no mesmo ponto fixo usado pela textura
+static_assert(pipeline::RASTER_FIXED_BITS == models::TEXTURE_FRACTION_BITS, "A textura e o rasterizador devem usar o mesmo ponto fixo");
+
 /**
- * @brief Preenche um polígono com sombreamento de Phong
+ * @brief Rasteriza um polígono texturizado (comum aos fillers RGBA e de 8 bits)
  *
- * @param _vertexes Lista de vertices e normais dos vertices
- * @param global_light Luz ambiente global
- * @param omni_lights Lista de luzes omnidirecionais
- * @param eye Posição do observador
- * @param object_material Material do objeto
+ * @param polygon Vertices do polígono (já recortado) com a coordenada UV de cada canto
+ * @param scissor_min Canto inferior esquerdo da viewport
+ * @param scissor_max Canto superior direito da viewport
+ * @param tex Textura do objeto
+ * @param source Primeiro texel do nível 0 (tex.texels ou tex.indices)
+ * @param mip_selection Como o nível de mipmap é escolhido
  * @param z_buffer Buffer de profundidade
- * @param color_buffer Buffer de cores
+ * @param pixel_buffer Buffer de saída (cores ou índices)
+ * @param raster_stats Contadores de pixels testados e sombreados
+ * @param output Converte o texel lido no pixel gravado
  */
-void pipeline::fill_polygon_phong(const std::vector<std::pair<Vec3f, Vec3f>> &_vertexes, const Vec3f &centroid, const models::GlobalLight &global_light, const std::vector<models::Omni> &omni_lights, const Vec3f &eye, const models::Material &object_material, std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<models::Color>> &color_buffer)
+template <typename Texel, typename Pixel, typename Output>
+static void fill_textured(const pipeline::ClipPolygon<pipeline::TextureVertex> &polygon, const Vec2f &scissor_min, const Vec2f &scissor_max, const models::Texture &tex,
+                          const Texel *source, pipeline::MipSelection mip_selection,
+                          std::vector<std::vector<float>> &z_buffer,
+                          std::vector<std::vector<Pixel>> &pixel_buffer,
+                          pipeline::RasterStats &raster_stats, Output output)
 {
-  int y_min = std::numeric_limits<int>::max();
-  int y_max = std::numeric_limits<int>::min();
+  pipeline::TextureGradients gradients = pipeline::texture_gradients(polygon);
 
-  for (auto vertex : _vertexes)
-  {
-    float y = vertex.first.y;
-    if (y < y_min)
-      y_min = static_cast<int>(y);
-    if (y > y_max)
-      y_max = static_cast<int>(y);
-  }
+  int level_index = 0;
 
-  // Vetor de scanlines
-  // 1º parâmetro do par: vetor de coordenadas SRT (coordenadas de tela)
-  // 2º parâmetro do par: vetor normal do pixel (interpolado)
-  std::vector<std::vector<std::tuple<Vec3f, Vec3f>>> scanlines(y_max - y_min);
+  // Sem seleção de mipmap o nível 0 é sempre amostrado (o streaming deve manter a resolução máxima)
+  if (mip_selection == pipeline::MipSelection::NONE)
+    tex.sampled_texels_per_pixel = 0.0f;
 
-  for (int l = 0; l < _vertexes.size(); l++)
+  if (mip_selection == pipeline::MipSelection::PER_POLYGON)
   {
-    int m = (l + 1) % _vertexes.size();
-    Vec3f start = _vertexes[l].first;
-    Vec3f end = _vertexes[m].first;
-
-    Vec3f start_normal = _vertexes[l].second;
-    Vec3f end_normal = _vertexes[m].second;
-
-    // Se a linha for horizontal, não faz nada
-    if (start.y == end.y)
-      continue;
-
-    if (start.y > end.y)
+    // Centro do polígono na tela
+    float x = 0.0f, y = 0.0f;
+    for (int i = 0; i < polygon.count; i++)
     {
-      std::swap(start, end);
-      std::swap(start_normal, end_normal);
+      x += polygon[i].position.x;
+      y += polygon[i].position.y;
     }
+    x /= polygon.count;
+    y /= polygon.count;
 
-    float dy = end.y - start.y;
-    float dx = end.x - start.x;
-    float dz = end.z - start.z;
-    // i,j,k se referem ao vetor normal do pixel (x, y, z)
-    float dn_i = end_normal.x - start_normal.x;
-    float dn_j = end_normal.y - start_normal.y;
-    float dn_k = end_normal.z - start_normal.z;
-
-    // taxa de variação do x em relação ao y
-    float t_x = dx / dy;
-    // taxa de variação do z em relação ao y
-    float t_z = dz / dy;
-    // taxa de variação do i em relação ao y
-    float t_i = dn_i / dy;
-    // taxa de variação do j em relação ao y
-    float t_j = dn_j / dy;
-    // taxa de variação do k em relação ao y
-    float t_k = dn_k / dy;
-
-    float x = start.x;
-    float z = start.z;
-
-    float i = start_normal.x;
-    float j = start_normal.y;
-    float k = start_normal.z;
-
-    for (int y = static_cast<int>(start.y); y < static_cast<int>(end.y); y++)
-    {
-      scanlines[y - y_min].push_back(std::make_tuple<Vec3f, Vec3f>({x, static_cast<float>(y), z}, {i, j, k}));
-      // incrementa com as taxas de variação (interpolação linear)
-      x += t_x;
-      z += t_z;
-      i += t_i;
-      j += t_j;
-      k += t_k;
-    }
+    level_index = pipeline::texture_level(gradients, tex, x, y);
   }
 
-  for (int row = 0; row < scanlines.size(); row++)
-  {
-    std::sort(scanlines[row].begin(), scanlines[row].end(),
-              [](std::tuple<Vec3f, Vec3f> a, std::tuple<Vec3f, Vec3f> b)
-              { return std::get<0>(a).x < std::get<0>(b).x; });
+  // Estado do nível atual (trocado por scanline no modo PER_SPAN)
+  const Texel *texels = nullptr;
+  const int *swizzle_u = nullptr;
+  const int *swizzle_v = nullptr;
+  int shift = 0, u_mask = 0, v_mask = 0, width_log2 = 0;
+  const models::BC1Block *blocks = nullptr;
+  int blocks_per_row = 0;
 
-    for (int col = 0; col < scanlines[row].size(); col += 2)
+  auto use_level = [&](int index)
+  {
+    const models::TextureLevel &level = tex.levels[index];
+    texels = source + level.offset;
+    blocks = tex.blocks.data() + level.block_offset;
+    blocks_per_row = level.blocks_per_row;
+    shift = models::TEXTURE_FRACTION_BITS + index;
+    u_mask = level.u_mask;
+    v_mask = level.v_mask;
+    width_log2 = level.width_log2;
+
+    if (tex.layout != models::TextureLayout::ROW_MAJOR)
     {
-      Vec3f start = std::get<0>(scanlines[row][col]);
-      Vec3f end = std::get<0>(scanlines[row][col + 1]);
-
-      Vec3f start_normal = std::get<1>(scanlines[row][col]);
-      Vec3f end_normal = std::get<1>(scanlines[row][col + 1]);
+      swizzle_u = tex.swizzle.data() + level.swizzle_offset;
+      swizzle_v = swizzle_u + level.width;
+    }
+  };
 
-      float dx = end.x - start.x;
-      float dz = (end.z - start.z) / dx;
-      float z = start.z + (start.x - ceilf(start.x)) * dz;
+  use_level(level_index);
+  float last_y = -1.0f;
 
-      float dn_i = (end_normal.x - start_normal.x) / dx;
-      float dn_j = (end_normal.y - start_normal.y) / dx;
-      float dn_k = (end_normal.z - start_normal.z) / dx;
+  // UVs em texels do nível 0, assim o rasterizador entrega u e v prontos em ponto fixo
+  pipeline::ClipPolygon<pipeline::TextureVertex> scaled = polygon;
+  for (int i = 0; i < scaled.count; i++)
+  {
+    scaled.vertexes[i].attributes[0] *= static_cast<float>(tex.width);
+    scaled.vertexes[i].attributes[1] *= static_cast<float>(tex.height);
+  }
 
-      float i = start_normal.x;
-      float j = start_normal.y;
-      float k = start_normal.z;
+  // A leitura do texel é escolhida uma vez por polígono, o laço interno não testa o layout nem a compressão
+  auto rasterize = [&](auto texel)
+  {
+    // A UV é interpolada com correção de perspectiva (sem divisão por pixel, veja rasterize_polygon)
+    pipeline::rasterize_polygon(scaled, scissor_min, scissor_max, z_buffer, pixel_buffer, raster_stats,
+                                [&](const Vec3f &pixel, const int *uv)
+                                {
+                                  // Nível escolhido no primeiro pixel de cada scanline
+                                  if (mip_selection == pipeline::MipSelection::PER_SPAN && pixel.y != last_y)
+                                  {
+                                    last_y = pixel.y;
+                                    use_level(pipeline::texture_level(gradients, tex, pixel.x, pixel.y));
+                                  }
+
+                                  // Repetição por máscara
+                                  return output(texel((uv[0] >> shift) & u_mask, (uv[1] >> shift) & v_mask));
+                                });
+  };
+
+  if constexpr (std::is_same_v<Texel, models::Color>)
+  {
+    // Textura comprimida: cada bloco 4x4 é descomprimido uma vez e reaproveitado pelos pixels vizinhos
+    if (tex.compression != models::TextureCompression::NONE)
+    {
+      static thread_local models::DecodedBlockCache block_cache;
+      block_cache.clear();
 
-      for (float x = ceilf(start.x); x <= floorf(end.x); x++)
-      {
-        Vec3f v = {x, start.y, z};
-        Vec3f n = {i, j, k};
-
-        models::Color color = models::PhongShading(global_light, omni_lights, centroid, v, n, eye, object_material);
-        pipeline::z_buffer(Vec3f{x, start.y, z}, color, z_buffer, color_buffer);
-        z += dz;
-        i += dn_i;
-        j += dn_j;
-        k += dn_k;
-      }
+      rasterize([&](int x, int y) -> const models::Color &
+                { return block_cache.fetch(blocks, blocks_per_row, x, y); });
+      return;
     }
   }
+
+  if (tex.layout == models::TextureLayout::ROW_MAJOR)
+    rasterize([&](int x, int y)
+              { return texels[(y << width_log2) | x]; });
+  else
+    rasterize([&](int x, int y)
+              { return texels[swizzle_u[x] + swizzle_v[y]]; });
 }
 
 /**
  * @brief Preenche um polígono com sombreamento baseado em textura (UV)
  *
- * @param vertexes Vertices da face do polígono
+ * @param polygon Vertices do polígono (já recortado) com a coordenada UV de cada canto
+ * @param scissor_min Canto inferior esquerdo da viewport (pixels fora dela são descartados)
+ * @param scissor_max Canto superior direito da viewport
  * @param tex Textura do objeto
+ * @param mip_selection Como o nível de mipmap é escolhido
  * @param global_light Luz global (mantido caso queira aplicar iluminação multiplicativa)
  * @param omni_lights Luzes omni
  * @param eye Posição do observador
@@ -1079,118 +1153,81 @@ void pipeline::fill_polygon_phong(const std::vector<std::pair<Vec3f, Vec3f>> &_v
  * @param object_material Material do objeto
  * @param z_buffer Buffer de profundidade
  * @param color_buffer Buffer de cores
+ * @param raster_stats Contadores de pixels testados e sombreados
+ *
+ * @note As UVs vêm dos atributos por canto da malha, então cada face tem o seu próprio mapeamento
+ * @note O nível de mipmap é escolhido pelas derivadas da UV na tela, uma vez por polígono (no centro)
+ *       ou uma vez por scanline (no primeiro pixel visível), de acordo com mip_selection
+ * @note As UVs avançam em ponto fixo 16.16 (texels do nível 0) e a repetição é feita com máscaras,
+ *       o laço interno não tem conversões de float nem clamps
+ * @note Nos layouts em blocos (TextureLayout) o endereço é a soma de duas tabelas (coluna e linha)
+ * @note Texturas comprimidas (BC1) são lidas por um cache de blocos descomprimidos (DecodedBlockCache)
  */
-void pipeline::fill_polygon_texture(const std::vector<Vertex *> &vertexes, const models::Texture &tex,
+void pipeline::fill_polygon_texture(const ClipPolygon<TextureVertex> &polygon, const Vec2f &scissor_min, const Vec2f &scissor_max, const models::Texture &tex,
+                                    MipSelection mip_selection,
                                     const models::GlobalLight &global_light,
                                     const std::vector<models::Omni> &omni_lights,
                                     const Vec3f &eye, const Vec3f &face_centroid, const Vec3f &face_normal,
                                     const models::Material &object_material,
                                     std::vector<std::vector<float>> &z_buffer,
-                                    std::vector<std::vector<models::Color>> &color_buffer)
+                                    std::vector<std::vector<models::Color>> &color_buffer,
+                                    RasterStats &raster_stats)
 {
-  // Determina os limites da scanline
-  int y_min = std::numeric_limits<int>::max();
-  int y_max = std::numeric_limits<int>::min();
-
-  for (auto v : vertexes)
-  {
-    float y = v->vertex_screen.y;
-    if (y < y_min)
-      y_min = static_cast<int>(y);
-    if (y > y_max)
-      y_max = static_cast<int>(y);
-  }
-
-  std::vector<std::vector<Vertex *>> scanlines(y_max - y_min);
-
-  // Construção das scanlines
-  for (int i = 0; i < vertexes.size(); i++)
-  {
-    int k = (i + 1) % vertexes.size();
-    Vertex *start = vertexes[i];
-    Vertex *end = vertexes[k];
-
-    if (start->vertex_screen.y == end->vertex_screen.y)
-      continue;
-
-    Vertex *v1 = start;
-    Vertex *v2 = end;
-    if (v1->vertex_screen.y > v2->vertex_screen.y)
-      std::swap(v1, v2);
-
-    float dy = v2->vertex_screen.y - v1->vertex_screen.y;
-    float dx = (v2->vertex_screen.x - v1->vertex_screen.x) / dy;
-    float dz = (v2->vertex_screen.z - v1->vertex_screen.z) / dy;
-    float du = (v2->u - v1->u) / dy;
-    float dv = (v2->v - v1->v) / dy;
-
-    float x = v1->vertex_screen.x;
-    float z = v1->vertex_screen.z;
-    float u = v1->u;
-    float v = v1->v;
-
-    for (int y = static_cast<int>(v1->vertex_screen.y); y < static_cast<int>(v2->vertex_screen.y); y++)
-    {
-      Vertex *interp = new Vertex();
-      interp->vertex_screen = {x, static_cast<float>(y), z};
-      interp->u = u;
-      interp->v = v;
-
-      scanlines[y - y_min].push_back(interp);
-
-      x += dx;
-      z += dz;
-      u += du;
-      v += dv;
-    }
-  }
-
-  // Preenchimento das scanlines
-  for (auto scanline : scanlines)
-  {
-    std::sort(scanline.begin(), scanline.end(), [](Vertex *a, Vertex *b)
-              { return a->vertex_screen.x < b->vertex_screen.x; });
-
-    for (int j = 0; j < scanline.size(); j += 2)
-    {
-      int k = (j + 1) % scanline.size();
-      Vertex *start = scanline[j];
-      Vertex *end = scanline[k];
-
-      float dx = (end->vertex_screen.x - start->vertex_screen.x);
-      if (dx == 0)
-        dx = 1.0f; // evita divisão por zero
-
-      float dz = (end->vertex_screen.z - start->vertex_screen.z) / dx;
-      float du = (end->u - start->u) / dx;
-      float dv = (end->v - start->v) / dx;
-
-      float z = start->vertex_screen.z;
-      float u = start->u;
-      float v = start->v;
-
-      for (float x = ceilf(start->vertex_screen.x); x <= floorf(end->vertex_screen.x); x++)
-      {
-        // Calcula os índices na textura
-        int tex_u = std::min(std::max(int(u * (tex.width - 1)), 0), tex.width - 1);
-        int tex_v = std::min(std::max(int(v * (tex.height - 1)), 0), tex.height - 1);
+  if (tex.width == 0 || tex.height == 0)
+    return;
 
-        models::Color color = tex.pixels[tex_v][tex_u];
+  fill_textured(polygon, scissor_min, scissor_max, tex, tex.texels.data(), mip_selection, z_buffer, color_buffer, raster_stats,
+                [](const models::Color &texel)
+                { return texel; });
+}
 
-        // Aplica z-buffer
-        pipeline::z_buffer(Vec3f{x, start->vertex_screen.y, z}, color, z_buffer, color_buffer);
+/**
+ * @brief Preenche um polígono texturizado no framebuffer de 8 bits
+ *
+ * @param polygon Vertices do polígono (já recortado) com a coordenada UV de cada canto
+ * @param scissor_min Canto inferior esquerdo da viewport
+ * @param scissor_max Canto superior direito da viewport
+ * @param tex Textura do objeto (já quantizada, veja Texture::quantize)
+ * @param mip_selection Como o nível de mipmap é escolhido
+ * @param colormap_row Linha do colormap com o nível de luz da face
+ * @param z_buffer Buffer de profundidade
+ * @param index_buffer Buffer de índices da paleta
+ * @param raster_stats Contadores de pixels testados e sombreados
+ *
+ * @note A iluminação de cada texel é uma leitura do colormap (colormap_row[índice]), sem aritmética de cor
+ */
+void pipeline::fill_polygon_texture_indexed(const ClipPolygon<TextureVertex> &polygon, const Vec2f &scissor_min, const Vec2f &scissor_max, const models::Texture &tex,
+                                            MipSelection mip_selection,
+                                            const models::Uint8 *colormap_row,
+                                            std::vector<std::vector<float>> &z_buffer,
+                                            std::vector<std::vector<models::Uint8>> &index_buffer,
+                                            RasterStats &raster_stats)
+{
+  if (tex.width == 0 || tex.height == 0 || tex.indices.size() != tex.texels.size())
+    return;
 
-        z += dz;
-        u += du;
-        v += dv;
-      }
-    }
-  }
+  fill_textured(polygon, scissor_min, scissor_max, tex, tex.indices.data(), mip_selection, z_buffer, index_buffer, raster_stats,
+                [colormap_row](models::Uint8 index)
+                { return colormap_row[index]; });
+}
 
-  // Limpar vértices interpolados criados
-  for (auto &line : scanlines)
-  {
-    for (auto v : line)
-      delete v;
-  }
+/**
+ * @brief Preenche um polígono no visibility buffer (apenas profundidade e id do triângulo)
+ *
+ * @param polygon Vertices do polígono (já recortado)
+ * @param scissor_min Canto inferior esquerdo da viewport
+ * @param scissor_max Canto superior direito da viewport
+ * @param id Id (objeto, triângulo) do polígono, veja visibility_id
+ * @param z_buffer Buffer de profundidade
+ * @param id_buffer Buffer de ids
+ * @param raster_stats Contadores de pixels testados e gravados
+ *
+ * @note Nenhuma iluminação é feita aqui, os pixels visíveis são sombreados depois por resolve_visibility
+ */
+void pipeline::fill_polygon_visibility(const ClipPolygon<FlatVertex> &polygon, const Vec2f &scissor_min, const Vec2f &scissor_max, std::uint32_t id,
+                                       std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<std::uint32_t>> &id_buffer, RasterStats &raster_stats)
+{
+  pipeline::rasterize_polygon(polygon, scissor_min, scissor_max, z_buffer, id_buffer, raster_stats,
+                              [id](const Vec3f &, const float *)
+                              { return id; });
 }
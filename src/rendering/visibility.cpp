@@ -0,0 +1,171 @@
+#include <rendering/visibility.hpp>
+#include <math/math.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+namespace pipeline
+{
+  /**
+   * @brief Inversa da matriz formada pelos cantos homogêneos de um triângulo
+   *
+   * @param triangle Triângulo (cantos em coordenadas homogêneas de tela)
+   * @return VisibilityPlanes Linhas da inversa (valid é falso em triângulos degenerados)
+   *
+   * @note Os cantos homogêneos são as colunas de uma matriz 3x3 cuja inversa leva (x, y, 1) para os pesos
+   *       de cada canto divididos por w (rasterização homogênea 2D, Olano e Greer). Cada linha da inversa é
+   *       o produto vetorial dos outros dois cantos dividido pelo determinante
+   */
+  VisibilityPlanes visibility_planes(const VisibilityTriangle &triangle)
+  {
+    const Vec3f &p0 = triangle.position[0];
+    const Vec3f &p1 = triangle.position[1];
+    const Vec3f &p2 = triangle.position[2];
+
+    VisibilityPlanes planes;
+    planes.rows[0] = Vector3CrossProduct(p1, p2);
+    planes.rows[1] = Vector3CrossProduct(p2, p0);
+    planes.rows[2] = Vector3CrossProduct(p0, p1);
+
+    float det = Vector3DotProduct(p0, planes.rows[0]);
+    planes.valid = det != 0.0f;
+    if (planes.valid)
+      for (Vec3f &row : planes.rows)
+        row = row * (1.0f / det);
+
+    return planes;
+  }
+
+  /**
+   * @brief Baricêntricas de um pixel dentro de um triângulo gravado
+   *
+   * @param planes Inversa da matriz do triângulo (visibility_planes)
+   * @param x Coordenada x do pixel
+   * @param y Coordenada y do pixel
+   * @param weights Pesos dos três cantos (somam 1, já com correção de perspectiva)
+   * @param inv_w 1/w do pixel
+   * @return true Se o pixel está à frente do observador em um triângulo válido
+   *
+   * @note Normalizando os pesos pela soma obtemos as baricêntricas do ponto na superfície,
+   *       e a soma é o próprio 1/w
+   */
+  bool visibility_barycentrics(const VisibilityPlanes &planes, float x, float y, Vec3f &weights, float &inv_w)
+  {
+    if (!planes.valid)
+      return false;
+
+    Vec3f pixel = {x, y, 1.0f};
+    float u0 = Vector3DotProduct(planes.rows[0], pixel);
+    float u1 = Vector3DotProduct(planes.rows[1], pixel);
+    float u2 = Vector3DotProduct(planes.rows[2], pixel);
+
+    inv_w = u0 + u1 + u2;
+    if (inv_w <= 0.0f)
+      return false;
+
+    weights = {u0 / inv_w, u1 / inv_w, u2 / inv_w};
+    return true;
+  }
+
+  /**
+   * @brief Resolve o visibility buffer: sombreia (phong) cada pixel coberto uma única vez
+   *
+   * @param id_buffer Ids (objeto, triângulo) de cada pixel
+   * @param objects Objetos gravados no quadro (indexados pelo objeto do id)
+   * @param scissor_min Canto inferior esquerdo da viewport
+   * @param scissor_max Canto superior direito da viewport
+   * @param global_light Luz ambiente global
+   * @param omni_lights Luzes omni
+   * @param eye Posição do observador
+   * @param color_buffer Buffer de cores
+   * @param stats Contadores (pixels resolvidos)
+   *
+   * @note A viewport é dividida em blocos de VISIBILITY_TILE_SIZE pixels, distribuídos entre as threads
+   *       por um contador atômico; dentro do bloco os pixels são percorridos em ordem de tela
+   * @note A inversa da matriz do triângulo só é refeita quando o id muda (pixels vizinhos quase sempre
+   *       vêm do mesmo triângulo), por pixel sobram três produtos escalares
+   */
+  void resolve_visibility(const std::vector<std::vector<std::uint32_t>> &id_buffer, const std::vector<VisibilityObject> &objects,
+                          const Vec2f &scissor_min, const Vec2f &scissor_max,
+                          const models::GlobalLight &global_light, const std::vector<models::Omni> &omni_lights, const Vec3f &eye,
+                          std::vector<std::vector<models::Color>> &color_buffer, RasterStats &stats)
+  {
+    int x_min = std::max(static_cast<int>(scissor_min.x), 0);
+    int y_min = std::max(static_cast<int>(scissor_min.y), 0);
+    int x_max = std::min(static_cast<int>(scissor_max.x), static_cast<int>(id_buffer.size()) - 1);
+    int y_max = id_buffer.empty() ? -1 : std::min(static_cast<int>(scissor_max.y), static_cast<int>(id_buffer[0].size()) - 1);
+
+    if (x_max < x_min || y_max < y_min)
+      return;
+
+    int tiles_x = (x_max - x_min) / VISIBILITY_TILE_SIZE + 1;
+    int tiles_y = (y_max - y_min) / VISIBILITY_TILE_SIZE + 1;
+    int tiles = tiles_x * tiles_y;
+
+    std::atomic<int> next{0};
+    std::atomic<int> resolved{0};
+
+    auto resolve = [&]()
+    {
+      int count = 0;
+
+      // Triângulo do último pixel resolvido
+      std::uint32_t last_id = VISIBILITY_EMPTY;
+      const VisibilityObject *object = nullptr;
+      const VisibilityTriangle *triangle = nullptr;
+      VisibilityPlanes planes = {};
+
+      for (int tile = next++; tile < tiles; tile = next++)
+      {
+        int x_begin = x_min + (tile % tiles_x) * VISIBILITY_TILE_SIZE;
+        int y_begin = y_min + (tile / tiles_x) * VISIBILITY_TILE_SIZE;
+        int x_end = std::min(x_begin + VISIBILITY_TILE_SIZE - 1, x_max);
+        int y_end = std::min(y_begin + VISIBILITY_TILE_SIZE - 1, y_max);
+
+        for (int y = y_begin; y <= y_end; y++)
+        {
+          for (int x = x_begin; x <= x_end; x++)
+          {
+            std::uint32_t id = id_buffer[x][y];
+            if (id == VISIBILITY_EMPTY)
+              continue;
+
+            if (id != last_id)
+            {
+              last_id = id;
+              object = &objects[visibility_object(id)];
+              triangle = &object->triangles[visibility_triangle(id)];
+              planes = visibility_planes(*triangle);
+            }
+
+            Vec3f weights;
+            float inv_w;
+            float sample_x = static_cast<float>(x), sample_y = static_cast<float>(y);
+            if (!visibility_barycentrics(planes, sample_x, sample_y, weights, inv_w))
+              continue;
+
+            Vec3f normal = triangle->normal[0] * weights.x + triangle->normal[1] * weights.y + triangle->normal[2] * weights.z;
+
+            color_buffer[x][y] = models::PhongShading(global_light, omni_lights, object->centroid, Vec3f{sample_x, sample_y, inv_w}, normal, eye, *object->material);
+            count++;
+          }
+        }
+      }
+
+      resolved += count;
+    };
+
+    unsigned int workers = std::min(std::clamp(std::thread::hardware_concurrency(), 1u, 16u), static_cast<unsigned int>(tiles));
+
+    std::vector<std::thread> helpers;
+    for (unsigned int w = 1; w < workers; w++)
+      helpers.emplace_back(resolve);
+    resolve();
+    for (std::thread &helper : helpers)
+      helper.join();
+
+    stats.resolved += resolved;
+  }
+}
@@ -1,5 +1,9 @@
 #include <scene/scene.hpp>
 
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+
 /**
  * @brief Construtor padrão da classe Scene
  *
@@ -15,7 +19,8 @@
 Scene::Scene()
 {
   player = new Player();
-  objects = std::vector<Mesh *>();
+  objects = std::vector<MeshInstance *>();
+  assets = std::vector<MeshAsset *>();
   min_viewport = {0.0f, 0.0f};
   max_viewport = {640.f, 480.0f};
   min_window = {-3.0f, -3.0f};
@@ -35,7 +40,7 @@ Scene::Scene()
 /**
  * @brief Destrutor da classe Scene
  *
- * @note Este destrutor libera a memória alocada para a câmera e para os objetos
+ * @note Este destrutor libera a memória alocada para a câmera, para as instâncias e para as malhas
  */
 Scene::~Scene()
 {
@@ -44,6 +49,10 @@ Scene::~Scene()
   {
     delete object;
   }
+  for (auto asset : this->assets)
+  {
+    delete asset;
+  }
 }
 
 void Scene::initialize_buffers()
@@ -56,27 +65,136 @@ void Scene::initialize_buffers()
   this->color_buffer.clear();
 
   // Redimensiona e inicializa os buffers
-  this->z_buffer = std::vector<std::vector<float>>(width, std::vector<float>(height, std::numeric_limits<float>::infinity()));
+  // O buffer de profundidade guarda 1/w, então 0 é o infinito
+  this->z_buffer = std::vector<std::vector<float>>(width, std::vector<float>(height, 0.0f));
   this->color_buffer = std::vector<std::vector<models::Color>>(width, std::vector<models::Color>(height, models::TRANSPARENT));
+
+  // No modo de 8 bits a rasterização escreve apenas índices, as cores são geradas na apresentação
+  if (indexed())
+    this->index_buffer = std::vector<std::vector<models::Uint8>>(width, std::vector<models::Uint8>(height, models::PALETTE_EMPTY));
+  else
+    this->index_buffer.clear();
+
+  // No visibility buffer a rasterização escreve apenas ids, as cores são geradas na resolução
+  if (illumination_mode == IlluminationMode::VISIBILITY)
+    this->id_buffer = std::vector<std::vector<std::uint32_t>>(width, std::vector<std::uint32_t>(height, pipeline::VISIBILITY_EMPTY));
+  else
+    this->id_buffer.clear();
+}
+
+bool Scene::indexed() const
+{
+  return palettized && illumination_mode == IlluminationMode::TEXTURED;
+}
+
+/**
+ * @brief Objeto e triângulo visíveis em um pixel do último quadro
+ *
+ * @param x Coordenada x do pixel (mesmas coordenadas dos buffers)
+ * @param y Coordenada y do pixel
+ * @param object Índice da instância em objects
+ * @param triangle Triângulo da malha (na ordem do leque das faces)
+ * @return true Se existe geometria no pixel
+ *
+ * @note Lê o id gravado no visibility buffer, então só funciona no modo VISIBILITY e é exato por pixel
+ */
+bool Scene::pick(int x, int y, int &object, int &triangle) const
+{
+  if (x < 0 || y < 0 || x >= static_cast<int>(id_buffer.size()) || y >= static_cast<int>(id_buffer[x].size()))
+    return false;
+
+  std::uint32_t id = id_buffer[x][y];
+  if (id == pipeline::VISIBILITY_EMPTY)
+    return false;
+
+  object = pipeline::visibility_object(id);
+  triangle = pipeline::visibility_triangle(id);
+  return true;
+}
+
+/**
+ * @brief Gera a paleta da cena, o colormap e as versões de 8 bits das texturas
+ *
+ * @note A paleta é feita por median cut sobre todas as texturas das malhas, então ela é refeita
+ *       apenas quando uma malha nova é registrada ou quando uma textura em streaming deixa de ser o
+ *       texel cinza (palette_dirty); os níveis mais finos que chegam depois usam a paleta atual
+ */
+void Scene::build_palette()
+{
+  std::vector<models::Texture *> scene_textures;
+  for (auto asset : assets)
+  {
+    if (asset->texture && std::find(scene_textures.begin(), scene_textures.end(), asset->texture.get()) == scene_textures.end())
+      scene_textures.push_back(asset->texture.get());
+  }
+
+  // A paleta é gerada a partir dos texels RGBA
+  for (auto texture : scene_textures)
+    texture->decompress();
+
+  palette = models::buildPalette(std::vector<const models::Texture *>(scene_textures.begin(), scene_textures.end()));
+  colormap = models::buildColormap(palette);
+
+  for (auto texture : scene_textures)
+    texture->quantize(palette);
+
+  palette_dirty = false;
 }
 
 /**
  * @brief Adiciona um objeto à cena
  *
  * @param object Ponteiro para o objeto a ser adicionado
+ *
+ * @note A malha é registrada como recurso da cena e uma instância com a matriz identidade é criada
  */
 void Scene::add_objects(Mesh *object)
 {
-  object->computeBounds();
-  objects.push_back(object);
+  add_instance(object);
+}
+
+/**
+ * @brief Adiciona uma instância de uma malha à cena
+ *
+ * @param asset Malha compartilhada
+ * @param model Matriz de modelo da instância (SRO -> SRU)
+ * @param id Identificador da instância
+ * @return MeshInstance* Ponteiro para a instância criada
+ *
+ * @note A malha só é registrada uma vez, independente do número de instâncias
+ * @note No registro as malhas montadas em tempo de execução são reordenadas (Mesh::optimizeLayout), o ACMR antes
+ *       e depois fica em asset->layout. As malhas cozidas já vêm na ordem do cache do mesh_cook
+ */
+MeshInstance *Scene::add_instance(MeshAsset *asset, const Matrix &model, std::string id)
+{
+  if (std::find(assets.begin(), assets.end(), asset) == assets.end())
+  {
+    // Faces e vértices na ordem do cache de vértices (antes de qualquer instância usar a malha)
+    // Só as malhas de createMesh não têm armazenamento contínuo: as cozidas foram reordenadas offline
+    if (asset->vertex_storage.empty())
+      asset->optimizeLayout();
+    asset->computeBounds();
+    assets.push_back(asset);
+
+    // As cores da malha nova podem não estar na paleta
+    palette_dirty = true;
+  }
+
+  MeshInstance *instance = new MeshInstance(asset, model, id);
+  objects.push_back(instance);
+
+  return instance;
 }
 
 /**
  * @brief Remove um objeto da cena
  *
  * @param object Ponteiro para o objeto a ser removido
+ *
+ * @note A malha continua registrada, pois pode ser usada por outras instâncias
+ * @note Se a instância era controlada por um nó do grafo, o nó continua no grafo sem ela
  */
-void Scene::remove_object(Mesh *object)
+void Scene::remove_object(MeshInstance *object)
 {
   for (auto it = this->objects.begin(); it != this->objects.end(); it++)
   {
@@ -86,6 +204,49 @@ void Scene::remove_object(Mesh *object)
       break;
     }
   }
+
+  graph.detach_instance(object);
+}
+
+/**
+ * @brief Adiciona um nó ao grafo de cena
+ *
+ * @param parent Nó pai (SceneGraph::NO_PARENT para um nó raiz)
+ * @param local Transformação local do nó
+ * @param asset Malha a ser instanciada no nó (opcional, nós sem malha servem como pivô)
+ * @param id Identificador do nó e da instância
+ * @return SceneGraph::NodeHandle Identificador do nó, ou SceneGraph::INVALID_NODE se o pai já foi removido
+ *
+ * @note A matriz de modelo da instância passa a ser controlada pelo grafo
+ */
+SceneGraph::NodeHandle Scene::add_node(SceneGraph::NodeHandle parent, const Matrix &local, MeshAsset *asset, std::string id)
+{
+  // Pai removido: a instância não é criada
+  if (parent != SceneGraph::NO_PARENT && !graph.valid(parent))
+    return SceneGraph::INVALID_NODE;
+
+  MeshInstance *instance = asset != nullptr ? add_instance(asset, local, id) : nullptr;
+
+  return graph.add_node(parent, local, instance, id);
+}
+
+/**
+ * @brief Remove um nó e a sua subárvore do grafo de cena
+ *
+ * @param node Nó a ser removido
+ *
+ * @note As instâncias dos nós removidos saem da cena e são liberadas (foram criadas por add_node)
+ */
+void Scene::remove_node(SceneGraph::NodeHandle node)
+{
+  std::vector<MeshInstance *> instances;
+  graph.remove_node(node, &instances);
+
+  for (MeshInstance *instance : instances)
+  {
+    remove_object(instance);
+    delete instance;
+  }
 }
 
 /**
@@ -104,6 +265,7 @@ void Scene::clipping()
 
   for (auto object : objects)
   {
+    // Centroide da instância no SRU (cacheado junto com a bounding box)
     Vec3f centroid = object->getCentroid();
     // VRP (View referece point)posição do jogador
     Vec3f vrp = player->position;
@@ -126,57 +288,14 @@ void Scene::clipping()
   }
 }
 
-void Scene::apply_pipeline()
-{
-  switch (illumination_mode)
-  {
-  case IlluminationMode::FLAT:
-    apply_pipeline_flat();
-    break;
-  case IlluminationMode::GOURAUD:
-    apply_pipeline_gouraud();
-    break;
-  case IlluminationMode::PHONG:
-    apply_pipeline_phong();
-    break;
-  case IlluminationMode::TEXTURED:
-    apply_pipeline_texture();
-    break;
-  case IlluminationMode::NO_ILLUMINATION:
-    // pode chamar flat com cores neutras ou aplicar apenas wireframe
-    break;
-  }
-
-  if (wireframe)
-  {
-    // Aqui você pode percorrer os objetos e chamar pipeline::DrawLineBuffer ou similar
-    for (auto obj : objects)
-    {
-      for (auto face : obj->faces)
-      {
-        if (!face->visible)
-          continue;
-
-        std::vector<Vec3f> vertexes;
-        HalfEdge *he = face->he;
-        do
-        {
-          vertexes.push_back(he->origin->vertex_screen);
-          he = he->next;
-        } while (he != face->he);
-
-        pipeline::DrawLineBuffer(vertexes, models::WHITE, z_buffer, color_buffer);
-      }
-    }
-  }
-}
-
-void Scene::apply_pipeline_flat()
+/**
+ * @brief Atualiza a matriz SRU -> SRT cacheada
+ *
+ * @note A matriz só depende do jogador e da janela/viewport, então é calculada uma vez por quadro
+ * @note Cada instância apenas combina a sua matriz de modelo com esta matriz
+ */
+void Scene::update_view_projection()
 {
-
-  // Faz a pré computação do que está dentro da visão do jogador
-  clipping();
-
   // Obtém as matrizes de transformação
   // Matriz que converte o sistema do universo (SRU) para o sistema de camera (SRC, Visão do player)
   Matrix sru_src_matrix = pipeline::sru_to_src(player->position, player->target);
@@ -194,448 +313,965 @@ void Scene::apply_pipeline_flat()
 
   // Obs.: Como estamos concatenando as matrizes precisamos aplicar na ordem inversa
   // SRC_TO_SRT -> Projeção -> SRU_TO_SRC
-  Matrix pipeline_matrix = MatrixMultiply(viewport_matrix, projection_matrix);
-  pipeline_matrix = MatrixMultiply(pipeline_matrix, sru_src_matrix);
+  view_projection = MatrixMultiply(viewport_matrix, projection_matrix);
+  view_projection = MatrixMultiply(view_projection, sru_src_matrix);
+}
+
+/**
+ * @brief Atualiza as janelas de recorte do quadro
+ *
+ * @note A guard band tem o mesmo centro da viewport e é guard_band_scale vezes maior
+ */
+void Scene::update_clip_window()
+{
+  float center_x = (min_viewport.x + max_viewport.x) * 0.5f;
+  float center_y = (min_viewport.y + max_viewport.y) * 0.5f;
+  float half_width = (max_viewport.x - min_viewport.x) * 0.5f * guard_band_scale;
+  float half_height = (max_viewport.y - min_viewport.y) * 0.5f * guard_band_scale;
+
+  clip_window.min_viewport = min_viewport;
+  clip_window.max_viewport = max_viewport;
+  clip_window.min_guard_band = {center_x - half_width, center_y - half_height};
+  clip_window.max_guard_band = {center_x + half_width, center_y + half_height};
+  // O plano near não pode passar pelo observador (W = 0 leva os pontos para o infinito)
+  clip_window.near = std::max(player->near, 0.1f);
+}
+
+/**
+ * @brief Leva um ponto do SRO para o SRU
+ *
+ * @param model Matriz de modelo
+ * @param point Ponto no SRO
+ * @return Vec3f Ponto no SRU
+ */
+static Vec3f point_to_world(const Matrix &model, const Vec3f &point)
+{
+  return MatrixMultiplyVector(model, Vec4f(point.x, point.y, point.z, 1.0f)).to_vec3();
+}
+
+/**
+ * @brief Leva um vetor normal do SRO para o SRU
+ *
+ * @param inverse_model Inversa da matriz de modelo
+ * @param normal Vetor normal no SRO
+ * @return Vec3f Vetor normal (unitário) no SRU
+ *
+ * @note As normais são transformadas pela transposta da inversa da matriz de modelo,
+ *       assim continuam perpendiculares à superfície mesmo com escala não uniforme
+ */
+static Vec3f normal_to_world(const Matrix &inverse_model, const Vec3f &normal)
+{
+  Vec3f result = {inverse_model.m0 * normal.x + inverse_model.m4 * normal.y + inverse_model.m8 * normal.z,
+                  inverse_model.m1 * normal.x + inverse_model.m5 * normal.y + inverse_model.m9 * normal.z,
+                  inverse_model.m2 * normal.x + inverse_model.m6 * normal.y + inverse_model.m10 * normal.z};
+
+  return Vector3Normalize(result);
+}
+
+/**
+ * @brief Aplica o pipeline nos vértices da malha de uma instância
+ *
+ * @param object Instância a ser projetada
+ *
+ * @note A matriz de modelo é combinada com a matriz SRU -> SRT cacheada, então cada vértice
+ *       é multiplicado por uma única matriz
+ * @note Como a malha é compartilhada, as coordenadas de tela ficam nos vértices da malha
+ *       apenas até a próxima instância ser projetada
+ */
+void Scene::project_instance(MeshInstance *object)
+{
+  MeshAsset *mesh = object->asset;
+
+  Matrix pipeline_matrix = MatrixMultiply(view_projection, object->model);
+
+  // Fluxo comprimido: a dequantização das posições entra no produto das matrizes e o estágio SIMD
+  // transforma todas as posições antes do laço (buffer por thread, a gravação pode rodar em paralelo)
+  thread_local std::vector<Vec4f> transformed;
+  bool quantized = false;
+  if (compressed_vertices)
+  {
+    if (mesh->compressed.empty() || mesh->compressed.precision() != normal_precision)
+      mesh->compressVertices(normal_precision);
+
+    pipeline_matrix = MatrixMultiply(pipeline_matrix, mesh->compressed.dequantization());
+    transformed.resize(mesh->compressed.positions.size());
+    mesh->compressed.transformPositions(pipeline_matrix, transformed.data());
+    quantized = true;
+  }
+  else if (!mesh->compressed.empty())
+  {
+    // Compressão desligada: as normais e UVs por canto voltam para os vetores em float
+    mesh->decompressVertices();
+  }
 
   // Vetor utilizado na aplicação do pipeline
   Vec4f vectorResult = Vec4f();
 
-  // Rasterização de todos os objetos presentes na cena
-  for (auto object : objects)
+  // aplica o pipeline em todos os vértices do objeto
+  for (std::size_t i = 0; i < mesh->vertexes.size(); i++)
   {
+    Vertex *v = mesh->vertexes[i];
 
-    // aqui ignoramos os objetos que foram recortados no clipping logo acima!
-    if (!object->is_visible)
-      continue;
-
-    // aplica o pipeline em todos os vértices do objeto
-    for (auto v : object->vertexes)
-    {
+    if (quantized)
+      vectorResult = transformed[i];
+    else
       vectorResult = MatrixMultiplyVector(pipeline_matrix, v->vertex);
 
-      // Esse fator W (Fator homogêneo) é a perspectiva, quando dividimos X e Y por W
-      // colocamos o objeto em perspectiva
-      // Como Z é a profundidade, não precismos fazer nada, "já está em perspectiva".
-      v->vertex_screen = {vectorResult.x / vectorResult.w,
-                          vectorResult.y / vectorResult.w,
-                          vectorResult.z};
-    }
+    // Esse fator W (Fator homogêneo) é a perspectiva, quando dividimos X e Y por W
+    // colocamos o objeto em perspectiva
+    // Como Z é a profundidade, não precismos fazer nada, "já está em perspectiva".
+    // Vértices no plano da câmera (W = 0) usam um W mínimo para evitar a divisão por zero,
+    // eles são tratados no recorte do plano near (que recupera X e Y homogêneos multiplicando por W)
+    float w = vectorResult.w;
+    if (std::fabs(w) < 1e-6f)
+      w = w < 0.0f ? -1e-6f : 1e-6f;
+
+    v->vertex_screen = {vectorResult.x / w,
+                        vectorResult.y / w,
+                        vectorResult.z};
+    v->screen_w = w;
+  }
 
-    // Determina a visibilidade de cada face
-    // A visibilidade é determinada por back culling (faces voltados para longe da câmera)
-    for (auto face : object->faces)
-    {
-      face->visible = face->is_visible(player->position);
-    }
+  // Determina a visibilidade de cada face
+  // A visibilidade é determinada por back culling (faces voltados para longe da câmera)
+  // O teste é feito no SRO, então levamos a posição do jogador para o sistema do objeto
+  Vec3f eye = MatrixMultiplyVector(object->inverse_model, Vec4f(player->position.x, player->position.y, player->position.z, 1.0f)).to_vec3();
+
+  for (auto face : mesh->faces)
+  {
+    face->visible = face->is_visible(eye);
   }
+}
+
+// Mínimo de faces das instâncias visíveis para gravar em paralelo (abaixo disso criar as threads custa mais que gravar)
+static constexpr std::size_t PARALLEL_RECORDING_MIN_FACES = 4096;
+
+// Instância a ser gravada, com o índice na cena e os ids do material e da textura no quadro
+struct RecordJob
+{
+  MeshInstance *object;
+  int index;
+  int material;
+  int texture;
+};
+
+void Scene::apply_pipeline()
+{
+  // Propaga as transformações que mudaram no grafo de cena
+  // As matrizes de modelo e bounding boxes das instâncias são atualizadas no mesmo passo
+  graph.update();
+
+  // Faz a pré computação do que está dentro da visão do jogador
+  clipping();
+
+  // Obtém a matriz SRU -> SRT do quadro
+  update_view_projection();
+
+  // Viewport, guard band e plano near usados no recorte dos triângulos
+  update_clip_window();
+
+  // Texturas carregadas em segundo plano: aplica os níveis que chegaram e pede os usados no quadro anterior
+  // Só o primeiro carregamento de uma textura muda a paleta; os refinamentos ficam sem índices e são
+  // quantizados com a paleta atual em prepare_instance
+  int arrived = textures.streamer.arrived;
+  textures.update();
+  if (textures.streamer.arrived != arrived)
+    palette_dirty = true;
 
   // Inicializa os buffers
   initialize_buffers();
 
-  for (auto object : objects)
+  // A paleta só é refeita quando uma malha nova entra na cena ou uma textura em streaming chega pela primeira vez
+  if (indexed() && palette_dirty)
+    build_palette();
+
+  // Gravação: cada instância visível vira uma sequência de comandos com o material e a textura na chave
+  std::unordered_map<const void *, int> material_ids;
+  std::unordered_map<const void *, int> texture_ids;
+  auto intern = [](std::unordered_map<const void *, int> &ids, const void *resource)
+  { return ids.emplace(resource, static_cast<int>(ids.size())).first->second; };
+
+  // Instâncias da mesma malha ficam no mesmo grupo (as coordenadas de tela ficam na malha compartilhada)
+  std::unordered_map<const MeshAsset *, std::size_t> group_index;
+  std::vector<std::vector<RecordJob>> groups;
+  std::size_t recorded_faces = 0;
+
+  for (std::size_t i = 0; i < objects.size(); i++)
   {
-    // Ignora objetos não visíveis
+    MeshInstance *object = objects[i];
+
+    // aqui ignoramos os objetos que foram recortados no clipping logo acima!
     if (!object->is_visible)
       continue;
 
-    for (auto face : object->faces)
-    {
-      if (!face->visible)
-        continue;
-
-      HalfEdge *he = face->he;
+    prepare_instance(object);
 
-      // coordenadas de tela
-      std::vector<Vec3f> vertexes;
+    RecordJob job = {object, static_cast<int>(i), intern(material_ids, &object->getMaterial()), intern(texture_ids, object->asset->texture.get())};
 
-      // percore os vértices no sentido anti-horário
-      while (true)
-      {
-        vertexes.push_back(he->origin->vertex_screen);
+    auto [group, inserted] = group_index.emplace(object->asset, groups.size());
+    if (inserted)
+      groups.emplace_back();
+    groups[group->second].push_back(job);
+    recorded_faces += object->asset->faces.size();
+  }
 
-        he = he->next;
-        if (he == face->he)
-          break;
-      }
+  // Cada instância grava os seus triângulos na própria entrada (as threads não compartilham entradas)
+  if (illumination_mode == IlluminationMode::VISIBILITY && visibility_objects.size() < objects.size())
+    visibility_objects.resize(objects.size());
 
-      // O vetor normal da face é calculado na ocultação de faces
-      // precisa recortar o vetor normal do vértice também (assim simplifica o calculo da interpolação)
-      vertexes = pipeline::clip_2D_polygon(vertexes, min_viewport, max_viewport);
+  // Uma lista por thread: a gravação em paralelo só compensa com várias malhas e faces suficientes
+  std::size_t workers = 1;
+  if (parallel_recording && recorded_faces >= PARALLEL_RECORDING_MIN_FACES)
+    workers = std::max<std::size_t>(1, std::min<std::size_t>(std::clamp(std::thread::hardware_concurrency(), 1u, 16u), groups.size()));
 
-      // Se o vetor de vertices for menor que 3, não é possível formar um polígono, então não rasteriza.
-      if (vertexes.size() < 3)
-        continue;
+  if (recording_lists.size() < workers)
+    recording_lists.resize(workers);
+  for (std::size_t w = 0; w < workers; w++)
+  {
+    recording_lists[w].clear();
+    recording_lists[w].order = command_order;
+  }
 
-      pipeline::fill_polygon_flat(vertexes, global_light, omni_lights, player->position, face->centroid, face->normal, object->material, z_buffer, color_buffer);
+  std::atomic<std::size_t> next{0};
+  auto record = [&](pipeline::CommandList &list)
+  {
+    for (std::size_t g = next++; g < groups.size(); g = next++)
+    {
+      for (const RecordJob &job : groups[g])
+      {
+        list.begin(job.index, job.material, job.texture);
+        record_instance(job.object, job.index, list);
+      }
     }
+  };
+
+  std::vector<std::thread> helpers;
+  for (std::size_t w = 1; w < workers; w++)
+    helpers.emplace_back(record, std::ref(recording_lists[w]));
+  record(recording_lists[0]);
+  for (std::thread &helper : helpers)
+    helper.join();
+
+  // Junta as listas (a primeira troca de lugar com a do quadro anterior, sem cópia), ordena e executa
+  std::swap(commands, recording_lists[0]);
+  for (std::size_t w = 1; w < workers; w++)
+    commands.append(recording_lists[w]);
+
+  clip_stats = commands.clip_stats;
+  commands.sort();
+  execute_commands();
+
+  // Visibility buffer: cada pixel coberto é sombreado uma vez a partir do triângulo gravado e as linhas vêm por cima
+  if (illumination_mode == IlluminationMode::VISIBILITY)
+  {
+    pipeline::resolve_visibility(id_buffer, visibility_objects, min_viewport, max_viewport, global_light, omni_lights, player->position, color_buffer, raster_stats);
+    execute_lines();
   }
 
-  // Resetar a clipping flag de cada vértice para a próxima iteração
+  // Apresentação do quadro de 8 bits: cada índice vira a cor da paleta
+  if (indexed())
+    pipeline::ExpandIndexBuffer(index_buffer, palette, min_viewport, max_viewport, color_buffer);
+
+  // Resetar a clipping flag de cada instância para a próxima iteração
   for (auto object : objects)
     object->is_visible = true;
 }
 
-void Scene::apply_pipeline_gouraud()
+/**
+ * @brief Prepara os recursos de uma instância visível para a gravação
+ *
+ * @param object Instância visível
+ *
+ * @note As texturas são compartilhadas entre malhas diferentes, então a troca de formato, de layout e a
+ *       quantização acontecem aqui, antes da gravação (que pode rodar em paralelo)
+ */
+void Scene::prepare_instance(MeshInstance *object)
 {
-  // Faz a pré computação do que está dentro da visão do jogador
-  clipping();
+  MeshAsset *mesh = object->asset;
 
-  // Obtém as matrizes de transformação
-  // Matriz que converte o sistema do universo (SRU) para o sistema de camera (SRC, Visão do player)
-  Matrix sru_src_matrix = pipeline::sru_to_src(player->position, player->target);
-  // Aplica a projeção (Efeito de perspectiva)
-  Matrix projection_matrix = pipeline::projection(player->position, player->target, player->d);
-  // Mapeia as coordenadas da camera para a tela
-  Matrix viewport_matrix = pipeline::src_to_srt(min_window, min_viewport, max_window, max_viewport, true);
+  if (illumination_mode != IlluminationMode::TEXTURED || !mesh->texture)
+    return;
 
-  // Observação, como o pipeline é simplificado, não é possível inverter as matrizes
-  // Isso acontece devido ao volume de visualização não ser normalizado
-  // Ou seja, não podemos pegar uma coordenada de tela e voltar para o Universo
-  // o máximo que podemos fazer é pegar as coordenadas de tela e voltar para o sistema o SRC (sem projeção)
+  // A textura é (des)comprimida uma única vez quando o formato da cena muda
+  // O caminho de 8 bits lê os índices da paleta, que são gerados a partir dos texels RGBA
+  models::TextureCompression compression = indexed() ? models::TextureCompression::NONE : texture_compression;
+  if (mesh->texture->compression != compression)
+    mesh->texture->compress(compression);
 
-  // Multiplicação de matrizes
+  // A textura é reordenada uma única vez quando o layout da cena muda (vale para todas as malhas que a compartilham)
+  if (mesh->texture->layout != texture_layout)
+    mesh->texture->setLayout(texture_layout);
 
-  // Obs.: Como estamos concatenando as matrizes precisamos aplicar na ordem inversa
-  // SRC_TO_SRT -> Projeção -> SRU_TO_SRC
-  Matrix pipeline_matrix = MatrixMultiply(viewport_matrix, projection_matrix);
-  pipeline_matrix = MatrixMultiply(pipeline_matrix, sru_src_matrix);
+  // Texturas trocadas depois da criação da paleta são quantizadas com a paleta atual
+  if (indexed() && mesh->texture->indices.size() != mesh->texture->texels.size())
+    mesh->texture->quantize(palette);
 
-  // Vetor utilizado na aplicação do pipeline
-  Vec4f vectorResult = Vec4f();
+  // Garantir que u, v já estão definidos (normalizados entre 0 e 1)
+  // Para cubo simples ou UV planar
+  if (mesh->corner_uvs.empty() && !mesh->compressed.hasUVs())
+  {
+    for (auto v : mesh->vertexes)
+    {
+      if (!v->has_uv)
+      {
+        v->u = (v->vertex.x + 1.0f) / 2.0f; // mapeia -1..1 -> 0..1
+        v->v = (v->vertex.y + 1.0f) / 2.0f;
+        v->has_uv = true;
+      }
+    }
+  }
+}
 
-  // Rasterização de todos os objetos presentes na cena
-  for (auto object : objects)
+/**
+ * @brief Projeta uma instância e grava os seus comandos
+ *
+ * @param object Instância visível
+ * @param index Índice da instância em objects
+ * @param list Lista de comandos da thread
+ *
+ * @note As coordenadas de tela ficam na malha compartilhada só até a próxima instância ser projetada,
+ *       por isso os comandos guardam cópias dos polígonos recortados
+ */
+void Scene::record_instance(MeshInstance *object, int index, pipeline::CommandList &list)
+{
+  project_instance(object);
+
+  switch (illumination_mode)
+  {
+  case IlluminationMode::FLAT:
+    record_flat(object, list);
+    break;
+  case IlluminationMode::GOURAUD:
+    record_gouraud(object, list);
+    break;
+  case IlluminationMode::PHONG:
+    record_phong(object, list);
+    break;
+  case IlluminationMode::TEXTURED:
+    record_texture(object, list);
+    break;
+  case IlluminationMode::NO_ILLUMINATION:
+    // Sem iluminação, usa apenas as cores por canto (se a malha tiver) e/ou o wireframe
+    record_colors(object, list);
+    break;
+  case IlluminationMode::VISIBILITY:
+    record_visibility(object, index, list);
+    break;
+  }
+
+  if (wireframe)
+    record_wireframe(object, list);
+}
+
+/**
+ * @brief Rasteriza apenas a profundidade do polígono de um comando (pré-passo)
+ *
+ * @param commands Lista de comandos do quadro
+ * @param payload Dados do comando
+ * @param scissor_min Canto inferior esquerdo da viewport
+ * @param scissor_max Canto superior direito da viewport
+ * @param z_buffer Buffer de profundidade
+ * @param stats Contadores da rasterização
+ *
+ * @note As linhas não entram no pré-passo, elas continuam testando a profundidade no passo de sombreamento
+ */
+static void depth_prepass_command(const pipeline::CommandList &commands, const pipeline::DrawPayload &payload,
+                                  const Vec2f &scissor_min, const Vec2f &scissor_max,
+                                  std::vector<std::vector<float>> &z_buffer, pipeline::RasterStats &stats)
+{
+  switch (payload.kind)
+  {
+  case pipeline::CommandKind::FLAT:
+  case pipeline::CommandKind::VISIBILITY:
+  {
+    pipeline::ClipPolygon<pipeline::FlatVertex> polygon;
+    commands.polygon(payload, polygon);
+    pipeline::rasterize_depth(polygon, scissor_min, scissor_max, z_buffer, stats);
+    break;
+  }
+  case pipeline::CommandKind::GOURAUD:
+  case pipeline::CommandKind::PHONG:
   {
+    pipeline::ClipPolygon<pipeline::PhongVertex> polygon;
+    commands.polygon(payload, polygon);
+    pipeline::rasterize_depth(polygon, scissor_min, scissor_max, z_buffer, stats);
+    break;
+  }
+  case pipeline::CommandKind::TEXTURE:
+  case pipeline::CommandKind::TEXTURE_INDEXED:
+  {
+    pipeline::ClipPolygon<pipeline::TextureVertex> polygon;
+    commands.polygon(payload, polygon);
+    pipeline::rasterize_depth(polygon, scissor_min, scissor_max, z_buffer, stats);
+    break;
+  }
+  case pipeline::CommandKind::LINES:
+  case pipeline::CommandKind::LINES_INDEXED:
+    break;
+  }
+}
 
-    // aqui ignoramos os objetos que foram recortados no clipping logo acima!
-    if (!object->is_visible)
-      continue;
+/**
+ * @brief Desenha a linha poligonal de um comando
+ *
+ * @param commands Lista de comandos do quadro
+ * @param payload Dados do comando (LINES ou LINES_INDEXED)
+ * @param line Vetor auxiliar (reaproveitado entre os comandos)
+ * @param z_buffer Buffer de profundidade
+ * @param color_buffer Buffer de cores
+ * @param index_buffer Buffer de índices da paleta
+ */
+static void draw_line_command(const pipeline::CommandList &commands, const pipeline::DrawPayload &payload, std::vector<Vec3f> &line,
+                              std::vector<std::vector<float>> &z_buffer, std::vector<std::vector<models::Color>> &color_buffer,
+                              std::vector<std::vector<models::Uint8>> &index_buffer)
+{
+  auto first = commands.line_vertexes.begin() + payload.first_vertex;
+  line.assign(first, first + payload.vertex_count);
 
-    // aplica o pipeline em todos os vértices do objeto
-    for (auto v : object->vertexes)
-    {
-      vectorResult = MatrixMultiplyVector(pipeline_matrix, v->vertex);
+  if (payload.kind == pipeline::CommandKind::LINES_INDEXED)
+    pipeline::DrawLineBuffer(line, payload.color_index, z_buffer, index_buffer);
+  else
+    pipeline::DrawLineBuffer(line, payload.color, z_buffer, color_buffer);
+}
 
-      // Esse fator W (Fator homogêneo) é a perspectiva, quando dividimos X e Y por W
-      // colocamos o objeto em perspectiva
-      // Como Z é a profundidade, não precismos fazer nada, "já está em perspectiva".
-      v->vertex_screen = {vectorResult.x / vectorResult.w,
-                          vectorResult.y / vectorResult.w,
-                          vectorResult.z};
-    }
+/**
+ * @brief Executa os comandos do quadro
+ *
+ * @note Cada comando chama a rotina de preenchimento do seu tipo com o polígono gravado
+ */
+void Scene::execute_commands()
+{
+  // Posição da camera (player)
+  Vec3f eye = player->position;
+
+  // Vértices das linhas (DrawLineBuffer recebe um vetor)
+  std::vector<Vec3f> line;
+
+  raster_stats.reset();
+
+  // Pré-passo: a profundidade de todos os polígonos é resolvida antes, assim o passo de sombreamento
+  // só aceita o fragmento mais próximo de cada pixel (sombreado uma única vez, em qualquer ordem)
+  if (depth_prepass)
+    for (const pipeline::RenderCommand &command : commands.commands)
+      depth_prepass_command(commands, commands.payloads[command.payload], min_viewport, max_viewport, z_buffer, raster_stats);
+
+  for (const pipeline::RenderCommand &command : commands.commands)
+  {
+    const pipeline::DrawPayload &payload = commands.payloads[command.payload];
 
-    // Determina a visibilidade de cada face
-    // A visibilidade é determinada por back culling (faces voltados para longe da câmera)
-    for (auto face : object->faces)
+    switch (payload.kind)
     {
-      face->visible = face->is_visible(player->position);
+    case pipeline::CommandKind::FLAT:
+    {
+      pipeline::ClipPolygon<pipeline::FlatVertex> polygon;
+      commands.polygon(payload, polygon);
+      pipeline::fill_polygon_flat(polygon, min_viewport, max_viewport, global_light, omni_lights, eye, payload.centroid, payload.normal, *payload.material, z_buffer, color_buffer, raster_stats);
+      break;
+    }
+    case pipeline::CommandKind::GOURAUD:
+    {
+      pipeline::ClipPolygon<pipeline::GouraudVertex> polygon;
+      commands.polygon(payload, polygon);
+      pipeline::fill_polygon_gourand(polygon, min_viewport, max_viewport, z_buffer, color_buffer, raster_stats);
+      break;
+    }
+    case pipeline::CommandKind::PHONG:
+    {
+      pipeline::ClipPolygon<pipeline::PhongVertex> polygon;
+      commands.polygon(payload, polygon);
+      pipeline::fill_polygon_phong(polygon, min_viewport, max_viewport, payload.centroid, global_light, omni_lights, eye, *payload.material, shading_rate, z_buffer, color_buffer, raster_stats);
+      break;
+    }
+    case pipeline::CommandKind::TEXTURE:
+    {
+      pipeline::ClipPolygon<pipeline::TextureVertex> polygon;
+      commands.polygon(payload, polygon);
+      pipeline::fill_polygon_texture(polygon, min_viewport, max_viewport, *payload.texture, mip_selection, global_light, omni_lights, eye,
+                                     payload.centroid, payload.normal, *payload.material, z_buffer, color_buffer, raster_stats);
+      break;
+    }
+    case pipeline::CommandKind::TEXTURE_INDEXED:
+    {
+      pipeline::ClipPolygon<pipeline::TextureVertex> polygon;
+      commands.polygon(payload, polygon);
+      pipeline::fill_polygon_texture_indexed(polygon, min_viewport, max_viewport, *payload.texture, mip_selection, payload.colormap_row, z_buffer, index_buffer, raster_stats);
+      break;
+    }
+    case pipeline::CommandKind::VISIBILITY:
+    {
+      pipeline::ClipPolygon<pipeline::FlatVertex> polygon;
+      commands.polygon(payload, polygon);
+      pipeline::fill_polygon_visibility(polygon, min_viewport, max_viewport, payload.visibility_id, z_buffer, id_buffer, raster_stats);
+      break;
+    }
+    case pipeline::CommandKind::LINES:
+    case pipeline::CommandKind::LINES_INDEXED:
+      // No visibility buffer a resolução sobrescreveria as linhas, elas são desenhadas depois (execute_lines)
+      if (illumination_mode != IlluminationMode::VISIBILITY)
+        draw_line_command(commands, payload, line, z_buffer, color_buffer, index_buffer);
+      break;
     }
-
-    // Nos sombreamentos Gouraud e Phong, precisamos calcular uma normal unitária em cada vértice.
-    // Para isso, pegamos as normais das faces que compartilham o mesmo vértice e calculamos sua média.
-    // Essa média define a orientação "suave" da superfície naquele ponto.
-    // Diferente do sombreamento Flat, onde a cor é calculada por face, aqui a cor depende das normais
-    // de cada vértice (Gouraud) ou de cada pixel (Phong), permitindo transições suaves entre as faces.
-    object->determineVertexNormals();
   }
 
-  // Inicializa os buffers
-  initialize_buffers();
+  // Pixels cobertos no fim do quadro (o z-buffer é limpo com 0, qualquer geometria grava 1/w > 0)
+  int x_begin = static_cast<int>(min_viewport.x), x_end = static_cast<int>(max_viewport.x);
+  int y_begin = static_cast<int>(min_viewport.y), y_end = static_cast<int>(max_viewport.y);
+  for (int x = x_begin; x <= x_end; x++)
+    for (int y = y_begin; y <= y_end; y++)
+      if (z_buffer[x][y] > 0.0f)
+        raster_stats.visible++;
+}
 
-  for (auto object : objects)
+void Scene::execute_lines()
+{
+  std::vector<Vec3f> line;
+
+  for (const pipeline::RenderCommand &command : commands.commands)
   {
-    // Ignora objetos não visíveis
-    if (!object->is_visible)
-      continue;
+    const pipeline::DrawPayload &payload = commands.payloads[command.payload];
+    if (payload.kind == pipeline::CommandKind::LINES || payload.kind == pipeline::CommandKind::LINES_INDEXED)
+      draw_line_command(commands, payload, line, z_buffer, color_buffer, index_buffer);
+  }
+}
 
-    for (auto face : object->faces)
-    {
-      if (!face->visible)
-        continue;
+/**
+ * @brief Grava as arestas de uma face como uma linha poligonal fechada
+ *
+ * @param face Face visível
+ * @param near Distância do plano near
+ * @param payload Tipo e cor das linhas
+ * @param vertexes Vetor auxiliar (reaproveitado entre as faces)
+ * @param list Lista de comandos
+ */
+static void record_face_lines(const Face *face, float near, const pipeline::DrawPayload &payload, std::vector<Vec3f> &vertexes, pipeline::CommandList &list)
+{
+  vertexes.clear();
+  bool behind_near = false;
+  HalfEdge *he = face->he;
+  do
+  {
+    // A profundidade das linhas também é 1/w (linear na tela)
+    vertexes.push_back({he->origin->vertex_screen.x, he->origin->vertex_screen.y, 1.0f / he->origin->screen_w});
+    behind_near |= he->origin->vertex_screen.z > -near;
+    he = he->next;
+  } while (he != face->he);
+
+  // As linhas não são recortadas, então faces que cruzam o plano near não são desenhadas
+  if (!behind_near)
+    list.lines(vertexes, payload);
+}
 
-      HalfEdge *he = face->he;
+void Scene::record_wireframe(MeshInstance *object, pipeline::CommandList &list)
+{
+  pipeline::DrawPayload payload;
+  payload.kind = indexed() ? pipeline::CommandKind::LINES_INDEXED : pipeline::CommandKind::LINES;
+  payload.color = models::WHITE;
+  payload.color_index = indexed() ? palette.nearest(models::WHITE) : 0;
 
-      // first: coordenadas de tela
-      // second: normal do vértice
-      std::vector<std::pair<Vec3f, Vec3f>> vertexes;
+  std::vector<Vec3f> vertexes;
+  for (auto face : object->asset->faces)
+  {
+    if (face->visible)
+      record_face_lines(face, player->near, payload, vertexes, list);
+  }
+}
 
-      // percore os vértices no sentido anti-horário
-      while (true)
-      {
-        vertexes.push_back(std::make_pair(he->origin->vertex_screen, he->origin->normal));
+void Scene::record_flat(MeshInstance *object, pipeline::CommandList &list)
+{
+  // Material do objeto
+  const models::Material &object_material = object->getMaterial();
 
-        he = he->next;
-        if (he == face->he)
-          break;
-      }
+  for (auto face : object->asset->faces)
+  {
+    if (!face->visible)
+      continue;
 
-      // No gouraud a cor é calculada antes do recorte, pois é determinada em cada vértice
-      // pois quando formos recortar, precisaremos interpolar corretamente a cor para o ponto do recorte
-      std::vector<std::pair<Vec3f, models::Color>> vertexes_gouraud;
+    // A iluminação é calculada no SRU
+    Vec3f centroid = point_to_world(object->model, face->centroid);
+    Vec3f normal = normal_to_world(object->inverse_model, face->normal);
 
-      // Posição da camera (player)
-      Vec3f eye = player->position;
-      // Material do objeto
-      models::Material object_material = object->material;
+    // A face é dividida em leque de triângulos (face->he é o vértice comum)
+    // assim cada polígono recortado cabe no buffer de capacidade fixa
+    HalfEdge *first = face->he;
+    for (HalfEdge *he = first->next; he->next != first; he = he->next)
+    {
+      HalfEdge *corners[3] = {first, he, he->next};
+
+      // coordenadas de tela
+      pipeline::ClipPolygon<pipeline::FlatVertex> polygon;
 
-      // Calcula a cor para cada vértice do objeto
-      for (auto vertex : vertexes)
+      for (auto corner : corners)
       {
-        Vec3f vert = vertex.first;
-        Vec3f normal_vert = vertex.second;
-        models::Color color = models::GouraudShading(global_light, omni_lights, std::make_pair(vert, normal_vert), eye, object_material);
-        vertexes_gouraud.push_back(std::make_pair(vert, color));
+        pipeline::FlatVertex vertex;
+        vertex.position = corner->origin->vertex_screen;
+        vertex.w = corner->origin->screen_w;
+        polygon.push(vertex);
       }
 
-      // O vetor normal da face é calculado na ocultação de faces
-      // precisa recortar o vetor normal do vértice também (assim simplifica o calculo da interpolação)
-      vertexes_gouraud = pipeline::clip_2D_polygon(vertexes_gouraud, min_viewport, max_viewport);
-
-      // Se o vetor de vertices for menor que 3, não é possível formar um polígono, então não rasteriza.
-      if (vertexes_gouraud.size() < 3)
+      // Se sobrar menos que 3 vértices, não é possível formar um polígono, então não rasteriza.
+      if (!pipeline::clip_triangle(polygon, clip_window, list.clip_stats))
         continue;
 
-      pipeline::fill_polygon_gourand(vertexes_gouraud, z_buffer, color_buffer);
+      pipeline::DrawPayload payload;
+      payload.kind = pipeline::CommandKind::FLAT;
+      payload.material = &object_material;
+      payload.centroid = centroid;
+      payload.normal = normal;
+      list.draw(polygon, payload);
     }
   }
-
-  // Resetar a clipping flag de cada vértice para a próxima iteração
-  for (auto object : objects)
-    object->is_visible = true;
 }
 
-void Scene::apply_pipeline_phong()
+void Scene::record_gouraud(MeshInstance *object, pipeline::CommandList &list)
 {
-  // Faz a pré computação do que está dentro da visão do jogador
-  clipping();
+  // Nos sombreamentos Gouraud e Phong, precisamos calcular uma normal unitária em cada vértice.
+  // Para isso, pegamos as normais das faces que compartilham o mesmo vértice e calculamos sua média.
+  // Essa média define a orientação "suave" da superfície naquele ponto.
+  // Diferente do sombreamento Flat, onde a cor é calculada por face, aqui a cor depende das normais
+  // de cada vértice (Gouraud) ou de cada pixel (Phong), permitindo transições suaves entre as faces.
+  // No fluxo comprimido as normais já estão gravadas por canto (preparado em project_instance)
+  const models::CompressedVertices *compressed = compressed_vertices ? &object->asset->compressed : nullptr;
+  if (!compressed)
+    object->asset->determineVertexNormals();
+
+  // Posição da camera (player)
+  Vec3f eye = player->position;
+  // Material do objeto
+  const models::Material &object_material = object->getMaterial();
+  // Normais por canto (se existirem) substituem a normal média do vértice
+  const std::vector<Vec3f> &corner_normals = object->asset->corner_normals;
+
+  for (auto face : object->asset->faces)
+  {
+    if (!face->visible)
+      continue;
 
-  // Obtém as matrizes de transformação
-  // Matriz que converte o sistema do universo (SRU) para o sistema de camera (SRC, Visão do player)
-  Matrix sru_src_matrix = pipeline::sru_to_src(player->position, player->target);
-  // Aplica a projeção (Efeito de perspectiva)
-  Matrix projection_matrix = pipeline::projection(player->position, player->target, player->d);
-  // Mapeia as coordenadas da camera para a tela
-  Matrix viewport_matrix = pipeline::src_to_srt(min_window, min_viewport, max_window, max_viewport, true);
+    HalfEdge *first = face->he;
+    for (HalfEdge *he = first->next; he->next != first; he = he->next)
+    {
+      HalfEdge *corners[3] = {first, he, he->next};
 
-  // Observação, como o pipeline é simplificado, não é possível inverter as matrizes
-  // Isso acontece devido ao volume de visualização não ser normalizado
-  // Ou seja, não podemos pegar uma coordenada de tela e voltar para o Universo
-  // o máximo que podemos fazer é pegar as coordenadas de tela e voltar para o sistema o SRC (sem projeção)
+      // No gouraud a cor é calculada antes do recorte, pois é determinada em cada vértice
+      // pois quando formos recortar, precisaremos interpolar corretamente a cor para o ponto do recorte
+      pipeline::ClipPolygon<pipeline::GouraudVertex> polygon;
 
-  // Multiplicação de matrizes
+      for (auto corner : corners)
+      {
+        Vertex *vertex = corner->origin;
 
-  // Obs.: Como estamos concatenando as matrizes precisamos aplicar na ordem inversa
-  // SRC_TO_SRT -> Projeção -> SRU_TO_SRC
-  Matrix pipeline_matrix = MatrixMultiply(viewport_matrix, projection_matrix);
-  pipeline_matrix = MatrixMultiply(pipeline_matrix, sru_src_matrix);
+        // A iluminação é calculada no SRU
+        Vec3f vert = point_to_world(object->model, compressed ? compressed->position(vertex->index) : vertex->vertex.to_vec3());
+        Vec3f normal_object = compressed ? compressed->normal(corner->index) : (corner_normals.empty() ? vertex->normal : corner_normals[corner->index]);
+        Vec3f normal_vert = normal_to_world(object->inverse_model, normal_object);
 
-  // Vetor utilizado na aplicação do pipeline
-  Vec4f vectorResult = Vec4f();
+        models::Color color = models::GouraudShading(global_light, omni_lights, std::make_pair(vert, normal_vert), eye, object_material);
 
-  // Rasterização de todos os objetos presentes na cena
-  for (auto object : objects)
-  {
+        pipeline::GouraudVertex clip_vertex;
+        clip_vertex.position = vertex->vertex_screen;
+        clip_vertex.w = vertex->screen_w;
+        clip_vertex.attributes = {static_cast<float>(color.r), static_cast<float>(color.g), static_cast<float>(color.b)};
+        polygon.push(clip_vertex);
+      }
 
-    // aqui ignoramos os objetos que foram recortados no clipping logo acima!
-    if (!object->is_visible)
+      // Se sobrar menos que 3 vértices, não é possível formar um polígono, então não rasteriza.
+      if (!pipeline::clip_triangle(polygon, clip_window, list.clip_stats))
+        continue;
+
+      pipeline::DrawPayload payload;
+      payload.kind = pipeline::CommandKind::GOURAUD;
+      list.draw(polygon, payload);
+    }
+  }
+}
+
+void Scene::record_phong(MeshInstance *object, pipeline::CommandList &list)
+{
+  // Normais médias dos vértices (veja record_gouraud)
+  const models::CompressedVertices *compressed = compressed_vertices ? &object->asset->compressed : nullptr;
+  if (!compressed)
+    object->asset->determineVertexNormals();
+
+  // Material do objeto
+  const models::Material &object_material = object->getMaterial();
+  // Centroide do objeto no SRU
+  Vec3f centroid = object->getCentroid();
+  // Normais por canto (se existirem) substituem a normal média do vértice
+  const std::vector<Vec3f> &corner_normals = object->asset->corner_normals;
+
+  for (auto face : object->asset->faces)
+  {
+    if (!face->visible)
       continue;
 
-    // aplica o pipeline em todos os vértices do objeto
-    for (auto v : object->vertexes)
+    HalfEdge *first = face->he;
+    for (HalfEdge *he = first->next; he->next != first; he = he->next)
     {
-      vectorResult = MatrixMultiplyVector(pipeline_matrix, v->vertex);
+      HalfEdge *corners[3] = {first, he, he->next};
 
-      // Esse fator W (Fator homogêneo) é a perspectiva, quando dividimos X e Y por W
-      // colocamos o objeto em perspectiva
-      // Como Z é a profundidade, não precismos fazer nada, "já está em perspectiva".
-      v->vertex_screen = {vectorResult.x / vectorResult.w,
-                          vectorResult.y / vectorResult.w,
-                          vectorResult.z};
-    }
+      // coordenadas de tela + normal do vértice (SRU)
+      pipeline::ClipPolygon<pipeline::PhongVertex> polygon;
 
-    // Determina a visibilidade de cada face
-    // A visibilidade é determinada por back culling (faces voltados para longe da câmera)
-    for (auto face : object->faces)
-    {
-      face->visible = face->is_visible(player->position);
-    }
+      for (auto corner : corners)
+      {
+        Vec3f normal_object = compressed ? compressed->normal(corner->index) : (corner_normals.empty() ? corner->origin->normal : corner_normals[corner->index]);
+        Vec3f normal = normal_to_world(object->inverse_model, normal_object);
+
+        pipeline::PhongVertex vertex;
+        vertex.position = corner->origin->vertex_screen;
+        vertex.w = corner->origin->screen_w;
+        vertex.attributes = {normal.x, normal.y, normal.z};
+        polygon.push(vertex);
+      }
+
+      // O vetor normal do vértice é recortado junto (assim simplifica o calculo da interpolação)
+      if (!pipeline::clip_triangle(polygon, clip_window, list.clip_stats))
+        continue;
 
-    // Nos sombreamentos Gouraud e Phong, precisamos calcular uma normal unitária em cada vértice.
-    // Para isso, pegamos as normais das faces que compartilham o mesmo vértice e calculamos sua média.
-    // Essa média define a orientação "suave" da superfície naquele ponto.
-    // Diferente do sombreamento Flat, onde a cor é calculada por face, aqui a cor depende das normais
-    // de cada vértice (Gouraud) ou de cada pixel (Phong), permitindo transições suaves entre as faces.
-    object->determineVertexNormals();
+      pipeline::DrawPayload payload;
+      payload.kind = pipeline::CommandKind::PHONG;
+      payload.material = &object_material;
+      payload.centroid = centroid;
+      list.draw(polygon, payload);
+    }
   }
+}
 
-  // Inicializa os buffers
-  initialize_buffers();
+/**
+ * @brief Grava os triângulos da instância no visibility buffer
+ *
+ * @param object Instância visível
+ * @param index Índice da instância em objects (objeto do id)
+ * @param list Lista de comandos da thread
+ *
+ * @note O comando leva apenas o polígono recortado e o id, os cantos do triângulo (posição homogênea de tela e
+ *       normal no SRU) ficam em visibility_objects para a resolução reconstruir as baricêntricas
+ * @note Os triângulos são numerados no leque de todas as faces (também as ocultas), assim o índice não muda
+ *       com a câmera e identifica o triângulo da malha
+ */
+void Scene::record_visibility(MeshInstance *object, int index, pipeline::CommandList &list)
+{
+  // O id tem 12 bits para o objeto e 20 para o triângulo
+  if (static_cast<std::uint32_t>(index) >= pipeline::VISIBILITY_MAX_OBJECTS)
+    return;
 
-  for (auto object : objects)
-  {
-    // Ignora objetos não visíveis
-    if (!object->is_visible)
-      continue;
+  // Normais médias dos vértices (veja record_gouraud)
+  const models::CompressedVertices *compressed = compressed_vertices ? &object->asset->compressed : nullptr;
+  if (!compressed)
+    object->asset->determineVertexNormals();
+
+  const std::vector<Vec3f> &corner_normals = object->asset->corner_normals;
 
-    for (auto face : object->faces)
+  pipeline::VisibilityObject &target = visibility_objects[index];
+  target.material = &object->getMaterial();
+  target.centroid = object->getCentroid();
+  target.triangles.clear();
+
+  for (auto face : object->asset->faces)
+  {
+    HalfEdge *first = face->he;
+    for (HalfEdge *he = first->next; he->next != first; he = he->next)
     {
+      int triangle = static_cast<int>(target.triangles.size());
+      if (static_cast<std::uint32_t>(triangle) > pipeline::VISIBILITY_TRIANGLE_MASK)
+        return;
+
+      pipeline::VisibilityTriangle &recorded = target.triangles.emplace_back();
       if (!face->visible)
         continue;
 
-      HalfEdge *he = face->he;
+      HalfEdge *corners[3] = {first, he, he->next};
 
-      // first: coordenadas de tela
-      // second: normal do vértice
-      std::vector<std::pair<Vec3f, Vec3f>> vertexes;
+      pipeline::ClipPolygon<pipeline::FlatVertex> polygon;
 
-      // percore os vértices no sentido anti-horário
-      while (true)
+      for (int i = 0; i < 3; i++)
       {
-        vertexes.push_back(std::make_pair(he->origin->vertex_screen, he->origin->normal));
+        const Vertex *origin = corners[i]->origin;
+        Vec3f normal_object = compressed ? compressed->normal(corners[i]->index) : (corner_normals.empty() ? origin->normal : corner_normals[corners[i]->index]);
 
-        he = he->next;
-        if (he == face->he)
-          break;
-      }
-
-      // Posição da camera (player)
-      Vec3f eye = player->position;
-      // Material do objeto
-      models::Material object_material = object->material;
+        // Posição homogênea de tela (desfaz a divisão por w da projeção)
+        recorded.position[i] = {origin->vertex_screen.x * origin->screen_w, origin->vertex_screen.y * origin->screen_w, origin->screen_w};
+        recorded.normal[i] = normal_to_world(object->inverse_model, normal_object);
 
-      // O vetor normal da face é calculado na ocultação de faces
-      // precisa recortar o vetor normal do vértice também (assim simplifica o calculo da interpolação)
-      vertexes = pipeline::clip_2D_polygon(vertexes, min_viewport, max_viewport);
+        pipeline::FlatVertex vertex;
+        vertex.position = origin->vertex_screen;
+        vertex.w = origin->screen_w;
+        polygon.push(vertex);
+      }
 
-      // Se o vetor de vertices for menor que 3, não é possível formar um polígono, então não rasteriza.
-      if (vertexes.size() < 3)
+      if (!pipeline::clip_triangle(polygon, clip_window, list.clip_stats))
         continue;
 
-      pipeline::fill_polygon_phong(vertexes, object->getCentroid(), global_light, omni_lights, eye, object_material, z_buffer, color_buffer);
+      pipeline::DrawPayload payload;
+      payload.kind = pipeline::CommandKind::VISIBILITY;
+      payload.visibility_id = pipeline::visibility_id(index, triangle);
+      list.draw(polygon, payload);
     }
   }
-
-  // Resetar a clipping flag de cada vértice para a próxima iteração
-  for (auto object : objects)
-    object->is_visible = true;
 }
 
 /**
- @todo Está com problema na estrutura
-
- O mapeamento de textura é feito por face. Por isso cada vértice de cada face tem seu par (u, v).
-
- As malhas poligonais esta triangularizando um cubo, mas usando UVs únicas por vértice global.
- Isso funciona para a primeira face, mas para as outras faces os vértices compartilhados têm UVs diferentes
- para cada face — ou seja, o mesmo vértice não pode ter múltiplas UVs.
- Isso é o que causa as distorções nas outras faces.
-
- O que precisa fazer:
+ * @brief Nível de luz de uma face no colormap
+ *
+ * @param global_light Luz global
+ * @param omni_lights Luzes omni
+ * @param centroid Centroide da face (SRU)
+ * @param normal Normal da face (SRU)
+ * @return int Linha do colormap
+ *
+ * @note A luz é monocromática (luminância), como no colormap do Quake: a cor vem só da textura
+ */
+static int face_light_level(const models::GlobalLight &global_light, const std::vector<models::Omni> &omni_lights, const Vec3f &centroid, const Vec3f &normal)
+{
+  auto luminance = [](float r, float g, float b)
+  { return (0.299f * r + 0.587f * g + 0.114f * b) / 255.0f; };
 
- 1. Cada face deve ter seus próprios vértices se usar UVs diferentes, mesmo que a posição 3D seja a mesma.
+  // Parcela ambiente fixa, para as faces de costas para as lâmpadas não ficarem pretas
+  float intensity = 0.25f * luminance(global_light.intensity.r, global_light.intensity.g, global_light.intensity.b);
 
- 2. Não dá para simplesmente atribuir UVs nos vértices globais do cubo, pois um vértice pode estar na face da frente (UV = 0,0) e na face do topo (UV = 1,0) ao mesmo tempo — isso não funciona no pipeline atual.
+  for (const auto &lamp : omni_lights)
+  {
+    float cos_theta = Vector3DotProduct(normal, Vector3Normalize(lamp.position - centroid));
+    if (cos_theta > 0.0f)
+      intensity += luminance(lamp.intensity.r, lamp.intensity.g, lamp.intensity.b) * cos_theta;
+  }
 
- Alternativamente pode se fazer:
+  return models::Colormap::level(intensity);
+}
 
- 1. O que você pode fazer é colocar as tuplas (u, v)
-    na mesma sequência com a qual se percorrem os vértices da face.
-    Assim, fica uma relação implícita.
-    O primeiro par u, v corresponde ao primeiro vértice da face e assim sucessivamente.
+/**
+ * @brief Grava os comandos com as texturas
+ *
+ * @param object Instância a ser rasterizada
+ * @param list Lista de comandos
+ *
+ * @note O mapeamento de textura é feito por face: um vértice do cubo pode estar na face da frente (UV = 0,0)
+ *       e na face do topo (UV = 1,0) ao mesmo tempo. Por isso as UVs são lidas dos atributos por canto
+ *       da malha (Mesh::corner_uvs, indexados pela meia aresta), sem duplicar os vértices.
+ * @note Malhas sem UV por canto usam a UV do vértice (ou um mapeamento planar, se o vértice não tiver UV)
  */
-void Scene::apply_pipeline_texture()
+void Scene::record_texture(MeshInstance *object, pipeline::CommandList &list)
 {
-  // Pré-computação do que está dentro da visão do jogador
-  clipping();
+  MeshAsset *mesh = object->asset;
 
-  // Matrizes de transformação
-  Matrix sru_src_matrix = pipeline::sru_to_src(player->position, player->target);
-  Matrix projection_matrix = pipeline::projection(player->position, player->target, player->d);
-  Matrix viewport_matrix = pipeline::src_to_srt(min_window, min_viewport, max_window, max_viewport, true);
+  bool has_corner_uvs = !mesh->corner_uvs.empty();
+  // UVs de 16 bits do fluxo comprimido (preparado em project_instance)
+  const models::CompressedVertices *compressed = compressed_vertices && mesh->compressed.hasUVs() ? &mesh->compressed : nullptr;
 
-  Matrix pipeline_matrix = MatrixMultiply(viewport_matrix, projection_matrix);
-  pipeline_matrix = MatrixMultiply(pipeline_matrix, sru_src_matrix);
+  // Malhas sem textura ficam apenas com o wireframe
+  if (!mesh->texture)
+    return;
 
-  Vec4f vectorResult = Vec4f();
+  // Formato, layout e UVs planares já foram preparados em prepare_instance
+  bool use_indices = indexed();
 
-  // Aplica pipeline em todos os objetos
-  for (auto object : objects)
+  // Linhas de depuração das faces
+  pipeline::DrawPayload lines;
+  lines.kind = use_indices ? pipeline::CommandKind::LINES_INDEXED : pipeline::CommandKind::LINES;
+  lines.color = models::CYAN;
+  lines.color_index = use_indices ? palette.nearest(models::CYAN) : 0;
+  std::vector<Vec3f> line_vertexes;
+
+  // A iluminação é calculada no SRU
+  const models::Material &object_material = object->getMaterial();
+
+  // Rasterização de cada face
+  for (auto face : mesh->faces)
   {
-    if (!object->is_visible)
+    if (!face->visible)
       continue;
 
-    // Aplica o pipeline em todos os vértices
-    for (auto v : object->vertexes)
+    // Desenha linhas para depuração
+    record_face_lines(face, player->near, lines, line_vertexes, list);
+
+    Vec3f centroid = point_to_world(object->model, face->centroid);
+    Vec3f normal = normal_to_world(object->inverse_model, face->normal);
+
+    // No modo de 8 bits a luz da face escolhe uma linha do colormap
+    const models::Uint8 *colormap_row = use_indices ? colormap.table[face_light_level(global_light, omni_lights, centroid, normal)] : nullptr;
+
+    HalfEdge *first = face->he;
+    for (HalfEdge *he = first->next; he->next != first; he = he->next)
     {
-      vectorResult = MatrixMultiplyVector(pipeline_matrix, v->vertex);
+      HalfEdge *corners[3] = {first, he, he->next};
 
-      v->vertex_screen = {vectorResult.x / vectorResult.w,
-                          vectorResult.y / vectorResult.w,
-                          vectorResult.z};
+      // coordenadas de tela + coordenada UV do canto
+      pipeline::ClipPolygon<pipeline::TextureVertex> polygon;
 
-      // Garantir que u, v já estão definidos (normalizados entre 0 e 1)
-      // Para cubo simples ou UV planar
-      if (!v->has_uv)
+      for (auto corner : corners)
       {
-        v->u = (v->vertex.x + 1.0f) / 2.0f; // mapeia -1..1 -> 0..1
-        v->v = (v->vertex.y + 1.0f) / 2.0f;
-        v->has_uv = true;
+        Vec2f uv = compressed ? compressed->uv(corner->index) : has_corner_uvs ? mesh->corner_uvs[corner->index] : Vec2f(corner->origin->u, corner->origin->v);
+
+        pipeline::TextureVertex vertex;
+        vertex.position = corner->origin->vertex_screen;
+        vertex.w = corner->origin->screen_w;
+        vertex.attributes = {uv.x, uv.y};
+        polygon.push(vertex);
       }
-    }
 
-    // Determina visibilidade das faces
-    for (auto face : object->faces)
-    {
-      face->visible = face->is_visible(player->position);
+      // A UV é recortada junto com a posição
+      if (!pipeline::clip_triangle(polygon, clip_window, list.clip_stats))
+        continue;
+
+      // Preenchimento da face com textura
+      pipeline::DrawPayload payload;
+      payload.kind = use_indices ? pipeline::CommandKind::TEXTURE_INDEXED : pipeline::CommandKind::TEXTURE;
+      payload.material = &object_material;
+      payload.texture = mesh->texture.get();
+      payload.colormap_row = colormap_row;
+      payload.centroid = centroid;
+      payload.normal = normal;
+      list.draw(polygon, payload);
     }
   }
+}
 
-  // Inicializa buffers
-  initialize_buffers();
+/**
+ * @brief Grava os comandos sem iluminação, usando as cores por canto da malha
+ *
+ * @param object Instância a ser rasterizada
+ * @param list Lista de comandos
+ *
+ * @note Malhas sem cores por canto não são preenchidas (apenas o wireframe é desenhado)
+ */
+void Scene::record_colors(MeshInstance *object, pipeline::CommandList &list)
+{
+  MeshAsset *mesh = object->asset;
 
-  // Rasterização de cada face
-  for (auto object : objects)
+  if (mesh->corner_colors.empty())
+    return;
+
+  for (auto face : mesh->faces)
   {
-    if (!object->is_visible)
+    if (!face->visible)
       continue;
 
-    for (auto face : object->faces)
+    HalfEdge *first = face->he;
+    for (HalfEdge *he = first->next; he->next != first; he = he->next)
     {
-      if (!face->visible)
-        continue;
+      HalfEdge *corners[3] = {first, he, he->next};
 
-      HalfEdge *he = face->he;
-      std::vector<Vertex *> vertexes;
+      // coordenadas de tela + cor do canto
+      pipeline::ClipPolygon<pipeline::GouraudVertex> polygon;
 
-      while (true)
+      for (auto corner : corners)
       {
-        vertexes.push_back(he->origin);
-        he = he->next;
-        if (he == face->he)
-          break;
-      }
+        const models::Color &color = mesh->corner_colors[corner->index];
 
-      // vertexes = pipeline::clip_2D_polygon(vertexes, min_viewport, max_viewport);
+        pipeline::GouraudVertex vertex;
+        vertex.position = corner->origin->vertex_screen;
+        vertex.w = corner->origin->screen_w;
+        vertex.attributes = {static_cast<float>(color.r), static_cast<float>(color.g), static_cast<float>(color.b)};
+        polygon.push(vertex);
+      }
 
-      if (vertexes.size() < 3)
+      if (!pipeline::clip_triangle(polygon, clip_window, list.clip_stats))
         continue;
 
-      // Desenha linhas para depuração
-      std::vector<Vec3f> vertex_positions;
-      for (auto v : vertexes)
-        vertex_positions.push_back(v->vertex_screen);
-
-      pipeline::DrawLineBuffer(vertex_positions, models::CYAN, z_buffer, color_buffer);
-
-      // Preenchimento da face com textura
-      pipeline::fill_polygon_texture(vertexes, object->texture, global_light, omni_lights, player->position,
-                                     face->centroid, face->normal, object->material, z_buffer, color_buffer);
+      pipeline::DrawPayload payload;
+      payload.kind = pipeline::CommandKind::GOURAUD;
+      list.draw(polygon, payload);
     }
   }
-
-  // Resetar flag de visibilidade
-  for (auto object : objects)
-    object->is_visible = true;
 }
 
 bool Scene::checkPlayerCollision(const Vec3f &newPos)
@@ -647,7 +1283,7 @@ bool Scene::checkPlayerCollision(const Vec3f &newPos)
 
   for (auto obj : objects)
   {
-    if (obj->bounds.intersects(playerBox))
+    if (obj->world_bounds.intersects(playerBox))
       return true;
   }
   return false;
@@ -0,0 +1,208 @@
+#include <scene/scene_graph.hpp>
+
+/**
+ * @brief Adiciona um nó ao grafo de cena
+ *
+ * @param parent Nó pai (NO_PARENT para adicionar um nó raiz)
+ * @param local Transformação local do nó
+ * @param instance Instância controlada pelo nó (opcional)
+ * @param id Identificador do nó
+ * @return NodeHandle Identificador do nó criado, ou INVALID_NODE se o pai já foi removido (nenhum nó é criado)
+ *
+ * @note O nó é inserido no final da subárvore do pai para manter a pré-ordem
+ * @note A inserção desloca os nós seguintes (O(n)), é pensada para a montagem da cena e não para cada quadro
+ */
+SceneGraph::NodeHandle SceneGraph::add_node(NodeHandle parent, const Matrix &local, MeshInstance *instance, std::string id)
+{
+  // Um handle antigo não vira raiz silenciosamente
+  if (parent != NO_PARENT && !valid(parent))
+    return INVALID_NODE;
+
+  int parent_index = parent == NO_PARENT ? -1 : handle_to_index[parent];
+  int position = parent_index < 0 ? static_cast<int>(nodes.size()) : parent_index + nodes[parent_index].subtree_size;
+
+  // Os nós que estão depois da posição de inserção andam uma casa
+  for (int i = position; i < static_cast<int>(nodes.size()); i++)
+    handle_to_index[index_to_handle[i]]++;
+
+  for (auto &node : nodes)
+  {
+    if (node.parent >= position)
+      node.parent++;
+  }
+
+  SceneNode node;
+  node.local = local;
+  node.world = local;
+  node.parent = parent_index;
+  node.subtree_size = 1;
+  node.dirty = true;
+  node.child_dirty = false;
+  node.instance = instance;
+  node.id = id;
+
+  NodeHandle handle = static_cast<NodeHandle>(handle_to_index.size());
+  handle_to_index.push_back(position);
+
+  nodes.insert(nodes.begin() + position, node);
+  index_to_handle.insert(index_to_handle.begin() + position, handle);
+
+  // Os ancestrais ganham um nó na subárvore
+  for (int i = parent_index; i >= 0; i = nodes[i].parent)
+    nodes[i].subtree_size++;
+
+  mark_ancestors(position);
+
+  return handle;
+}
+
+/**
+ * @brief Remove um nó e toda a sua subárvore do grafo
+ *
+ * @param node Nó a ser removido
+ * @param instances Recebe as instâncias associadas aos nós removidos (opcional)
+ *
+ * @note As instâncias associadas não são liberadas, elas pertencem à cena (veja Scene::remove_node)
+ */
+void SceneGraph::remove_node(NodeHandle node, std::vector<MeshInstance *> *instances)
+{
+  int index = handle_to_index[node];
+  if (index < 0)
+    return;
+
+  int size = nodes[index].subtree_size;
+  int end = index + size;
+
+  if (instances)
+  {
+    for (int i = index; i < end; i++)
+      if (nodes[i].instance)
+        instances->push_back(nodes[i].instance);
+  }
+
+  for (int i = nodes[index].parent; i >= 0; i = nodes[i].parent)
+    nodes[i].subtree_size -= size;
+
+  for (int i = index; i < end; i++)
+    handle_to_index[index_to_handle[i]] = -1;
+
+  for (int i = end; i < static_cast<int>(nodes.size()); i++)
+  {
+    handle_to_index[index_to_handle[i]] -= size;
+    if (nodes[i].parent >= end)
+      nodes[i].parent -= size;
+  }
+
+  nodes.erase(nodes.begin() + index, nodes.begin() + end);
+  index_to_handle.erase(index_to_handle.begin() + index, index_to_handle.begin() + end);
+}
+
+/**
+ * @brief Desassocia uma instância dos nós que a controlam
+ *
+ * @param instance Instância que está saindo da cena
+ *
+ * @note Os nós continuam no grafo (como pivôs), apenas deixam de atualizar a instância
+ */
+void SceneGraph::detach_instance(const MeshInstance *instance)
+{
+  for (auto &node : nodes)
+  {
+    if (node.instance == instance)
+      node.instance = nullptr;
+  }
+}
+
+/**
+ * @brief Altera a transformação local de um nó
+ *
+ * @param node Nó
+ * @param local Nova transformação local
+ *
+ * @note Apenas marca o nó como sujo, o cálculo acontece em update()
+ */
+void SceneGraph::set_local(NodeHandle node, const Matrix &local)
+{
+  int index = handle_to_index[node];
+  nodes[index].local = local;
+  nodes[index].dirty = true;
+  mark_ancestors(index);
+}
+
+const Matrix &SceneGraph::get_local(NodeHandle node) const
+{
+  return nodes[handle_to_index[node]].local;
+}
+
+const Matrix &SceneGraph::get_world(NodeHandle node) const
+{
+  return nodes[handle_to_index[node]].world;
+}
+
+SceneNode &SceneGraph::get_node(NodeHandle node)
+{
+  return nodes[handle_to_index[node]];
+}
+
+/**
+ * @brief Recalcula as matrizes globais das subárvores sujas
+ *
+ * @note O vetor é percorrido em pré-ordem, então o pai sempre é atualizado antes dos filhos
+ * @note Subárvores sem nós sujos são puladas de uma vez (subtree_size)
+ * @note Quando um nó está sujo, toda a sua subárvore é recalculada em sequência, de forma contínua na memória
+ * @note A matriz de modelo e a bounding box (usada no recorte) das instâncias são atualizadas no mesmo passo
+ */
+void SceneGraph::update()
+{
+  updated_nodes = 0;
+
+  int count = static_cast<int>(nodes.size());
+  int i = 0;
+
+  while (i < count)
+  {
+    SceneNode &node = nodes[i];
+
+    if (node.dirty)
+    {
+      int end = i + node.subtree_size;
+
+      for (int k = i; k < end; k++)
+      {
+        SceneNode &current = nodes[k];
+
+        current.world = current.parent < 0 ? current.local : MatrixMultiply(nodes[current.parent].world, current.local);
+        current.dirty = false;
+        current.child_dirty = false;
+
+        if (current.instance != nullptr)
+          current.instance->setModel(current.world);
+      }
+
+      updated_nodes += end - i;
+      i = end;
+    }
+    else if (node.child_dirty)
+    {
+      // Desce na subárvore procurando os nós sujos
+      node.child_dirty = false;
+      i++;
+    }
+    else
+    {
+      // Subárvore limpa
+      i += node.subtree_size;
+    }
+  }
+}
+
+/**
+ * @brief Marca os ancestrais de um nó indicando que há um descendente sujo
+ *
+ * @param index Índice do nó
+ */
+void SceneGraph::mark_ancestors(int index)
+{
+  for (int i = nodes[index].parent; i >= 0 && !nodes[i].child_dirty; i = nodes[i].parent)
+    nodes[i].child_dirty = true;
+}
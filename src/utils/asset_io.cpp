@@ -0,0 +1,836 @@
+#include <utils/asset_io.hpp>
+#include <utils/pak.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <future>
+
+#ifdef _WIN32
+#include <cstdio>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// io_uring pelas syscalls (sem liburing): apenas o cabeçalho do kernel é necessário
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#define ASSET_IO_URING 1
+#endif
+#endif
+
+namespace io
+{
+  /**
+   * @brief Ajusta o trecho pedido ao tamanho do arquivo
+   *
+   * @param file_size Tamanho do arquivo
+   * @param offset Início do trecho
+   * @param size Tamanho do trecho (0 = até o fim), recebe o tamanho efetivo
+   * @return true Se o trecho cabe no arquivo
+   */
+  static bool resolve_range(std::size_t file_size, std::size_t offset, std::size_t &size)
+  {
+    if (offset > file_size || (size != 0 && size > file_size - offset))
+      return false;
+
+    if (size == 0)
+      size = file_size - offset;
+    return true;
+  }
+
+  /**
+   * @brief Lê um trecho de um arquivo (backend sem io_uring)
+   *
+   * @param path Caminho do arquivo
+   * @param offset Início do trecho
+   * @param size Tamanho do trecho (0 = até o fim)
+   * @param data Recebe o conteúdo
+   * @param error Recebe a mensagem de erro
+   * @return true Se o trecho foi lido
+   */
+  static bool read_file(const std::string &path, std::size_t offset, std::size_t size, std::vector<std::uint8_t> &data, std::string &error)
+  {
+#ifdef _WIN32
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file)
+    {
+      error = "Erro ao abrir '" + path + "'";
+      return false;
+    }
+
+    long file_size = -1;
+    if (std::fseek(file, 0, SEEK_END) == 0)
+      file_size = std::ftell(file);
+
+    if (file_size < 0)
+    {
+      std::fclose(file);
+      error = "Arquivo inacessível: '" + path + "'";
+      return false;
+    }
+
+    if (!resolve_range(static_cast<std::size_t>(file_size), offset, size))
+    {
+      std::fclose(file);
+      error = "Arquivo truncado: '" + path + "'";
+      return false;
+    }
+
+    data.resize(size);
+    bool ok = std::fseek(file, static_cast<long>(offset), SEEK_SET) == 0 && std::fread(data.data(), 1, data.size(), file) == data.size();
+    std::fclose(file);
+
+    if (!ok)
+      error = "Erro ao ler '" + path + "'";
+    return ok;
+#else
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+      error = "Erro ao abrir '" + path + "': " + std::strerror(errno);
+      return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+      error = "Arquivo inacessível: '" + path + "'";
+      close(fd);
+      return false;
+    }
+
+    if (!resolve_range(static_cast<std::size_t>(info.st_size), offset, size))
+    {
+      error = "Arquivo truncado: '" + path + "'";
+      close(fd);
+      return false;
+    }
+
+    data.resize(size);
+
+    // pread pode ler menos que o pedido (arquivos grandes, sinais)
+    std::size_t done = 0;
+    while (done < data.size())
+    {
+      ssize_t count = pread(fd, data.data() + done, data.size() - done, static_cast<off_t>(offset + done));
+      if (count < 0 && errno == EINTR)
+        continue;
+
+      if (count <= 0)
+      {
+        error = count < 0 ? "Erro ao ler '" + path + "': " + std::strerror(errno) : "Arquivo truncado: '" + path + "'";
+        close(fd);
+        return false;
+      }
+
+      done += static_cast<std::size_t>(count);
+    }
+
+    close(fd);
+    return true;
+#endif
+  }
+
+#ifdef ASSET_IO_URING
+  // Leitura em andamento no kernel (o endereço vai no user_data do SQE)
+  struct AssetIO::InFlight
+  {
+    Request request;
+    int fd = -1;
+    std::vector<std::uint8_t> data;
+    std::size_t offset = 0; // Bytes já lidos (a partir de request.offset)
+    iovec buffer;
+  };
+
+  // Filas compartilhadas com o kernel (submissão e conclusão), mapeadas a partir do fd do io_uring
+  struct AssetIO::Ring
+  {
+    void *sq_map = MAP_FAILED;
+    void *cq_map = MAP_FAILED;
+    void *sqe_map = MAP_FAILED;
+    std::size_t sq_map_size = 0;
+    std::size_t cq_map_size = 0;
+    std::size_t sqe_map_size = 0;
+
+    unsigned *sq_head = nullptr;
+    unsigned *sq_tail = nullptr;
+    unsigned *sq_mask = nullptr;
+    unsigned *sq_array = nullptr;
+    io_uring_sqe *sqes = nullptr;
+
+    unsigned *cq_head = nullptr;
+    unsigned *cq_tail = nullptr;
+    unsigned *cq_mask = nullptr;
+    io_uring_cqe *cqes = nullptr;
+
+    unsigned queued = 0; // SQEs escritos e ainda não enviados ao kernel
+
+    // Escreve um SQE na fila de submissão (enviado no próximo io_uring_enter)
+    // Só a thread do io_uring escreve na fila, então o tail é lido sem sincronização
+    void push(const io_uring_sqe &entry)
+    {
+      unsigned tail = *sq_tail;
+      unsigned index = tail & *sq_mask;
+      sqes[index] = entry;
+      sq_array[index] = index;
+      __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+      queued++;
+    }
+
+    // Pede ao kernel o restante do arquivo (leituras curtas são reenviadas a partir do offset)
+    void submit_read(InFlight &read)
+    {
+      read.buffer.iov_base = read.data.data() + read.offset;
+      read.buffer.iov_len = read.data.size() - read.offset;
+
+      io_uring_sqe entry;
+      std::memset(&entry, 0, sizeof(entry));
+      entry.opcode = IORING_OP_READV;
+      entry.fd = read.fd;
+      entry.off = read.request.offset + read.offset;
+      entry.addr = reinterpret_cast<std::uint64_t>(&read.buffer);
+      entry.len = 1;
+      entry.user_data = reinterpret_cast<std::uint64_t>(&read);
+      push(entry);
+    }
+  };
+#else
+  struct AssetIO::Ring
+  {
+  };
+#endif
+
+  AssetIO::AssetIO(bool use_io_uring)
+  {
+    if (use_io_uring)
+      ring_active = open_ring();
+
+    // Sistema de jobs: executa os callbacks (e as leituras quando não há io_uring)
+    unsigned int hardware = std::thread::hardware_concurrency();
+    unsigned int count = std::clamp(hardware > 1 ? hardware - 1 : 1u, 1u, 4u);
+    for (unsigned int i = 0; i < count; i++)
+      workers.emplace_back(&AssetIO::work, this);
+
+    if (ring_active)
+      ring_thread = std::thread(&AssetIO::run_ring, this);
+  }
+
+  AssetIO::~AssetIO()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+      for (auto &queue : queues)
+        queue.clear();
+      archived.clear();
+      active.clear();
+    }
+    wake.notify_all();
+    notify_ring();
+
+    for (std::thread &worker : workers)
+      worker.join();
+    if (ring_thread.joinable())
+      ring_thread.join();
+
+    close_ring();
+  }
+
+  /**
+   * @brief Pede a leitura de um arquivo
+   *
+   * @param path Caminho do arquivo
+   * @param callback Chamado com o conteúdo (ou o erro) na thread escolhida por delivery
+   * @param priority Posição na fila
+   * @param delivery Threads de jobs ou thread principal (pump)
+   * @return RequestId Identificador para cancel
+   */
+  RequestId AssetIO::read(const std::string &path, Callback callback, Priority priority, Delivery delivery)
+  {
+    return read(path, 0, 0, std::move(callback), priority, delivery);
+  }
+
+  /**
+   * @brief Pede a leitura de um trecho de um arquivo
+   *
+   * @param path Caminho do arquivo
+   * @param offset Início do trecho
+   * @param size Tamanho do trecho (0 = até o fim do arquivo)
+   * @param callback Chamado com o trecho (ou o erro) na thread escolhida por delivery
+   * @param priority Posição na fila
+   * @param delivery Threads de jobs ou thread principal (pump)
+   * @return RequestId Identificador para cancel
+   *
+   * @note Usada para ler só alguns níveis de um arquivo de textura (ex.: os níveis grossos de um .bc1)
+   */
+  RequestId AssetIO::read(const std::string &path, std::size_t offset, std::size_t size, Callback callback, Priority priority, Delivery delivery)
+  {
+    bool archive = pak::contains(path);
+
+    RequestId id;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      id = next_id++;
+      active.insert(id);
+
+      Request request{id, path, std::move(callback), delivery, offset, size};
+      if (archive)
+      {
+        if (priority == Priority::HIGH)
+          archived.push_front(std::move(request));
+        else
+          archived.push_back(std::move(request));
+      }
+      else
+        queues[static_cast<int>(priority)].push_back(std::move(request));
+    }
+
+    if (ring_active && !archive)
+      notify_ring();
+    else
+      wake.notify_one();
+
+    return id;
+  }
+
+  /**
+   * @brief Lê um arquivo pela fila e espera o resultado
+   *
+   * @param path Caminho do arquivo
+   * @param priority Posição na fila (alta por padrão: quem chama está parado esperando)
+   * @return ReadResult Conteúdo do arquivo (ou o erro)
+   *
+   * @note Os carregadores síncronos passam pelo mesmo caminho das leituras assíncronas (io_uring, pread ou
+   *       pacote montado), então um arquivo pedido aqui disputa a fila com os pedidos em andamento
+   */
+  ReadResult AssetIO::readBlocking(const std::string &path, Priority priority)
+  {
+    std::promise<ReadResult> promise;
+    std::future<ReadResult> future = promise.get_future();
+
+    read(path, [&promise](ReadResult &result)
+         { promise.set_value(std::move(result)); }, priority, Delivery::WORKER);
+
+    return future.get();
+  }
+
+  /**
+   * @brief Cancela um pedido
+   *
+   * @param id Identificador devolvido por read
+   * @return true Se o callback não vai ser chamado
+   *
+   * @note Um pedido que ainda está na fila sai dela. Um pedido em leitura termina normalmente e o resultado
+   *       é descartado na entrega
+   */
+  bool AssetIO::cancel(RequestId id)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (active.erase(id) == 0)
+      return false;
+
+    auto remove = [id](std::deque<Request> &queue)
+    {
+      auto it = std::find_if(queue.begin(), queue.end(), [id](const Request &request)
+                             { return request.id == id; });
+      if (it == queue.end())
+        return false;
+      queue.erase(it);
+      return true;
+    };
+
+    if (!remove(archived))
+    {
+      for (auto &queue : queues)
+      {
+        if (remove(queue))
+          break;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief Executa os callbacks entregues na thread principal
+   *
+   * @return int Número de callbacks executados
+   */
+  int AssetIO::pump()
+  {
+    int count = 0;
+    for (;;)
+    {
+      Completion completion;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (main_completions.empty())
+          break;
+
+        completion = std::move(main_completions.front());
+        main_completions.pop_front();
+        if (active.erase(completion.result.id) == 0)
+          continue;
+      }
+
+      completion.callback(completion.result);
+      count++;
+    }
+
+    return count;
+  }
+
+  int AssetIO::pending()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<int>(active.size());
+  }
+
+  // Próximo pedido da fila de maior prioridade (com o mutex travado)
+  bool AssetIO::next_request(Request &request)
+  {
+    for (auto &queue : queues)
+    {
+      if (!queue.empty())
+      {
+        request = std::move(queue.front());
+        queue.pop_front();
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // Entrega o resultado de uma leitura (descartado se o pedido foi cancelado enquanto era lido)
+  void AssetIO::complete(Request &request, ReadResult &result)
+  {
+    result.id = request.id;
+    result.path = std::move(request.path);
+    if (!result.data)
+    {
+      result.data = result.storage.data();
+      result.size = result.storage.size();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!active.count(request.id))
+        return;
+
+      Completion completion{std::move(request.callback), std::move(result)};
+      if (request.delivery == Delivery::WORKER)
+        worker_completions.push_back(std::move(completion));
+      else
+        main_completions.push_back(std::move(completion));
+    }
+
+    if (request.delivery == Delivery::WORKER)
+      wake.notify_one();
+  }
+
+  /**
+   * @brief Laço das threads de jobs
+   *
+   * @note Os callbacks passam na frente das leituras: um arquivo lido é decodificado antes de outro ser lido
+   */
+  void AssetIO::work()
+  {
+    for (;;)
+    {
+      Completion completion;
+      Request request;
+      bool has_completion = false, from_archive = false;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait(lock, [this]
+                  { return stopping || !worker_completions.empty() || !archived.empty() ||
+                           (!ring_active && std::any_of(std::begin(queues), std::end(queues), [](const std::deque<Request> &queue)
+                                                       { return !queue.empty(); })); });
+        if (stopping)
+          return;
+
+        if (!worker_completions.empty())
+        {
+          completion = std::move(worker_completions.front());
+          worker_completions.pop_front();
+          if (active.erase(completion.result.id) == 0)
+            continue;
+          has_completion = true;
+        }
+        else if (!archived.empty())
+        {
+          request = std::move(archived.front());
+          archived.pop_front();
+          from_archive = true;
+        }
+        else if (!next_request(request))
+          continue;
+      }
+
+      if (has_completion)
+      {
+        completion.callback(completion.result);
+        continue;
+      }
+
+      ReadResult result;
+      if (from_archive)
+      {
+        // Entrada sem compressão: o resultado aponta para o pacote mapeado. Comprimida: o trecho fica em storage
+        pak::File file;
+        std::size_t size = request.size;
+        result.ok = pak::open(request.path, file) && resolve_range(file.size, request.offset, size);
+        if (result.ok && file.storage.empty())
+        {
+          result.data = file.data + request.offset;
+          result.size = size;
+        }
+        else if (result.ok)
+        {
+          file.storage.resize(request.offset + size);
+          file.storage.erase(file.storage.begin(), file.storage.begin() + request.offset);
+          result.storage = std::move(file.storage);
+        }
+        if (!result.ok)
+          result.error = "Erro ao ler '" + request.path + "' do pacote";
+      }
+      else
+        result.ok = read_file(request.path, request.offset, request.size, result.storage, result.error);
+      complete(request, result);
+    }
+  }
+
+#ifdef ASSET_IO_URING
+  /**
+   * @brief Cria o io_uring e mapeia as filas
+   *
+   * @return true Se o io_uring está disponível (senão as leituras ficam com as threads de jobs)
+   */
+  bool AssetIO::open_ring()
+  {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+
+    // Leituras + o poll do eventfd
+    int fd = static_cast<int>(syscall(__NR_io_uring_setup, QUEUE_DEPTH + 1, &params));
+    if (fd < 0)
+      return false;
+
+    ring_fd = fd;
+    ring = std::make_unique<Ring>();
+    Ring &r = *ring;
+
+    r.sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    r.cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    r.sqe_map_size = params.sq_entries * sizeof(io_uring_sqe);
+
+    // Kernels novos mapeiam as duas filas juntas
+    bool single_map = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_map)
+      r.sq_map_size = r.cq_map_size = std::max(r.sq_map_size, r.cq_map_size);
+
+    r.sq_map = mmap(nullptr, r.sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    r.cq_map = single_map ? r.sq_map : mmap(nullptr, r.cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    r.sqe_map = mmap(nullptr, r.sqe_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    event_fd = eventfd(0, EFD_CLOEXEC);
+
+    if (r.sq_map == MAP_FAILED || r.cq_map == MAP_FAILED || r.sqe_map == MAP_FAILED || event_fd < 0)
+    {
+      close_ring();
+      return false;
+    }
+
+    auto *sq = static_cast<std::uint8_t *>(r.sq_map);
+    auto *cq = static_cast<std::uint8_t *>(r.cq_map);
+    r.sq_head = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    r.sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    r.sq_mask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    r.sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    r.sqes = static_cast<io_uring_sqe *>(r.sqe_map);
+    r.cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    r.cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    r.cq_mask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    r.cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    return true;
+  }
+
+  void AssetIO::close_ring()
+  {
+    if (ring)
+    {
+      if (ring->sqe_map != MAP_FAILED)
+        munmap(ring->sqe_map, ring->sqe_map_size);
+      if (ring->cq_map != MAP_FAILED && ring->cq_map != ring->sq_map)
+        munmap(ring->cq_map, ring->cq_map_size);
+      if (ring->sq_map != MAP_FAILED)
+        munmap(ring->sq_map, ring->sq_map_size);
+      ring.reset();
+    }
+
+    if (event_fd >= 0)
+      close(event_fd);
+    if (ring_fd >= 0)
+      close(ring_fd);
+    event_fd = ring_fd = -1;
+  }
+
+  // Acorda a thread do io_uring (pedido novo ou destruição)
+  void AssetIO::notify_ring()
+  {
+    if (event_fd < 0)
+      return;
+
+    std::uint64_t one = 1;
+    ssize_t written = ::write(event_fd, &one, sizeof(one));
+    (void)written;
+  }
+
+  /**
+   * @brief Laço da thread do io_uring
+   *
+   * @note Cada volta completa a fila até QUEUE_DEPTH leituras, envia os SQEs e dorme no mesmo io_uring_enter
+   *       até uma leitura terminar ou o eventfd receber um pedido novo (poll no próprio anel)
+   * @note open/fstat são feitos nesta thread: o que pesa é a leitura, que fica com o kernel
+   * @note Se o io_uring_enter falha (ex.: EBUSY com a fila de conclusões cheia), a thread espera um tempo que
+   *       dobra a cada falha seguida. Depois de RING_MAX_FAILURES falhas seguidas as leituras passam para as
+   *       threads de jobs (pread) e a thread termina
+   */
+  void AssetIO::run_ring()
+  {
+    Ring &r = *ring;
+    unsigned in_flight = 0;
+    bool event_armed = false;
+    int failures = 0; // io_uring_enter seguidos com erro
+
+    // Entrega as conclusões que estão na fila do kernel
+    auto reap = [&]()
+    {
+      unsigned head = *r.cq_head;
+      unsigned tail = __atomic_load_n(r.cq_tail, __ATOMIC_ACQUIRE);
+      for (; head != tail; head++)
+      {
+        const io_uring_cqe &cqe = r.cqes[head & *r.cq_mask];
+        int res = cqe.res;
+
+        if (cqe.user_data == 0)
+        {
+          std::uint64_t value;
+          ssize_t count = ::read(event_fd, &value, sizeof(value));
+          (void)count;
+          event_armed = false;
+          continue;
+        }
+
+        auto *read = reinterpret_cast<InFlight *>(cqe.user_data);
+        if (res == -EINTR || res == -EAGAIN)
+        {
+          r.submit_read(*read);
+          continue;
+        }
+
+        if (res > 0)
+        {
+          read->offset += static_cast<std::size_t>(res);
+          if (read->offset < read->data.size())
+          {
+            r.submit_read(*read);
+            continue;
+          }
+        }
+
+        ReadResult result;
+        result.ok = res > 0;
+        if (res < 0)
+          result.error = "Erro ao ler '" + read->request.path + "': " + std::strerror(-res);
+        else if (res == 0)
+          result.error = "Arquivo truncado: '" + read->request.path + "'";
+        else
+          result.storage = std::move(read->data);
+
+        close(read->fd);
+        complete(read->request, result);
+        delete read;
+        in_flight--;
+      }
+      __atomic_store_n(r.cq_head, head, __ATOMIC_RELEASE);
+    };
+
+    for (;;)
+    {
+      if (!event_armed)
+      {
+        io_uring_sqe entry;
+        std::memset(&entry, 0, sizeof(entry));
+        entry.opcode = IORING_OP_POLL_ADD;
+        entry.fd = event_fd;
+        entry.poll32_events = POLLIN;
+        entry.user_data = 0;
+        r.push(entry);
+        event_armed = true;
+      }
+
+      // Pedidos novos, em ordem de prioridade
+      std::vector<Request> started;
+      bool stop, backlog;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = stopping;
+
+        Request request;
+        while (!stop && in_flight + started.size() < QUEUE_DEPTH && next_request(request))
+          started.push_back(std::move(request));
+
+        backlog = std::any_of(std::begin(queues), std::end(queues), [](const std::deque<Request> &queue)
+                              { return !queue.empty(); });
+      }
+
+      if (stop && in_flight == 0)
+        break;
+
+      for (Request &request : started)
+      {
+        auto read = std::make_unique<InFlight>();
+        read->request = std::move(request);
+        read->fd = open(read->request.path.c_str(), O_RDONLY | O_CLOEXEC);
+
+        ReadResult result;
+        struct stat info;
+        if (read->fd < 0 || fstat(read->fd, &info) != 0)
+        {
+          result.error = "Erro ao abrir '" + read->request.path + "': " + std::strerror(errno);
+          if (read->fd >= 0)
+            close(read->fd);
+          complete(read->request, result);
+          continue;
+        }
+
+        std::size_t size = read->request.size;
+        if (!resolve_range(static_cast<std::size_t>(info.st_size), read->request.offset, size))
+        {
+          close(read->fd);
+          result.error = "Arquivo truncado: '" + read->request.path + "'";
+          complete(read->request, result);
+          continue;
+        }
+
+        if (size == 0)
+        {
+          close(read->fd);
+          result.ok = true;
+          complete(read->request, result);
+          continue;
+        }
+
+        read->data.resize(size);
+        r.submit_read(*read);
+        read.release();
+        in_flight++;
+      }
+
+      // Envia os SQEs e espera pelo menos uma conclusão
+      // Se ainda há pedidos na fila e espaço no anel (ex.: arquivos que falharam no open), não espera
+      unsigned wait = backlog && !stop && in_flight < QUEUE_DEPTH ? 0 : 1;
+      int submitted = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, r.queued, wait, IORING_ENTER_GETEVENTS, nullptr, 0));
+      int error = submitted < 0 ? errno : 0;
+      if (submitted >= 0)
+      {
+        r.queued -= std::min(r.queued, static_cast<unsigned>(submitted));
+        failures = 0;
+      }
+      else if (error != EINTR && ++failures >= RING_MAX_FAILURES)
+      {
+        reap();
+        abandon_ring(in_flight);
+        while (in_flight > 0 && !stop)
+        {
+          // Leituras que o kernel já aceitou terminam sem io_uring_enter (threads do io_uring no kernel)
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          reap();
+          std::lock_guard<std::mutex> lock(mutex);
+          stop = stopping;
+        }
+        return;
+      }
+      else if (error != EINTR)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1 << failures));
+
+      reap();
+    }
+  }
+
+  /**
+   * @brief Passa as leituras do io_uring para as threads de jobs
+   *
+   * @param in_flight Leituras em andamento, recebe as que continuam com o kernel
+   *
+   * @note Os SQEs que o kernel ainda não consumiu são desfeitos e os pedidos voltam para o início da fila
+   *       (a leitura recomeça do zero com pread). Os que já foram consumidos terminam pelo anel
+   */
+  void AssetIO::abandon_ring(unsigned &in_flight)
+  {
+    Ring &r = *ring;
+    unsigned head = __atomic_load_n(r.sq_head, __ATOMIC_ACQUIRE);
+    unsigned tail = *r.sq_tail;
+
+    std::vector<Request> returned;
+    for (unsigned i = head; i != tail; i++)
+    {
+      const io_uring_sqe &entry = r.sqes[r.sq_array[i & *r.sq_mask]];
+      if (entry.user_data == 0)
+        continue;
+
+      auto *read = reinterpret_cast<InFlight *>(entry.user_data);
+      close(read->fd);
+      returned.push_back(std::move(read->request));
+      delete read;
+      in_flight--;
+    }
+
+    __atomic_store_n(r.sq_tail, head, __ATOMIC_RELEASE);
+    r.queued = 0;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (auto request = returned.rbegin(); request != returned.rend(); request++)
+        queues[static_cast<int>(Priority::HIGH)].push_front(std::move(*request));
+      ring_active = false;
+    }
+    wake.notify_all();
+  }
+#else
+  bool AssetIO::open_ring()
+  {
+    return false;
+  }
+
+  void AssetIO::close_ring()
+  {
+  }
+
+  void AssetIO::notify_ring()
+  {
+  }
+
+  void AssetIO::run_ring()
+  {
+  }
+#endif
+
+  AssetIO &shared()
+  {
+    static AssetIO instance;
+    return instance;
+  }
+}
@@ -2,62 +2,345 @@
 #include <iostream>
 #include <stdexcept>
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// A troca BGR -> RGBA usa SSSE3 (pshufb) em x86, escolhido em tempo de execução
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <tmmintrin.h>
+#define BMP_SSSE3 1
+#if defined(__GNUC__) || defined(__clang__)
+#define BMP_SSSE3_TARGET __attribute__((target("ssse3")))
+#define BMP_CPU_HAS_SSSE3() __builtin_cpu_supports("ssse3")
+#else
+#define BMP_SSSE3_TARGET
+#define BMP_CPU_HAS_SSSE3() true
+#endif
+#endif
+
 // ===================================================
-// Implementação baseada em SDL3
+// Arquivo mapeado em memória
 // ===================================================
 
-BMPImage bmp::load(const std::string &filename)
+bmp::MappedFile::MappedFile(const std::string &filename)
 {
-  // Carrega o arquivo BMP
-  SDL_Surface *surface = SDL_LoadBMP(filename.c_str());
-  if (!surface)
-    throw std::runtime_error("Erro ao carregar BMP via SDL: " + std::string(SDL_GetError()));
+#ifdef _WIN32
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    throw std::runtime_error("Erro ao abrir '" + filename + "'");
 
-  // Converter para formato RGBA8888
-  SDL_PixelFormat format = SDL_PIXELFORMAT_RGBA8888;
-  SDL_Surface *converted = SDL_ConvertSurface(surface, format);
-  SDL_DestroySurface(surface); // SDL3 usa DestroySurface, não FreeSurface
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+  {
+    CloseHandle(file);
+    throw std::runtime_error("Arquivo vazio ou inacessível: '" + filename + "'");
+  }
 
-  if (!converted)
-    throw std::runtime_error("Falha ao converter BMP para RGBA8888: " + std::string(SDL_GetError()));
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  const void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+  if (!view)
+  {
+    if (mapping)
+      CloseHandle(mapping);
+    CloseHandle(file);
+    throw std::runtime_error("Erro ao mapear '" + filename + "'");
+  }
 
-  // Cria o objeto BMPImage com os dados da imagem
-  BMPImage img;
-  img.width = converted->w;
-  img.height = converted->h;
-  img.data.resize(img.width * img.height);
+  file_handle = file;
+  mapping_handle = mapping;
+  bytes = static_cast<const std::uint8_t *>(view);
+  length = static_cast<std::size_t>(file_size.QuadPart);
+#else
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("Erro ao abrir '" + filename + "'");
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size == 0)
+  {
+    close(fd);
+    throw std::runtime_error("Arquivo vazio ou inacessível: '" + filename + "'");
+  }
+
+  void *view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // O mapeamento continua válido depois do close
+
+  if (view == MAP_FAILED)
+    throw std::runtime_error("Erro ao mapear '" + filename + "'");
+
+  bytes = static_cast<const std::uint8_t *>(view);
+  length = static_cast<std::size_t>(info.st_size);
+#endif
+}
+
+bmp::MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+  if (bytes)
+    UnmapViewOfFile(bytes);
+  if (mapping_handle)
+    CloseHandle(static_cast<HANDLE>(mapping_handle));
+  if (file_handle)
+    CloseHandle(static_cast<HANDLE>(file_handle));
+#else
+  if (bytes)
+    munmap(const_cast<std::uint8_t *>(bytes), length);
+#endif
+}
+
+// ===================================================
+// Cabeçalho
+// ===================================================
+
+static std::uint16_t read_u16(const std::uint8_t *p)
+{
+  return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+}
+
+static std::uint32_t read_u32(const std::uint8_t *p)
+{
+  return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8) |
+         (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+}
+
+// Tipos de compressão do BITMAPINFOHEADER
+#define BMP_BI_RGB 0
+#define BMP_BI_BITFIELDS 3
+
+/**
+ * @brief Lê o cabeçalho de um BMP
+ *
+ * @param data Conteúdo do arquivo (mapeado ou lido para a memória)
+ * @param size Tamanho do arquivo
+ * @return bmp::Header Dimensões, formato e posição das linhas
+ *
+ * @note Formatos suportados: 8 bits com paleta, 24 bits (BGR) e 32 bits (BGRX/BGRA, sem compressão)
+ */
+bmp::Header bmp::parse(const std::uint8_t *data, std::size_t size)
+{
+  // BITMAPFILEHEADER (14 bytes) + tamanho do cabeçalho de informações
+  if (size < 18 || data[0] != 'B' || data[1] != 'M')
+    throw std::runtime_error("Arquivo não é um BMP");
+
+  std::uint32_t info_size = read_u32(data + 14);
+  if (info_size < 40 || 14 + info_size > size)
+    throw std::runtime_error("Cabeçalho BMP não suportado");
+
+  const std::uint8_t *info = data + 14;
+  int32_t width = static_cast<int32_t>(read_u32(info + 4));
+  int32_t height = static_cast<int32_t>(read_u32(info + 8));
+  std::uint16_t bits = read_u16(info + 14);
+  std::uint32_t compression = read_u32(info + 16);
+  std::uint32_t colors_used = read_u32(info + 32);
+
+  if (width <= 0 || height == 0)
+    throw std::runtime_error("Dimensões inválidas no BMP");
 
-  const uint8_t *pixels = static_cast<uint8_t *>(converted->pixels);
-  const int pitch = converted->pitch;
+  if (bits != 8 && bits != 24 && bits != 32)
+    throw std::runtime_error("BMP com " + std::to_string(bits) + " bits por pixel não é suportado");
 
-  // Copia os pixels RGBA para o vetor
-  for (int y = 0; y < img.height; ++y)
+  if (compression != BMP_BI_RGB && !(bits == 32 && compression == BMP_BI_BITFIELDS))
+    throw std::runtime_error("BMP comprimido não é suportado");
+
+  Header header;
+
+  // Máscaras de 32 bits diferentes de BGRA não são suportadas
+  if (compression == BMP_BI_BITFIELDS)
   {
-    const uint8_t *row = pixels + y * pitch;
-    for (int x = 0; x < img.width; ++x)
+    if (info_size < 52 || read_u32(info + 40) != 0x00FF0000u || read_u32(info + 44) != 0x0000FF00u || read_u32(info + 48) != 0x000000FFu)
+      throw std::runtime_error("Máscaras de cor do BMP não suportadas");
+
+    header.alpha = info_size >= 56 && read_u32(info + 52) == 0xFF000000u;
+  }
+
+  header.width = width;
+  header.top_down = height < 0;
+  header.height = height < 0 ? -height : height;
+  header.bits_per_pixel = bits;
+  header.pixel_offset = read_u32(data + 10);
+  header.stride = ((static_cast<std::size_t>(width) * bits / 8) + 3) & ~static_cast<std::size_t>(3);
+
+  if (bits == 8)
+  {
+    header.palette_size = colors_used ? static_cast<int>(colors_used) : 256;
+    std::size_t palette_offset = 14 + info_size;
+    if (header.palette_size > 256 || palette_offset + header.palette_size * 4 > size)
+      throw std::runtime_error("Paleta do BMP inválida");
+    header.palette = data + palette_offset;
+  }
+
+  if (header.pixel_offset + header.stride * header.height > size)
+    throw std::runtime_error("BMP truncado");
+
+  return header;
+}
+
+// ===================================================
+// Decodificação
+// ===================================================
+
+#ifdef BMP_SSSE3
+/**
+ * @brief Converte 4 pixels por vez de BGR (24 bits) para RGBA com um único pshufb
+ *
+ * @return int Número de pixels convertidos (o resto fica para o laço escalar)
+ *
+ * @note A leitura é de 16 bytes para 12 bytes úteis, então o laço para quando não há 16 bytes disponíveis
+ */
+BMP_SSSE3_TARGET static int convert_bgr_ssse3(const std::uint8_t *source, std::size_t available, models::Color *destination, int width)
+{
+  const __m128i shuffle = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+  const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+
+  int x = 0;
+  for (; x + 4 <= width && static_cast<std::size_t>(x) * 3 + 16 <= available; x += 4)
+  {
+    __m128i bgr = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + x * 3));
+    __m128i rgba = _mm_or_si128(_mm_shuffle_epi8(bgr, shuffle), alpha);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + x), rgba);
+  }
+  return x;
+}
+
+/**
+ * @brief Converte 4 pixels por vez de BGRA/BGRX (32 bits) para RGBA
+ */
+BMP_SSSE3_TARGET static int convert_bgra_ssse3(const std::uint8_t *source, models::Color *destination, int width, bool keep_alpha)
+{
+  const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+  const __m128i alpha = _mm_set1_epi32(keep_alpha ? 0 : static_cast<int>(0xFF000000u));
+
+  int x = 0;
+  for (; x + 4 <= width; x += 4)
+  {
+    __m128i bgra = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + x * 4));
+    __m128i rgba = _mm_or_si128(_mm_shuffle_epi8(bgra, shuffle), alpha);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + x), rgba);
+  }
+  return x;
+}
+
+static const bool cpu_has_ssse3 = BMP_CPU_HAS_SSSE3();
+#endif
+
+/**
+ * @brief Converte uma linha BGR (24 bits) para RGBA
+ *
+ * @param source Início da linha no arquivo
+ * @param available Bytes que podem ser lidos a partir de source (inclui o que vem depois da linha)
+ * @param destination Linha de destino
+ * @param width Número de pixels
+ */
+static void convert_bgr_row(const std::uint8_t *source, std::size_t available, models::Color *destination, int width)
+{
+  int x = 0;
+
+#ifdef BMP_SSSE3
+  if (cpu_has_ssse3)
+    x = convert_bgr_ssse3(source, available, destination, width);
+#endif
+
+  for (; x < width; x++)
+  {
+    const std::uint8_t *p = source + x * 3;
+    destination[x] = {p[2], p[1], p[0], 255};
+  }
+}
+
+/**
+ * @brief Converte uma linha BGRA/BGRX (32 bits) para RGBA
+ *
+ * @param keep_alpha Se falso, o quarto byte é ignorado e o alpha é 255
+ */
+static void convert_bgra_row(const std::uint8_t *source, models::Color *destination, int width, bool keep_alpha)
+{
+  int x = 0;
+
+#ifdef BMP_SSSE3
+  if (cpu_has_ssse3)
+    x = convert_bgra_ssse3(source, destination, width, keep_alpha);
+#endif
+
+  for (; x < width; x++)
+  {
+    const std::uint8_t *p = source + x * 4;
+    destination[x] = {p[2], p[1], p[0], keep_alpha ? p[3] : static_cast<std::uint8_t>(255)};
+  }
+}
+
+/**
+ * @brief Decodifica os pixels de um BMP direto no destino
+ *
+ * @param data Conteúdo do arquivo
+ * @param size Tamanho do arquivo
+ * @param header Cabeçalho (bmp::parse)
+ * @param destination Primeira linha de destino (topo da imagem)
+ * @param pitch Distância em Colors entre duas linhas de destino
+ *
+ * @note Cada linha do arquivo é lida uma única vez (direto das páginas, quando o arquivo está mapeado)
+ */
+void bmp::decode(const std::uint8_t *data, std::size_t size, const Header &header, models::Color *destination, std::size_t pitch)
+{
+  const std::uint8_t *end = data + size;
+
+  for (int y = 0; y < header.height; y++)
+  {
+    // Sem altura negativa, a primeira linha do arquivo é a de baixo
+    int file_row = header.top_down ? y : header.height - 1 - y;
+    const std::uint8_t *source = data + header.pixel_offset + header.stride * file_row;
+    models::Color *row = destination + pitch * y;
+
+    switch (header.bits_per_pixel)
     {
-      int i = y * img.width + x;
-      img.data[i] = {
-          row[x * 4 + 0], // R
-          row[x * 4 + 1], // G
-          row[x * 4 + 2], // B
-          row[x * 4 + 3]  // A
-      };
+    case 24:
+      convert_bgr_row(source, static_cast<std::size_t>(end - source), row, header.width);
+      break;
+
+    case 32:
+      convert_bgra_row(source, row, header.width, header.alpha);
+      break;
+
+    case 8:
+      for (int x = 0; x < header.width; x++)
+      {
+        int index = source[x] < header.palette_size ? source[x] : 0;
+        const std::uint8_t *entry = header.palette + index * 4;
+        row[x] = {entry[2], entry[1], entry[0], 255};
+      }
+      break;
     }
   }
+}
+
+BMPImage bmp::load(const std::string &filename)
+{
+  MappedFile file(filename);
+  Header header = parse(file);
+
+  BMPImage img;
+  img.width = header.width;
+  img.height = header.height;
+  img.data.resize(static_cast<std::size_t>(img.width) * img.height);
 
-  SDL_DestroySurface(converted);
+  decode(file, header, img.data.data(), img.width);
   return img;
 }
 
 // ===================================================
-// Criação da textura SDL3 a partir da imagem BMP
+// Criação da textura SDL3 a partir da imagem BMP (bytes r, g, b, a em qualquer endianness)
 // ===================================================
 SDL_Texture *bmp::createTextureFromBMP(SDL_Renderer *renderer, const BMPImage &img)
 {
   SDL_Texture *texture = SDL_CreateTexture(
       renderer,
-      SDL_PIXELFORMAT_RGBA8888,
+      SDL_PIXELFORMAT_RGBA32,
       SDL_TEXTUREACCESS_STATIC,
       img.width,
       img.height);
@@ -0,0 +1,573 @@
+#include <utils/pak.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+namespace pak
+{
+  static const char MAGIC[4] = {'P', 'A', 'K', '1'};
+
+  // Bloco gravado sem compressão (bit alto do tamanho na tabela de blocos)
+  static constexpr std::uint32_t RAW_CHUNK = 0x80000000u;
+
+  // Entradas a partir deste tamanho são descomprimidas por várias threads
+  static constexpr std::size_t PARALLEL_SIZE = 16 * CHUNK_SIZE;
+
+  // ===================================================
+  // LZ4 (formato de bloco)
+  // ===================================================
+
+  static std::uint32_t read32(const std::uint8_t *p)
+  {
+    std::uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+  }
+
+  // Comprimento estendido: bytes 255 somados até um byte menor
+  static bool read_length(const std::uint8_t *&ip, const std::uint8_t *end, std::size_t &length)
+  {
+    std::uint8_t byte;
+    do
+    {
+      if (ip >= end)
+        return false;
+      byte = *ip++;
+      length += byte;
+    } while (byte == 255);
+
+    return true;
+  }
+
+  static void write_length(std::uint8_t *&op, std::size_t length)
+  {
+    while (length >= 255)
+    {
+      *op++ = 255;
+      length -= 255;
+    }
+    *op++ = static_cast<std::uint8_t>(length);
+  }
+
+  // Maior saída possível do lz4_compress
+  static std::size_t lz4_bound(std::size_t size)
+  {
+    return size + size / 255 + 16;
+  }
+
+  /**
+   * @brief Comprime um bloco no formato LZ4
+   *
+   * @param source Dados originais
+   * @param size Tamanho dos dados (até 64 KB: os offsets das cópias cabem em 16 bits)
+   * @param destination Saída com pelo menos lz4_bound(size) bytes
+   * @return std::size_t Bytes escritos
+   *
+   * @note Busca gulosa com uma tabela de hash de 4 bytes (o formato é o do LZ4, a razão é a do modo rápido)
+   * @note Regras do formato: os últimos 5 bytes são literais e a última cópia começa 12 bytes antes do fim
+   */
+  static std::size_t lz4_compress(const std::uint8_t *source, std::size_t size, std::uint8_t *destination)
+  {
+    constexpr int HASH_LOG = 12;
+    std::uint32_t table[1 << HASH_LOG] = {};
+
+    const std::uint8_t *ip = source, *anchor = source, *end = source + size;
+    std::uint8_t *op = destination;
+
+    auto emit = [&](const std::uint8_t *literal_end, std::size_t offset, std::size_t match_length)
+    {
+      std::size_t literal_length = static_cast<std::size_t>(literal_end - anchor);
+      std::uint8_t *token = op++;
+      *token = static_cast<std::uint8_t>(std::min<std::size_t>(literal_length, 15) << 4);
+      if (literal_length >= 15)
+        write_length(op, literal_length - 15);
+
+      std::memcpy(op, anchor, literal_length);
+      op += literal_length;
+
+      // Última sequência: apenas literais
+      if (match_length == 0)
+        return;
+
+      *op++ = static_cast<std::uint8_t>(offset);
+      *op++ = static_cast<std::uint8_t>(offset >> 8);
+
+      match_length -= 4;
+      *token |= static_cast<std::uint8_t>(std::min<std::size_t>(match_length, 15));
+      if (match_length >= 15)
+        write_length(op, match_length - 15);
+    };
+
+    if (size > 12)
+    {
+      const std::uint8_t *match_limit = end - 12;
+      const std::uint8_t *extend_limit = end - 5;
+
+      while (ip < match_limit)
+      {
+        std::uint32_t sequence = read32(ip);
+        std::uint32_t slot = (sequence * 2654435761u) >> (32 - HASH_LOG);
+        const std::uint8_t *reference = source + table[slot];
+        table[slot] = static_cast<std::uint32_t>(ip - source);
+
+        if (reference < ip && ip - reference <= 65535 && read32(reference) == sequence)
+        {
+          std::size_t length = 4;
+          while (ip + length < extend_limit && reference[length] == ip[length])
+            length++;
+
+          emit(ip, static_cast<std::size_t>(ip - reference), length);
+          ip += length;
+          anchor = ip;
+        }
+        else
+          ip++;
+      }
+    }
+
+    emit(end, 0, 0);
+    return static_cast<std::size_t>(op - destination);
+  }
+
+  /**
+   * @brief Descomprime um bloco LZ4
+   *
+   * @return true Se o bloco é válido e preencheu exatamente destination_size bytes
+   *
+   * @note Todas as leituras e escritas são verificadas (o pacote pode estar corrompido)
+   */
+  static bool lz4_decompress(const std::uint8_t *source, std::size_t source_size, std::uint8_t *destination, std::size_t destination_size)
+  {
+    const std::uint8_t *ip = source, *end = source + source_size;
+    std::uint8_t *op = destination, *out_end = destination + destination_size;
+
+    while (ip < end)
+    {
+      unsigned token = *ip++;
+
+      std::size_t literal_length = token >> 4;
+      if (literal_length == 15 && !read_length(ip, end, literal_length))
+        return false;
+      if (literal_length > static_cast<std::size_t>(end - ip) || literal_length > static_cast<std::size_t>(out_end - op))
+        return false;
+
+      std::memcpy(op, ip, literal_length);
+      op += literal_length;
+      ip += literal_length;
+
+      if (ip == end)
+        break;
+
+      if (end - ip < 2)
+        return false;
+      std::size_t offset = ip[0] | (ip[1] << 8);
+      ip += 2;
+      if (offset == 0 || offset > static_cast<std::size_t>(op - destination))
+        return false;
+
+      std::size_t match_length = token & 15;
+      if (match_length == 15 && !read_length(ip, end, match_length))
+        return false;
+      match_length += 4;
+      if (match_length > static_cast<std::size_t>(out_end - op))
+        return false;
+
+      // Cópias com offset menor que o comprimento repetem o padrão: byte a byte
+      const std::uint8_t *match = op - offset;
+      if (offset >= match_length)
+        std::memcpy(op, match, match_length);
+      else
+        for (std::size_t i = 0; i < match_length; i++)
+          op[i] = match[i];
+      op += match_length;
+    }
+
+    return op == out_end;
+  }
+
+  // ===================================================
+  // Pacote
+  // ===================================================
+
+  std::uint64_t hash(std::string_view name)
+  {
+    std::uint64_t value = 1469598103934665603ull;
+    for (char c : name)
+    {
+      value ^= static_cast<std::uint8_t>(c);
+      value *= 1099511628211ull;
+    }
+    return value;
+  }
+
+  Archive::Archive(const std::string &filename) : mapped(filename)
+  {
+    const std::uint8_t *data = mapped.data();
+    std::size_t size = mapped.size();
+
+    Header header;
+    if (size < sizeof(header))
+      throw std::runtime_error("Pacote truncado: '" + filename + "'");
+
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0 || header.version != VERSION)
+      throw std::runtime_error("Formato de pacote não suportado: '" + filename + "'");
+
+    if (header.directory_offset % ALIGNMENT != 0 || header.directory_offset > size ||
+        header.entry_count > (size - header.directory_offset) / sizeof(Entry) || header.names_offset > size)
+      throw std::runtime_error("Diretório inválido: '" + filename + "'");
+
+    entries = reinterpret_cast<const Entry *>(data + header.directory_offset);
+    count = header.entry_count;
+    names = reinterpret_cast<const char *>(data + header.names_offset);
+    names_size = size - header.names_offset;
+  }
+
+  std::string_view Archive::name(const Entry &entry) const
+  {
+    if (entry.name_offset > names_size || entry.name_length > names_size - entry.name_offset)
+      return {};
+    return std::string_view(names + entry.name_offset, entry.name_length);
+  }
+
+  const Entry *Archive::find(std::string_view name) const
+  {
+    std::uint64_t key = hash(name);
+    const Entry *entry = std::lower_bound(begin(), end(), key, [](const Entry &e, std::uint64_t value)
+                                          { return e.hash < value; });
+
+    for (; entry != end() && entry->hash == key; entry++)
+    {
+      if (this->name(*entry) == name)
+        return entry;
+    }
+
+    return nullptr;
+  }
+
+  /**
+   * @brief Lê o conteúdo de uma entrada
+   *
+   * @param entry Entrada do diretório deste pacote
+   * @param file Recebe o conteúdo
+   * @return true Se a entrada é válida
+   *
+   * @note Entradas sem compressão apontam para as páginas do arquivo (nenhuma cópia). Entradas LZ4 são
+   *       descomprimidas em file.storage, um bloco de CHUNK_SIZE por vez, divididos entre as threads quando
+   *       a entrada passa de PARALLEL_SIZE
+   */
+  bool Archive::read(const Entry &entry, File &file) const
+  {
+    if (entry.offset > mapped.size() || entry.size > mapped.size() - entry.offset)
+      return false;
+
+    const std::uint8_t *data = mapped.data() + entry.offset;
+
+    if (entry.compression == Compression::NONE)
+    {
+      if (entry.size != entry.original_size)
+        return false;
+
+      file.storage.clear();
+      file.data = data;
+      file.size = static_cast<std::size_t>(entry.size);
+      return true;
+    }
+
+    if (entry.compression != Compression::LZ4 ||
+        entry.chunk_count != (entry.original_size + CHUNK_SIZE - 1) / CHUNK_SIZE ||
+        entry.size < entry.chunk_count * sizeof(std::uint32_t))
+      return false;
+
+    // Início de cada bloco a partir da tabela de tamanhos
+    std::vector<std::size_t> starts(entry.chunk_count + 1);
+    starts[0] = entry.chunk_count * sizeof(std::uint32_t);
+    for (std::uint32_t i = 0; i < entry.chunk_count; i++)
+    {
+      std::uint32_t chunk_size;
+      std::memcpy(&chunk_size, data + i * sizeof(std::uint32_t), sizeof(chunk_size));
+      starts[i + 1] = starts[i] + (chunk_size & ~RAW_CHUNK);
+    }
+
+    if (starts[entry.chunk_count] != entry.size)
+      return false;
+
+    file.storage.resize(static_cast<std::size_t>(entry.original_size));
+    file.data = file.storage.data();
+    file.size = file.storage.size();
+
+    std::atomic<std::uint32_t> next{0};
+    std::atomic<bool> ok{true};
+
+    auto decompress = [&]()
+    {
+      for (std::uint32_t i = next++; i < entry.chunk_count; i = next++)
+      {
+        std::size_t begin = static_cast<std::size_t>(i) * CHUNK_SIZE;
+        std::size_t size = std::min<std::size_t>(CHUNK_SIZE, file.size - begin);
+        const std::uint8_t *chunk = data + starts[i];
+        std::size_t chunk_size = starts[i + 1] - starts[i];
+
+        std::uint32_t flags;
+        std::memcpy(&flags, data + i * sizeof(std::uint32_t), sizeof(flags));
+
+        if (flags & RAW_CHUNK)
+        {
+          if (chunk_size != size)
+            ok = false;
+          else
+            std::memcpy(file.storage.data() + begin, chunk, size);
+        }
+        else if (!lz4_decompress(chunk, chunk_size, file.storage.data() + begin, size))
+          ok = false;
+      }
+    };
+
+    std::vector<std::thread> helpers;
+    if (file.size >= PARALLEL_SIZE)
+    {
+      unsigned int hardware = std::thread::hardware_concurrency();
+      unsigned int count = std::min<unsigned int>(std::clamp(hardware, 1u, 8u) - 1, entry.chunk_count - 1);
+      for (unsigned int i = 0; i < count; i++)
+        helpers.emplace_back(decompress);
+    }
+
+    decompress();
+    for (std::thread &helper : helpers)
+      helper.join();
+
+    return ok;
+  }
+
+  /**
+   * @brief Gera um pacote
+   *
+   * @param filename Arquivo .pak de saída
+   * @param root Diretório dos arquivos
+   * @param names Caminhos relativos a root (separados por '/'), que viram os nomes das entradas
+   * @param compress Comprime com LZ4 as entradas que diminuem
+   * @return true Se o pacote foi gravado
+   */
+  bool build(const std::string &filename, const std::string &root, const std::vector<std::string> &names, bool compress)
+  {
+    std::FILE *file = std::fopen(filename.c_str(), "wb");
+    if (!file)
+      return false;
+
+    bool written = true;
+    std::uint64_t position = 0;
+
+    auto write = [&](const void *data, std::size_t size)
+    {
+      written = written && (size == 0 || std::fwrite(data, size, 1, file) == 1);
+      position += size;
+    };
+
+    auto align = [&]()
+    {
+      static const std::uint8_t zeros[ALIGNMENT] = {};
+      write(zeros, (ALIGNMENT - position % ALIGNMENT) % ALIGNMENT);
+    };
+
+    // O cabeçalho é regravado no final, com as posições do diretório
+    Header header = {};
+    write(&header, sizeof(header));
+
+    std::vector<Entry> entries;
+    std::string name_table;
+
+    for (const std::string &name : names)
+    {
+      std::vector<std::uint8_t> content;
+      std::string path = root + "/" + name;
+      std::FILE *input = std::fopen(path.c_str(), "rb");
+      if (!input)
+      {
+        std::cerr << "Erro ao abrir '" << path << "'\n";
+        std::fclose(file);
+        return false;
+      }
+
+      std::uint8_t buffer[1 << 16];
+      std::size_t count;
+      while ((count = std::fread(buffer, 1, sizeof(buffer), input)) > 0)
+        content.insert(content.end(), buffer, buffer + count);
+      std::fclose(input);
+
+      Entry entry = {};
+      entry.hash = hash(name);
+      entry.original_size = content.size();
+      entry.name_offset = static_cast<std::uint32_t>(name_table.size());
+      entry.name_length = static_cast<std::uint32_t>(name.size());
+      name_table += name;
+
+      // Blocos independentes: cada um pode ser descomprimido por uma thread
+      std::vector<std::uint8_t> packed;
+      if (compress && !content.empty())
+      {
+        std::uint32_t chunk_count = static_cast<std::uint32_t>((content.size() + CHUNK_SIZE - 1) / CHUNK_SIZE);
+        std::vector<std::uint32_t> sizes(chunk_count);
+        std::vector<std::uint8_t> chunks;
+        std::vector<std::uint8_t> scratch(lz4_bound(CHUNK_SIZE));
+
+        for (std::uint32_t i = 0; i < chunk_count; i++)
+        {
+          const std::uint8_t *chunk = content.data() + static_cast<std::size_t>(i) * CHUNK_SIZE;
+          std::size_t size = std::min<std::size_t>(CHUNK_SIZE, content.size() - static_cast<std::size_t>(i) * CHUNK_SIZE);
+          std::size_t compressed = lz4_compress(chunk, size, scratch.data());
+
+          if (compressed < size)
+          {
+            sizes[i] = static_cast<std::uint32_t>(compressed);
+            chunks.insert(chunks.end(), scratch.begin(), scratch.begin() + compressed);
+          }
+          else
+          {
+            sizes[i] = static_cast<std::uint32_t>(size) | RAW_CHUNK;
+            chunks.insert(chunks.end(), chunk, chunk + size);
+          }
+        }
+
+        std::size_t total = sizes.size() * sizeof(std::uint32_t) + chunks.size();
+        if (total < content.size())
+        {
+          packed.resize(sizes.size() * sizeof(std::uint32_t));
+          std::memcpy(packed.data(), sizes.data(), packed.size());
+          packed.insert(packed.end(), chunks.begin(), chunks.end());
+          entry.compression = Compression::LZ4;
+          entry.chunk_count = chunk_count;
+        }
+      }
+
+      const std::vector<std::uint8_t> &stored = entry.compression == Compression::LZ4 ? packed : content;
+
+      align();
+      entry.offset = position;
+      entry.size = stored.size();
+      write(stored.data(), stored.size());
+      entries.push_back(entry);
+    }
+
+    // Diretório ordenado pelo hash (nomes iguais no hash ficam em ordem alfabética)
+    std::sort(entries.begin(), entries.end(), [&](const Entry &a, const Entry &b)
+              {
+                if (a.hash != b.hash)
+                  return a.hash < b.hash;
+                return name_table.compare(a.name_offset, a.name_length, name_table, b.name_offset, b.name_length) < 0; });
+
+    align();
+    std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.entry_count = static_cast<std::uint32_t>(entries.size());
+    header.directory_offset = position;
+    write(entries.data(), entries.size() * sizeof(Entry));
+
+    header.names_offset = position;
+    write(name_table.data(), name_table.size());
+
+    written = written && std::fseek(file, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, file) == 1;
+    return std::fclose(file) == 0 && written;
+  }
+
+  // ===================================================
+  // Pacotes montados
+  // ===================================================
+
+  struct Mount
+  {
+    std::string prefix; // Diretório do pacote, com a barra final
+    std::unique_ptr<Archive> archive;
+  };
+
+  static std::vector<Mount> &mounts()
+  {
+    static std::vector<Mount> list;
+    return list;
+  }
+
+  /**
+   * @brief Monta um pacote
+   *
+   * @param filename Caminho do .pak
+   * @return true Se o pacote foi montado (um arquivo inexistente não é erro, os arquivos soltos continuam valendo)
+   */
+  bool mount(const std::string &filename)
+  {
+    std::error_code error;
+    if (!std::filesystem::exists(filename, error))
+      return false;
+
+    try
+    {
+      Mount entry;
+      std::size_t slash = filename.find_last_of("/\\");
+      entry.prefix = slash == std::string::npos ? "" : filename.substr(0, slash + 1);
+      entry.archive = std::make_unique<Archive>(filename);
+      mounts().push_back(std::move(entry));
+      return true;
+    }
+    catch (const std::exception &e)
+    {
+      std::cerr << "Erro ao montar pacote: " << e.what() << "\n";
+      return false;
+    }
+  }
+
+  // Entrada de um caminho nos pacotes montados (o último montado tem preferência)
+  static const Entry *lookup(const std::string &path, const Archive *&archive)
+  {
+    std::vector<Mount> &list = mounts();
+    for (auto it = list.rbegin(); it != list.rend(); it++)
+    {
+      if (path.compare(0, it->prefix.size(), it->prefix) != 0)
+        continue;
+
+      std::string name = path.substr(it->prefix.size());
+      std::replace(name.begin(), name.end(), '\\', '/');
+
+      if (const Entry *entry = it->archive->find(name))
+      {
+        archive = it->archive.get();
+        return entry;
+      }
+    }
+
+    return nullptr;
+  }
+
+  bool contains(const std::string &path)
+  {
+    const Archive *archive;
+    return lookup(path, archive) != nullptr;
+  }
+
+  /**
+   * @brief Lê um arquivo dos pacotes montados
+   *
+   * @param path Caminho do arquivo solto que o pacote substitui
+   * @param file Recebe o conteúdo (sem cópia quando a entrada não é comprimida)
+   * @return true Se algum pacote tem o arquivo
+   */
+  bool open(const std::string &path, File &file)
+  {
+    const Archive *archive;
+    const Entry *entry = lookup(path, archive);
+    if (!entry)
+      return false;
+
+    if (!archive->read(*entry, file))
+    {
+      std::cerr << "Entrada corrompida no pacote: '" << path << "'\n";
+      return false;
+    }
+
+    return true;
+  }
+}
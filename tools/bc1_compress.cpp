@@ -0,0 +1,87 @@
+// Compressor offline de texturas: BMP -> .bc1 (blocos BC1 de todos os níveis de mipmap)
+//
+// Uso: bc1_compress <entrada.bmp> [saída.bc1] [--fast]
+//
+// Os mipmaps são gerados a partir do BMP original (com correção de gamma) e cada nível é comprimido
+// com a qualidade BC1_HIGH (ou BC1_FAST com --fast). O erro (PSNR) de cada nível é mostrado no final.
+// Em tempo de execução o arquivo .bc1 é carregado pelo loadTexture, sem descompressão
+
+#include <models/texture.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+int main(int argc, char **argv)
+{
+  std::string input, output;
+  models::TextureCompression quality = models::TextureCompression::BC1_HIGH;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "--fast") == 0)
+      quality = models::TextureCompression::BC1_FAST;
+    else if (input.empty())
+      input = argv[i];
+    else
+      output = argv[i];
+  }
+
+  if (input.empty())
+  {
+    std::printf("Uso: %s <entrada.bmp> [saída.bc1] [--fast]\n", argv[0]);
+    return 1;
+  }
+
+  if (output.empty())
+  {
+    std::size_t dot = input.find_last_of('.');
+    output = (dot == std::string::npos ? input : input.substr(0, dot)) + ".bc1";
+  }
+
+  models::Texture texture;
+  if (!models::loadTexture(input, texture))
+    return 1;
+
+  // Cópia dos texels originais para medir o erro
+  models::Texture original = texture;
+
+  texture.compress(quality);
+  if (!models::saveCompressedTexture(output, texture))
+  {
+    std::printf("Erro ao gravar '%s'\n", output.c_str());
+    return 1;
+  }
+
+  std::size_t original_bytes = original.texels.size() * sizeof(models::Color);
+  std::size_t compressed_bytes = texture.blocks.size() * sizeof(models::BC1Block);
+  std::printf("%s -> %s (%dx%d, %d níveis, %s)\n", input.c_str(), output.c_str(), texture.width, texture.height, texture.levelCount(),
+              quality == models::TextureCompression::BC1_HIGH ? "high" : "fast");
+  std::printf("  %zu KB -> %zu KB\n", original_bytes / 1024, compressed_bytes / 1024);
+
+  for (int i = 0; i < texture.levelCount(); i++)
+  {
+    const models::TextureLevel &level = texture.levels[i];
+    const models::TextureLevel &source = original.levels[i];
+
+    double error = 0.0;
+    for (int y = 0; y < level.height; y++)
+    {
+      for (int x = 0; x < level.width; x++)
+      {
+        models::Color a = original.data(source)[y * source.width + x];
+        models::Color b = texture.fetchCompressed(level, x, y);
+        error += (a.r - b.r) * (a.r - b.r) + (a.g - b.g) * (a.g - b.g) + (a.b - b.b) * (a.b - b.b);
+      }
+    }
+
+    double mse = error / (3.0 * level.width * level.height);
+    if (mse > 0.0)
+      std::printf("  nível %d (%dx%d): PSNR %.2f dB\n", i, level.width, level.height, 10.0 * std::log10(255.0 * 255.0 / mse));
+    else
+      std::printf("  nível %d (%dx%d): sem perdas\n", i, level.width, level.height);
+  }
+
+  return 0;
+}
@@ -0,0 +1,103 @@
+// Empacotador de assets: diretório -> .pak (diretório ordenado, entradas alinhadas em 64 bytes)
+//
+// Uso: pak_build <diretório> [saída.pak] [--lz4]
+//
+// Todos os arquivos do diretório (e subdiretórios) entram no pacote com o caminho relativo como nome.
+// Com --lz4 as entradas que diminuem são comprimidas em blocos de 64 KB, descomprimidos em paralelo.
+// O pacote padrão é <diretório>/assets.pak, montado pelo jogo na inicialização no lugar dos arquivos soltos
+
+#include <utils/pak.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+  std::string root, output;
+  bool compress = false;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "--lz4") == 0)
+      compress = true;
+    else if (root.empty())
+      root = argv[i];
+    else
+      output = argv[i];
+  }
+
+  if (root.empty())
+  {
+    std::printf("Uso: %s <diretório> [saída.pak] [--lz4]\n", argv[0]);
+    return 1;
+  }
+
+  if (output.empty())
+    output = root + "/assets.pak";
+
+  std::error_code error;
+  std::filesystem::path output_path = std::filesystem::weakly_canonical(output, error);
+
+  std::vector<std::string> names;
+  std::uintmax_t original_bytes = 0;
+  for (const auto &item : std::filesystem::recursive_directory_iterator(root, error))
+  {
+    if (!item.is_regular_file() || std::filesystem::weakly_canonical(item.path(), error) == output_path)
+      continue;
+
+    names.push_back(std::filesystem::relative(item.path(), root).generic_string());
+    original_bytes += item.file_size();
+  }
+
+  if (error)
+  {
+    std::printf("Erro ao listar '%s': %s\n", root.c_str(), error.message().c_str());
+    return 1;
+  }
+
+  std::sort(names.begin(), names.end());
+
+  if (!pak::build(output, root, names, compress))
+  {
+    std::printf("Erro ao gravar '%s'\n", output.c_str());
+    return 1;
+  }
+
+  pak::Archive archive(output);
+  std::printf("%s: %zu arquivos, %ju KB -> %ju KB%s\n", output.c_str(), archive.size(), original_bytes / 1024,
+              static_cast<std::uintmax_t>(std::filesystem::file_size(output)) / 1024, compress ? " (lz4)" : "");
+
+  // Confere cada entrada contra o arquivo original (relido do disco e comparado byte a byte)
+  std::vector<std::uint8_t> original;
+  for (const pak::Entry &entry : archive)
+  {
+    std::string_view name = archive.name(entry);
+    std::string path = root + "/" + std::string(name);
+
+    original.clear();
+    std::FILE *input = std::fopen(path.c_str(), "rb");
+    if (input)
+    {
+      std::uint8_t buffer[1 << 16];
+      std::size_t count;
+      while ((count = std::fread(buffer, 1, sizeof(buffer), input)) > 0)
+        original.insert(original.end(), buffer, buffer + count);
+      std::fclose(input);
+    }
+
+    pak::File file;
+    if (!input || !archive.read(entry, file) || file.size != entry.original_size || file.size != original.size() ||
+        (file.size > 0 && std::memcmp(file.data, original.data(), file.size) != 0))
+    {
+      std::printf("  entrada inválida: %.*s\n", static_cast<int>(name.size()), name.data());
+      return 1;
+    }
+  }
+
+  return 0;
+}
@@ -94,4 +94,59 @@ target("app")
   add_deps("rendering")
   add_deps("scene")
   add_deps("utils")
+  set_targetdir("./app")
+
+-- benchmark do layout das texturas (xmake build texture_layout_bench && xmake run texture_layout_bench)
+target("texture_layout_bench")
+  set_kind("binary")
+  set_default(false)
+  add_files("bench/texture_layout.cpp")
+  add_packages(table.unpack(project_libs))
+  add_deps("imgui")
+  add_deps("models")
+  add_deps("rendering")
+  add_deps("utils")
+  set_targetdir("./app")
+
+-- benchmark do pré-passo de profundidade (xmake build depth_prepass_bench && xmake run depth_prepass_bench)
+target("depth_prepass_bench")
+  set_kind("binary")
+  set_default(false)
+  add_files("bench/depth_prepass.cpp")
+  add_packages(table.unpack(project_libs))
+  add_deps("imgui")
+  add_deps("models")
+  add_deps("rendering")
+  add_deps("utils")
+  set_targetdir("./app")
+
+-- compressor offline de texturas (xmake build bc1_compress && xmake run bc1_compress assets/redbrick.bmp)
+target("bc1_compress")
+  set_kind("binary")
+  set_default(false)
+  add_files("tools/bc1_compress.cpp")
+  add_packages(table.unpack(project_libs))
+  add_deps("imgui")
+  add_deps("models")
+  add_deps("utils")
+  set_targetdir("./app")
+
+-- empacotador de assets (xmake build pak_build && xmake run pak_build assets [--lz4])
+target("pak_build")
+  set_kind("binary")
+  set_default(false)
+  add_files("tools/pak_build.cpp")
+  add_packages(table.unpack(project_libs))
+  add_deps("utils")
+  set_targetdir("./app")
+
+-- cozinhador offline de malhas (xmake build mesh_cook && xmake run mesh_cook modelo.obj)
+target("mesh_cook")
+  set_kind("binary")
+  set_default(false)
+  add_files("tools/mesh_cook.cpp")
+  add_packages(table.unpack(project_libs))
+  add_deps("imgui")
+  add_deps("models")
+  add_deps("utils")
   set_targetdir("./app")
\ No newline at end of file